@@ -41,6 +41,24 @@ const _ui = __binding__('_ui');
 let _current: Application | null = null;
 export type AEvent = Event<Application>; //!<
 
+/**
+ * Statistics of the image cache, returned by {@link NativeApplication.imageCacheStats}.
+ */
+export interface ImageCacheStats {
+	/** Number of cached image sources */
+	count: number;
+	/** Memory used by the decoded images in bytes */
+	capacity: number;
+	/** Memory budget of the image cache in bytes, 0 means unlimited */
+	maxCapacity: number;
+	/** Number of lookups served from the cache */
+	hits: number;
+	/** Number of lookups that created a new image source */
+	misses: number;
+	/** Number of image sources evicted to keep within the budget */
+	evictions: number;
+}
+
 /**
  * System clipboard interface.
  *
@@ -145,6 +163,15 @@ declare class NativeApplication extends Notification<AEvent> {
 	 */
 	usedResourceMemory(): number;
 
+	/**
+	 * Returns the statistics of the image cache.
+	 *
+	 * Images not used by any view are evicted in least recently used order
+	 * once `capacity` exceeds `maxCapacity`, they are reloaded on next use.
+	 * `maxCapacity` follows `maxResourceMemoryLimit` after it has been set.
+	 */
+	imageCacheStats(): ImageCacheStats;
+
 	/**
 	 * Clear cached resources.
 	 *
@@ -47,6 +47,22 @@ export interface Stat {
 	entries: Uint;     // ★ 关键字段：总键值对数量
 }
 
+/**
+ * Compare keys by code points, the same order as LMDB compares the UTF-8 bytes of keys.
+ * JS string comparison uses UTF-16 code units, which puts the non-BMP characters
+ * (surrogate pairs) before U+E000..U+FFFF.
+ */
+function compareKey(a: string, b: string): Int {
+	for (let i = 0, j = 0; i < a.length && j < b.length; ) {
+		const x = a.codePointAt(i)!, y = b.codePointAt(j)!;
+		if (x !== y)
+			return x < y ? -1: 1;
+		i += x > 0xFFFF ? 2: 1;
+		j += y > 0xFFFF ? 2: 1;
+	}
+	return a.length === b.length ? 0: a.length < b.length ? -1: 1;
+}
+
 /*
  * Native LMDB binding.
  * 
@@ -77,6 +93,144 @@ declare abstract class NativeLMDB {
 	scanRange(dbi: DBI, start: string, end: string, limit?: Uint): [string, Uint8Array][];
 	removePrefix(dbi: DBI): Int;
 	clear(dbi: DBI): Int;
+	begin(readonly?: boolean): NativeLMDBTxn | null;
+}
+
+/*
+ * Native LMDB transaction, see NativeLMDB.begin().
+ */
+declare abstract class NativeLMDBTxn {
+	private constructor();
+	readonly readonly: boolean;
+	readonly active: boolean;
+	get(dbi: DBI, key: string): string | null;
+	getBuf(dbi: DBI, key: string): Uint8Array | null;
+	set(dbi: DBI, key: string, value: string): Int;
+	setBuf(dbi: DBI, key: string, value: Uint8Array): Int;
+	remove(dbi: DBI, key: string): Int;
+	has(dbi: DBI, key: string): boolean;
+	cursor(dbi: DBI): NativeLMDBCursor | null;
+	commit(): Int;
+	abort(): void;
+}
+
+/*
+ * Native LMDB cursor, values are copied only when `key`/`val` are read.
+ */
+declare abstract class NativeLMDBCursor {
+	private constructor();
+	readonly valid: boolean;
+	readonly key: string | null;
+	readonly val: Uint8Array | null;
+	first(): boolean;
+	seek(key: string): boolean;
+	next(): boolean;
+	remove(): Int;
+}
+
+/**
+ * Explicit LMDB transaction with automatic JSONB encoding.
+ *
+ * All operations share one native transaction and are committed together,
+ * a write transaction blocks other writers until commit() or abort(),
+ * so keep it short and always finish it, see LMDB.transaction().
+ */
+export class Transaction {
+	private _txn: NativeLMDBTxn;
+
+	/**
+	 * @private
+	 */
+	constructor(txn: NativeLMDBTxn) {
+		this._txn = txn;
+	}
+
+	/**
+	 * Whether the transaction is read-only.
+	 */
+	get readonly(): boolean {
+		return this._txn.readonly;
+	}
+
+	/**
+	 * Whether the transaction is not yet committed or aborted.
+	 */
+	get active(): boolean {
+		return this._txn.active;
+	}
+
+	/**
+	 * Read raw binary value.
+	 */
+	getBuf(dbi: DBI, key: string): Uint8Array | null {
+		return this._txn.getBuf(dbi, key);
+	}
+
+	/**
+	 * Get a JSON value.
+	 */
+	get<T = any>(dbi: DBI, key: string): T | null {
+		const v = this._txn.getBuf(dbi, key);
+		return v != null ? jsonb.parse(v) : null;
+	}
+
+	/**
+	 * Store a JSON value, visible to others after commit().
+	 * @return 0 on success.
+	 */
+	set<T = any>(dbi: DBI, key: string, value: T): Int {
+		return this._txn.setBuf(dbi, key, jsonb.binaryify(value));
+	}
+
+	/**
+	 * Remove a key.
+	 */
+	remove(dbi: DBI, key: string): Int {
+		return this._txn.remove(dbi, key);
+	}
+
+	/**
+	 * Check if a key exists.
+	 */
+	has(dbi: DBI, key: string): boolean {
+		return this._txn.has(dbi, key);
+	}
+
+	/**
+	 * Iterate keys in [start, end] in order and decode values lazily,
+	 * nothing is materialized up front unlike LMDB.scanRange().
+	 *
+	 * @param start - First key, default from the first key of the table.
+	 * @param end - Last key, default to the end of the table.
+	 */
+	*entries<T = any>(dbi: DBI, start?: string, end?: string): Generator<[string, T]> {
+		const cur = this._txn.cursor(dbi);
+		if (!cur)
+			return;
+		let ok = start ? cur.seek(start): cur.first();
+		while (ok) {
+			const key = cur.key!;
+			if (end !== undefined && compareKey(key, end) > 0)
+				break;
+			yield [key, jsonb.parse(cur.val!)];
+			ok = cur.next();
+		}
+	}
+
+	/**
+	 * Commit all operations.
+	 * @return 0 on success.
+	 */
+	commit(): Int {
+		return this._txn.commit();
+	}
+
+	/**
+	 * Discard all operations.
+	 */
+	abort(): void {
+		this._txn.abort();
+	}
 }
 
 /**
@@ -266,6 +420,69 @@ export class LMDB {
 		return list as [string, T][];
 	}
 
+	/**
+	 * Begin an explicit transaction, see Transaction.
+	 *
+	 * The caller must commit() or abort() it, an unfinished write transaction
+	 * holds the write lock until it is garbage collected, prefer transaction().
+	 * Writes outside of it on the same thread fail while it is active.
+	 *
+	 * @param readonly - Begin a read-only transaction.
+	 * @return Transaction or null on error.
+	 */
+	begin(readonly?: boolean): Transaction | null {
+		const txn = this._lmdb.begin(!!readonly);
+		return txn ? new Transaction(txn): null;
+	}
+
+	/**
+	 * Run `fn` in one transaction that is always finished when `fn` returns,
+	 * committed if `fn` returns normally and aborted if it throws.
+	 *
+	 * @param readonly - Begin a read-only transaction.
+	 *
+	 * @example
+	 * ```ts
+	 * const total = db.transaction(txn => {
+	 * 	let total = 0;
+	 * 	for (const [,item] of txn.entries(dbi, 'order/', 'order/\uffff'))
+	 * 		total += item.price;
+	 * 	return total;
+	 * }, true);
+	 * ```
+	 */
+	transaction<R>(fn: (txn: Transaction) => R, readonly?: boolean): R {
+		const txn = this.begin(readonly);
+		if (!txn)
+			throw new Error('LMDB.transaction, cannot begin transaction');
+		try {
+			const r = fn(txn);
+			if (txn.active) {
+				const rc = txn.commit();
+				if (rc)
+					throw new Error(`LMDB.transaction, commit error ${rc}`);
+			}
+			return r;
+		} finally {
+			txn.abort(); // no-op after commit
+		}
+	}
+
+	/**
+	 * Run many writes in one transaction, see transaction().
+	 *
+	 * @example
+	 * ```ts
+	 * db.batch(txn => {
+	 * 	for (const item of items)
+	 * 		txn.set(dbi, item.id, item);
+	 * });
+	 * ```
+	 */
+	batch<R>(fn: (txn: Transaction) => R): R {
+		return this.transaction(fn);
+	}
+
 	/**
 	 * Scan key range and automatically decode JSONB values.
 	 * 
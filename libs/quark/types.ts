@@ -880,7 +880,7 @@ initDefaults(Vec2, { x: 0, y: 0 });
 /**
  * @type Vec2In:'0　0'|'vec2(0,0)'|N|[0,0]|Vec2
 */
-export type Vec2In = `${number} ${number}` | `vec2(${N},${N})` | N | [N,N] | Vec2;
+export type Vec2In = `${number} ${number}` | `vec2(${N},${N})` | N | [N,N] | Float32Array | Vec2;
 
 /**
  * @class Vec3
@@ -895,7 +895,7 @@ initDefaults(Vec3, { x: 0, y: 0, z: 0 });
 /**
  * @type Vec3In:'0　0　1'|'vec3(0,0,1)'|N|[0,0,1]|Vec3
 */
-export type Vec3In = `${number} ${number} ${number}` | `vec3(${N},${N},${N})` | N | [N,N,N] | Vec3;
+export type Vec3In = `${number} ${number} ${number}` | `vec3(${N},${N},${N})` | N | [N,N,N] | Float32Array | Vec3;
 
 /**
  * @class Vec4
@@ -914,7 +914,7 @@ initDefaults(Vec4, { x: 0, y: 0, z: 0, w: 0 });
  * @type Vec4In:'0　0　1　1'|'vec4(0,0,1,1)'|N|[0,0,1,1]|Vec4
 */
 export type Vec4In = `${number} ${number} ${number} ${number}` |
-	`vec4(${N},${N},${N},${N})` | N | [N,N,N,N] | Vec4;
+	`vec4(${N},${N},${N},${N})` | N | [N,N,N,N] | Float32Array | Vec4;
 
 /**
  * @class Curve
@@ -953,7 +953,7 @@ export class Rect extends Base<Rect> {
 }
 initDefaults(Rect, { begin: new Vec2, size: new Vec2 });
 export type RectIn = `rect(${N},${N},${N},${N})` | `rect(${N},${N})` | //!< {'rect(0,0,100,100)'|'rect(0,0)'|[0,0,100,100]|Rect}
-	[number,number,number,number] | Rect;
+	[number,number,number,number] | Float32Array | Rect;
 
 /**
  * @class Range
@@ -1060,7 +1060,7 @@ export class Mat extends Base<Mat> {
 	}
 }
 initDefaults(Mat, { m0: 1, m1: 0, m2: 0, m3: 0, m4: 1, m5: 0 });
-export type MatIn = N | Mat | ReturnType<typeof Mat.prototype.toString>; //!< {N|Mat|'mat(0,0,0,0,0,0)'}
+export type MatIn = N | Mat | Float32Array | ReturnType<typeof Mat.prototype.toString>; //!< {N|Mat|Float32Array|'mat(0,0,0,0,0,0)'}
 
 /**
  * @class Mat4
@@ -1099,7 +1099,7 @@ initDefaults(Mat4, {
 	m0: 1, m1: 0, m2: 0, m3: 0,m4: 0, m5: 1, m6: 0, m7: 0,
 	m8: 0, m9: 0, m10: 1, m11: 0,m12: 0, m13: 0, m14: 0, m15: 1
 });
-export type Mat4In = N | Mat4 | ReturnType<typeof Mat4.prototype.toString>;
+export type Mat4In = N | Mat4 | Float32Array | ReturnType<typeof Mat4.prototype.toString>;
 
 const colorScale = 1/255;
 
@@ -1956,7 +1956,7 @@ export function parseVec2(val: Vec2In, msg?: string): Vec2 { //!<
 		}
 	} else if (typeof val === 'number') {
 		return newVec2(val, val);
-	} else if (Array.isArray(val)) {
+	} else if (Array.isArray(val) || val instanceof Float32Array) {
 		return newVec2(val[0], val[1]);
 	} else if (val instanceof Vec2) {
 		return val;
@@ -1975,7 +1975,7 @@ export function parseVec3(val: Vec3In, msg?: string): Vec3 { //!<
 			return newVec3(parseFloat(m[1]), parseFloat(m[2]), parseFloat(m[3]));
 	} else if (typeof val === 'number') {
 		return newVec3(val, val, val);
-	} else if (Array.isArray(val)) {
+	} else if (Array.isArray(val) || val instanceof Float32Array) {
 		return newVec3(val[0], val[1], val[2]);
 	} else if (val instanceof Vec3) {
 		return val;
@@ -1996,7 +1996,7 @@ export function parseVec4(val: Vec4In, msg?: string): Vec4 { //!<
 		return newVec4(val, val, val, val);
 	} else if (val instanceof Vec4) {
 		return val;
-	} else if (Array.isArray(val)) {
+	} else if (Array.isArray(val) || val instanceof Float32Array) {
 		return newVec4(val[0],val[1],val[2],val[3]);
 	}
 	throw error(val, msg, ['0 0 1 1', 'vec4(0,0,1,1)']);
@@ -2041,7 +2041,7 @@ export function parseRect(val: RectIn, msg?: string): Rect { //!<
 		if (m) {
 			return newRect(parseFloat(m[1]), parseFloat(m[2]), parseFloat(m[3]), parseFloat(m[4]));
 		}
-	} else if (Array.isArray(val)) {
+	} else if (Array.isArray(val) || val instanceof Float32Array) {
 		return newRect(val[0], val[1], val[2], val[3]);
 	} else if (val instanceof Rect) {
 		return val;
@@ -2070,8 +2070,8 @@ export function parseBorderRadius(val: BorderRadiusIn, msg?: string): BorderRadi
 	throw error(val, msg);
 }
 
-const matReg = new RegExp(`^\s*mat\\(\s*${new Array(6).join(
-	'(-?(?:\\d+)?\\.?\\d+)\s*,\s*')}(-?(?:\\d+)?\\.?\\d+)\s*\\)\s*$`
+const matReg = new RegExp(`^\\s*mat\\(\\s*${new Array(6).join(
+	'(-?(?:\\d+)?\\.?\\d+)\\s*,\\s*')}(-?(?:\\d+)?\\.?\\d+)\\s*\\)\\s*$`
 );
 export function parseMat(val: MatIn, msg?: string): Mat { //!<
 	if (typeof val === 'string') {
@@ -2084,14 +2084,16 @@ export function parseMat(val: MatIn, msg?: string): Mat { //!<
 		}
 	} else if (typeof val === 'number') {
 		return newMat(val,0,0,0,val,0);
+	} else if (val instanceof Float32Array) {
+		return newMat(val[0], val[1], val[2], val[3], val[4], val[5]);
 	} else if (val instanceof Mat) {
 		return val;
 	} 
 	throw error(val, msg, ['mat(1,0,0,1,0,1)']);
 }
 
-const mat4Reg = new RegExp(`^\s*mat4\\(\s*${new Array(16).join(
-	'(-?(?:\\d+)?\\.?\\d+)\s*,\s*')}(-?(?:\\d+)?\\.?\\d+)\s*\\)\s*$`
+const mat4Reg = new RegExp(`^\\s*mat4\\(\\s*${new Array(16).join(
+	'(-?(?:\\d+)?\\.?\\d+)\\s*,\\s*')}(-?(?:\\d+)?\\.?\\d+)\\s*\\)\\s*$`
 );
 export function parseMat4(val: Mat4In, msg?: string): Mat4 { //!<
 	if (typeof val === 'string') {
@@ -2106,6 +2108,8 @@ export function parseMat4(val: Mat4In, msg?: string): Mat4 { //!<
 		}
 	} else if (typeof val === 'number') {
 		return newMat4(val,0,0,0,0,val,0,0,0,0,val,0,0,0,0,val);
+	} else if (val instanceof Float32Array) {
+		return newMat4(...Array.from(val.subarray(0, 16)));
 	} else if (val instanceof Mat4) {
 		return val;
 	}
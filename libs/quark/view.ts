@@ -754,6 +754,13 @@ export interface MorphView extends View {
  * @implements MorphView
  */
 export declare class Morph extends Box implements MorphView {
+	/**
+	 * Cache the subtree in an offscreen layer, it is rendered once into an image and then
+	 * composited as a single textured rect until a view inside it changes.
+	 * The view must clip its content and the layer holds a full surface size image.
+	 * Default: false
+	*/
+	layer: boolean;
 	translate: Vec2;
 	scale: Vec2;
 	skew: Vec2;
@@ -1206,6 +1213,14 @@ export declare class World extends Morph {
 	 * Default: 0.0f
 	 */
 	waypointRadius: Float;
+
+	/**
+	 * Simulate agents in parallel on the compute workers.
+	 * Agents always step from a snapshot of the world at the start of each frame,
+	 * so the results are identical to the serial mode and do not depend on the number of worker threads.
+	 * Default: false
+	 */
+	parallel: boolean;
 }
 
 /**
@@ -2068,6 +2083,7 @@ declare global {
 		}
 
 		interface MorphJSX extends BoxJSX, MorphViewJSX {
+			layer?: boolean;
 		}
 
 		interface EntityJSX extends ViewJSX, MorphViewJSX {
@@ -2130,6 +2146,7 @@ declare global {
 			predictionTime?: Float;
 			discoveryThresholdBuffer?: Float;
 			waypointRadius?: Float;
+			parallel?: boolean;
 		}
 
 		interface TextOptionsJSX {
@@ -56,6 +56,28 @@ export interface Options {
 	enableCAPAQuantizeCoverage?: boolean;
 };
 
+/**
+ * @interface ProfilerFrame
+ * A rendered frame recorded by the window profiler, times are in microseconds
+*/
+export interface ProfilerFrame {
+	time: number; //!< frame begin time
+	duration: number; //!< whole frame duration
+	class: number; //!< CSS class apply duration
+	action: number; //!< actions advance duration
+	layoutForward: number; //!< forward layout pass duration
+	layoutReverse: number; //!< reverse layout pass duration
+	paint: number; //!< painter visitation duration
+	swap: number; //!< hand the recorded commands to the rendering thread, swapBuffer() duration
+	submit: number; //!< GPU submit duration on the rendering thread, filled in when the next frame ends
+	layoutViews: number; //!< views laid out
+	paintViews: number; //!< views visited by the painter
+	drawCalls: number; //!< draw commands recorded by the canvas
+	pathCacheHits: number; //!< path cache lookups served from the cache
+	pathCacheMisses: number; //!< path cache lookups that built new data
+	pathCacheEvictions: number; //!< path cache entries evicted by the capacity limit
+}
+
 class RootViewController extends ViewController {
 	constructor(window: Window) {
 		super({}, { window, children: [], owner: null as any });
@@ -137,6 +159,36 @@ declare class NativeWindow extends Notification<WEvent> {
 	*/
 	debugMode: boolean;
 
+	/**
+	 * Get or set whether to draw only the damaged region of the window,
+	 * when only the appearance of boxes changed, such as background colors or the input cursor.
+	 * The render backend must preserve the surface between frames.
+	 * Default: false
+	*/
+	partialRedraw: boolean;
+
+	/**
+	 * Get or set whether to typeset the views of large levels in parallel on the compute workers,
+	 * that is the reverse layout pass, the forward pass stays serial.
+	 * The views are grouped by parent and every level is joined before the next one.
+	 * Default: false
+	*/
+	parallelLayout: boolean;
+
+	/**
+	 * Get or set the number of unchanged frames, after which the clipped morph views are
+	 * cached in offscreen layers automatically, see `Morph.layer`.
+	 * Default: 0, disabled
+	*/
+	autoLayerFrames: Uint;
+
+	/**
+	 * Get or set whether to record per-frame phase timings and counters,
+	 * the most recent 300 rendered frames are kept
+	 * Default: false
+	*/
+	profiling: boolean;
+
 	/**
 	 * When rendering next frame call,
 	 * if a frame render is not complete, it will be wait for complete.
@@ -170,6 +222,22 @@ declare class NativeWindow extends Notification<WEvent> {
 	*/
 	setCursorStyle(style: types.CursorStyle): void;
 
+	/**
+	 * Get the frames recorded while profiling, oldest first
+	*/
+	profilerFrames(): ProfilerFrame[];
+
+	/**
+	 * Get the frames recorded while profiling as Chrome trace event JSON,
+	 * it can be loaded into chrome://tracing or Perfetto
+	*/
+	profilerTrace(): string;
+
+	/**
+	 * Clear the frames recorded while profiling
+	*/
+	profilerClear(): void;
+
 	/**
 	*/
 	constructor(opts?: Options);
@@ -33,6 +33,137 @@
 #include "./ui.h"
 
 namespace qk { namespace js {
+	typedef LMDB::Txn LMDBTxn;
+	typedef LMDB::Cursor LMDBCursor;
+
+	struct MixLMDBCursor: MixObject {
+		typedef LMDBCursor Type;
+
+		static void binding(JSObject* exports, Worker* worker) {
+			Js_Define_Class(LMDBCursor, 0, {
+				Js_Throw("Access forbidden.");
+			});
+
+			Js_MixObject_Acce_Get(LMDBCursor, bool, valid, valid);
+
+			Js_Class_Accessor_Get(key, {
+				auto key = self->key();
+				if (self->valid()) {
+					Js_Return(String(*key, key.length()));
+				} else {
+					Js_Return_Null();
+				}
+			});
+
+			Js_Class_Accessor_Get(val, {
+				if (self->valid()) {
+					Js_Return(self->val().copy()); // the only copy, made when the value is read
+				} else {
+					Js_Return_Null();
+				}
+			});
+
+			Js_Class_Method(first, {
+				Js_Return(self->first());
+			});
+
+			Js_Class_Method(seek, {
+				Js_Parse_Args(String, 0, "key = %s");
+				Js_Return(self->seek(arg0));
+			});
+
+			Js_Class_Method(next, {
+				Js_Return(self->next());
+			});
+
+			Js_Class_Method(remove, {
+				Js_Return(self->remove());
+			});
+
+			cls->exports("LMDBCursor", exports);
+		}
+	};
+
+	struct MixLMDBTxn: MixObject {
+		typedef LMDBTxn Type;
+
+		static void binding(JSObject* exports, Worker* worker) {
+			Js_Define_Class(LMDBTxn, 0, {
+				Js_Throw("Access forbidden.");
+			});
+
+			Js_MixObject_Acce_Get(LMDBTxn, bool, readonly, readonly);
+			Js_MixObject_Acce_Get(LMDBTxn, bool, active, active);
+
+			Js_Class_Method(get, {
+				Js_Parse_Args(NativePtr, 0, "dbi = %s");
+				Js_Parse_Args(String, 1, "key = %s");
+				String out;
+				if (self->get((LMDB::DBI*)arg0, arg1, &out) == 0) {
+					Js_Return(out); // found
+				} else {
+					Js_Return_Null(); // not found
+				}
+			});
+
+			Js_Class_Method(getBuf, {
+				Js_Parse_Args(NativePtr, 0, "dbi = %s");
+				Js_Parse_Args(String, 1, "key = %s");
+				Buffer out;
+				if (self->get_buf((LMDB::DBI*)arg0, arg1, &out) == 0) {
+					Js_Return(out); // found
+				} else {
+					Js_Return_Null(); // not found
+				}
+			});
+
+			Js_Class_Method(set, {
+				Js_Parse_Args(NativePtr, 0, "dbi = %s");
+				Js_Parse_Args(String, 1, "key = %s");
+				Js_Parse_Args(String, 2, "val = %s");
+				Js_Return(self->set((LMDB::DBI*)arg0, arg1, arg2));
+			});
+
+			Js_Class_Method(setBuf, {
+				Js_Parse_Args(NativePtr, 0, "dbi = %s");
+				Js_Parse_Args(String, 1, "key = %s");
+				Js_Parse_Args(WeakBuffer, 2, "val = %s");
+				Js_Return(self->set_buf((LMDB::DBI*)arg0, arg1, arg2.buffer()));
+			});
+
+			Js_Class_Method(remove, {
+				Js_Parse_Args(NativePtr, 0, "dbi = %s");
+				Js_Parse_Args(String, 1, "key = %s");
+				Js_Return(self->remove((LMDB::DBI*)arg0, arg1));
+			});
+
+			Js_Class_Method(has, {
+				Js_Parse_Args(NativePtr, 0, "dbi = %s");
+				Js_Parse_Args(String, 1, "key = %s");
+				Js_Return(self->has((LMDB::DBI*)arg0, arg1));
+			});
+
+			Js_Class_Method(cursor, {
+				Js_Parse_Args(NativePtr, 0, "dbi = %s");
+				Sp<LMDBCursor> cur;
+				if (self->cursor((LMDB::DBI*)arg0, &cur) == 0) {
+					Js_Return(MixObject::mix(cur.get())->handle());
+				} else {
+					Js_Return_Null();
+				}
+			});
+
+			Js_Class_Method(commit, {
+				Js_Return(self->commit());
+			});
+
+			Js_Class_Method(abort, {
+				self->abort();
+			});
+
+			cls->exports("LMDBTxn", exports);
+		}
+	};
 
 	struct MixLMDB: MixObject {
 		typedef LMDB Type;
@@ -192,7 +323,20 @@ namespace qk { namespace js {
 				Js_Return(self->clear((LMDB::DBI*)arg0));
 			});
 
+			Js_Class_Method(begin, {
+				Js_Parse_Args(bool, 0, "readonly = %s", (false));
+				Sp<LMDBTxn> txn;
+				if (self->begin(&txn, arg0) == 0) {
+					Js_Return(MixObject::mix(txn.get())->handle());
+				} else {
+					Js_Return_Null();
+				}
+			});
+
 			cls->exports("LMDB", exports);
+
+			MixLMDBTxn::binding(exports, worker);
+			MixLMDBCursor::binding(exports, worker);
 		}
 	};
 
@@ -83,10 +83,12 @@ namespace qk { namespace js {
 
 	class MixMorph: public MixViewObject {
 	public:
+		typedef Morph Type;
 		virtual MorphView* asMorphView() { return self<Morph>(); }
 		static void binding(JSObject* exports, Worker* worker) {
 			Js_Define_Class(Morph, Box, { Js_NewView(Morph); });
 			inheritMorphView(cls, worker);
+			Js_MixObject_Accessor(Morph, bool, layer, layer);
 			cls->exports("Morph", exports);
 		}
 	};
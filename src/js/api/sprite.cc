@@ -117,6 +117,7 @@ namespace qk { namespace js {
 			Js_MixObject_Accessor(World, float, predictionTime, predictionTime);
 			Js_MixObject_Accessor(World, float, discoveryThresholdBuffer, discoveryThresholdBuffer);
 			Js_MixObject_Accessor(World, float, waypointRadius, waypointRadius);
+			Js_MixObject_Accessor(World, bool, parallel, parallel);
 			cls->exports("World", exports);
 		}
 	};
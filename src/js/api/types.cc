@@ -561,9 +561,384 @@ namespace qk { namespace js {
 		return _newBounds->call(worker, 5, args);
 	}
 
+	// --------------------------------------------------------------------------------------------
+	// Native fast path of the parse functions, it handles the common inputs directly
+	// and returns false for anything else, then the js parse function does the work
+	// and reports the error for the bad inputs.
+
+	static inline bool is_space(char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+	}
+
+	static inline cChar* skip_space(cChar* s) {
+		while (is_space(*s)) s++;
+		return s;
+	}
+
+	static inline bool is_digit(char c) {
+		return c >= '0' && c <= '9';
+	}
+
+	// Scan a number of the form /-?(?:\d+)?\.?\d+/ used by the js parse functions
+	static bool scan_number(cChar* &s, float &out, bool sign = true) {
+		cChar* p = s;
+		bool neg = sign && *p == '-';
+		if (neg) p++;
+		double val = 0, scale = 1;
+		cChar* digits = p;
+		while (is_digit(*p))
+			val = val * 10 + (*p++ - '0');
+		if (*p == '.') {
+			cChar* frac = ++p;
+			while (is_digit(*p)) {
+				val = val * 10 + (*p++ - '0');
+				scale *= 10;
+			}
+			if (p == frac) return false; // digits are required after the dot
+		} else if (p == digits) {
+			return false;
+		}
+		out = float(neg ? -val / scale: val / scale);
+		s = p;
+		return true;
+	}
+
+	// Scan numbers from `func(N,N,..)` or from `N N ..` if spaced is true
+	static bool scan_numbers(cChar* s, cChar* func, bool spaced, float *out, int count) {
+		s = skip_space(s);
+		auto len = strlen(func);
+		if (strncmp(s, func, len) == 0 && s[len] == '(') {
+			s += len + 1;
+			for (int i = 0; i < count; i++) {
+				if (i && *s++ != ',')
+					return false;
+				s = skip_space(s);
+				if (!scan_number(s, out[i]))
+					return false;
+				s = skip_space(s);
+			}
+			if (*s++ != ')')
+				return false;
+		} else if (spaced) {
+			for (int i = 0; i < count; i++) {
+				if (i) {
+					if (!is_space(*s))
+						return false;
+					s = skip_space(s);
+				}
+				if (!scan_number(s, out[i]))
+					return false;
+			}
+		} else {
+			return false;
+		}
+		return *skip_space(s) == '\0';
+	}
+
+	// Read numbers from a Float32Array
+	static bool read_float32_numbers(Worker* worker, JSValue* in, float *out, int count) {
+		if (!in->isFloat32Array())
+			return false;
+		auto buf = in->cast<JSTypedArray>()->value(worker);
+		if (buf.length() < count * sizeof(float))
+			return false;
+		memcpy(out, buf.val(), count * sizeof(float));
+		return true;
+	}
+
+	// Read numbers from the elements of an array or a Float32Array
+	static bool read_numbers(Worker* worker, JSValue* in, float *out, int count) {
+		if (in->isArray()) {
+			auto arr = in->cast<JSArray>();
+			if (arr->length() < count)
+				return false;
+			for (int i = 0; i < count; i++) {
+				auto num = arr->get(worker, i);
+				if (!num->isNumber())
+					return false;
+				out[i] = num->cast<JSNumber>()->float32();
+			}
+			return true;
+		}
+		return read_float32_numbers(worker, in, out, count);
+	}
+
+	static bool read_numbers(Worker* worker, JSValue* in, cChar* func, bool spaced, float *out, int count) {
+		if (in->isString()) {
+			auto str = in->cast<JSString>()->value(worker);
+			return scan_numbers(str.c_str(), func, spaced, out, count);
+		}
+		return read_numbers(worker, in, out, count);
+	}
+
+	static inline int hex_value(char c) {
+		if (is_digit(c)) return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	static inline uint8_t clamp_color(uint32_t n) {
+		return n > 255 ? 255: n;
+	}
+
+	// Parse `#rgb`, `#rgba`, `#rrggbb`, `#rrggbbaa`, `rgb(r,g,b)` or `rgba(r,g,b,a)`
+	static bool scan_color(cChar* s, Color &out) {
+		if (*s == '#') {
+			int hex[8], len = 0;
+			for (s++; *s; s++) {
+				if (len == 8 || (hex[len++] = hex_value(*s)) < 0)
+					return false;
+			}
+			switch (len) {
+				case 3: case 4:
+					out = Color(hex[0] * 17, hex[1] * 17, hex[2] * 17, len == 4 ? hex[3] * 17: 255);
+					return true;
+				case 6: case 8:
+					out = Color(hex[0] << 4 | hex[1], hex[2] << 4 | hex[3], hex[4] << 4 | hex[5],
+						len == 8 ? hex[6] << 4 | hex[7]: 255);
+					return true;
+			}
+			return false;
+		}
+		s = skip_space(s);
+		if (strncmp(s, "rgb", 3) != 0)
+			return false;
+		s += 3;
+		bool rgba = *s == 'a';
+		if (rgba) s++;
+		if (*s++ != '(')
+			return false;
+		uint32_t rgb[3];
+		for (int i = 0; i < 3; i++) {
+			if (i && *s++ != ',')
+				return false;
+			s = skip_space(s);
+			int n = 0;
+			for (rgb[i] = 0; is_digit(*s); n++)
+				rgb[i] = rgb[i] * 10 + (*s++ - '0');
+			if (n == 0 || n > 3)
+				return false;
+			s = skip_space(s);
+		}
+		uint32_t a = 255;
+		if (rgba) {
+			if (*s++ != ',')
+				return false;
+			s = skip_space(s);
+			float alpha;
+			if (*s == '1' && !is_digit(s[1]) && s[1] != '.') {
+				s++, alpha = 1;
+			} else if ((*s == '0' && s[1] == '.') || *s == '.') {
+				if (!scan_number(s, alpha, false))
+					return false;
+			} else {
+				return false;
+			}
+			a = clamp_color(uint32_t(double(alpha) * 255));
+			s = skip_space(s);
+		}
+		if (*s++ != ')' || *skip_space(s) != '\0')
+			return false;
+		out = Color(clamp_color(rgb[0]), clamp_color(rgb[1]), clamp_color(rgb[2]), a);
+		return true;
+	}
+
+	static bool read_color(Worker* worker, JSValue* in, Color &out) {
+		uint32_t val;
+		if (in->isUint32()) {
+			val = in->cast<JSUint32>()->value();
+		} else if (in->isInt32()) {
+			val = in->cast<JSInt32>()->value();
+		} else if (in->isString()) {
+			return scan_color(in->cast<JSString>()->value(worker).c_str(), out);
+		} else {
+			return false;
+		}
+		out = Color(val >> 24, val >> 16 & 255, val >> 8 & 255, val & 255); // rgba
+		return true;
+	}
+
+	// Scan the `N`, `N%` or `N!` value, with the unit char written to `unit`
+	static bool scan_value(cChar* s, cChar* units, float &out, char &unit) {
+		s = skip_space(s);
+		if (!scan_number(s, out))
+			return false;
+		unit = *s && strchr(units, *s) ? *s++: '\0';
+		return *skip_space(s) == '\0';
+	}
+
+	template<class T>
+	static inline bool parse_native(Worker* worker, JSValue* in, T& out) {
+		return false; // no fast path for the type
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, Color& out) {
+		return read_color(worker, in, out);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, Vec2& out) {
+		if (in->isNumber())
+			return out = Vec2(in->cast<JSNumber>()->float32()), true;
+		return read_numbers(worker, in, "vec2", true, out.val, 2);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, Vec3& out) {
+		if (in->isNumber())
+			return out = Vec3(in->cast<JSNumber>()->float32()), true;
+		return read_numbers(worker, in, "vec3", true, out.val, 3);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, Vec4& out) {
+		if (in->isNumber())
+			return out = Vec4(in->cast<JSNumber>()->float32()), true;
+		return read_numbers(worker, in, "vec4", true, out.val, 4);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, Rect& out) {
+		float val[4];
+		if (!read_numbers(worker, in, "rect", true, val, 4))
+			return false;
+		out = { {val[0], val[1]}, {val[2], val[3]} };
+		return true;
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, Mat& out) {
+		if (in->isNumber()) {
+			float val = in->cast<JSNumber>()->float32();
+			return out = Mat(val, 0, 0, 0, val, 0), true;
+		}
+		// As the JS parseMat, the plain arrays are not accepted
+		if (in->isString()) {
+			auto str = in->cast<JSString>()->value(worker);
+			return scan_numbers(str.c_str(), "mat", false, out.val, 6);
+		}
+		return read_float32_numbers(worker, in, out.val, 6);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, Mat4& out) {
+		if (in->isNumber())
+			return out = Mat4(in->cast<JSNumber>()->float32()), true;
+		if (in->isString()) {
+			auto str = in->cast<JSString>()->value(worker);
+			return scan_numbers(str.c_str(), "mat4", false, out.val, 16);
+		}
+		return read_float32_numbers(worker, in, out.val, 16);
+	}
+
+	// Parse the number, the keyword or `N%` of the value with kind, as `auto` or `20%`
+	template<class T, class Kind>
+	static bool parse_kind_value(Worker* worker, JSValue* in, T& out,
+		std::initializer_list<std::pair<cChar*, Kind>> keywords, Kind value, Kind ratio)
+	{
+		if (in->isNumber()) {
+			out.kind = value;
+			out.value = in->cast<JSNumber>()->float32();
+			return true;
+		}
+		if (!in->isString())
+			return false;
+		auto str = in->cast<JSString>()->value(worker);
+		for (auto &i: keywords) {
+			if (str == i.first) {
+				out.kind = i.second;
+				out.value = 0;
+				return true;
+			}
+		}
+		char unit;
+		if (!scan_value(str.c_str(), "%", out.value, unit))
+			return false;
+		if (unit == '%') {
+			out.kind = ratio;
+			out.value *= 0.01f;
+		} else {
+			out.kind = value;
+		}
+		return true;
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, FillPosition& out) {
+		return parse_kind_value(worker, in, out, {
+			{"start", FillPositionKind::Start},
+			{"center", FillPositionKind::Center},
+			{"end", FillPositionKind::End},
+		}, FillPositionKind::Value, FillPositionKind::Ratio);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, FillSize& out) {
+		return parse_kind_value(worker, in, out, {
+			{"auto", FillSizeKind::Auto},
+		}, FillSizeKind::Value, FillSizeKind::Ratio);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, BoxOrigin& out) {
+		return parse_kind_value(worker, in, out, {
+			{"auto", BoxOriginKind::Auto},
+		}, BoxOriginKind::Value, BoxOriginKind::Ratio);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, BoxSize& out) {
+		if (in->isString()) {
+			auto str = in->cast<JSString>()->value(worker);
+			char unit;
+			if (scan_value(str.c_str(), "%!", out.value, unit)) {
+				if (unit == '%') {
+					out.kind = BoxSizeKind::Ratio;
+					out.value *= 0.01f;
+				} else {
+					out.kind = unit == '!' ? BoxSizeKind::Minus: BoxSizeKind::Value;
+				}
+				return true;
+			}
+		}
+		return parse_kind_value(worker, in, out, {
+			{"none", BoxSizeKind::None},
+			{"auto", BoxSizeKind::Auto},
+			{"match", BoxSizeKind::Match},
+		}, BoxSizeKind::Value, BoxSizeKind::Ratio);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, TextColor& out) {
+		if (in->isString()) {
+			auto str = in->cast<JSString>()->value(worker);
+			if (str == "inherit" || str == "default") {
+				out.kind = str == "inherit" ? TextValueKind::Inherit: TextValueKind::Default;
+				out.value = Color(0, 0, 0, 255);
+				return true;
+			}
+			out.kind = TextValueKind::Value;
+			return scan_color(str.c_str(), out.value);
+		}
+		out.kind = TextValueKind::Value;
+		return read_color(worker, in, out.value);
+	}
+
+	static bool parse_native(Worker* worker, JSValue* in, FontSize& out) {
+		if (in->isNumber()) {
+			out.kind = TextValueKind::Value;
+			out.value = in->cast<JSNumber>()->float32();
+			return true;
+		}
+		if (!in->isString())
+			return false;
+		auto str = in->cast<JSString>()->value(worker);
+		if (str == "inherit" || str == "default") {
+			out.kind = str == "inherit" ? TextValueKind::Inherit: TextValueKind::Default;
+			out.value = 0;
+			return true;
+		}
+		cChar* s = str.c_str();
+		if (!scan_number(s, out.value, false) || *s) // /^(?:\d+)?\.?\d+$/
+			return false;
+		out.kind = TextValueKind::Value;
+		return true;
+	}
+
 	// --------------------------------------------------------------------------------------------
 
 	#define js_parse(Type, block) { \
+		if (parse_native(worker, in, out)) return true;\
 		JSObject* obj;\
 		JSValue* val;\
 		if (msg) {\
@@ -1107,11 +1482,6 @@ namespace qk { namespace js {
 	}
 
 	bool TypesParser::parse(JSValue* in, FontSize& out, cChar* msg) {
-		if (in->isNumber()) {
-			out.kind = TextValueKind::Value;
-			out.value = in->cast<JSNumber>()->float32();
-			return true;
-		}
 		js_parse(FontSize, {
 			// TODO: need to check type
 			out.kind = kind<TextValueKind>(obj);
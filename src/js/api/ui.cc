@@ -268,6 +268,18 @@ namespace qk { namespace js {
 				Js_Return(self->usedResourceMemory());
 			});
 
+			Js_Class_Method(imageCacheStats, {
+				auto pool = self->imgPool();
+				auto stats = worker->newObject();
+				stats->set(worker, "count", worker->newValue(pool->count()));
+				stats->set(worker, "capacity", worker->newValue(pool->capacity()));
+				stats->set(worker, "maxCapacity", worker->newValue(pool->maxCapacity()));
+				stats->set(worker, "hits", worker->newValue(pool->hits()));
+				stats->set(worker, "misses", worker->newValue(pool->misses()));
+				stats->set(worker, "evictions", worker->newValue(pool->evictions()));
+				Js_Return(stats);
+			});
+
 			Js_Class_Method(openURL, {
 				if (!args.length() || !args[0]->isString()) {
 					Js_Throw(
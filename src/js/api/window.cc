@@ -126,6 +126,44 @@ namespace qk { namespace js {
 			});
 
 			Js_MixObject_Accessor(Window, bool, debugMode, debugMode);
+			Js_MixObject_Accessor(Window, bool, partialRedraw, partialRedraw);
+			Js_MixObject_Accessor(Window, bool, parallelLayout, parallelLayout);
+			Js_MixObject_Accessor(Window, uint32_t, autoLayerFrames, autoLayerFrames);
+
+			Js_Class_Accessor(profiling, {
+				Js_Return( self->profiler().enabled() );
+			}, {
+				self->profiler().set_enabled(val->toBoolean(worker));
+			});
+
+			Js_Class_Method(profilerFrames, {
+				auto frames = self->profiler().frames();
+				JSObject* js_frames = worker->newArray();
+				for (uint32_t i = 0; i < frames.length(); i++) {
+					auto &frame = frames[i];
+					JSObject* js_frame = worker->newObject();
+					js_frame->set(worker, "time", worker->newValue(frame.frame.begin));
+					js_frame->set(worker, "duration", worker->newValue(frame.frame.duration));
+					for (int j = 0; j < FrameProfiler::kPhase_Count; j++) {
+						auto name = FrameProfiler::phaseName(FrameProfiler::Phase(j));
+						js_frame->set(worker, name, worker->newValue(frame.phases[j].duration));
+					}
+					for (int j = 0; j < FrameProfiler::kCounter_Count; j++) {
+						auto name = FrameProfiler::counterName(FrameProfiler::Counter(j));
+						js_frame->set(worker, name, worker->newValue(frame.counters[j]));
+					}
+					js_frames->set(worker, i, js_frame);
+				}
+				Js_Return(js_frames);
+			});
+
+			Js_Class_Method(profilerTrace, {
+				Js_Return( self->profiler().chromeTrace() );
+			});
+
+			Js_Class_Method(profilerClear, {
+				self->profiler().clear();
+			});
 
 			Js_Class_Method(nextFrame, {
 				if (!args.length() || !args[0]->isFunction()) {
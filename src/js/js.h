@@ -264,6 +264,7 @@ namespace qk { namespace js {
 		bool isArrayBuffer() const;
 		bool isTypedArray() const;
 		bool isUint8Array() const;
+		bool isFloat32Array() const;
 		bool isBuffer() const; // IsTypedArray or IsArrayBuffer
 		bool equals(Worker *worker, JSValue* val) const;
 		bool strictEquals(Worker *worker, JSValue* val) const;
@@ -564,6 +564,12 @@ namespace qk { namespace js {
 		return ok;
 	}
 
+	bool JSValue::isFloat32Array() const {
+		ENV();
+		auto ok = JSValueIsInstanceOfConstructor(ctx, Back(this), worker->_data.global_Float32Array, JsFatal("JSValue::isFloat32Array"));
+		return ok;
+	}
+
 	bool JSValue::isBuffer() const {
 		ENV();
 		auto ok = JSValueIsInstanceOfConstructor(
@@ -68,6 +68,7 @@
 	F(Function, global) \
 	F(ArrayBuffer, global) \
 	F(Uint8Array, global) \
+	F(Float32Array, global) \
 	F(Set, global) \
 	F(prototype, global_Set) \
 	F(add, global_Set_prototype) \
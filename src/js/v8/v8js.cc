@@ -28,7 +28,10 @@
  *
  * ***** END LICENSE BLOCK ***** */
 
+#include <unistd.h>
+#include <algorithm>
 #include "./v8js.h"
+#include "../../util/hash.h"
 
 namespace qk { namespace js {
 	// -------------------------- W o r k e r . I m p l --------------------------
@@ -269,6 +272,7 @@ namespace qk { namespace js {
 	bool JSValue::isArrayBuffer() const { return Back<v8::Value>(this)->IsArrayBuffer(); }
 	bool JSValue::isTypedArray() const { return Back<v8::Value>(this)->IsTypedArray(); }
 	bool JSValue::isUint8Array() const { return Back<v8::Value>(this)->IsUint8Array(); }
+	bool JSValue::isFloat32Array() const { return Back<v8::Value>(this)->IsFloat32Array(); }
 	bool JSValue::isBuffer() const { return isTypedArray() || isArrayBuffer(); }
 	bool JSValue::equals(Worker *worker, JSValue* val) const {
 		return Back<v8::Value>(this)->Equals(CONTEXT(worker), Back(val)).ToChecked();
@@ -827,10 +831,127 @@ namespace qk { namespace js {
 		ISOLATE(this)->ThrowException(Back(exception));
 	}
 
+	// ------------------------------ C o d e . C a c h e ------------------------------
+
+	static bool code_cache_enable = true; // disabled by --no-code-cache
+	static constexpr int CODE_CACHE_THRESHOLD = 1024; // scripts shorter than this are not cached
+	static constexpr uint64_t CODE_CACHE_MAX_SIZE = 64 * 1024 * 1024; // max bytes of the cache files
+	static constexpr uint64_t CODE_CACHE_TMP_EXPIRE = 3600; // seconds, leftover of a crashed write
+	static std::once_flag code_cache_pruned;
+
+	/**
+	 * Directory of the on-disk code cache, versioned by the V8 version and the cached data
+	 * version tag that covers the V8 flags, so the caches of other versions can be removed.
+	*/
+	static String code_cache_dir() {
+		return fs_temp(String::format("js_code_cache/%s-%08x",
+			v8::V8::GetVersion(), v8::ScriptCompiler::CachedDataVersionTag()));
+	}
+
+	/**
+	 * Path of the on-disk code cache of a script, keyed by the content hash of the source
+	 * and the compile mode, the V8 cached data version tag is also hashed for safety.
+	*/
+	static String code_cache_path(Worker* worker, JSString* source, bool isFunction) {
+		auto src = source->value2(worker);
+		Hash hash;
+		hash.updateu16v(src.c_str(), src.length());
+		hash.updateu32(v8::ScriptCompiler::CachedDataVersionTag());
+		hash.updateu32(isFunction);
+		return String::format("%s/%s-%x.jsc", *code_cache_dir(), *hash.hashStr(), src.length());
+	}
+
+	/**
+	 * Remove the caches of the other V8 versions and flags, the leftover temporary files,
+	 * and the oldest written cache files when they take more than CODE_CACHE_MAX_SIZE.
+	*/
+	static void code_cache_prune() {
+		struct Entry { String path; uint64_t size, mtime; };
+		auto root = fs_temp("js_code_cache");
+		auto dir = code_cache_dir();
+		Array<Entry> files;
+		uint64_t total = 0;
+		uint64_t now = time_second();
+		Qk_Try({
+			for (auto &i: fs_readdir_sync(root)) {
+				if (i.pathname != dir)
+					fs_remove_recursion_sync(i.pathname); // other versions or flags
+			}
+			for (auto &i: fs_readdir_sync(dir)) {
+				if (i.type != FTYPE_FILE)
+					continue;
+				auto stat = fs_stat_sync(i.pathname);
+				if (!i.name.endsWith(".jsc")) {
+					if (stat.mtime() / 1000000 + CODE_CACHE_TMP_EXPIRE < now)
+						fs_unlink_sync(i.pathname); // the writer has crashed
+					continue;
+				}
+				files.push({i.pathname, stat.size(), stat.mtime()});
+				total += stat.size();
+			}
+			if (total > CODE_CACHE_MAX_SIZE) {
+				std::sort(files.val(), files.val() + files.length(), [](const Entry &a, const Entry &b) {
+					return a.mtime < b.mtime;
+				});
+				for (auto &i: files) { // evict down to 3/4 of the limit
+					if (total <= CODE_CACHE_MAX_SIZE / 4 * 3)
+						break;
+					fs_unlink_sync(i.path);
+					total -= i.size;
+				}
+			}
+		}) {
+			Qk_DLog("Prune code cache fail, %s", *err.message());
+		}
+	}
+
+	static v8::ScriptCompiler::CachedData* code_cache_read(cString& path, Buffer &data) {
+		if (!fs_exists_sync(path))
+			return nullptr;
+		Qk_Try(data = fs_read_file_sync(path)) {
+			Qk_DLog("Read code cache fail, %s", *err.message());
+			return nullptr;
+		}
+		return new v8::ScriptCompiler::CachedData(
+			reinterpret_cast<const uint8_t*>(data.val()), data.length(),
+			v8::ScriptCompiler::CachedData::BufferNotOwned
+		);
+	}
+
+	static void code_cache_write(cString& path, v8::ScriptCompiler::CachedData* data) {
+		// write to a temporary file first, other workers and processes may read the same cache,
+		// the name is unique with the process id, the id and random suffix in the process
+		auto tmp = String::format("%s.%d-%x-%x.tmp", *path, int(getpid()), getId32(), random());
+		Qk_Try({
+			fs_mkdirs_sync(fs_dirname(path));
+			fs_write_file_sync(tmp, data->data, data->length);
+			fs_rename_sync(tmp, path);
+		}) {
+			Qk_DLog("Write code cache fail, %s", *err.message());
+			if (fs_exists_sync(tmp))
+				Qk_Try(fs_unlink_sync(tmp)) {}
+		}
+		delete data;
+		std::call_once(code_cache_pruned, code_cache_prune); // once a process after writing
+	}
+
 	JSValue* Worker::runScript(JSString* source, JSString* name, JSObject* sandbox) {
+		String cachePath;
+		Buffer cacheData; // keep the buffer alive while compiling
+		v8::ScriptCompiler::CachedData *cached = nullptr;
+		bool useCache = code_cache_enable && source->length() >= CODE_CACHE_THRESHOLD;
+
+		if (useCache) {
+			cachePath = code_cache_path(this, source, sandbox);
+			cached = code_cache_read(cachePath, cacheData);
+		}
+		// the source takes the ownership of cached data
 		v8::ScriptCompiler::Source _source(
-			Back<v8::String>(source), ScriptOrigin(Back<v8::String>(name)));
+			Back<v8::String>(source), ScriptOrigin(Back<v8::String>(name)), cached);
+		auto options = cached ?
+			v8::ScriptCompiler::kConsumeCodeCache: v8::ScriptCompiler::kNoCompileOptions;
 		v8::MaybeLocal<v8::Value> result;
+		v8::ScriptCompiler::CachedData *produce = nullptr;
 
 		auto isolate = ISOLATE(this);
 		auto ctx = CONTEXT(this);
@@ -838,16 +959,24 @@ namespace qk { namespace js {
 			v8::Local<v8::Function> func;
 			auto sandbox_ = Back<v8::Object>(sandbox);
 			if (v8::ScriptCompiler::
-					CompileFunctionInContext(ctx, &_source, 0, nullptr, 1, &sandbox_).ToLocal(&func)
+					CompileFunctionInContext(ctx, &_source, 0, nullptr, 1, &sandbox_, options).ToLocal(&func)
 			) {
 				result = func->Call(ctx, v8::Undefined(isolate), 0, nullptr);
+				// produce after running to include the functions compiled lazily at startup
+				if (!result.IsEmpty() && useCache && (!cached || cached->rejected))
+					produce = v8::ScriptCompiler::CreateCodeCacheForFunction(func);
 			}
 		} else { // use default sandbox
 			v8::Local<v8::Script> script;
-			if (v8::ScriptCompiler::Compile(ctx, &_source).ToLocal(&script)) {
+			if (v8::ScriptCompiler::Compile(ctx, &_source, options).ToLocal(&script)) {
 				result = script->Run(ctx);
+				if (!result.IsEmpty() && useCache && (!cached || cached->rejected))
+					produce = v8::ScriptCompiler::CreateCodeCache(script->GetUnboundScript());
 			}
 		}
+		if (produce) // rewrite the rejected cache as well
+			code_cache_write(cachePath, produce);
+
 		return Cast(result.FromMaybe(v8::Local<v8::Value>()));
 	}
 
@@ -877,8 +1006,11 @@ namespace qk { namespace js {
 			Qk_Log("Usage: quark [options] [ script.js ] [arguments]");
 			Qk_Log("       quark --eval|-e [ script ] [arguments]");
 			Qk_Log("       quark --debug[=127.0.0.1:9229]] [--brk] [ script.js ] [arguments]");
+			Qk_Log("       quark --no-code-cache [ script.js ] [arguments]");
 			Qk_Log("       quark --help [--v8]");
 		}
+		if (args->options.has("no-code-cache"))
+			code_cache_enable = false;
 		// Normal launches still pass command-line options to V8. For --help, skip
 		// V8's very large option list unless the caller explicitly adds --v8.
 		if (!args->options.has("help") || args->options.has("v8")) {
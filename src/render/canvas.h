@@ -31,6 +31,7 @@
 #ifndef __quark_render_canvas__
 #define __quark_render_canvas__
 
+#include <atomic>
 #include "../util/util.h"
 #include "./font/families.h"
 #include "./pathv_cache.h"
@@ -309,6 +310,14 @@ namespace qk {
 		/** Returns the cached path vectorizer for path reuse. */
 		virtual PathvCache* getPathvCache() = 0;
 
+		/**
+		 * @brief Returns the frame arena of the canvas.
+		 *
+		 * The callers drawing a frame can keep their frame-local temporary data in it,
+		 * it is rewound by `swapBuffer()`, so the data must not be used after that.
+		 */
+		virtual Allocator* frameAllocator() = 0;
+
 		/**
 		 * @brief Updates surface transform and scaling parameters.
 		 * 
@@ -332,8 +341,41 @@ namespace qk {
 		*/
 		virtual Vec2 surfaceSize() const = 0;
 
+		/**
+		 * Returns the total number of draw commands recorded by this canvas.
+		 * The counter wraps around, so callers should sample deltas between frames.
+		 */
+		inline uint32_t drawCalls() const { return _drawCalls; }
+
+		/**
+		 * Returns the total microseconds the rendering thread spent submitting the swapped
+		 * commands of this canvas to the GPU, and the begin time of the last submit.
+		 * The total wraps around, so callers should sample deltas between frames.
+		 * @thread Any
+		 */
+		inline uint32_t submitTime() const { return _submitTime.load(std::memory_order_relaxed); }
+		inline int64_t submitBegin() const { return _submitBegin.load(std::memory_order_relaxed); }
+
+		/**
+		 * @struct SubmitScope records a submit of the rendering thread for the lifetime of the object
+		 */
+		struct SubmitScope {
+			inline SubmitScope(Canvas *host): _host(host), _begin(time_monotonic()) {
+				host->_submitBegin.store(_begin, std::memory_order_relaxed);
+			}
+			inline ~SubmitScope() {
+				_host->_submitTime.fetch_add(uint32_t(time_monotonic() - _begin), std::memory_order_relaxed);
+			}
+		private:
+			Canvas *_host;
+			int64_t _begin;
+		};
+
 	protected:
 		Canvas() = default;
+		uint32_t _drawCalls = 0; // draw commands recorded by the backend
+		std::atomic<uint32_t> _submitTime{0}; // written by the rendering thread
+		std::atomic<int64_t>  _submitBegin{0};
 	};
 }
 
@@ -373,6 +373,7 @@ namespace qk {
 		budget.maxPathTileCount *= kCAPABudgetMultiplier;
 		budget.maxPathTileRowCount *= kCAPABudgetMultiplier;
 		_owner->drawCAPACmd(_data);
+		_owner->_drawCalls++;
 		reset();
 	}
 
@@ -30,6 +30,11 @@
 
 #include "./codec.h"
 #include "../../util/string.h"
+#include <math.h>
+#define Qk_ARM_NEON Qk_ARCH_ARM64
+#if Qk_ARM_NEON
+# include <arm_neon.h>
+#endif
 
 namespace qk {
 
@@ -44,12 +49,17 @@ namespace qk {
 	bool img_gif_test(cBuffer& data, PixelInfo* out);
 	bool img_pvrt_test(cBuffer& data, PixelInfo* out);
 	// decode
-	bool img_jpeg_decode(cBuffer& data, Array<Pixel> *out);
-	bool img_png_decode(cBuffer& data, Array<Pixel> *out);
-	bool img_webp_decode(cBuffer& data, Array<Pixel> *out);
+	bool img_jpeg_decode(cBuffer& data, Array<Pixel> *out, Vec2 size);
+	bool img_png_decode(cBuffer& data, Array<Pixel> *out, Vec2 size);
+	bool img_webp_decode(cBuffer& data, Array<Pixel> *out, Vec2 size);
 	bool img_tga_decode(cBuffer& data, Array<Pixel> *out);
-	bool img_gif_decode(cBuffer& data, Array<Pixel> *out);
+	bool img_gif_decode(cBuffer& data, Array<Pixel> *out, Vec2 size);
 	bool img_pvrt_decode(cBuffer& data, Array<Pixel> *out);
+	// partial decode
+	bool img_jpeg_decode_partial(cBuffer& data, Array<Pixel> *out, Vec2 size);
+	bool img_png_decode_partial(cBuffer& data, Array<Pixel> *out, Vec2 size);
+	bool img_webp_decode_partial(cBuffer& data, Array<Pixel> *out, Vec2 size, void **ctx);
+	void img_webp_partial_delete(void *ctx);
 
 	bool img_test(cBuffer& data, PixelInfo* out, ImageFormat fmt) {
 		bool ok = false;
@@ -78,22 +88,22 @@ namespace qk {
 #endif
 	}
 
-	bool img_decode(cBuffer& data, Array<Pixel> *out, ImageFormat fmt) {
+	static bool img_decode_(cBuffer& data, Array<Pixel> *out, ImageFormat fmt, Vec2 size) {
 		bool ok = false;
 		switch (fmt) {
-			case kJPEG_ImageFormat: ok = img_jpeg_decode(data, out); break;
-			case kGIF_ImageFormat: ok = img_gif_decode(data, out); break;
-			case kPNG_ImageFormat: ok = img_png_decode(data, out); break;
-			case kWEBP_ImageFormat: ok = img_webp_decode(data, out); break;
+			case kJPEG_ImageFormat: ok = img_jpeg_decode(data, out, size); break;
+			case kGIF_ImageFormat: ok = img_gif_decode(data, out, size); break;
+			case kPNG_ImageFormat: ok = img_png_decode(data, out, size); break;
+			case kWEBP_ImageFormat: ok = img_webp_decode(data, out, size); break;
 			case kTGA_ImageFormat: ok = img_tga_decode(data, out); break;
 			case kPVRTC_ImageFormat: ok = img_pvrt_decode(data, out); break;
 			default: break;
 		}
 		if (ok
-			|| img_png_decode(data, out)
-			|| img_jpeg_decode(data, out)
-			|| img_webp_decode(data, out)
-			|| img_gif_decode(data, out)
+			|| img_png_decode(data, out, size)
+			|| img_jpeg_decode(data, out, size)
+			|| img_webp_decode(data, out, size)
+			|| img_gif_decode(data, out, size)
 			|| img_tga_decode(data, out)
 			|| img_pvrt_decode(data, out)
 		) return true;
@@ -106,6 +116,192 @@ namespace qk {
 #endif
 	}
 
+	static void img_scale_down_all(Array<Pixel> *out, Vec2 size) {
+		if (size[0] > 0 || size[1] > 0) {
+			// Some codecs can't decode to the target size or only reduce to 1/8,
+			// so continue to downscale the decoded pixels
+			for (auto &pix: *out) {
+				Pixel scaled;
+				if (img_scale_down(pix, &scaled, size))
+					pix = std::move(scaled);
+			}
+		}
+	}
+
+	bool img_decode(cBuffer& data, Array<Pixel> *out, ImageFormat fmt, Vec2 size) {
+		if (!img_decode_(data, out, fmt, size))
+			return false;
+		img_scale_down_all(out, size);
+		return true;
+	}
+
+	ImageProgressiveDecoder::ImageProgressiveDecoder(Vec2 size)
+		: _size(size), _format(kUnknown_ImageFormat), _detected(false), _webp(nullptr)
+	{}
+
+	ImageProgressiveDecoder::~ImageProgressiveDecoder() {
+		if (_webp)
+			img_webp_partial_delete(_webp);
+	}
+
+	bool ImageProgressiveDecoder::decode(cBuffer& data, Array<Pixel> *out) {
+		if (!_detected) { // detect format by the file signature
+			if (data.length() < 12)
+				return false;
+			auto s = (const uint8_t*)data.val();
+			if (s[0] == 0xFF && s[1] == 0xD8 && s[2] == 0xFF) {
+				_format = kJPEG_ImageFormat;
+			} else if (memcmp(s, "\x89PNG", 4) == 0) {
+				_format = kPNG_ImageFormat;
+			} else if (memcmp(s, "RIFF", 4) == 0 && memcmp(s + 8, "WEBP", 4) == 0) {
+				_format = kWEBP_ImageFormat;
+			}
+			_detected = true;
+		}
+		bool ok = false;
+		switch (_format) {
+			case kJPEG_ImageFormat: ok = img_jpeg_decode_partial(data, out, _size); break;
+			case kPNG_ImageFormat: ok = img_png_decode_partial(data, out, _size); break;
+			case kWEBP_ImageFormat: ok = img_webp_decode_partial(data, out, _size, &_webp); break;
+			default: break;
+		}
+		if (ok)
+			img_scale_down_all(out, _size);
+		return ok;
+	}
+
+	uint32_t img_scale_levels(uint32_t width, uint32_t height, Vec2 size) {
+		uint32_t w = size[0] > 0 ? uint32_t(ceilf(size[0])): 1;
+		uint32_t h = size[1] > 0 ? uint32_t(ceilf(size[1])): 1;
+		uint32_t levels = 0;
+		if (size[0] > 0 || size[1] > 0) {
+			while (levels < 16 && (width >> (levels + 1)) >= w && (height >> (levels + 1)) >= h)
+				levels++;
+		}
+		return levels;
+	}
+
+	bool img_scale_down(cPixel& pixel, Pixel *out, Vec2 size) {
+		auto channels = ImageRowScaler::channels(pixel.type());
+		if (!channels || !pixel.val())
+			return false;
+		auto levels = img_scale_levels(pixel.width(), pixel.height(), size);
+		if (!levels)
+			return false;
+		uint32_t w = ImageRowScaler::size(pixel.width(), levels);
+		uint32_t h = ImageRowScaler::size(pixel.height(), levels);
+		auto buff = Buffer::alloc(w * h * channels);
+		ImageRowScaler scaler(pixel.width(), channels, levels, (uint8_t*)buff.val());
+		auto rowbytes = pixel.rowbytes();
+		for (int y = 0; y < pixel.height(); y++) {
+			scaler.push(pixel.val() + y * rowbytes);
+		}
+		scaler.flush();
+		*out = Pixel(PixelInfo(w, h, pixel.type(), pixel.alphaType()), buff);
+		return true;
+	}
+
+	// 2x2 box filter, average the two rows to one row of half width
+	static void halve_rows(const uint8_t *r0, const uint8_t *r1, uint8_t *out, uint32_t width, uint32_t channels) {
+		uint32_t x = 0;
+#if Qk_ARM_NEON
+		if (channels == 4) {
+			// 16 pixels to 8 pixels each time
+			for (; x + 16 <= width; x += 16) {
+				uint8x16x4_t a = vld4q_u8(r0 + x * 4);
+				uint8x16x4_t b = vld4q_u8(r1 + x * 4);
+				uint8x8x4_t o;
+				o.val[0] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(a.val[0]), vpaddlq_u8(b.val[0])), 2);
+				o.val[1] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(a.val[1]), vpaddlq_u8(b.val[1])), 2);
+				o.val[2] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(a.val[2]), vpaddlq_u8(b.val[2])), 2);
+				o.val[3] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(a.val[3]), vpaddlq_u8(b.val[3])), 2);
+				vst4_u8(out + (x >> 1) * 4, o);
+			}
+		} else if (channels == 1) {
+			for (; x + 16 <= width; x += 16) {
+				uint16x8_t s = vaddq_u16(vpaddlq_u8(vld1q_u8(r0 + x)), vpaddlq_u8(vld1q_u8(r1 + x)));
+				vst1_u8(out + (x >> 1), vrshrn_n_u16(s, 2));
+			}
+		}
+#endif
+		for (; x < width; x += 2) {
+			uint32_t x1 = x + 1 < width ? x + 1: x; // repeat the last pixel of odd width
+			auto a = r0 + x * channels, b = r0 + x1 * channels;
+			auto c = r1 + x * channels, d = r1 + x1 * channels;
+			auto o = out + (x >> 1) * channels;
+			for (uint32_t k = 0; k < channels; k++) {
+				o[k] = (a[k] + b[k] + c[k] + d[k] + 2) >> 2;
+			}
+		}
+	}
+
+	ImageRowScaler::ImageRowScaler(uint32_t width, uint32_t channels, uint32_t levels, uint8_t *out)
+		: _channels(channels), _rowbytes(0), _rows(0), _out(out)
+	{
+		for (uint32_t i = 0; i < levels; i++) {
+			uint32_t w = width;
+			width = (width + 1) >> 1;
+			_levels.push({
+				w, Buffer::alloc(w * channels),
+				i + 1 < levels ? Buffer::alloc(width * channels): Buffer(), false
+			});
+		}
+		_rowbytes = width * channels;
+	}
+
+	void ImageRowScaler::push(const uint8_t *row) {
+		push(0, row);
+	}
+
+	void ImageRowScaler::push(uint32_t level, const uint8_t *row) {
+		if (level == _levels.length()) { // output
+			memcpy(_out + _rows++ * _rowbytes, row, _rowbytes);
+			return;
+		}
+		auto &l = _levels[level];
+		if (!l.hasPending) { // wait for next row
+			memcpy(l.pending.val(), row, l.width * _channels);
+			l.hasPending = true;
+			return;
+		}
+		l.hasPending = false;
+		if (level + 1 == _levels.length()) { // write to output directly
+			halve_rows((uint8_t*)l.pending.val(), row, _out + _rows++ * _rowbytes, l.width, _channels);
+		} else {
+			auto halved = (uint8_t*)l.halved.val();
+			halve_rows((uint8_t*)l.pending.val(), row, halved, l.width, _channels);
+			push(level + 1, halved);
+		}
+	}
+
+	void ImageRowScaler::flush() {
+		for (uint32_t i = 0; i < _levels.length(); i++) {
+			auto &l = _levels[i];
+			if (l.hasPending) // repeat the last row of odd height
+				push(i, (uint8_t*)l.pending.val());
+		}
+	}
+
+	uint32_t ImageRowScaler::size(uint32_t size, uint32_t levels) {
+		for (uint32_t i = 0; i < levels; i++)
+			size = (size + 1) >> 1;
+		return size;
+	}
+
+	uint32_t ImageRowScaler::channels(ColorType type) {
+		switch (type) {
+			case kAlpha_8_ColorType:
+			case kGray_8_ColorType: return 1;
+			case kLuminance_Alpha_88_ColorType: return 2;
+			case kRGB_888_ColorType: return 3;
+			case kRGBA_8888_ColorType:
+			case kRGB_888X_ColorType:
+			case kBGRA_8888_ColorType:
+			case kBGR_888X_ColorType: return 4;
+			default: return 0;
+		}
+	}
+
 	ImageFormat img_format_from(cString& path) {
 
 		String str = path.toLowerCase();
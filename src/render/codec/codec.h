@@ -57,11 +57,99 @@ namespace qk {
 
 	/**
 	 * 解码图像为GPU可读取的格式如:RGBA8888/RGBA4444/ETC1/ETC2_RGB/ETC2_RGBA...,并返回mipmap列表
+	 *
+	 * 如果提供了目标尺寸`size`,会在解码时直接缩小图像到不小于该尺寸的最小尺寸并保持宽高比,
+	 * 某个分量为零表示该方向不限制,全部为零解码原始尺寸
+	 *
 	 * @method decode
 	 * @param data {cBuffer&}
+	 * @param size {Vec2} target size hint in pixels
 	 * @ret {Array<Pixel>}
 	 */
-	Qk_EXPORT bool img_decode(cBuffer& data, Array<Pixel> *out, ImageFormat fmt = kUnknown_ImageFormat);
+	Qk_EXPORT bool img_decode(cBuffer& data, Array<Pixel> *out,
+		ImageFormat fmt = kUnknown_ImageFormat, Vec2 size = Vec2());
+
+	/**
+	 * @method img_scale_levels() 
+	 * Returns how many times the image of `width`x`height` can be halved and still cover `size`
+	 */
+	Qk_EXPORT uint32_t img_scale_levels(uint32_t width, uint32_t height, Vec2 size);
+
+	/**
+	 * @method img_scale_down() 
+	 * Downscale the pixel with the 2x2 box filter until it's as small as possible but still covers `size`,
+	 * only supported 8 bits per channel color types, returns false if it's not scaled
+	 */
+	Qk_EXPORT bool img_scale_down(cPixel& pixel, Pixel *out, Vec2 size);
+
+	/**
+	 * @class ImageRowScaler
+	 * Streaming downscale the image rows by `2^levels` with cascaded 2x2 box filter,
+	 * only keeps a few rows in memory, so the full size image is never allocated.
+	 */
+	class Qk_EXPORT ImageRowScaler {
+		Qk_DISABLE_COPY(ImageRowScaler);
+	public:
+		/**
+		 * @param width {uint32_t} input row pixels
+		 * @param channels {uint32_t} bytes per pixel, 8 bits per channel
+		 * @param levels {uint32_t} halve times
+		 * @param out {uint8_t*} output data that size at least `outWidth*outHeight*channels`
+		 */
+		ImageRowScaler(uint32_t width, uint32_t channels, uint32_t levels, uint8_t *out);
+		void push(const uint8_t *row); // push an input row
+		void flush(); // flush the rest odd rows, call after all rows pushed
+		static uint32_t size(uint32_t size, uint32_t levels); // Returns the output size of the input
+		static uint32_t channels(ColorType type); // Returns 0 if the type is not supported
+	private:
+		void push(uint32_t level, const uint8_t *row);
+		struct Level {
+			uint32_t width;
+			Buffer pending, halved;
+			bool hasPending;
+		};
+		Array<Level> _levels;
+		uint32_t _channels, _rowbytes, _rows;
+		uint8_t *_out;
+	};
+
+	/**
+	 * @class ImageProgressiveDecoder
+	 *
+	 * Decode the image incrementally while its data is still arriving, such as over a slow network.
+	 * Each call decodes all of the data received so far and outputs a low-fi preview:
+	 * the received scans of progressive JPEG, the received passes of interlaced PNG,
+	 * or the top rows of baseline JPEG, PNG and WebP, the other formats are not supported.
+	 *
+	 * It's not thread safe, but can be called from different threads serially.
+	 */
+	class Qk_EXPORT ImageProgressiveDecoder {
+		Qk_DISABLE_COPY(ImageProgressiveDecoder);
+	public:
+		/**
+		 * @param size {Vec2} target size hint in pixels, see `img_decode()`
+		 */
+		ImageProgressiveDecoder(Vec2 size = Vec2());
+		~ImageProgressiveDecoder();
+
+		/**
+		 * @method decode(data,out) decode the partial image data
+		 * @param data {cBuffer&} all of the data received so far, the prefix of the image data
+		 * @return {bool} returns true if output a partial image
+		 */
+		bool decode(cBuffer& data, Array<Pixel> *out);
+
+		/**
+		 * @method isSupported() Returns false if the format of data is known to be not supported
+		 */
+		inline bool isSupported() const { return _format != kUnknown_ImageFormat || !_detected; }
+
+	private:
+		Vec2 _size;
+		ImageFormat _format;
+		bool _detected;
+		void *_webp; // webp incremental decoder
+	};
 
 	/**
 	 * @method image_format 通过路径获取图片类型
@@ -42,7 +42,7 @@ namespace qk {
 		return size;
 	}
 
-	bool img_gif_decode(cBuffer& data, Array<Pixel> *rv) {
+	bool img_gif_decode(cBuffer& data, Array<Pixel> *rv, Vec2 size) {
 		GifSource source = { &data, 0 };
 		GifFileType* gif = DGifOpen(&source, GifInputFunc, nullptr);
 
@@ -55,8 +55,11 @@ namespace qk {
 		if (DGifSlurp(gif) == GIF_ERROR) return false;
 
 		typedef uint16_t type_t;
-		uint32_t width = gif->SWidth;
-		uint32_t height = gif->SHeight;
+		// The palette color can't be filtered, so sample every `step` pixels when downscaling
+		uint32_t levels = img_scale_levels(gif->SWidth, gif->SHeight, size);
+		uint32_t step = 1 << levels;
+		uint32_t width = ImageRowScaler::size(gif->SWidth, levels);
+		uint32_t height = ImageRowScaler::size(gif->SHeight, levels);
 		uint32_t rowbytes = width * sizeof(type_t);
 
 		for ( int i = 0; i < gif->ImageCount; i++ ) {
@@ -81,10 +84,14 @@ namespace qk {
 			}
 
 			for (int row = 0; row < desc->Height; row++) {
-				auto pix = frame->RasterBits + row * desc->Width;
-				auto end = pix + desc->Width;
-				auto out = ((type_t*)buff.val()) + (desc->Top + row) * width + desc->Left;
-				while (pix != end) {
+				uint32_t y = desc->Top + row;
+				if (y & (step - 1))
+					continue; // skip the row
+				uint32_t x = desc->Left + ((step - (desc->Left & (step - 1))) & (step - 1)); // first sampled column
+				auto pix = frame->RasterBits + row * desc->Width + (x - desc->Left);
+				auto end = frame->RasterBits + (row + 1) * desc->Width;
+				auto out = ((type_t*)buff.val()) + (y >> levels) * width + (x >> levels);
+				for (; pix < end; pix += step, out++) {
 					if (transColor != *pix) {
 						auto color = colorMap->Colors[*pix];
 						// kRGBA_5551_ColorType
@@ -104,7 +111,6 @@ namespace qk {
 						// 				((color.Green << 2) << 12) |
 						// 				((color.Blue << 2) << 2) | 0b11;
 					} // else transparent
-					pix++; out++;
 				}
 			}
 			PixelInfo info(width, height, kRGBA_5551_ColorType, kUnpremul_AlphaType);
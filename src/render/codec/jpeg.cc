@@ -48,11 +48,20 @@ namespace qk {
 		longjmp(data->jmpbuf, 1);
 	}
 
-	bool img_jpeg_decode(cBuffer& data, Array<Pixel> *rv) {
+	static void jpeg_emit_message_silent(j_common_ptr cinfo, int msg_level) {
+		// ignore the warnings of the premature end of data when partial decoding
+	}
+
+	static bool jpeg_decode(cBuffer& data, Array<Pixel> *rv, Vec2 size, bool partial) {
 		struct jpeg_decompress_struct jpeg;
 		struct jpeg_error_mgr jerr;
 		jpeg.err = jpeg_std_error(&jerr);
 		jerr.error_exit = jpeg_error_output;
+		if (partial) {
+			// The memory source inserts a fake EOI marker at the end of the partial data,
+			// so the decoder outputs the scans received so far, and the missing blocks are gray.
+			jerr.emit_message = jpeg_emit_message_silent;
+		}
 		
 		JPEGClientData client_data;
 		jpeg.client_data = &client_data;
@@ -83,8 +92,20 @@ namespace qk {
 			jpeg.out_color_space = JCS_EXT_RGBA;
 		}
 
+		// DCT scaling, the decoder directly outputs 1/2, 1/4 or 1/8 size
+		jpeg.scale_num = 1;
+		jpeg.scale_denom = 1 << Qk_Min(img_scale_levels(w, h, size), 3);
+
 		jpeg_start_decompress(&jpeg);
 
+		if (partial && jpeg.input_scan_number < 1) { // no scan data yet
+			jpeg_destroy_decompress(&jpeg);
+			return false;
+		}
+
+		w = jpeg.output_width;
+		h = jpeg.output_height;
+
 		uint32_t rowbytes = w * num;
 		uint32_t count = h * rowbytes;
 		Buffer buff(count) ;
@@ -106,6 +127,14 @@ namespace qk {
 		return true;
 	}
 
+	bool img_jpeg_decode(cBuffer& data, Array<Pixel> *rv, Vec2 size) {
+		return jpeg_decode(data, rv, size, false);
+	}
+
+	bool img_jpeg_decode_partial(cBuffer& data, Array<Pixel> *rv, Vec2 size) {
+		return jpeg_decode(data, rv, size, true);
+	}
+
 	bool img_jpeg_test(cBuffer& data, PixelInfo *out) {
 		struct jpeg_decompress_struct jpeg;
 		struct jpeg_error_mgr jerr;
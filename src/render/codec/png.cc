@@ -39,12 +39,137 @@ namespace qk {
 	};
 
 	static void png_rw_fn(png_structp png, png_bytep bytep, png_size_t size) {
-		PngDataSource *s = (PngDataSource*)png->io_ptr;
+		PngDataSource *s = (PngDataSource*)png_get_io_ptr(png);
+		if (s->index + size > s->buff->length())
+			png_error(png, "Unexpected end of PNG data"); // longjmp
 		memcpy(bytep, s->buff->val() + s->index, size);
 		s->index += size;
 	}
 
-	bool img_png_decode(cBuffer& data, Array<Pixel> *rv) {
+	static void png_error_silent(png_structp png, png_const_charp msg) {
+		png_longjmp(png, 1); // the end of partial data is expected
+	}
+
+	static void png_warning_silent(png_structp png, png_const_charp msg) {
+	}
+
+	struct PngPartial {
+		Buffer   buff;
+		PixelInfo info;
+		uint32_t rows; // number of rows decoded in all passes
+		Vec2     size; // target size hint
+		Buffer   row; // input row for the scaler
+		ImageRowScaler *scaler; // held out of `setjmp()` scope, delete by the caller
+	};
+
+	static bool png_read_partial(png_structp png, png_infop info, PngPartial *p) {
+		if ( setjmp(png_jmpbuf(png)) )
+			return false; // end of the partial data
+
+		png_read_info(png, info);
+
+		png_uint_32 w, h;
+		int bit_depth;
+		int color_type;
+		png_get_IHDR(png, info, &w, &h, &bit_depth, &color_type, NULL, NULL, NULL);
+
+		if ( bit_depth == 16 ) {
+			png_set_strip_16(png);
+		}
+		if (color_type == PNG_COLOR_TYPE_PALETTE) {
+			png_set_expand(png);
+		}
+		if ( bit_depth < 8 ) {
+			png_set_expand_gray_1_2_4_to_8(png);
+		}
+		if ( png_get_valid(png, info, PNG_INFO_tRNS) ) {
+			png_set_expand(png);
+		}
+		int passes = png_set_interlace_handling(png);
+
+		png_read_update_info(png, info);
+
+		png_uint_32 rowbytes = png_get_rowbytes(png, info);
+		png_uint_32 channel = rowbytes / w;
+		ColorType format;
+
+		switch (channel) {
+			case 1: format = kLuminance_8_ColorType; break;
+			case 2: format = kLuminance_Alpha_88_ColorType; break;
+			case 3: format = kRGB_888_ColorType; break;
+			case 4: format = kRGBA_8888_ColorType; break;
+			default: // unknown error
+				return false;
+		}
+		AlphaType alphaType = channel == 2 || channel == 4
+			? kUnpremul_AlphaType
+			: kOpaque_AlphaType;
+
+		auto levels = img_scale_levels(w, h, p->size);
+
+		if (levels && png_get_interlace_type(png, info) == PNG_INTERLACE_NONE) {
+			// Downscale row by row as `img_png_decode()`, the rows not arrived yet are transparent
+			uint32_t ow = ImageRowScaler::size(w, levels);
+			uint32_t oh = ImageRowScaler::size(h, levels);
+			p->info = PixelInfo(ow, oh, format, alphaType);
+			p->buff = Buffer::alloc(ow * oh * channel);
+			p->row = Buffer::alloc(rowbytes);
+			memset(p->buff.val(), 0, p->buff.length());
+			p->scaler = new ImageRowScaler(w, channel, levels, (uint8_t*)p->buff.val());
+			for (uint32_t y = 0; y < h; y++) {
+				png_read_row(png, (png_bytep)p->row.val(), NULL);
+				p->scaler->push((uint8_t*)p->row.val());
+				p->rows++;
+			}
+			return true;
+		}
+
+		p->info = PixelInfo(w, h, format, alphaType);
+		p->buff = Buffer::alloc(h * rowbytes);
+		memset(p->buff.val(), 0, p->buff.length());
+
+		for (int pass = 0; pass < passes; pass++) {
+			for (uint32_t y = 0; y < h; y++) {
+				png_bytep row = (png_bytep)p->buff.val() + rowbytes * y;
+				// rectangle mode, the interlaced pixels are filled to the whole block of the pass,
+				// so each pass outputs a complete but coarser image
+				png_read_rows(png, NULL, &row, 1);
+				p->rows++;
+			}
+		}
+		return true;
+	}
+
+	bool img_png_decode_partial(cBuffer& data, Array<Pixel> *rv, Vec2 size) {
+		png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL,
+			png_error_silent, png_warning_silent);
+
+		CPointerHold<png_struct> scope(png, [](png_structp png) {
+			png_destroy_read_struct(&png, NULL, NULL);
+		});
+
+		png_infop info = png_create_info_struct(png);
+
+		if ( ! info )
+			return false;
+
+		PngDataSource source = { &data, 0 };
+		PngPartial partial = { Buffer(), PixelInfo(), 0, size, Buffer(), nullptr };
+		png_set_read_fn(png, &source, png_rw_fn);
+		png_read_partial(png, info, &partial);
+
+		if (partial.scaler) {
+			partial.scaler->flush(); // output the pending rows of the received data
+			delete partial.scaler;
+		}
+		if (!partial.rows)
+			return false; // no row decoded
+		rv->push( Pixel(partial.info, partial.buff) );
+
+		return true;
+	}
+
+	bool img_png_decode(cBuffer& data, Array<Pixel> *rv, Vec2 size) {
 		png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
 		
 		CPointerHold<png_struct> scope(png, [](png_structp png) {
@@ -86,6 +211,7 @@ namespace qk {
 		if ( png_get_valid(png, info, PNG_INFO_tRNS) ) {
 			png_set_expand(png);
 		}
+		png_set_interlace_handling(png);
 		
 		png_read_update_info(png, info);
 		
@@ -102,6 +228,29 @@ namespace qk {
 				return false;
 		}
 
+		AlphaType alphaType = channel == 2 || channel == 4
+			? kUnpremul_AlphaType
+			: kOpaque_AlphaType;
+		auto levels = img_scale_levels(w, h, size);
+
+		if (levels && png_get_interlace_type(png, info) == PNG_INTERLACE_NONE) {
+			// Downscale row by row while decoding, only a few rows are kept in memory,
+			// the interlaced image must be fully decoded and then scaled by `img_decode()`.
+			uint32_t ow = ImageRowScaler::size(w, levels);
+			uint32_t oh = ImageRowScaler::size(h, levels);
+			auto buff = Buffer::alloc(ow * oh * channel);
+			auto row = Buffer::alloc(rowbytes);
+			ImageRowScaler scaler(w, channel, levels, (uint8_t*)buff.val());
+			for (uint32_t i = 0; i < h; i++) {
+				png_read_row(png, (png_bytep)row.val(), NULL);
+				scaler.push((uint8_t*)row.val());
+			}
+			scaler.flush();
+			png_read_end(png, info);
+			rv->push( Pixel(PixelInfo(ow, oh, format, alphaType), buff) );
+			return true;
+		}
+
 		auto buff = Buffer::alloc((uint32_t)(h * rowbytes));
 		Array<png_bytep> row_pointers((uint32_t)h);
 		
@@ -111,9 +260,6 @@ namespace qk {
 		png_read_image(png, &row_pointers[0]);
 		png_read_end(png, info);
 
-		AlphaType alphaType = channel == 2 || channel == 4
-			? kUnpremul_AlphaType
-			: kOpaque_AlphaType;
 		rv->push( Pixel(PixelInfo(w, h, format, alphaType), buff) );
 
 		return true;
@@ -30,6 +30,7 @@
 
 #include "./codec.h"
 #include <webp/decode.h>
+#include <math.h>
 
 namespace qk {
 
@@ -49,24 +50,107 @@ namespace qk {
 		return false;
 	}
 
-	bool img_webp_decode(cBuffer& data, Array<Pixel> *rv) {
-		WebPBitstreamFeatures features;
-		if (WebPGetFeatures((uint8_t*)data.val(), data.length(), &features) != VP8_STATUS_OK)
+	// Scale to the smallest size that covers the target size and keep the aspect ratio,
+	// the decoder scales while decoding, so the full size image is never allocated.
+	// Returns the output buffer of decoder
+	static Buffer webp_config_output(WebPDecoderConfig *config, Vec2 size) {
+		int width = config->input.width;
+		int height = config->input.height;
+		float scale = 0;
+		if (size[0] > 0)
+			scale = size[0] / width;
+		if (size[1] > 0)
+			scale = Qk_Max(scale, size[1] / height);
+		if (scale > 0 && scale < 1) {
+			width = Qk_Max(1, int(ceilf(width * scale)));
+			height = Qk_Max(1, int(ceilf(height * scale)));
+			config->options.use_scaling = 1;
+			config->options.scaled_width = width;
+			config->options.scaled_height = height;
+		}
+		auto buff = Buffer::alloc(width * height * 4);
+		config->output.colorspace = MODE_RGBA;
+		config->output.width = width;
+		config->output.height = height;
+		config->output.is_external_memory = 1;
+		config->output.u.RGBA.rgba = (uint8_t*)buff.val();
+		config->output.u.RGBA.stride = width * 4;
+		config->output.u.RGBA.size = buff.length();
+		return buff;
+	}
+
+	static PixelInfo webp_pixel_info(WebPDecoderConfig *config) {
+		bool hasAlpha = config->input.has_alpha;
+		return PixelInfo(
+			config->output.width,
+			config->output.height,
+			hasAlpha ? kRGBA_8888_ColorType: kRGB_888X_ColorType,
+			hasAlpha ? kUnpremul_AlphaType: kOpaque_AlphaType
+		);
+	}
+
+	bool img_webp_decode(cBuffer& data, Array<Pixel> *rv, Vec2 size) {
+		WebPDecoderConfig config;
+		if (!WebPInitDecoderConfig(&config))
+			return false;
+		if (WebPGetFeatures((uint8_t*)data.val(), data.length(), &config.input) != VP8_STATUS_OK)
 			return false;
 
-		int width, height;
-		uint8_t* buff = WebPDecodeRGBA((uint8_t*)data.val(), data.length(), &width, &height);
-		if (buff) {
-			bool hasAlpha = features.has_alpha;
-			auto bf = Buffer::from((char*)buff, width * height * 4);
-			rv->push( Pixel( PixelInfo(
-				width,
-				height,
-				hasAlpha ? kRGBA_8888_ColorType: kRGB_888X_ColorType,
-				hasAlpha ? kUnpremul_AlphaType: kOpaque_AlphaType
-			), bf) );
+		auto buff = webp_config_output(&config, size);
+		auto info = webp_pixel_info(&config);
+		auto status = WebPDecode((uint8_t*)data.val(), data.length(), &config);
+		WebPFreeDecBuffer(&config.output);
+		if (status != VP8_STATUS_OK)
+			return false;
+
+		rv->push( Pixel(info, buff) );
+
+		return true;
+	}
+
+	struct WebPPartial {
+		WebPDecoderConfig config;
+		WebPIDecoder *idec;
+		Buffer buff;
+	};
+
+	bool img_webp_decode_partial(cBuffer& data, Array<Pixel> *rv, Vec2 size, void **ctx) {
+		auto p = (WebPPartial*)*ctx;
+		if (!p) {
+			WebPDecoderConfig config;
+			if (!WebPInitDecoderConfig(&config))
+				return false;
+			if (WebPGetFeatures((uint8_t*)data.val(), data.length(), &config.input) != VP8_STATUS_OK)
+				return false; // header not enough
+			p = new WebPPartial{config, nullptr};
+			p->buff = webp_config_output(&p->config, size);
+			memset(p->buff.val(), 0, p->buff.length());
+			p->idec = WebPIDecode(nullptr, 0, &p->config);
+			if (!p->idec) {
+				delete p;
+				return false;
+			}
+			*ctx = p;
 		}
-		return rv->length();
+		// The data is always the prefix of image and may be moved, the decoder continues from last position
+		auto status = WebPIUpdate(p->idec, (uint8_t*)data.val(), data.length());
+		if (status != VP8_STATUS_OK && status != VP8_STATUS_SUSPENDED)
+			return false;
+		int lastY = 0;
+		if (!WebPIDecGetRGB(p->idec, &lastY, nullptr, nullptr, nullptr) || lastY <= 0)
+			return false; // no row decoded
+
+		// copy the rows decoded so far, the decoder continues to write the buffer
+		rv->push( Pixel(webp_pixel_info(&p->config), p->buff.copy()) );
+
+		return true;
+	}
+
+	void img_webp_partial_delete(void *ctx) {
+		auto p = (WebPPartial*)ctx;
+		WebPIDelete(p->idec);
+		WebPFreeDecBuffer(&p->config.output);
+		delete p;
 	}
 
 }
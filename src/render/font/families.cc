@@ -30,6 +30,7 @@
 
 #include "./families.h"
 #include "./pool.h"
+#include "../../util/hash.h"
 
 namespace qk {
 
@@ -127,9 +128,24 @@ namespace qk {
 
 	Array<FontGlyphs> FontFamilies::makeFontGlyphs(cArray<Unichar>& unichars, FontStyle style, float fontSize) {
 		if (unichars.length()) {
+			// Text is usually shaped again with unchanged content, such as re-wrap on resize,
+			// so reuse the glyphs, advances and fallback typefaces from the shaped runs cache
+			Hash hash;
+			hash.updateu64(uint64_t(this));
+			hash.updateu32(style.value());
+			hash.update1f(fontSize);
+			hash.updateu32v(*unichars, unichars.length());
+			auto key = hash.hashCode();
+			Array<FontGlyphs> result;
+			if (_pool->getShapedRun(key, this, style, fontSize, unichars, &result))
+				return result;
+
 			FontGlyphsBuilder builder = { matchs(style), fontSize, _pool };
 			auto glyphs = builder.tfs[0]->unicharsToGlyphs(unichars);
 			builder.make(*unichars, *glyphs, glyphs.length(), 0);
+			for (auto &fg: builder.result)
+				fg.advances(); // compute advances before caching
+			_pool->setShapedRun(key, this, style, fontSize, unichars, builder.result);
 			return std::move(builder.result);
 		} else {
 			return Array<FontGlyphs>();
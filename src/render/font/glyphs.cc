@@ -44,6 +44,44 @@ namespace qk {
 		: _fontSize(fontSize), _typeface(ft), _glyphs(std::move(glyphs))
 	{}
 
+	FontGlyphs::FontGlyphs(const FontGlyphs& fg)
+		: _fontSize(fg._fontSize), _glyphs(fg._glyphs), _advances(fg._advances), _typeface(fg.typeface())
+	{}
+
+	FontGlyphs::FontGlyphs(FontGlyphs&& fg)
+		: _fontSize(fg._fontSize)
+		, _glyphs(std::move(fg._glyphs))
+		, _advances(std::move(fg._advances)), _typeface(std::move(fg._typeface))
+	{}
+
+	FontGlyphs& FontGlyphs::operator=(const FontGlyphs& fg) {
+		_fontSize = fg._fontSize;
+		_glyphs = fg._glyphs;
+		_advances = fg._advances;
+		_typeface = fg.typeface(); // retain, don't take it away from `fg`
+		return *this;
+	}
+
+	FontGlyphs& FontGlyphs::operator=(FontGlyphs&& fg) {
+		_fontSize = fg._fontSize;
+		_glyphs = std::move(fg._glyphs);
+		_advances = std::move(fg._advances);
+		_typeface = std::move(fg._typeface);
+		return *this;
+	}
+
+	cArray<float>& FontGlyphs::advances() const {
+		if (_advances.length() != _glyphs.length()) {
+			_advances.clear();
+			_advances.extend(_glyphs.length());
+			float *dst = *_advances;
+			for (auto &gm: _typeface->getGlyphsMetrics(_glyphs, _fontSize)) {
+				*dst++ = gm.fAdvanceX;
+			}
+		}
+		return _advances;
+	}
+
 	Array<Vec2> FontGlyphs::getHorizontalOffset(Vec2 origin) const {
 		if (!_glyphs.length())
 			return Array<Vec2>({origin});
@@ -53,9 +91,9 @@ namespace qk {
 		float x = origin.x(), y = origin.y();
 		Vec2 *dst = *offset;
 
-		for (auto &gm: _typeface->getGlyphsMetrics(_glyphs, _fontSize)) {
+		for (auto advance: advances()) {
 			*dst++ = Vec2(x, y);
-			x += gm.fAdvanceX;
+			x += advance;
 		}
 		*dst = Vec2(x, y);
 
@@ -40,7 +40,12 @@ namespace qk {
 	public:
 		FontGlyphs(float fontSize, Typeface *ft, const GlyphID glyphs[], uint32_t count);
 		FontGlyphs(float fontSize, Typeface *ft, Array<GlyphID> &&glyphs);
+		FontGlyphs(const FontGlyphs& fg);
+		FontGlyphs(FontGlyphs&& fg);
+		FontGlyphs& operator=(const FontGlyphs& fg);
+		FontGlyphs& operator=(FontGlyphs&& fg);
 		Array<Vec2> getHorizontalOffset(Vec2 origin = 0) const;
+		cArray<float>& advances() const; // horizontal advance of glyphs, computed once
 		inline Typeface* typeface() const { return *_typeface; }
 		inline cArray<GlyphID>& glyphs() const { return _glyphs; }
 		inline int length() const { return _glyphs.length(); }
@@ -48,6 +53,7 @@ namespace qk {
 	private:
 		float _fontSize;
 		Array<GlyphID> _glyphs;
+		mutable Array<float> _advances;
 		mutable Sp<Typeface> _typeface;
 	};
 
@@ -31,6 +31,7 @@
 #include "../../util/hash.h"
 #include "../../../out/native-font.h"
 #include "./pool.h"
+#include <algorithm>
 
 namespace qk {
 
@@ -41,7 +42,11 @@ namespace qk {
 		return _shared_fontPool;
 	}
 
-	FontPool::FontPool(): _tf65533GlyphID(0), _Mutex(new SharedMutex) {}
+	FontPool::FontPool()
+		: _tf65533GlyphID(0)
+		, _shapedRunsMaxCapacity(4 * 1024 * 1024) // 4MB
+		, _shapedRunsCapacity(0)
+		, _shapedRunsTick(0), _Mutex(new SharedMutex) {}
 	
 	FontPool::~FontPool() {
 		Releasep(_Mutex);
@@ -149,6 +154,11 @@ namespace qk {
 				_ext.get(alias).set(tf->fontStyle(), tf);
 			}
 		}
+		if (familyName.length()) {
+			// the new family may change the fallback typefaces of the shaped runs
+			_shapedRuns.clear();
+			_shapedRunsCapacity = 0;
+		}
 		return familyName;
 	}
 
@@ -188,4 +198,78 @@ namespace qk {
 		return onMatchFamilyStyleCharacter(c_familyName, style, nullptr, 0, character);
 	}
 
+	bool FontPool::getShapedRun(uint64_t key, FontFamilies *ffs, FontStyle style, float fontSize,
+		cArray<Unichar>& unichars, Array<FontGlyphs> *out)
+	{
+		AutoSharedMutexExclusive asme(*_Mutex);
+		auto it = _shapedRuns.find(key);
+		if (it == _shapedRuns.end())
+			return false;
+		auto &run = it->second;
+		if (run.families != ffs || !(run.style == style) || run.fontSize != fontSize ||
+				run.unichars.length() != unichars.length() ||
+				memcmp(*run.unichars, *unichars, unichars.length() * sizeof(Unichar))
+		) {
+			return false; // hash collision
+		}
+		run.use = ++_shapedRunsTick;
+		*out = run.glyphs; // copy
+		return true;
+	}
+
+	void FontPool::setShapedRun(uint64_t key, FontFamilies *ffs, FontStyle style, float fontSize,
+		cArray<Unichar>& unichars, cArray<FontGlyphs>& glyphs)
+	{
+		uint32_t size = sizeof(ShapedRun) + unichars.length() * sizeof(Unichar);
+		for (auto &fg: glyphs) {
+			size += sizeof(FontGlyphs) + fg.length() * (sizeof(GlyphID) + sizeof(float));
+		}
+		if (size > _shapedRunsMaxCapacity >> 4)
+			return; // too large to cache, such as a very long paragraph
+
+		AutoSharedMutexExclusive asme(*_Mutex);
+		auto it = _shapedRuns.find(key);
+		if (it != _shapedRuns.end()) {
+			_shapedRunsCapacity -= it->second.size;
+			_shapedRuns.erase(it);
+		}
+		if (_shapedRunsCapacity + size > _shapedRunsMaxCapacity) {
+			// free 1/4 of the max capacity beyond the excess, don't evict again at every miss
+			clearShapedRuns(_shapedRunsCapacity + size - _shapedRunsMaxCapacity + (_shapedRunsMaxCapacity >> 2));
+		}
+		_shapedRunsCapacity += size;
+		_shapedRuns.set(key, { ffs, style, fontSize, unichars, glyphs, size, ++_shapedRunsTick });
+	}
+
+	void FontPool::set_shapedRunsMaxCapacity(uint32_t val) {
+		AutoSharedMutexExclusive asme(*_Mutex);
+		_shapedRunsMaxCapacity = val;
+		if (_shapedRunsCapacity > val)
+			clearShapedRuns(_shapedRunsCapacity - val);
+	}
+
+	void FontPool::clearShapedRuns(uint32_t capacity) {
+		struct Victim {
+			uint32_t use, size;
+			uint64_t key;
+		};
+		Array<Victim> victims;
+		for (auto &i: _shapedRuns)
+			victims.push({i.second.use, i.second.size, i.first});
+
+		// least recently used first
+		std::sort(victims.val(), victims.val() + victims.length(), [](const Victim &a, const Victim &b) {
+			return a.use < b.use;
+		});
+
+		uint32_t freed = 0;
+		for (auto &v: victims) {
+			if (freed >= capacity)
+				break;
+			_shapedRuns.erase(v.key);
+			freed += v.size;
+		}
+		_shapedRunsCapacity -= Qk_Min(freed, _shapedRunsCapacity);
+	}
+
 }
@@ -46,6 +46,8 @@ namespace qk {
 		Qk_DEFINE_PROP_GET(FFID, defaultFontFamilies);
 		Qk_DEFINE_PROP_GET(Sp<Typeface>, tf65533);
 		Qk_DEFINE_PROP_GET(GlyphID, tf65533GlyphID, Const);
+		Qk_DEFINE_PROPERTY(uint32_t, shapedRunsMaxCapacity, Const); // max memory capacity of shaped runs cache
+		Qk_DEFINE_PROP_GET(uint32_t, shapedRunsCapacity, Const); // current memory capacity of shaped runs cache
 		// define methods
 		~FontPool() override;
 		String getFamilyName(int index) const;
@@ -66,9 +68,33 @@ namespace qk {
 			cChar* bcp47[], int bcp47Count, Unichar character) const = 0;
 		virtual Typeface* onAddFontFamily(cBuffer& data, int ttcIndex) const = 0;
 
+		/**
+		 * Shaped run, the glyphs, advances and fallback typefaces of the text run,
+		 * keyed by the hash of (families, style, font size, unichars)
+		*/
+		struct ShapedRun {
+			FontFamilies*     families; // compare on hit with the other fields, the key is only a hash
+			FontStyle         style;
+			float             fontSize;
+			Array<Unichar>    unichars;
+			Array<FontGlyphs> glyphs;
+			uint32_t          size; // memory size counted in capacity
+			uint32_t          use;  // tick of last use
+		};
+		bool getShapedRun(uint64_t key, FontFamilies *ffs, FontStyle style, float fontSize,
+			cArray<Unichar>& unichars, Array<FontGlyphs> *out);
+		void setShapedRun(uint64_t key, FontFamilies *ffs, FontStyle style, float fontSize,
+			cArray<Unichar>& unichars, cArray<FontGlyphs>& glyphs);
+		/**
+		 * @dev Evict the least recently used shaped runs until at least `capacity` bytes are freed
+		*/
+		void clearShapedRuns(uint32_t capacity);
+
 		Array<String> _defaultFamilyNames; // default families names
 		Dict<String, Dict<FontStyle, Sp<Typeface>>> _ext; // familiesName => (style=>tf)
 		Dict<uint64_t, Sp<FontFamilies>> _fontFamilies;
+		Dict<uint64_t, ShapedRun> _shapedRuns; // shaped runs cache
+		uint32_t _shapedRunsTick; // advanced by every access
 		// Conservative line-height strut. Prefer the default CJK font metrics
 		// and fall back to the default Latin font metrics.
 		mutable FontMetrics _strutMetrics64;
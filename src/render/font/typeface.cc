@@ -268,4 +268,20 @@ namespace qk {
 		Qk_ReturnLocal(out);
 	}
 
+	Typeface::TextImage Typeface::getGlyphImage(GlyphID glyph, float fontSize) {
+		auto gm = getGlyphMetrics(glyph, fontSize);
+		// The run image clips each glyph to its layout box, so shift the pen right
+		// for ink left of the origin and pad for ink right of the advance
+		float lead = F32::max(0, -gm.fLeft) + 1;
+		float tail = F32::max(0, gm.fLeft + gm.fWidth - gm.fAdvanceX) + 1;
+		float size = F32::min(gm.fHeight, lead + gm.fAdvanceX);
+		if (size <= 0) {
+			return {ImageSource::Make(PixelInfo())}; // blank glyph
+		}
+		Array<Vec2> offset{Vec2(lead, 0), Vec2(lead + gm.fAdvanceX, 0)};
+		auto out = onGetImage({glyph}, fontSize, &offset, tail / size, true);
+		out.left += lead * out.scale; // left of image to the pen position
+		Qk_ReturnLocal(out);
+	}
+
 }
@@ -94,6 +94,13 @@ namespace qk {
 		*/
 		TextImage getSDFImage(cArray<GlyphID> &glyphs, float fontSize, cArray<Vec2> *offset, bool is_signed);
 
+		/**
+		 * get the image of a single glyph, the image reserves room for ink that extends
+		 * beyond the pen position or the advance, used to fill the glyph atlas
+		 * @method getGlyphImage
+		*/
+		TextImage getGlyphImage(GlyphID glyph, float fontSize);
+
 	protected:
 		Typeface(FontStyle style);
 		virtual int onCountGlyphs() const = 0;
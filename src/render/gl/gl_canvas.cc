@@ -101,6 +101,7 @@ namespace qk {
 
 	bool GLCanvas::swapBuffer() {
 		_alloc.reset();
+		_frameAlloc.reset();
 		ScopeLock lock(_mutex);
 		// check if have cmds in front buffer, if have cmds, wait for next swap
 		bool canSwap = _cmdPackFront->isEmpty();
@@ -108,6 +109,7 @@ namespace qk {
 			std::swap(_cmdPackFront, _cmdPack); // swap cmd buffer
 			_cmdPack->savePipelineState(); // save initial pipeline state
 			clear_PathvCache(_cache, 0); // tag: clear mark
+			_glyphAtlas->nextFrame();
 		}
 		_cmdPack->clear(); // clear cmd buffer for next frame
 		return canSwap;
@@ -52,6 +52,7 @@ namespace qk {
 	constexpr float whiteColor[] = {1.0f,1.0f,1.0f,1.0f};
 	constexpr float emptyColor[] = {0.0f,0.0f,0.0f,0.0f};
 	constexpr GLenum DrawBuffers[]{ GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	constexpr GLuint ubo0Binding = 3, ubo1Binding = 4; // binding points of GLRender::_ubo0,_ubo1
 
 	Qk_DEFINE_INLINE_MEMBERS(GLC_CmdPack, Inl) {
 	public:
@@ -192,7 +193,82 @@ namespace qk {
 			_optionBlocks.index = 0;
 		}
 
+		/**
+		 * Gather the vertex, index and uniform data of the queued draw cmds into
+		 * the stream buffer and record the offsets in the cmds, return total bytes.
+		 *
+		 * If dst is null only measure the size and mark all cmds as not streamed,
+		 * these cmds then upload their data at draw time.
+		*/
+		uint32_t streamCmds(char *dst, uint32_t base) {
+			constexpr uint32_t vAlign = 16;
+			uint32_t uAlign = _render->_stream.uniformAlign();
+			uint32_t size = 0;
+			auto put = [&](const void *src, uint32_t bytes, uint32_t align) {
+				size = (size + align - 1) / align * align;
+				uint32_t offset = size;
+				size += bytes;
+				if (!dst)
+					return GLStreamBuffer::kNone;
+				memcpy(dst + offset, src, bytes);
+				return base + offset;
+			};
+			auto putVertex = [&](DrawCmd *c) {
+				c->vStream = c->vertex.id || !c->vertex.vertex.length() ? GLStreamBuffer::kNone:
+					put(c->vertex.vertex.val(), c->vertex.vertex.size(), vAlign);
+			};
+			for (auto &block: _cmds.blocks) {
+				if (block.size == 0) break;
+				auto cmd = block.val;
+				auto end = (Cmd*)(((char*)cmd) + block.size);
+				while (cmd < end) {
+					switch (cmd->type) {
+						case kColor_CmdType:
+						case kImage_CmdType:
+						case kClip_CmdType:
+							putVertex((DrawCmd*)cmd);
+							break;
+						case kGradient_CmdType: {
+							auto c = (GradientCmd*)cmd;
+							auto count = Qk_Min(64, c->paint.count);
+							putVertex(c);
+							c->colorsStream = put(c->paint.colors, sizeof(Color4f) * count, uAlign);
+							c->positionsStream = put(c->paint.positions, sizeof(float) * count, uAlign);
+							break;
+						}
+						case kColorBatch_CmdType: {
+							auto c = (ColorBatchCmd*)cmd;
+							c->vStream = put(c->vertex, c->vCount * sizeof(Vec4), vAlign);
+							c->optsStream = put(c->opts, sizeof(ColorBatchCmd::Option) * c->subcmd, uAlign);
+							break;
+						}
+						case kTriangles_CmdType: {
+							auto c = (TrianglesCmd*)cmd;
+							c->vStream = put(c->triangles.verts, c->triangles.vertCount * sizeof(V3F_T2F_C4B_C4B), vAlign);
+							c->iStream = put(c->triangles.indices, c->triangles.indexCount * sizeof(uint16_t), vAlign);
+							break;
+						}
+						default: break;
+					}
+					cmd = (Cmd*)(((char*)cmd) + cmd->size); // next cmd
+				}
+			}
+			return size;
+		}
+
 		void callCmds() {
+			auto &stream = _render->_stream;
+			auto region = GLStreamBuffer::kNone;
+			auto size = streamCmds(nullptr, 0); // measure and mark as not streamed
+			if (size) {
+				auto dst = stream.map(size, &region);
+				if (dst) {
+					streamCmds(dst, region);
+					if (!stream.unmap())
+						streamCmds(nullptr, 0); // data store corrupted, upload per draw call
+				}
+			}
+
 			for (auto &block: _cmds.blocks) {
 				if (block.size == 0) break;
 				auto cmd = block.val;
@@ -237,7 +313,7 @@ namespace qk {
 						}
 						case kColor_CmdType: {
 							auto c = (ColorCmd*)cmd;
-							drawColor(c->vertex, c->color, c->vPos, {0}, c->flags);
+							drawColor(c->vertex, c->vStream, c->color, c->vPos, {0}, c->flags);
 							c->~ColorCmd();
 							break;
 						}
@@ -267,13 +343,15 @@ namespace qk {
 						case kColorBatch_CmdType: {
 							auto c = (ColorBatchCmd*)cmd;
 							auto s = &_render->_shaders.colorBatch;
-							glBindBuffer(GL_UNIFORM_BUFFER, _render->_ubo0);
-							glBufferData(GL_UNIFORM_BUFFER, sizeof(ColorBatchCmd::Option) * c->subcmd, c->opts,
-								GL_DYNAMIC_DRAW);
-							glBindBuffer(GL_ARRAY_BUFFER, s->vbo);
-							glBufferData(GL_ARRAY_BUFFER, c->vCount * sizeof(Vec4), c->vertex, GL_DYNAMIC_DRAW);
-							glBindVertexArray(s->vao);
-							glUseProgram(s->shader);
+							auto optsSize = sizeof(ColorBatchCmd::Option) * c->subcmd;
+							if (c->vStream != GLStreamBuffer::kNone) {
+								glBindBufferRange(GL_UNIFORM_BUFFER, ubo0Binding, stream.buffer(), c->optsStream, optsSize);
+								s->useStream(stream.buffer(), c->vStream);
+							} else {
+								glBindBufferBase(GL_UNIFORM_BUFFER, ubo0Binding, _render->_ubo0);
+								glBufferData(GL_UNIFORM_BUFFER, optsSize, c->opts, GL_DYNAMIC_DRAW);
+								s->use(c->vCount * sizeof(Vec4), c->vertex);
+							}
 							glDrawArrays(GL_TRIANGLES, 0, c->vCount);
 							break;
 						}
@@ -325,6 +403,8 @@ namespace qk {
 				}
 				block.size = 0;
 			}
+			if (region != GLStreamBuffer::kNone)
+				stream.fence(region);
 			clearCmds();
 		}
 
@@ -334,10 +414,12 @@ namespace qk {
 			);
 		}
 
-		void useShaderProgram(GLSLShader *shader, const VertexData &vertex) {
+		void useShaderProgram(GLSLShader *shader, const VertexData &vertex, uint32_t vStream) {
 			if (Render::useVertexData(vertex.id)) {
 				glBindVertexArray(gl_get_vertex_vao(vertex.id->ptr)); // use vao
 				glUseProgram(shader->shader); // use shader program
+			} else if (vStream != GLStreamBuffer::kNone) {
+				shader->useStream(_render->_stream.buffer(), vStream);
 			} else /*if (vertex.vertex.length())*/ {
 				// copy vertex data to gpu and use shader
 				Qk_ASSERT_EQ(vertex.vertex.length(), vertex.vCount, "useShaderProgram, vertex vCount != vertex.vertex.size()");
@@ -439,7 +521,7 @@ namespace qk {
 				if (cmd->kind == kImage_DrawKind &&
 						!paint._isCanvas && kYUV420P_Y_8_ColorType == src->type()) { // yuv420p or yuv420sp
 					auto yuv = &_render->_shaders.imageYuv;
-					useShaderProgram(yuv, cmd->vertex);
+					useShaderProgram(yuv, cmd->vertex, cmd->vStream);
 					Qk_ASSERT_EQ(true, _render->use_texture(src, 0, yuv->imageSlot, &paint));
 					Qk_ASSERT_EQ(true, _render->use_texture(src, 1, yuv->image_uvSlot, &paint)); // u or uv
 					if (src->pixel(1)->type() == kYUV420P_U_8_ColorType) {
@@ -454,7 +536,7 @@ namespace qk {
 					glUniform1ui(yuv->pc_flags, cmd->flags);
 				} else {
 					auto s = &_render->_shaders.image;
-					useShaderProgram(s, cmd->vertex);
+					useShaderProgram(s, cmd->vertex, cmd->vStream);
 					auto type = paint._isCanvas ? kRGBA_8888_ColorType: paint.image->type();
 					glUniform1i(s->pc_alphaIndex, cmd->kind == kMask_DrawKind ?
 						(type == kAlpha_8_ColorType ? 0 : type == kLuminance_Alpha_88_ColorType ? 1 : 3): 0);
@@ -482,21 +564,34 @@ namespace qk {
 			if (useTexture0(cmd->paint, s->imageSlot)) {
 				// auto isPre = cmd->paint.image->premultipliedAlpha();
 				Qk_ASSERT_EQ(cmd->triangles.indexCount % 3, 0, "drawTrianglesCall, indexCount must be a multiple of 3");
-				s->use(cmd->triangles.vertCount * sizeof(V3F_T2F_C4B_C4B), cmd->triangles.verts);
+				auto vSize = cmd->triangles.vertCount * sizeof(V3F_T2F_C4B_C4B);
+				auto iSize = sizeof(uint16_t) * cmd->triangles.indexCount;
+				auto stream = cmd->vStream != GLStreamBuffer::kNone;
+				if (stream) {
+					s->useStream(_render->_stream.buffer(), cmd->vStream);
+				} else {
+					s->use(vSize, cmd->triangles.verts);
+				}
 				glUniform1ui(s->pc_flags, cmd->flags | (cmd->triangles.isDarkColor ? Qk_FLAGS_DARK_COLOR : 0));
 				glUniform4fv(s->pc_color, 1, cmd->color.val);
 				glUniform2fv(s->pc_vPos, 1, cmd->vPos.val);
 				// glUniform1f(s->premultipliedAlpha, isPre ? 1.0f : 0.0f);
-				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _render->_ebo); // restore ebo
-				glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * cmd->triangles.indexCount, cmd->triangles.indices, GL_DYNAMIC_DRAW);
-				glDrawElements(GL_TRIANGLES, cmd->triangles.indexCount, GL_UNSIGNED_SHORT, 0);
+				if (stream) {
+					glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _render->_stream.buffer());
+					glDrawElements(GL_TRIANGLES, cmd->triangles.indexCount, GL_UNSIGNED_SHORT,
+						(const GLvoid*)(uintptr_t)cmd->iStream);
+				} else {
+					glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _render->_ebo); // restore ebo
+					glBufferData(GL_ELEMENT_ARRAY_BUFFER, iSize, cmd->triangles.indices, GL_DYNAMIC_DRAW);
+					glDrawElements(GL_TRIANGLES, cmd->triangles.indexCount, GL_UNSIGNED_SHORT, 0);
+				}
 			}
 		}
 
 		void drawGradientCall(GradientCmd *cmd) {
 			auto s = &_render->_shaders.colorGradient;
 			int count = Qk_Min(64, cmd->paint.count); // max 64 stops
-			useShaderProgram(s, cmd->vertex);
+			useShaderProgram(s, cmd->vertex, cmd->vStream);
 			glUniform1ui(s->pc_flags, cmd->flags |
 				(count == 2 ? Qk_FLAG_GRADIENT_COUNT2: 0) |
 				(cmd->paint.type == PaintGradient::kRadial_Type ? Qk_FLAG_RADIAL_GRADIENT: 0));
@@ -504,10 +599,16 @@ namespace qk {
 			glUniform4fv(s->pc_range, 1, cmd->paint.origin.val);
 			glUniform2fv(s->pc_vPos, 1, cmd->vPos.val);
 			glUniform1i(s->pc_count, count);
-			glBindBuffer(GL_UNIFORM_BUFFER, _render->_ubo0);
-			glBufferData(GL_UNIFORM_BUFFER, sizeof(Color4f) * count, (const GLfloat*)cmd->paint.colors, GL_DYNAMIC_DRAW);
-			glBindBuffer(GL_UNIFORM_BUFFER, _render->_ubo1);
-			glBufferData(GL_UNIFORM_BUFFER, sizeof(float) * count, (const GLfloat*)cmd->paint.positions, GL_DYNAMIC_DRAW);
+			if (cmd->colorsStream != GLStreamBuffer::kNone) {
+				auto buffer = _render->_stream.buffer();
+				glBindBufferRange(GL_UNIFORM_BUFFER, ubo0Binding, buffer, cmd->colorsStream, sizeof(Color4f) * count);
+				glBindBufferRange(GL_UNIFORM_BUFFER, ubo1Binding, buffer, cmd->positionsStream, sizeof(float) * count);
+			} else {
+				glBindBufferBase(GL_UNIFORM_BUFFER, ubo0Binding, _render->_ubo0);
+				glBufferData(GL_UNIFORM_BUFFER, sizeof(Color4f) * count, (const GLfloat*)cmd->paint.colors, GL_DYNAMIC_DRAW);
+				glBindBufferBase(GL_UNIFORM_BUFFER, ubo1Binding, _render->_ubo1);
+				glBufferData(GL_UNIFORM_BUFFER, sizeof(float) * count, (const GLfloat*)cmd->paint.positions, GL_DYNAMIC_DRAW);
+			}
 			glDrawArrays(GL_TRIANGLES, 0, cmd->vertex.vCount);
 		}
 
@@ -530,7 +631,7 @@ namespace qk {
 				// This produces a smooth subtractive mask edge.
 				int flags = black ? Qk_FLAG_AASIDE_Inverted : 0; // Qk_FLAG_AASIDE_Inverted
 				flags |= Qk_CLIP(clip); // set clip flag if have clip
-				drawColor(cmd->vertex, Color4f{1,1,1,1}, cmd->vPos, offset, flags);
+				drawColor(cmd->vertex, cmd->vStream, Color4f{1,1,1,1}, cmd->vPos, offset, flags);
 			};
 			if (cmd->rawOp == Canvas::kIntersect_ClipOp || !last) {
 				// clear clipTex with black color
@@ -583,9 +684,10 @@ namespace qk {
 			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 		}
 
-		void drawColor(const VertexData &vertex, const Color4f &color, Vec2 vPos, Vec4 offset, uint32_t flags) {
+		void drawColor(const VertexData &vertex, uint32_t vStream,
+				const Color4f &color, Vec2 vPos, Vec4 offset, uint32_t flags) {
 			auto s = &_render->_shaders.color;
-			useShaderProgram(s, vertex);
+			useShaderProgram(s, vertex, vStream);
 			glUniform4fv(s->pc_color, 1, color.val);
 			glUniform4fv(s->pc_surfaceOffset, 1, offset.val);
 			glUniform2fv(s->pc_vPos, 1, vPos.val);
@@ -85,6 +85,7 @@ namespace qk {
 		struct DrawCmd: Cmd { // draw base cmd
 			Vec2           vPos; // view position
 			VertexData     vertex;
+			uint32_t       vStream; // vertex offset of the stream buffer
 		};
 
 		struct alignas(void*) MatrixCmd: Cmd {
@@ -146,6 +147,7 @@ namespace qk {
 		struct alignas(void*) GradientCmd: DrawCmd { //!
 			Color4f        color;
 			PaintGradient  paint;
+			uint32_t       colorsStream, positionsStream; // uniform offsets of the stream buffer
 		};
 
 		struct alignas(void*) ImageCmd: DrawCmd { //!
@@ -168,6 +170,7 @@ namespace qk {
 			Option         *opts;  // subcmd option
 			uint32_t       vCount; // vertex count
 			int            subcmd; // subcmd count
+			uint32_t       vStream, optsStream; // offsets of the stream buffer
 		};
 
 		struct alignas(void*) TrianglesCmd: Cmd {
@@ -176,6 +179,7 @@ namespace qk {
 			PaintImage     paint;
 			Color4f        color;
 			bool           copyData;
+			uint32_t       vStream, iStream; // vertex and index offsets of the stream buffer
 			~TrianglesCmd();
 		};
 
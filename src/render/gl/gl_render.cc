@@ -40,6 +40,9 @@
 # define GL_UNSIGNED_INT_10_10_10_2 0x8036
 #endif
 
+#define Qk_GL_StreamBuffer_Capacity (4 * 1024 * 1024) // about three frames in flight
+#define Qk_GL_StreamBuffer_WaitTimeout 1000000000 // 1s, nanoseconds
+
 namespace qk {
 	String gl_Global_GLSL_Macros, gl_extensions;
 	int gl_MaxTextureImageUnits = 0;
@@ -447,6 +450,24 @@ namespace qk {
 		return true;
 	}
 
+	bool gl_upload_texture_rect(Pixel *pix, IRect rect, TexStat *tex, bool mipmap, PostMessage *msg) {
+		auto ptr = static_cast<GLTexture*>(tex->ptr());
+		if (!ptr || !pix || !pix->length() || pix->type() >= kPVRTCI_2BPP_RGB_ColorType)
+			return false; // not uploaded yet or compressed texture
+		msg->post_message(Cb([pix=Pixel(std::move(*pix)),rect,mipmap,ptr](auto e) {
+			if (!ptr->id)
+				return; // texture was deleted
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, ptr->id);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, rect.begin[0], rect.begin[1], rect.size[0], rect.size[1],
+				gl_get_texture_format(pix.type()), gl_get_texture_data_type(pix.type()), pix.val());
+			if (mipmap)
+				glGenerateMipmap(GL_TEXTURE_2D);
+		}));
+		return true;
+	}
+
 	void gl_unload_texture(TexStat *tex, PostMessage *msg) {
 		auto ptr = static_cast<GLTexture*>(tex->ptr());
 		if (!ptr) return;
@@ -501,6 +522,10 @@ namespace qk {
 		return gl_upload_texture(pix, levels, tex, mipmap, this);
 	}
 
+	bool GLRenderResource::uploadTextureRect(Pixel *pix, IRect rect, TexStat *tex, bool mipmap) {
+		return gl_upload_texture_rect(pix, rect, tex, mipmap, this);
+	}
+
 	void GLRenderResource::unloadTexture(TexStat *tex) {
 		gl_unload_texture(tex, this);
 	}
@@ -511,6 +536,83 @@ namespace qk {
 
 	// --------------------------------------------------
 
+	GLStreamBuffer::GLStreamBuffer()
+		: _buffer(0), _capacity(0), _head(0), _uniformAlign(16)
+	{}
+
+	void GLStreamBuffer::init(uint32_t capacity) {
+		GLint align = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+		_uniformAlign = Qk_Max(align, 16);
+		_capacity = capacity;
+		glGenBuffers(1, &_buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	Array<GLsync> GLStreamBuffer::detach() {
+		Array<GLsync> syncs;
+		for (auto &i: _regions) {
+			if (i.sync)
+				syncs.push(i.sync);
+		}
+		_regions.clear();
+		_buffer = 0;
+		_capacity = _head = 0;
+		return syncs;
+	}
+
+	char* GLStreamBuffer::map(uint32_t size, uint32_t *offset) {
+		size = (size + _uniformAlign - 1) / _uniformAlign * _uniformAlign;
+		if (size > _capacity)
+			return nullptr;
+		uint32_t begin = _head + size > _capacity ? 0: _head; // wrap
+		uint32_t end = begin + size;
+
+		// The regions are reserved in ring order, so the ones overlapping
+		// the new region are always the oldest at the front of the list.
+		while (_regions.length()) {
+			auto &r = _regions.front();
+			if (r.end <= begin || r.begin >= end)
+				break;
+			if (!r.sync)
+				return nullptr; // still being drawn by an outer flush
+			if (glClientWaitSync(r.sync, GL_SYNC_FLUSH_COMMANDS_BIT,
+					Qk_GL_StreamBuffer_WaitTimeout) == GL_TIMEOUT_EXPIRED)
+				return nullptr;
+			glDeleteSync(r.sync);
+			_regions.popFront();
+		}
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+		auto data = glMapBufferRange(GL_COPY_WRITE_BUFFER, begin, size,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (!data)
+			return nullptr;
+		_regions.pushBack({begin, end, nullptr});
+		_head = end;
+		*offset = begin;
+		return (char*)data;
+	}
+
+	bool GLStreamBuffer::unmap() {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+		return glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_TRUE;
+	}
+
+	void GLStreamBuffer::fence(uint32_t offset) {
+		for (auto i = _regions.end(); i != _regions.begin(); ) {
+			auto &r = *(--i);
+			if (r.begin == offset && !r.sync) {
+				r.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				break;
+			}
+		}
+	}
+
+	// --------------------------------------------------
+
 	GLRender::GLRender(Options opts)
 		: Render(opts), _glcanvas(nullptr), _blendMode(kInvalid_BlendMode)
 	{
@@ -527,6 +629,7 @@ namespace qk {
 			glBindBufferBase(GL_UNIFORM_BUFFER, i, (&_uboRMat)[i]);
 			glBufferData(GL_UNIFORM_BUFFER, 128, nullptr, GL_DYNAMIC_DRAW);
 		}
+		_stream.init(Qk_GL_StreamBuffer_Capacity);
 #if DEBUG
 		int64_t st = time_microsecond();
 #endif
@@ -551,11 +654,13 @@ namespace qk {
 	void GLRender::release() {
 		Qk_CHECK(_glcanvas->refCount() == 1,
 			"GLCanvas still has reference, ref count: %d", _glcanvas->refCount());
-		GLuint ubo[] = { _uboRMat,_ubovMat,_uboClip,_ubo0,_ubo1,_ebo };
-		post_message(Cb([ubo,samplers=std::move(_texSamplers)](auto &e) {
+		GLuint ubo[] = { _uboRMat,_ubovMat,_uboClip,_ubo0,_ubo1,_ebo,_stream.buffer() };
+		post_message(Cb([ubo,samplers=std::move(_texSamplers),syncs=_stream.detach()](auto &e) {
 			for (auto &i: samplers)
 				glDeleteSamplers(1, &i.second);
-			glDeleteBuffers(6, ubo);
+			for (auto i: syncs)
+				glDeleteSync(i);
+			glDeleteBuffers(7, ubo);
 		}));
 		Releasep(_glcanvas); // release canvas and set to nullptr
 		_canvas = nullptr;
@@ -635,6 +740,12 @@ namespace qk {
 		return gl_upload_texture(pix, levels, tex, mipmap, this);
 	}
 
+	bool GLRender::uploadTextureRect(Pixel *pix, IRect rect, TexStat *tex, bool mipmap) {
+		if (!_canvas)
+			return false;
+		return gl_upload_texture_rect(pix, rect, tex, mipmap, this);
+	}
+
 	void GLRender::unloadTexture(TexStat *tex) {
 		if (_canvas) {
 			gl_unload_texture(tex, this);
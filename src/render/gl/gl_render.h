@@ -35,6 +35,7 @@
 
 #include "../render.h"
 #include "./gl_canvas.h"
+#include "../../util/list.h"
 
 namespace qk {
 
@@ -63,6 +64,40 @@ namespace qk {
 		return src ? static_cast<GLTexture*>(src->texture(0)->ptr())->id : _else;
 	}
 
+	/**
+	 * Streaming ring buffer for per-draw vertex, index and uniform data.
+	 *
+	 * Each cmd pack flush reserves one region of a single large buffer, writes it
+	 * through one unsynchronized map, draws from it by offset and fences it, the fence
+	 * is waited before the ring wraps onto the region again, so data still read by the
+	 * frames in flight is never overwritten and the driver never has to reallocate.
+	 */
+	class GLStreamBuffer {
+		Qk_DISABLE_COPY(GLStreamBuffer);
+	public:
+		static constexpr uint32_t kNone = 0xffffffff; // not offset of the stream buffer
+		GLStreamBuffer();
+		void init(uint32_t capacity);
+		Array<GLsync> detach(); // detach the fences and return them for release
+		/**
+		 * Reserve and map a region of size bytes, return null if the region can't be served,
+		 * then the caller should fall back to upload data per draw call
+		*/
+		char* map(uint32_t size, uint32_t *offset);
+		bool unmap(); // return false if the data store was corrupted while mapped
+		void fence(uint32_t offset); // fence the region after its draw calls have been issued
+		inline GLuint buffer() const { return _buffer; }
+		inline uint32_t uniformAlign() const { return _uniformAlign; }
+	private:
+		struct Region {
+			uint32_t begin, end;
+			GLsync   sync; // null until the region is fenced
+		};
+		GLuint         _buffer;
+		uint32_t       _capacity, _head, _uniformAlign;
+		List<Region>   _regions; // regions in flight, ordered by submission
+	};
+
 	/**
 	 * Global render resource, not thread safe, called in the post message callback of thread
 	 */
@@ -70,6 +105,7 @@ namespace qk {
 	public:
 		void post_message(Cb cb) override;
 		bool uploadTexture(Pixel *pix, int levels, TexStat *tex, bool mipmap) override;
+		bool uploadTextureRect(Pixel *pix, IRect rect, TexStat *tex, bool mipmap) override;
 		void unloadTexture(TexStat *tex) override;
 		TexStat createTextureStat(Vec2 size, ColorType type, uint8_t flags) override;
 	protected:
@@ -85,6 +121,7 @@ namespace qk {
 		void release() override;
 		Canvas* createCanvas(Options opts) override;
 		bool uploadTexture(Pixel *pix, int levels, TexStat *tex, bool mipmap) override;
+		bool uploadTextureRect(Pixel *pix, IRect rect, TexStat *tex, bool mipmap) override;
 		void unloadTexture(TexStat *tex) override;
 		TexStat createTextureStat(Vec2 size, ColorType type, uint8_t flags) override;
 		bool uploadVertexData(VertexData::ID *id) override;
@@ -101,6 +138,7 @@ namespace qk {
 		GLuint _uboRMat,_ubovMat,_uboClip; // ubo: rootMatrixBlock,viewportBlock,clipBlock
 		GLuint _ubo0,_ubo1; // temp ubo for draw call
 		GLuint _ebo; // temp ebo, GL_ELEMENT_ARRAY_BUFFER
+		GLStreamBuffer _stream; // streaming vertex, index and uniform data for draw calls
 		GLCanvas* _glcanvas; // main canvas
 		GLSLShaders _shaders; // glsl shaders
 		BlendMode _blendMode; // last setting status
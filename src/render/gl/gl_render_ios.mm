@@ -134,6 +134,7 @@ class IosGLRender final: public GLRender, public RenderSurface {
 		Qk_ASSERT_EQ(EAGLContext.currentContext, _ctx, "Failed to set current OpenGL context");
 
 		if (_delegate->onRenderBackendDisplay()) {
+			Canvas::SubmitScope submit(_glcanvas); // profile submit time, including present
 			_glcanvas->flushBuffer(); // commit gl canvas cmd
 
 			auto src = _glcanvas->surfaceSize();
@@ -273,6 +273,7 @@ namespace qk {
 			resolvedMsg(false);
 
 			if (_delegate->onRenderBackendDisplay()) {
+				Canvas::SubmitScope submit(_glcanvas); // profile submit time, including swap
 				_glcanvas->flushBuffer(); // commit gl canvas cmd
 #if 0
 				auto src = _glcanvas->surfaceSize();
@@ -147,6 +147,7 @@ class MacGLRender final: public GLRender, public RenderSurface {
 		resolvedMsg(false); // resolve messages before display
 
 		if (_delegate->onRenderBackendDisplay()) {
+			Canvas::SubmitScope submit(_glcanvas); // profile submit time
 			_glcanvas->flushBuffer(); // commit gl canvas cmds
 			_glcanvas->vportCopy(0); // copy pixels to default color buffer
 			glFlush(); // flush gl buffer, glFinish, glFenceSync, glWaitSync
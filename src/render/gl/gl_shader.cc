@@ -36,6 +36,13 @@ namespace qk {
 	extern String gl_Global_GLSL_Macros;
 	extern int    gl_MaxTextureImageUnits;
 
+	static void set_vertex_attrib_pointers(GLSLShader *s, GLintptr offset) {
+		for (auto &i: s->attributes) {
+			glVertexAttribPointer(*i.location, i.size, i.glType, i.normalized, s->stride, (const GLvoid*)offset);
+			offset += i.sizeOf;
+		}
+	}
+
 	static GLuint compile_shader(cChar* name, cString &code, GLenum shader_type) {
 		GLuint shader_handle = glCreateShader(shader_type);
 		GLint code_len = (GLint)code.length();
@@ -127,17 +134,17 @@ namespace qk {
 			}
 		}
 
-		GLsizei stride = 0, pointer = 0;
+		s->stride = 0;
+		s->streamed = false;
+		s->attributes = attributes;
 
 		for (auto &i: attributes) {
-			stride += i.sizeOf;
+			s->stride += i.sizeOf;
 		}
 		for (auto &i: attributes) {
-			GLuint local = *i.location;
 			glEnableVertexAttribArray(*i.location);
-			glVertexAttribPointer(local, i.size, i.glType, i.normalized, stride, (const GLvoid*)pointer);
-			pointer += i.sizeOf;
 		}
+		set_vertex_attrib_pointers(s, 0);
 
 		// clean up
 		glBindVertexArray(0);
@@ -150,6 +157,18 @@ namespace qk {
 		glBindBuffer(GL_ARRAY_BUFFER, vbo);
 		glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW); // GL_STATIC_DRAW
 		glBindVertexArray(vao);
+		if (streamed) { // point the attributes back to vbo
+			set_vertex_attrib_pointers(this, 0);
+			streamed = false;
+		}
+	}
+
+	void GLSLShader::useStream(GLuint buffer, GLintptr offset) {
+		glUseProgram(shader);
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		set_vertex_attrib_pointers(this, offset);
+		streamed = true;
 	}
 
 }
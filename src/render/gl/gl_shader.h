@@ -83,7 +83,11 @@ namespace qk {
 
 	struct GLSLShader {
 		GLuint shader, vao, vbo;
+		GLsizei stride; // vertex attributes stride
+		bool    streamed; // vao attributes source from a stream buffer instead of vbo
+		Array<GLShaderAttr> attributes; // vertex attributes layout
 		void use(GLsizeiptr size, const GLvoid* data);
+		void useStream(GLuint buffer, GLintptr offset); // use vertex data at offset of buffer
 		virtual void build(cChar* name, cChar *macros) = 0;
 	};
 
@@ -0,0 +1,242 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include "./glyph_atlas.h"
+
+namespace qk {
+
+	inline static uint64_t glyph_key(GlyphID glyph, float fontSize) {
+		return (uint64_t(*reinterpret_cast<uint32_t*>(&fontSize)) << 32) | glyph;
+	}
+
+	GlyphAtlas::GlyphAtlas(uint32_t pageSize, uint32_t maxPages)
+		: _pageSize(pageSize), _maxPages(maxPages), _frame(1), _prune(false)
+	{}
+
+	const GlyphAtlas::Glyph* GlyphAtlas::get(Typeface *tf, GlyphID glyph, float fontSize) {
+		auto &face = _faces[tf];
+		if (!face.typeface)
+			face.typeface = tf;
+		auto key = glyph_key(glyph, fontSize);
+		Glyph *out;
+		if (face.glyphs.get(key, out)) {
+			if (!out->width || out->epoch == _pages[out->page].epoch) {
+				if (out->width)
+					_pages[out->page].lastUse = _frame;
+				return out;
+			}
+			// the page was cleared after packing, fill it again
+		} else {
+			out = &face.glyphs.set(key, Glyph());
+		}
+		if (!fill(tf, glyph, fontSize, out)) {
+			face.glyphs.erase(key);
+			return nullptr;
+		}
+		return out;
+	}
+
+	bool GlyphAtlas::fill(Typeface *tf, GlyphID glyph, float fontSize, Glyph *out) {
+		auto img = tf->getGlyphImage(glyph, fontSize);
+		auto pix = img.image->pixel(0);
+		*out = Glyph();
+		out->advance = tf->getGlyphMetrics(glyph, fontSize).fAdvanceX;
+		out->scale = 1;
+		if (!pix || !pix->width() || !pix->height())
+			return true; // blank glyph, only advance
+
+		auto type = pix->type();
+		if (type != kAlpha_8_ColorType && type != kRGBA_8888_ColorType)
+			return false;
+		int bpp = type == kAlpha_8_ColorType ? 1: 4;
+		int w = pix->width(), h = pix->height();
+		int rowbytes = pix->rowbytes();
+		auto src = pix->val();
+		auto alpha = [&](int x, int y) {
+			return src[y * rowbytes + x * bpp + bpp - 1];
+		};
+
+		// trim transparent padding to the ink bounds
+		int l = w, t = h, r = -1, b = -1;
+		for (int y = 0; y < h; y++) {
+			for (int x = 0; x < w; x++) {
+				if (alpha(x, y)) {
+					l = Qk_Min(l, x); r = Qk_Max(r, x);
+					t = Qk_Min(t, y); b = Qk_Max(b, y);
+				}
+			}
+		}
+		if (r < l)
+			return true; // no ink
+
+		// keep one transparent texel around the ink for linear sampling
+		int iw = r - l + 1, ih = b - t + 1;
+		if (!alloc(iw + 2, ih + 2, out))
+			return false;
+		auto &page = _pages[out->page];
+		auto dst = page.pixel.val();
+		auto pageRow = page.pixel.rowbytes();
+		auto hasColors = img.hasColors;
+
+		for (int y = 0; y < ih; y++) {
+			auto d = dst + (out->y + 1 + y) * pageRow + (out->x + 1) * 4;
+			auto s = src + (t + y) * rowbytes + l * bpp;
+			for (int x = 0; x < iw; x++, d += 4, s += bpp) {
+				if (hasColors) {
+					d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = s[3]; // premultiplied color
+				} else {
+					d[0] = d[1] = d[2] = d[3] = s[bpp - 1]; // white coverage
+				}
+			}
+		}
+		auto &d = page.dirty; // join the area of glyph
+		if (d.isEmpty()) {
+			d = {{out->x, out->y}, {out->x + out->width, out->y + out->height}};
+		} else {
+			d.begin = {Qk_Min(d.begin[0], int(out->x)), Qk_Min(d.begin[1], int(out->y))};
+			d.end = {Qk_Max(d.end[0], out->x + out->width), Qk_Max(d.end[1], out->y + out->height)};
+		}
+		out->bearing = Vec2(l - 1 - img.left, t - 1 - img.top);
+		out->scale = img.scale;
+		out->hasColors = hasColors;
+		return true;
+	}
+
+	bool GlyphAtlas::alloc(uint32_t w, uint32_t h, Glyph *out) {
+		if (w > _pageSize / 4 || h > _pageSize / 4)
+			return false; // large glyphs would exhaust pages quickly, draw them directly
+		for (uint32_t i = 0; i < _pages.length(); i++) {
+			if (allocInPage(i, w, h, out))
+				return true;
+		}
+		if (_pages.length() < _maxPages) {
+			PixelInfo info(_pageSize, _pageSize, kRGBA_8888_ColorType, kPremul_AlphaType);
+			Buffer buf(info.bytes());
+			memset(*buf, 0, buf.length());
+			_pages.push({Pixel(info, std::move(buf)), nullptr, 0, 0, 0, _frame, 0, {}, true});
+			return allocInPage(_pages.length() - 1, w, h, out);
+		}
+		// evict the least recently drawn page, except those drawn by the current frame
+		int lru = -1;
+		for (uint32_t i = 0; i < _pages.length(); i++) {
+			if (_pages[i].lastUse != _frame &&
+				(lru == -1 || _pages[i].lastUse < _pages[lru].lastUse)) {
+				lru = i;
+			}
+		}
+		if (lru == -1)
+			return false;
+		clearPage(lru);
+		return allocInPage(lru, w, h, out);
+	}
+
+	bool GlyphAtlas::allocInPage(uint32_t index, uint32_t w, uint32_t h, Glyph *out) {
+		auto &page = _pages[index];
+		if (page.shelfX + w > _pageSize) { // next shelf
+			page.shelfY += page.shelfH;
+			page.shelfX = 0;
+			page.shelfH = 0;
+		}
+		if (page.shelfY + h > _pageSize)
+			return false;
+		out->page = index;
+		out->x = page.shelfX;
+		out->y = page.shelfY;
+		out->width = w;
+		out->height = h;
+		out->epoch = page.epoch;
+		page.shelfX += w;
+		page.shelfH = Qk_Max(page.shelfH, h);
+		page.lastUse = _frame;
+		return true;
+	}
+
+	void GlyphAtlas::clearPage(uint32_t index) {
+		auto &page = _pages[index];
+		memset(page.pixel.val(), 0, page.pixel.length());
+		page.shelfX = page.shelfY = page.shelfH = 0;
+		page.epoch++; // entries packed before are now stale
+		page.dirty = {};
+		page.cleared = true;
+		_prune = true;
+	}
+
+	void GlyphAtlas::prune() {
+		for (auto face = _faces.begin(); face != _faces.end(); ) {
+			auto &glyphs = face->second.glyphs;
+			uint32_t inked = 0;
+			for (auto it = glyphs.begin(); it != glyphs.end(); ) {
+				auto &g = it->second;
+				if (g.width && g.epoch != _pages[g.page].epoch) {
+					it = glyphs.erase(it); // stale, its page was cleared
+				} else {
+					inked += g.width ? 1: 0;
+					it++;
+				}
+			}
+			if (inked) {
+				face++;
+			} else { // only blank glyphs, release the typeface
+				face = _faces.erase(face);
+			}
+		}
+		_prune = false;
+	}
+
+	ImageSource* GlyphAtlas::pageImage(uint32_t index, RenderResource *res) {
+		auto &page = _pages[index];
+		if (page.cleared) {
+			// recorded commands retain the old version, publish a copy as the new one
+			page.image = ImageSource::Make(Pixel(page.pixel));
+			page.image->set_mipmap(false);
+			page.cleared = false;
+			page.dirty = {};
+		}
+		else if (!page.dirty.isEmpty()) {
+			auto &d = page.dirty;
+			IRect rect{d.begin, d.end - d.begin};
+			// only upload the area of new glyphs into the current texture
+			if (!page.image->updateTexture(page.pixel, rect, res)) {
+				// not texture yet or not supported by backend
+				page.image = ImageSource::Make(Pixel(page.pixel));
+				page.image->set_mipmap(false);
+			}
+			page.dirty = {};
+		}
+		return page.image.get();
+	}
+
+	void GlyphAtlas::nextFrame() {
+		if (_prune)
+			prune();
+		_frame++;
+	}
+
+}
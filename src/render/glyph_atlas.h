@@ -0,0 +1,127 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+// @private head
+
+#ifndef __quark__render__glyph_atlas__
+#define __quark__render__glyph_atlas__
+
+#include "./font/typeface.h"
+#include "./source.h"
+#include "../util/dict.h"
+
+namespace qk {
+
+	/**
+	 * @class GlyphAtlas
+	 * Canvas glyph image cache.
+	 *
+	 * GlyphAtlas rasterizes every glyph once per (typeface, glyph, font size) and
+	 * packs it into shared premultiplied RGBA pages with a shelf allocator, so text
+	 * draws become a batch of textured quads instead of a freshly rasterized image
+	 * for each text blob. Ordinary glyphs are stored as white coverage and color
+	 * glyphs keep their intrinsic colors.
+	 *
+	 * Pages keep a CPU copy of their pixels. New glyphs are only packed into unused
+	 * texels, so the dirty area of a page is uploaded into its current texture the
+	 * next time it is drawn. When all pages are full, the least recently drawn page
+	 * that has not been used by the current frame is cleared and reused, a cleared
+	 * page is published as a new ImageSource version, because the commands already
+	 * recorded still sample its previous texels. The glyphs of cleared pages and the
+	 * faces left without glyphs are pruned by nextFrame().
+	 *
+	 * @thread Rt, owned by one canvas
+	 */
+	class GlyphAtlas: public Object {
+		Qk_DISABLE_COPY(GlyphAtlas);
+	public:
+		struct Glyph {
+			uint16_t page;        ///< Page index, only valid when width and height are non-zero.
+			uint16_t x, y;        ///< Top-left position in page pixels.
+			uint16_t width, height; ///< Size in page pixels, zero for blank glyphs.
+			Vec2     bearing;     ///< Pen position to the top-left of the image, in image pixels.
+			float    scale;       ///< Image pixels per font size unit, see TextImage::scale.
+			float    advance;     ///< Advance of the glyph in font size units.
+			uint32_t epoch;       ///< Page epoch the glyph was packed into.
+			bool     hasColors;   ///< Color glyph, draw with text opacity only.
+		};
+
+		GlyphAtlas(uint32_t pageSize = 512, uint32_t maxPages = 8);
+
+		/**
+		 * Get the atlas entry of glyph, rasterize and pack it when not cached yet.
+		 * The entry also marks its page as used by the current frame.
+		 * @return {const Glyph*} null if the glyph is too large or the atlas cannot evict a page
+		 */
+		const Glyph* get(Typeface *tf, GlyphID glyph, float fontSize);
+
+		/**
+		 * Get the current texture of page, publishing its pending glyphs first
+		 * @param res {RenderResource*} the render resource of caller, see ImageSource::markAsTexture()
+		 */
+		ImageSource* pageImage(uint32_t page, RenderResource *res = nullptr);
+
+		/**
+		 * Advance the frame counter, called by the canvas when swapping buffers,
+		 * prune the glyphs and faces of the pages cleared by the last frame
+		 */
+		void nextFrame();
+
+		inline uint32_t pageSize() const { return _pageSize; }
+		inline uint32_t faces() const { return _faces.length(); }
+
+	private:
+		struct Page {
+			Pixel    pixel;  // CPU copy of page pixels
+			Sp<ImageSource> image; // current published version
+			uint16_t shelfY, shelfX, shelfH; // shelf allocator cursor
+			uint32_t lastUse; // last frame that drew the page
+			uint32_t epoch; // incremented each time the page is cleared
+			IRange   dirty; // area of new glyphs to upload, empty if none
+			bool     cleared; // cleared after publish, publish a new version
+		};
+		typedef Dict<uint64_t, Glyph> Glyphs; // key(fontSize bits << 32 | glyph)
+		struct Face {
+			Sp<Typeface> typeface; // keep typeface pointer valid as key
+			Glyphs       glyphs;
+		};
+		bool alloc(uint32_t w, uint32_t h, Glyph *out);
+		bool allocInPage(uint32_t index, uint32_t w, uint32_t h, Glyph *out);
+		void clearPage(uint32_t index);
+		void prune();
+		bool fill(Typeface *tf, GlyphID glyph, float fontSize, Glyph *out);
+		uint32_t _pageSize, _maxPages, _frame;
+		bool     _prune; // any page was cleared, prune at next frame
+		Array<Page> _pages;
+		Dict<Typeface*, Face> _faces;
+	};
+
+}
+#endif
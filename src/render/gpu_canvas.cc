@@ -135,10 +135,91 @@ namespace qk {
 					right_bottom, left_bottom, // triangle 1 /|
 				}, &_alloc}};
 				drawImageCmd(vertex, info);
+				_drawCalls++;
 			}
 			return scale_1;
 		}
 
+		bool drawTextBlobAtlas(TextBlob *blob, Vec2 origin, float scale, float fixedFSize, const Paint &paint) {
+			auto tf = blob->typeface.get();
+			auto count = blob->glyphs.length();
+			auto offset = blob->offset.length() >= count ? blob->offset.val(): nullptr;
+			Array<GlyphAtlas::Glyph> glyphs(&_frameAlloc);
+			glyphs.extend(count);
+			uint32_t pages = 0;
+
+			for (uint32_t i = 0; i < count; i++) {
+				auto g = _glyphAtlas->get(tf, blob->glyphs[i], fixedFSize);
+				if (!g)
+					return false; // atlas full or glyph too large, draw as run image
+				glyphs[i] = *g; // copy, entries may move when the atlas grows
+				if (g->width)
+					pages = Qk_Max(pages, g->page + 1u);
+			}
+
+			auto scale_1 = 1.0f / scale;
+			auto pageSize_1 = 1.0f / _glyphAtlas->pageSize();
+			Color maskColor = paint.fill.color.to_color();
+			Color tintColor = Color4f(1, 1, 1, paint.fill.color.a()).to_color();
+			Array<V3F_T2F_C4B_C4B> verts(&_frameAlloc);
+			Array<uint16_t> indices(&_frameAlloc);
+			PaintImage p;
+			p.mipmapMode = PaintImage::kNone_MipmapMode;
+			p.filterMode = PaintImage::kLinear_FilterMode;
+
+			auto flush = [&](uint32_t page) {
+				if (!verts.length())
+					return;
+				auto size = Vec2(_glyphAtlas->pageSize());
+				p.setImage(_glyphAtlas->pageImage(page, _render), {Vec2(0), size});
+				Triangles triangles{verts.val(), indices.val(), verts.length(), indices.length()};
+				drawTrianglesCmd(triangles, &p, Color4f(1, 1, 1, 1), true);
+				_drawCalls++;
+				verts.reset(0); // keep the buffers for the next page
+				indices.reset(0);
+			};
+
+			setBlendMode(paint.blendMode); // switch blend mode
+			flushCAPABatch();
+
+			// one batch of quads per atlas page, usually a single draw for the whole run
+			for (uint32_t page = 0; page < pages; page++) {
+				Vec2 pen = origin;
+				for (uint32_t i = 0; i < count; i++) {
+					auto &g = glyphs[i];
+					if (offset)
+						pen = origin + offset[i];
+					if (g.width && g.page == page) {
+						auto s = scale_1 / g.scale;
+						Vec2 start = pen + g.bearing * s;
+						if (_axisAlignedTransform) { // same pixel snapping as drawTextImage
+							Vec2 devicePos = (_state->matrix * start) * _surfaceScale;
+							Vec2 deviceScale = _surfaceScale * _state->matrix.getScaling();
+							start += (devicePos.round() - devicePos) / deviceScale;
+						}
+						Vec2 end = start + Vec2(g.width, g.height) * s;
+						float u0 = g.x * pageSize_1, v0 = g.y * pageSize_1;
+						float u1 = (g.x + g.width) * pageSize_1, v1 = (g.y + g.height) * pageSize_1;
+						auto color = g.hasColors ? tintColor: maskColor;
+						uint16_t idx = verts.length();
+						verts.push({Vec3(start.x(), start.y(), 0), Vec2(u0, v0), color, Color()});
+						verts.push({Vec3(end.x(), start.y(), 0), Vec2(u1, v0), color, Color()});
+						verts.push({Vec3(start.x(), end.y(), 0), Vec2(u0, v1), color, Color()});
+						verts.push({Vec3(end.x(), end.y(), 0), Vec2(u1, v1), color, Color()});
+						uint16_t quad[] = {
+							idx, uint16_t(idx + 1), uint16_t(idx + 2),
+							uint16_t(idx + 1), uint16_t(idx + 3), uint16_t(idx + 2)};
+						indices.write(quad, 6);
+						if (verts.length() > 0xFFFF - 4)
+							flush(page); // uint16 indices
+					}
+					pen.set_x(pen.x() + g.advance * scale_1);
+				}
+				flush(page);
+			}
+			return true;
+		}
+
 		void fillPathAASide(const VertexData& vertex, const Paint &paint, const PaintStyle& style) {
 			if (!vertex.vCount)
 				return;
@@ -153,6 +234,7 @@ namespace qk {
 			} else {
 				drawColorCmd(vertex, style.color);
 			}
+			_drawCalls++;
 		}
 
 		void fillPathColor(const Path &path, const Color4f &color, float aaRadius, bool aa) {
@@ -163,6 +245,7 @@ namespace qk {
 			if (!vertex.vCount)
 				return;
 			drawColorCmd(vertex, color);
+			_drawCalls++;
 		}
 
 		void strokePath(const Path &path, const Paint& paint, float aaRadius, bool useCapa) {
@@ -284,7 +367,7 @@ namespace qk {
 	//---------------------------------------------------------------------
 
 	GPUCanvas::GPUCanvas(Render *render, Render::Options opts)
-		: _state(nullptr), _cache(nullptr), _render(render)
+		: _state(nullptr), _cache(nullptr), _glyphAtlas(nullptr), _render(render)
 		, _surfaceSize(), _surfaceScale(1)
 		, _size(), _scale(1)
 		, _surfaceScaleAverage(1), _scaleAverage(1), _allScaleAverage(1)
@@ -302,6 +385,7 @@ namespace qk {
 		, _axisAlignedTransform(true)
 	{
 		_cache = new PathvCache(opts.maxCapacityForPathvCache, render);
+		_glyphAtlas = new GlyphAtlas();
 		_stateStack.push({ .matrix=Mat() });
 		_state = &_stateStack.back();
 	}
@@ -309,6 +393,7 @@ namespace qk {
 	GPUCanvas::~GPUCanvas() {
 		_texPools.clear();
 		Releasep(_cache);
+		Releasep(_glyphAtlas);
 		_capaBuilder = nullptr;
 	}
 
@@ -346,6 +431,10 @@ namespace qk {
 		return _cache;
 	}
 
+	Allocator* GPUCanvas::frameAllocator() {
+		return &_frameAlloc;
+	}
+
 	Vec2 GPUCanvas::size() const {
 		return _size;
 	}
@@ -510,6 +599,7 @@ namespace qk {
 		} else {
 			drawClipCmd(_cache->getPathTriangles(path), lastClip, clip, rawOp);
 		}
+		_drawCalls++;
 		_state->clip = clip;
 		_clipState = clip; // set current clip state
 		_flags |= Qk_FLAG_CLIP; // set clip flag
@@ -531,6 +621,7 @@ namespace qk {
 			{0,0,0}, {_size[0],0,0}, {_size[0],_size[1],0}, // triangle 1
 			{_size[0],_size[1],0}, {0,_size[1],0}, { 0,0,0 } // triangle 2
 		}}, color);
+		_drawCalls++;
 	}
 
 	void GPUCanvas::drawRRectBlurColor(const RRect& rrect, float blur, const Color4f &color,
@@ -541,6 +632,7 @@ namespace qk {
 		_this->setBlendMode(mode); // switch blend mode
 		_this->flushCAPABatch();
 		drawRRectBlurColorCmd(rrect, blur, color, clip, mode);
+		_drawCalls++;
 	}
 
 	void GPUCanvas::drawPathColor(const Path& path, const Color4f &color, BlendMode mode, bool antiAlias) {
@@ -580,7 +672,7 @@ namespace qk {
 	}
 
 	float GPUCanvas::drawGlyphs(const FontGlyphs &glyphs, Vec2 origin, cArray<Vec2> *offsetIn, const Paint &paint) {
-		Array<Vec2> offset, *offsetP = nullptr;
+		Array<Vec2> offset(&_frameAlloc), *offsetP = nullptr;
 		if (offsetIn) {
 			offset = *offsetIn;
 			offsetP = &offset;
@@ -606,10 +698,17 @@ namespace qk {
 		auto scale = fixedFSize / fontSize; // scale from original font size to fixed font size
 		auto needSDF = paint.style != Paint::kFill_Style;
 
+		// Plain filled text draws from the glyph atlas, SDF strokes, filters and the CAPA
+		// batch keep using the rasterized image of whole blob
+		if (!needSDF && !paint.filter && !_capaEnabled &&
+			_this->drawTextBlobAtlas(blob, origin, scale, fixedFSize, paint)) {
+			return;
+		}
+
 		if (blob->img.fontSize != fixedFSize || !blob->img.image ||
 			(needSDF ? !blob->img.hasColors && !_this->isSDFImage(blob->img.image.get()): false)
 		) { // fill text bolb
-			Array<Vec2> offset;
+			Array<Vec2> offset(&_frameAlloc);
 			if (blob->offset.length() >= blob->glyphs.length()) {
 				offset = blob->offset;
 				for (auto &o: offset) o *= scale;
@@ -632,6 +731,7 @@ namespace qk {
 		_this->setBlendMode(paint.blendMode); // switch blend mode
 		_this->flushCAPABatch(); // flush current CAPA batch before draw triangles
 		drawTrianglesCmd(triangles, paint.fill.image, paint.fill.color, copyData);
+		_drawCalls++;
 	}
 
 	Sp<ImageSource> GPUCanvas::readImage(const Rect &src, Vec2 dst, ColorType type, BlendMode mode, bool mipmap) {
@@ -695,6 +795,7 @@ namespace qk {
 		if (_capaBuilder)
 			_capaBuilder->reset();
 		_alloc.clear();
+		_frameAlloc.clear();
 
 		Qk_DLog("setSurface: %f, %f, scale: %f, %f",
 			_surfaceSize.x(), _surfaceSize.y(), _surfaceScale.x(), _surfaceScale.y());
@@ -36,6 +36,7 @@
 #include "./render.h"
 #include "./canvas.h"
 #include "./capa.h"
+#include "./glyph_atlas.h"
 
 #define Qk_CLIP(clip) (clip ? Qk_FLAG_CLIP: 0)
 // global flags from 1u << 0 to 1u << 15, 0x0000FFFF
@@ -131,6 +132,7 @@ namespace qk {
 		Sp<ImageSource> readImage(const Rect &src, Vec2 dst, ColorType type, BlendMode mode, bool mipmap) override;
 		Sp<ImageSource> outputImage(ImageSource* dst, bool mipmap) override;
 		PathvCache* getPathvCache() override;
+		Allocator* frameAllocator() override;
 		void setSurface(const Mat4& root, Vec2 surfaceSize, Vec2 surfaceScale) override;
 		Vec2 surfaceSize() const override;
 		const Render::Options& opts() const { return _opts; }
@@ -169,6 +171,7 @@ namespace qk {
 		Array<GC_State> _stateStack; // state
 		GC_State    *_state; // state pointer
 		PathvCache *_cache;
+		GlyphAtlas *_glyphAtlas; // glyph images shared by all text draws
 		Render 	 *_render; // render backend
 		Vec2  _surfaceSize, _surfaceScale; // surface scale and size, surfaceSize = surfaceScale * size
 		Vec2   _size, _scale; // size=surfaceSize/surfaceScale, _scale = matrix scale extracted
@@ -185,7 +188,8 @@ namespace qk {
 		// texture pool, key(w << 40 | h << 8 | colorType << 1 | mipmap),
 		// value is texture handle and ref count
 		Dict<uint64_t, Array<Sp<ImageSource>>> _texPools;
-		LinearAllocator _alloc; // linear allocator for Canvas
+		LinearAllocator _alloc; // linear allocator for Canvas, also rewound by every CAPA batch
+		LinearAllocator _frameAlloc; // frame-local temporary data, rewound only by swapBuffer()
 		Sp<CAPABuilder> _capaBuilder; // compute shader batch builder for CAPA
 		uint32_t _capaMaxImageCount; // backend CAPA image/sampler table size
 		bool _capaEnabled; // true if CAPA is enabled, false if disabled
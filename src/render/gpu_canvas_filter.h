@@ -101,6 +101,7 @@ namespace qk {
 			}
 			_host->_flags = _flags; // restore flags before blur filter
 			_host->blurFilterEndCmd(_bounds, _rootMatrix, _radius, _clearPad, _sample, _imageLod, *_tmpA, *_tmpB);
+			_host->_drawCalls++;
 		}
 
 	private:
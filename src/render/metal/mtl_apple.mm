@@ -131,6 +131,7 @@ public:
 		setDefaultTarget(drawable);
 
 		if (_delegate->onRenderBackendDisplay() && _mtlcanvas->isRecorded()) {
+			Canvas::SubmitScope submit(_mtlcanvas); // profile submit time
 			auto cmds = _mtlcanvas->flushBuffer();
 			if (cmds.length()) {
 				// _mtlcanvas->vportCopy(cmds.back(), drawable);
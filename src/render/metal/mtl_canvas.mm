@@ -223,6 +223,7 @@ namespace qk {
 	bool MetalCanvas::swapBuffer() {
 		flushCAPABatch(); // flush CAPA data
 		_alloc.reset();
+		_frameAlloc.reset();
 		endPass(); // end current pass to ensure all commands are encoded before swap
 		ScopeLock lock(_mutex);
 		bool canSwap = _cmdPackFront.current == nil;
@@ -231,6 +232,7 @@ namespace qk {
 			std::swap(_cmdPackFront, _cmdPack); // swap cmd buffer and pass descriptor to front
 		}
 		clear_PathvCache(_cache, 0); // tag: clear mark
+		_glyphAtlas->nextFrame();
 		// reset cmd pack for next frame
 		_cmdPack = {
 			.allocator = std::move(_cmdPack.allocator), // move buffer allocator to new cmd pack
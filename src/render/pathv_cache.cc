@@ -31,6 +31,7 @@
 #include "./pathv_cache.h"
 #include "./render.h"
 #include "../os/os.h"
+#include <algorithm>
 
 namespace qk {
 
@@ -46,7 +47,7 @@ namespace qk {
 	}
 
 	PathvCache::PathvCache(uint32_t maxCapacity, Render *render)
-		: _render(render), _capacity(0)
+		: _render(render), _capacity(0), _hits(0), _misses(0), _evictions(0), _frame(0)
 		, _maxCapacity(uint32_t(U64::clamp(
 			maxCapacity ? maxCapacity: os_memory() >> 8, // 2GB:8MB, 4GB:16MB, 8GB:32MB
 			uint64_t(8 * 1024 * 1024), uint64_t(128 * 1024 * 1024))))
@@ -59,12 +60,12 @@ namespace qk {
 	const Path& PathvCache::getNormalizedPath(const Path &path) {
 		if (path.isNormalized()) return path;
 		auto key = path.hashCode();
-		Path *const *out;
-		if (_normalizedPath.get(key, out)) return **out;
+		Entry<Path*> *out;
+		if (_normalizedPath.get(key, out)) return *use(out);
+		_misses++;
 		auto p = new Path(Path(path).normalizedPath(1));
-		_capacity += p->sizeOf();
 		Qk_ASSERT(p->isNormalized());
-		return *_normalizedPath.set(key, p);
+		return *add(_normalizedPath, key, p, p->sizeOf());
 	}
 
 	const Path& PathvCache::getStrokePath(
@@ -74,13 +75,13 @@ namespace qk {
 		hash.updateu64(((*(int64_t*)&width) << 32) | *(int32_t*)&miterLimit);
 		hash.updateu32((cap << 2) | join);
 		auto key = hash.hashCode();
-		Path *const*out;
+		Entry<Path*> *out;
 		if (_strokePath.get(key, out))
-			return **out;
+			return *use(out);
+		_misses++;
 		auto stroke = path.strokePath(width,cap,join,miterLimit);
 		auto p = new Path(stroke.isNormalized() ? std::move(stroke): stroke.normalizedPath(1));
-		_capacity += p->sizeOf();
-		return *_strokePath.set(key, p);
+		return *add(_strokePath, key, p, p->sizeOf());
 	}
 
 	const Path& PathvCache::getStrokePath(const Rect &rect,
@@ -91,14 +92,14 @@ namespace qk {
 
 	const VertexData& PathvCache::getPathTriangles(const Path &path) {
 		auto hash = path.hashCode();
-		Wrap<VertexData> *const*out;
+		Entry<Wrap<VertexData>*> *out;
 		if (_pathTriangles.get(hash, out))
-			return (*out)->base;
+			return use(out)->base;
+		_misses++;
 		auto gb = new Wrap<VertexData>{path.getTriangles(1),{{this,0,0}}};
 		gb->base.id = gb->id;
 		gb->id->data = &gb->base;
-		_capacity += gb->base.vCount * sizeof(Vec3);
-		return _pathTriangles.set(hash, gb)->base;
+		return add(_pathTriangles, hash, gb, gb->base.vCount * sizeof(Vec3))->base;
 	}
 
 	const VertexData& PathvCache::getAASideTriangles(const Path &path, float radius, bool onlyAASide) {
@@ -106,14 +107,14 @@ namespace qk {
 		float floatBits[2] = {radius, static_cast<float>(onlyAASide)};
 		hash.update2f(floatBits);
 		auto key = hash.hashCode();
-		Wrap<VertexData> *const *out;
+		Entry<Wrap<VertexData>*> *out;
 		if (_aaSideTriangle.get(key, out))
-			return (*out)->base;
+			return use(out)->base;
+		_misses++;
 		auto gb = new Wrap<VertexData>{path.getAASideTriangles(radius, 1, onlyAASide),{{this,0,0}}};
 		gb->base.id = gb->id;
 		gb->id->data = &gb->base;
-		_capacity += gb->base.vCount * sizeof(Vec3);
-		return _aaSideTriangle.set(key, gb)->base;
+		return add(_aaSideTriangle, key, gb, gb->base.vCount * sizeof(Vec3))->base;
 	}
 
 	const VertexData& PathvCache::getPathTriangles(const Rect &rect) {
@@ -123,8 +124,7 @@ namespace qk {
 
 	const RectPath& PathvCache::setRRectPathFromHash(uint64_t hash, RectPath&& rect) {
 		auto gb = new Wrap<RectPath>{std::move(rect),{{this,0,0}}};
-		_capacity += gb->base.sizeOf();
-		return _rectPath.set(hash, gb)->base;
+		return add(_rectPath, hash, gb, gb->base.sizeOf())->base;
 	}
 
 	const RectPath& PathvCache::getRRectPath(const Rect &rect, const Path::BorderRadius &radius) {
@@ -133,9 +133,10 @@ namespace qk {
 		hash.update4f(radius.leftTop.val);
 		hash.update4f(radius.rightBottom.val);
 		hash.updateu32(1); // flag for border radius
-		Wrap<RectPath> *const *out;
+		Entry<Wrap<RectPath>*> *out;
 		if (_rectPath.get(hash.hashCode(), out))
-			return (*out)->base;
+			return use(out)->base;
+		_misses++;
 		return setRRectPathFromHash(hash.hashCode(), RectPath::MakeRRect(rect, radius));
 	}
 
@@ -154,10 +155,11 @@ namespace qk {
 		if (border)
 			hash.update4f(border);
 		auto key = hash.hashCode();
-		Wrap<RectPath> *const *out;
+		Entry<Wrap<RectPath>*> *out;
 		if (_rectPath.get(key, out)) {
-			return (*out)->base;
+			return use(out)->base;
 		}
+		_misses++;
 		if (border && is_not_Zero(border)) {
 			auto newRect = rect;
 			auto limit = std::min(newRect.size.x() * 0.5f, newRect.size.y() * 0.5f);
@@ -191,11 +193,11 @@ namespace qk {
 
 	const RectOutlinePath& PathvCache::setRRectOutlinePathFromHash(uint64_t hash, RectOutlinePath&& outline) {
 		auto gb = new Wrap<RectOutlinePath,4>{std::move(outline),{{this,0,0},{this,0,0},{this,0,0},{this,0,0}}};
-		_capacity +=
+		auto size =
 			gb->base.top.sizeOf() +
 			gb->base.right.sizeOf() +
 			gb->base.bottom.sizeOf() + gb->base.left.sizeOf();
-		return _rectOutlinePath.set(hash, gb)->base;
+		return add(_rectOutlinePath, hash, gb, size)->base;
 	}
 
 	const RectOutlinePath& PathvCache::getRectOutlinePath(const Rect &rect, const float border[4]) {
@@ -208,10 +210,11 @@ namespace qk {
 		hash.update4f(border);
 		if (radius)
 			hash.update4f(radius);
-		Wrap<RectOutlinePath,4> *const *out;
+		Entry<Wrap<RectOutlinePath,4>*> *out;
 		if (_rectOutlinePath.get(hash.hashCode(), out)) {
-			return (*out)->base;
+			return use(out)->base;
 		}
+		_misses++;
 		if (radius && is_not_Zero(radius)) {
 			// Vec2 shrink = rect.size * 0.01;
 			// Rect _rect{
@@ -233,19 +236,31 @@ namespace qk {
 		Hash hash = path.hash();
 		hash.update1f(precision);
 		auto key = hash.hashCode();
-		PathEdgeInfo const *out;
+		Entry<PathEdgeInfo> *out;
 		if (_edgeInfo.get(key, out))
-			return *out;
+			return use(out);
+		_misses++;
 		auto info = path.getEdgeInfo(precision);
-		_capacity += info.edges.size() + sizeof(info.bounds) + sizeof(info.totalEdgeLength);
-		return _edgeInfo.set(key, std::move(info));
+		auto size = info.edges.size() + sizeof(info.bounds) + sizeof(info.totalEdgeLength);
+		return add(_edgeInfo, key, std::move(info), size);
+	}
+
+	template<class T, int N>
+	static void deleteWrap(RenderBackend *render, PathvCache::Wrap<T,N> *wrap) {
+		if (render) {
+			for (int i = 0; i < N; i++)
+				render->unloadVertexData(wrap->id + i);
+		}
+		delete wrap;
 	}
 
 	void PathvCache::clear(int flags) {
 		if (flags == 0) {
 			if (_capacity > _maxCapacity) { // max limit clear
-				clearPart(_capacity - _maxCapacity);
+				// free a little more than the excess, so it does not evict again in the next frames
+				clearPart(_capacity - _maxCapacity + (_maxCapacity >> 4));
 			}
+			_frame++; // next frame
 		} else if (flags == 1) { // memory warning, clean half or clean to max limit
 			clearPart(I32::max(_capacity * 0.5, _capacity - _maxCapacity));
 		} else { // clear all
@@ -254,13 +269,78 @@ namespace qk {
 	}
 
 	void PathvCache::clearPart(uint32_t capacity) {
-		clearAll(false); // TODO: Not yet realized
+		enum Kind { kNormalized, kStroke, kTriangles, kAASide, kRect, kOutline, kEdgeInfo };
+		struct Victim {
+			uint32_t use, size;
+			Kind     kind;
+			uint64_t key;
+		};
+		Array<Victim> victims;
+		auto collect = [&](auto &dict, Kind kind) {
+			for (auto &i: dict) {
+				if (i.second.use != _frame) // keep the entries referenced by the current frame
+					victims.push({i.second.use, i.second.size, kind, i.first});
+			}
+		};
+		collect(_normalizedPath, kNormalized);
+		collect(_strokePath, kStroke);
+		collect(_pathTriangles, kTriangles);
+		collect(_aaSideTriangle, kAASide);
+		collect(_rectPath, kRect);
+		collect(_rectOutlinePath, kOutline);
+		collect(_edgeInfo, kEdgeInfo);
+
+		// least recently used first, and the larger first in the same frame
+		std::sort(victims.val(), victims.val() + victims.length(), [](const Victim &a, const Victim &b) {
+			return a.use < b.use || (a.use == b.use && a.size > b.size);
+		});
+
+		struct Wraps {
+			Array<Wrap<VertexData>*> triangles;
+			Array<Wrap<RectPath>*> rect;
+			Array<Wrap<RectOutlinePath,4>*> outline;
+		} *wraps = new Wraps;
+		uint32_t freed = 0;
+
+		for (auto &v: victims) {
+			if (freed >= capacity)
+				break;
+			switch (v.kind) {
+				case kNormalized: Release(_normalizedPath[v.key].value); _normalizedPath.erase(v.key); break;
+				case kStroke: Release(_strokePath[v.key].value); _strokePath.erase(v.key); break;
+				case kTriangles: wraps->triangles.push(_pathTriangles[v.key].value); _pathTriangles.erase(v.key); break;
+				case kAASide: wraps->triangles.push(_aaSideTriangle[v.key].value); _aaSideTriangle.erase(v.key); break;
+				case kRect: wraps->rect.push(_rectPath[v.key].value); _rectPath.erase(v.key); break;
+				case kOutline: wraps->outline.push(_rectOutlinePath[v.key].value); _rectOutlinePath.erase(v.key); break;
+				case kEdgeInfo: _edgeInfo.erase(v.key); break;
+			}
+			freed += v.size;
+			_evictions++;
+		}
+		_capacity -= Qk_Min(freed, _capacity);
+
+		// Must be called after rendering is complete
+		Cb exec([render=_render,wraps](auto &e) {
+			for (auto i: wraps->triangles)
+				deleteWrap(render, i);
+			for (auto i: wraps->rect)
+				deleteWrap(render, i);
+			for (auto i: wraps->outline)
+				deleteWrap(render, i);
+			delete wraps;
+		});
+
+		if (_render) {
+			add_delay_task_for_app(exec, false);
+		} else {
+			exec->resolve(); // no render backend, no pending draw commands
+		}
 	}
 
 	void PathvCache::clearAll(bool destroy) {
 		for (auto &it: {&_normalizedPath, &_strokePath}) {
 			for (auto &i: *it)
-				Release(i.second);
+				Release(i.second.value);
 			it->clear();
 		}
 		_capacity = 0;
@@ -269,16 +349,16 @@ namespace qk {
 		// If the render backend is not available, directly clear the cache data and return
 		if (!_render) {
 			for (auto &i: _pathTriangles) {
-				delete i.second;
+				delete i.second.value;
 			}
 			for (auto &i: _aaSideTriangle) {
-				delete i.second;
+				delete i.second.value;
 			}
 			for (auto &i: _rectPath) {
-				delete i.second;
+				delete i.second.value;
 			}
 			for (auto &i: _rectOutlinePath) {
-				delete i.second;
+				delete i.second.value;
 			}
 			_pathTriangles.clear();
 			_aaSideTriangle.clear();
@@ -287,32 +367,21 @@ namespace qk {
 			return; // No render backend, skip GPU resource deletion
 		}
 
-		auto a0 = new Dict<uint64_t, Wrap<VertexData>*>(std::move(_pathTriangles));
-		auto a1 = new Dict<uint64_t, Wrap<VertexData>*>(std::move(_aaSideTriangle));
-		auto b = new Dict<uint64_t, Wrap<RectPath>*>(std::move(_rectPath));
-		auto c = new Dict<uint64_t, Wrap<RectOutlinePath,4>*>(std::move(_rectOutlinePath));
+		auto a0 = new Dict<uint64_t, Entry<Wrap<VertexData>*>>(std::move(_pathTriangles));
+		auto a1 = new Dict<uint64_t, Entry<Wrap<VertexData>*>>(std::move(_aaSideTriangle));
+		auto b = new Dict<uint64_t, Entry<Wrap<RectPath>*>>(std::move(_rectPath));
+		auto c = new Dict<uint64_t, Entry<Wrap<RectOutlinePath,4>*>>(std::move(_rectOutlinePath));
 
 		// Must be called after rendering is complete
 		Cb exec([render=_render,a0,a1,b,c](auto &e) {
-			for (auto &i: *a0) {
-				render->unloadVertexData(i.second->id);
-				delete i.second;
-			}
-			for (auto &i: *a1) {
-				render->unloadVertexData(i.second->id);
-				delete i.second;
-			}
-			for (auto &i: *b) {
-				render->unloadVertexData(i.second->id);
-				delete i.second;
-			}
-			for (auto &i: *c) {
-				render->unloadVertexData(i.second->id);
-				render->unloadVertexData(i.second->id+1);
-				render->unloadVertexData(i.second->id+2);
-				render->unloadVertexData(i.second->id+3);
-				delete i.second;
-			}
+			for (auto &i: *a0)
+				deleteWrap(render, i.second.value);
+			for (auto &i: *a1)
+				deleteWrap(render, i.second.value);
+			for (auto &i: *b)
+				deleteWrap(render, i.second.value);
+			for (auto &i: *c)
+				deleteWrap(render, i.second.value);
 			Releasep(a0);
 			Releasep(a1);
 			Releasep(b);
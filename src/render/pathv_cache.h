@@ -92,6 +92,9 @@ namespace qk
 
 		Qk_DEFINE_PROP_GET(uint32_t, capacity, Const); // Used memory capacity
 		Qk_DEFINE_PROP_GET(uint32_t, maxCapacity, Const); // max memory capacity
+		Qk_DEFINE_PROP_GET(uint32_t, hits, Const); // total lookups served from the cache, wraps around
+		Qk_DEFINE_PROP_GET(uint32_t, misses, Const); // total lookups that built new data, wraps around
+		Qk_DEFINE_PROP_GET(uint32_t, evictions, Const); // total entries evicted by the capacity limit, wraps around
 
 		PathvCache(uint32_t maxCapacity, RenderBackend *render);
 		~PathvCache();
@@ -210,14 +213,40 @@ namespace qk
 		 */
 		void clear(int flags = 0);
 		void clearAll(bool destroy);
+		/**
+		 * @dev Evict the least recently used entries until at least `capacity` bytes are freed,
+		 *      the entries used in the current frame are kept
+		*/
 		void clearPart(uint32_t capacity);
+
+		/**
+		 * Cache entry with its memory size and the frame of last use for LRU eviction
+		*/
+		template<class T>
+		struct Entry {
+			T        value;
+			uint32_t size; // memory size counted in capacity
+			uint32_t use;  // frame of last use
+		};
+		template<class T>
+		inline const T& use(Entry<T> *entry) {
+			entry->use = _frame;
+			return _hits++, entry->value;
+		}
+		template<class T>
+		inline T& add(Dict<uint64_t, Entry<T>> &dict, uint64_t key, T value, uint32_t size) {
+			_capacity += size;
+			return dict.set(key, {std::move(value), size, _frame}).value;
+		}
+
 		RenderBackend *_render; // render for GPU cache management
-		Dict<uint64_t, Path*> _normalizedPath, _strokePath; // path hash => path
-		Dict<uint64_t, Wrap<VertexData>*> _pathTriangles; // path hash => triangles
-		Dict<uint64_t, Wrap<VertexData>*> _aaSideTriangle; // path hash => aa side triangles
-		Dict<uint64_t, Wrap<RectPath>*> _rectPath; // rect hash => rect path
-		Dict<uint64_t, Wrap<RectOutlinePath,4>*> _rectOutlinePath; // rect hash => rect outline path
-		Dict<uint64_t, PathEdgeInfo> _edgeInfo; // path hash => edge info
+		uint32_t _frame; // current frame, advanced by every clear(0)
+		Dict<uint64_t, Entry<Path*>> _normalizedPath, _strokePath; // path hash => path
+		Dict<uint64_t, Entry<Wrap<VertexData>*>> _pathTriangles; // path hash => triangles
+		Dict<uint64_t, Entry<Wrap<VertexData>*>> _aaSideTriangle; // path hash => aa side triangles
+		Dict<uint64_t, Entry<Wrap<RectPath>*>> _rectPath; // rect hash => rect path
+		Dict<uint64_t, Entry<Wrap<RectOutlinePath,4>*>> _rectOutlinePath; // rect hash => rect outline path
+		Dict<uint64_t, Entry<PathEdgeInfo>> _edgeInfo; // path hash => edge info
 
 		friend class RenderBackend;
 		friend void clear_PathvCache(PathvCache *cache, int flags);
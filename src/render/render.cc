@@ -48,6 +48,10 @@ namespace qk {
 		return 1;
 	}
 
+	bool RenderResource::uploadTextureRect(Pixel *pix, IRect rect, TexStat *tex, bool mipmap) {
+		return false; // not supported by default
+	}
+
 	Sp<ImageSource> RenderResource::createTexture(Vec2 size, ColorType type, uint8_t flags) {
 		auto src = ImageSource::Make(PixelInfo{(int)size.x(), (int)size.y(), type, kPremul_AlphaType}, nullptr);
 		src->set_mipmap(flags & kMipmap_TextureFlags);
@@ -138,15 +142,29 @@ namespace qk {
 	Render* make_metal_render(Render::Options opts);
 	Render* make_vulkan_render(Render::Options opts);
 	Render* make_gl_render(Render::Options opts);
+	Render* make_soft_render(Render::Options opts);
 
 	// get shared render resource for each backend
 	RenderResource* get_shared_metal_render_resource();
 	RenderResource* get_shared_vulkan_render_resource();
 	RenderResource* get_shared_gl_render_resource();
+	RenderResource* get_shared_soft_render_resource();
+
+	// use cpu soft render, selected by the `soft` run argument
+	static bool useSoftRender() {
+#if Qk_APPLE
+		return false;
+#else
+		static bool useSoft = runArguments && runArguments->options.has("soft");
+		return useSoft;
+#endif
+	}
 
 	// get shared render resource for each platform
 	RenderResource* getSharedRenderResource() {
 		RenderResource* r = nullptr;
+		if (useSoftRender())
+			return get_shared_soft_render_resource();
 #if Qk_ENABLE_GL
 		static bool useGL = runArguments && runArguments->options.has("gl");
 		if (useGL)
@@ -160,6 +178,9 @@ namespace qk {
 #endif
 #if Qk_ENABLE_GL
 		if (!r) r = get_shared_gl_render_resource();
+#endif
+#if !Qk_APPLE
+		if (!r) r = get_shared_soft_render_resource();
 #endif
 		return r;
 	}
@@ -167,6 +188,8 @@ namespace qk {
 	// make render backend for each platform
 	Render* Render::Make(Options opts) {
 		Render* r = nullptr;
+		if (useSoftRender())
+			return make_soft_render(opts);
 #if Qk_ENABLE_GL
 		if (runArguments && runArguments->options.has("gl"))
 			return make_gl_render(opts);
@@ -179,6 +202,9 @@ namespace qk {
 #endif
 #if Qk_ENABLE_GL
 		if (!r) r = make_gl_render(opts);
+#endif
+#if !Qk_APPLE
+		if (!r) r = make_soft_render(opts); // fallback to cpu rendering
 #endif
 		if (!r) {
 			Qk_DLog("No render backend available for this platform");
@@ -83,6 +83,20 @@ namespace qk {
 		 */
 		virtual bool uploadTexture(Pixel *pix, int levels, TexStat *tex, bool mipmap) = 0;
 
+		/**
+		 * Upload pixel data into a sub rectangle of the texture previously uploaded by uploadTexture().
+		 *
+		 * @param pix Source pixel data, the size of pix is the size of rect.
+		 * @param rect Destination rectangle in level 0 texture pixels.
+		 * @param tex Texture state container previously uploaded by uploadTexture().
+		 * @param mipmap Whether the mipmap levels of texture should be regenerated.
+		 * @returns false if the backend does not support it, the caller then uploads the whole texture.
+		 *
+		 * @note The texels outside rect are kept, and the commands recorded before
+		 *       may sample the updated texels when they are executed later.
+		 */
+		virtual bool uploadTextureRect(Pixel *pix, IRect rect, TexStat *tex, bool mipmap);
+
 		/**
 		 * Release backend-local GPU texture resources.
 		 *
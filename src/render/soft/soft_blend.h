@@ -0,0 +1,223 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+// @private head
+
+#ifndef __quark_render_soft_blend__
+#define __quark_render_soft_blend__
+
+#include "../blend.h"
+#include "../../util/util.h"
+
+#if Qk_ARCH_ARM64 || defined(__ARM_NEON)
+# define Qk_SC_NEON 1
+# include <arm_neon.h>
+#elif Qk_ARCH_X86 && (defined(__SSE2__) || defined(__x86_64__) || defined(_M_X64))
+# define Qk_SC_SSE2 1
+# include <emmintrin.h>
+#endif
+
+namespace qk {
+
+	// Pixels are premultiplied RGBA_8888 stored as uint32 in memory order r,g,b,a,
+	// all channel math below is independent of the byte order except for the alpha index.
+
+	// (a * b) / 255 with rounding
+	inline uint32_t sc_mul255(uint32_t a, uint32_t b) {
+		uint32_t p = a * b + 128;
+		return (p + (p >> 8)) >> 8;
+	}
+
+	inline uint32_t sc_alpha(uint32_t px) {
+		return px >> 24;
+	}
+
+	// scale all channels of `px` by `a`/255
+	inline uint32_t sc_scale(uint32_t px, uint32_t a) {
+		if (a == 255) return px;
+		uint32_t rb = (px & 0x00ff00ff) * a + 0x00800080;
+		uint32_t ag = ((px >> 8) & 0x00ff00ff) * a + 0x00800080;
+		rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+		ag = (ag + ((ag >> 8) & 0x00ff00ff)) & 0xff00ff00;
+		return rb | ag;
+	}
+
+	inline uint32_t sc_src_over(uint32_t s, uint32_t d) {
+		return s + sc_scale(d, 255 - sc_alpha(s));
+	}
+
+	// Generic blend of one pixel, `s` has already been scaled by its coverage,
+	// this matches the fixed-function blend states used by the GPU backends.
+	inline uint32_t sc_blend(BlendMode mode, uint32_t s, uint32_t d) {
+		uint32_t sa = sc_alpha(s), da = sc_alpha(d);
+		switch (mode) {
+			case kClear_BlendMode: return 0;
+			case kSrc_BlendMode: return s;
+			case kSrcOver_BlendMode: return sc_src_over(s, d);
+			case kDst_BlendMode: return d;
+			case kDstOver_BlendMode: return sc_scale(s, 255 - da) + d;
+			case kSrcIn_BlendMode: return sc_scale(s, da);
+			case kDstIn_BlendMode: return sc_scale(d, sa);
+			case kSrcOut_BlendMode: return sc_scale(s, 255 - da);
+			case kDstOut_BlendMode: return sc_scale(d, 255 - sa);
+			case kSrcATop_BlendMode: return sc_scale(s, da) + sc_scale(d, 255 - sa);
+			case kDstATop_BlendMode: return sc_scale(s, 255 - da) + sc_scale(d, sa);
+			case kXor_BlendMode: return sc_scale(s, 255 - da) + sc_scale(d, 255 - sa);
+			default: break;
+		}
+		// per channel modes, results are saturated like the fixed-function pipeline
+		uint32_t r = 0;
+		for (int i = 0; i < 32; i += 8) {
+			uint32_t sc = (s >> i) & 0xff, dc = (d >> i) & 0xff, v;
+			uint32_t f = i == 24 ? 255: sa; // legacy modes keep the alpha channel pma
+			switch (mode) {
+				case kPlus_BlendMode: v = sc + dc; break;
+				case kSrcOverLegacy_BlendMode:
+					v = sc_mul255(sc, f) + sc_mul255(dc, 255 - sa); break;
+				case kPlusLegacy_BlendMode: v = sc_mul255(sc, sa) + dc; break;
+				case kModulateLegacy_BlendMode: v = sc_mul255(sc, dc); break;
+				case kScreenLegacy_BlendMode: v = sc + sc_mul255(dc, 255 - sc); break;
+				case kMultiplyLegacy_BlendMode: v = sc_mul255(dc, sc) + sc_mul255(dc, 255 - sa); break;
+				default: v = dc; break;
+			}
+			r |= (v > 255 ? 255: v) << i;
+		}
+		return r;
+	}
+
+#if Qk_SC_SSE2
+	// 8 x u16 lanes (a * b) / 255
+	inline __m128i sc_mul255_epu16(__m128i a, __m128i b) {
+		__m128i p = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(p, _mm_srli_epi16(p, 8)), 8);
+	}
+	// broadcast the alpha of two unpacked pixels to all of their lanes
+	inline __m128i sc_alpha_epu16(__m128i px) {
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+	}
+	// src over for four pixels, `s` is premultiplied and already scaled by coverage
+	inline __m128i sc_src_over_x4(__m128i s, __m128i d) {
+		const __m128i zero = _mm_setzero_si128(), full = _mm_set1_epi16(255);
+		__m128i slo = _mm_unpacklo_epi8(s, zero), shi = _mm_unpackhi_epi8(s, zero);
+		__m128i dlo = _mm_unpacklo_epi8(d, zero), dhi = _mm_unpackhi_epi8(d, zero);
+		dlo = sc_mul255_epu16(dlo, _mm_sub_epi16(full, sc_alpha_epu16(slo)));
+		dhi = sc_mul255_epu16(dhi, _mm_sub_epi16(full, sc_alpha_epu16(shi)));
+		return _mm_packus_epi16(_mm_add_epi16(slo, dlo), _mm_add_epi16(shi, dhi));
+	}
+#elif Qk_SC_NEON
+	// src over for two pixels
+	inline uint8x8_t sc_src_over_x2(uint8x8_t s, uint8x8_t d) {
+		const uint8x8_t alphaIdx = {3,3,3,3,7,7,7,7};
+		uint8x8_t ia = vmvn_u8(vtbl1_u8(s, alphaIdx));
+		uint16x8_t p = vmull_u8(d, ia);
+		return vqadd_u8(s, vraddhn_u16(p, vrshrq_n_u16(p, 8)));
+	}
+#endif
+
+	/**
+	 * Blend a solid premultiplied color over `len` destination pixels with a constant coverage.
+	 */
+	inline void sc_blend_solid(BlendMode mode, uint32_t *dst, uint32_t color, uint8_t coverage, int len) {
+		uint32_t s = sc_scale(color, coverage);
+		if (mode == kSrc_BlendMode || (mode == kSrcOver_BlendMode && sc_alpha(s) == 255)) {
+			for (int i = 0; i < len; i++) dst[i] = s;
+			return;
+		}
+		if (mode != kSrcOver_BlendMode) {
+			for (int i = 0; i < len; i++) dst[i] = sc_blend(mode, s, dst[i]);
+			return;
+		}
+		if (!s)
+			return;
+		int i = 0;
+#if Qk_SC_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		__m128i s16 = _mm_unpacklo_epi8(_mm_set1_epi32(s), zero);
+		__m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), sc_alpha_epu16(s16));
+		__m128i s8 = _mm_set1_epi32(s);
+		for (; i + 4 <= len; i += 4) {
+			__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+			__m128i dlo = sc_mul255_epu16(_mm_unpacklo_epi8(d, zero), ia);
+			__m128i dhi = sc_mul255_epu16(_mm_unpackhi_epi8(d, zero), ia);
+			_mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epu8(s8, _mm_packus_epi16(dlo, dhi)));
+		}
+#elif Qk_SC_NEON
+		uint8x8_t s8 = vreinterpret_u8_u32(vdup_n_u32(s));
+		for (; i + 2 <= len; i += 2) {
+			uint8x8_t d = vld1_u8((const uint8_t*)(dst + i));
+			vst1_u8((uint8_t*)(dst + i), sc_src_over_x2(s8, d));
+		}
+#endif
+		for (; i < len; i++)
+			dst[i] = sc_src_over(s, dst[i]);
+	}
+
+	/**
+	 * Blend `len` premultiplied source pixels into destination pixels.
+	 * Each source pixel is first scaled by `coverage` and, if not null, by `cover[i]`.
+	 */
+	inline void sc_blend_row(BlendMode mode, uint32_t *dst, const uint32_t *src,
+		const uint8_t *cover, uint8_t coverage, int len)
+	{
+		if (mode != kSrcOver_BlendMode) {
+			for (int i = 0; i < len; i++) {
+				uint32_t a = cover ? sc_mul255(cover[i], coverage): coverage;
+				dst[i] = sc_blend(mode, sc_scale(src[i], a), dst[i]);
+			}
+			return;
+		}
+		int i = 0;
+		if (!cover && coverage == 255) {
+#if Qk_SC_SSE2
+			for (; i + 4 <= len; i += 4) {
+				__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+				_mm_storeu_si128((__m128i*)(dst + i), sc_src_over_x4(s, d));
+			}
+#elif Qk_SC_NEON
+			for (; i + 2 <= len; i += 2) {
+				uint8x8_t s = vld1_u8((const uint8_t*)(src + i));
+				uint8x8_t d = vld1_u8((const uint8_t*)(dst + i));
+				vst1_u8((uint8_t*)(dst + i), sc_src_over_x2(s, d));
+			}
+#endif
+		}
+		for (; i < len; i++) {
+			uint32_t a = cover ? sc_mul255(cover[i], coverage): coverage;
+			uint32_t s = sc_scale(src[i], a);
+			if (sc_alpha(s) == 255)
+				dst[i] = s;
+			else if (s)
+				dst[i] = sc_src_over(s, dst[i]);
+		}
+	}
+
+}
+#endif
@@ -0,0 +1,598 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include <math.h>
+#include "./soft_canvas.h"
+#include "./soft_render.h"
+#include "../source.h"
+
+namespace qk {
+	float get_level_font_size(float fontSize);
+	void  clear_PathvCache(PathvCache *cache, int flags);
+	void  setTexUnsafe_SourceImage(ImageSource* img, const TexStat *tex);
+
+	// the gray rasterizer indexes outline points with short integers
+	static constexpr uint32_t kMaxOutlinePoints = 30000;
+
+	inline IRange sc_intersect(const IRange &a, const IRange &b) {
+		IRange r{
+			IVec2(Qk_Max(a.begin[0], b.begin[0]), Qk_Max(a.begin[1], b.begin[1])),
+			IVec2(Qk_Min(a.end[0], b.end[0]), Qk_Min(a.end[1], b.end[1])),
+		};
+		return r.isEmpty() ? IRange{IVec2(0),IVec2(0)}: r;
+	}
+
+	inline IRange sc_union(const IRange &a, const IRange &b) {
+		if (a.isEmpty()) return b;
+		if (b.isEmpty()) return a;
+		return {
+			IVec2(Qk_Min(a.begin[0], b.begin[0]), Qk_Min(a.begin[1], b.begin[1])),
+			IVec2(Qk_Max(a.end[0], b.end[0]), Qk_Max(a.end[1], b.end[1])),
+		};
+	}
+
+	SoftCanvas::SoftCanvas(Render *render, Render::Options opts)
+		: _render(render), _opts(opts), _cache(nullptr), _state(nullptr)
+		, _surfaceSize(), _surfaceScale(1), _size()
+		, _surfaceScaleAverage(1), _scaleAverage(1), _allScaleAverage(1)
+		, _axisAlignedTransform(true)
+	{
+		_opts.colorType = kRGBA_8888_ColorType; // the only color buffer format of soft canvas
+		_cache = new PathvCache(opts.maxCapacityForPathvCache, render);
+		_stateStack.push({ .matrix=Mat(), .target=&_colorBuffer });
+		_state = &_stateStack.back();
+	}
+
+	SoftCanvas::~SoftCanvas() {
+		_cmds.clear();
+		_cmdsFront.clear();
+		Releasep(_cache);
+	}
+
+	Mat SoftCanvas::deviceMatrix() const {
+		auto &m = _state->matrix;
+		float sx = _surfaceScale[0], sy = _surfaceScale[1];
+		return Mat(m[0] * sx, m[1] * sx, m[2] * sx, m[3] * sy, m[4] * sy, m[5] * sy);
+	}
+
+	IRange SoftCanvas::targetBounds() const {
+		auto t = _state->target;
+		return {IVec2(0), IVec2(t->width(), t->height())};
+	}
+
+	void SoftCanvas::computeScale() {
+		auto &mat = _state->matrix;
+		_axisAlignedTransform = mat[1] == 0.0f && mat[3] == 0.0f && mat[0] != 0.0f && mat[4] != 0.0f;
+		Vec2 scale(Vec2(mat[0], mat[3]).length(), Vec2(mat[1], mat[4]).length());
+		_scaleAverage = sqrtf(scale.x() * scale.y());
+		_allScaleAverage = _surfaceScaleAverage * _scaleAverage;
+	}
+
+	void SoftCanvas::pushCmd(SC_Cmd *cmd, const IRange &bounds) {
+		cmd->target = _state->target;
+		cmd->bounds = sc_intersect(bounds, targetBounds());
+		if (cmd->bounds.isEmpty()) {
+			delete cmd;
+		} else {
+			_cmds.push(cmd);
+			_drawCalls++;
+		}
+	}
+
+	void SoftCanvas::addOutlines(SC_FillCmd *cmd, const Path &path, const Mat &mat, IRange &bounds) {
+		auto add = [&](const Path &p) {
+			auto o = new SC_Outline(p, mat);
+			bounds = sc_union(bounds, o->bounds());
+			cmd->outlines.push(o);
+		};
+		if (path.ptsLen() <= kMaxOutlinePoints) {
+			add(path);
+			return;
+		}
+		// split very large paths by contours
+		Path chunk;
+		auto pts = path.pts().val();
+		for (auto verb: path.verbs()) {
+			switch (verb) {
+				case Path::kMove_Verb:
+					if (chunk.ptsLen() >= kMaxOutlinePoints) {
+						add(chunk);
+						chunk = Path();
+					}
+					chunk.moveTo(*pts++); break;
+				case Path::kLine_Verb:
+					chunk.lineTo(*pts++); break;
+				case Path::kQuad_Verb:
+					chunk.quadTo(pts[0], pts[1]); pts += 2; break;
+				case Path::kCubic_Verb:
+					chunk.cubicTo(pts[0], pts[1], pts[2]); pts += 3; break;
+				default:
+					chunk.close(); break;
+			}
+		}
+		if (chunk.ptsLen())
+			add(chunk);
+	}
+
+	void SoftCanvas::fillPath(const Path &path, const Paint &paint, const PaintStyle &style, bool stroke) {
+		auto &p = stroke ?
+			_cache->getStrokePath(path, paint.strokeWidth, paint.cap, paint.join, 0): path;
+		auto mat = deviceMatrix();
+		auto cmd = new SC_FillCmd;
+		if (!cmd->shader.setPaint(style, paint.mask, mat)) {
+			delete cmd;
+			return;
+		}
+		IRange bounds{IVec2(0), IVec2(0)};
+		cmd->mode = paint.blendMode;
+		cmd->clip = _state->clip;
+		cmd->antiAlias = paint.antiAlias;
+		addOutlines(cmd, p, mat, bounds);
+		pushCmd(cmd, bounds);
+	}
+
+	void SoftCanvas::fillPathColor(const Path &path, const Color4f &color, BlendMode mode, bool antiAlias) {
+		auto mat = deviceMatrix();
+		auto cmd = new SC_FillCmd;
+		IRange bounds{IVec2(0), IVec2(0)};
+		cmd->shader.setColor(color);
+		cmd->mode = mode;
+		cmd->clip = _state->clip;
+		cmd->antiAlias = antiAlias;
+		addOutlines(cmd, path, mat, bounds);
+		pushCmd(cmd, bounds);
+	}
+
+	PathvCache* SoftCanvas::getPathvCache() {
+		return _cache;
+	}
+
+	Allocator* SoftCanvas::frameAllocator() {
+		return &_frameAlloc;
+	}
+
+	Vec2 SoftCanvas::size() const {
+		return _size;
+	}
+
+	Vec2 SoftCanvas::surfaceSize() const {
+		return _surfaceSize;
+	}
+
+	int SoftCanvas::getSaveCount() const {
+		return _stateStack.length() - 1;
+	}
+
+	const Mat& SoftCanvas::getMatrix() const {
+		return _state->matrix;
+	}
+
+	void SoftCanvas::setMatrix(const Mat& mat) {
+		_state->matrix = mat;
+		computeScale();
+	}
+
+	void SoftCanvas::setTranslate(Vec2 val) {
+		_state->matrix.set_translate(val);
+	}
+
+	void SoftCanvas::translate(Vec2 val) {
+		_state->matrix.translate(val);
+	}
+
+	void SoftCanvas::scale(Vec2 val) {
+		_state->matrix.scale(val);
+		computeScale();
+	}
+
+	void SoftCanvas::rotate(float z) {
+		_state->matrix.rotate(z);
+		computeScale();
+	}
+
+	int SoftCanvas::save() {
+		auto &back = _stateStack.back();
+		_stateStack.push({ back.matrix, back.clip.get(), back.output.get(), back.target });
+		_state = &_stateStack.back();
+		return _stateStack.length();
+	}
+
+	void SoftCanvas::restore(uint32_t count) {
+		if (!count || _stateStack.length() == 1)
+			return;
+		count = U32::min(count, _stateStack.length() - 1);
+		auto target = _state->target;
+		while (count--) {
+			_stateStack.pop();
+		}
+		_state = &_stateStack.back();
+		if (target != _state->target) {
+			_cmds.push(new SC_BarrierCmd); // end of output image, switch back to last target
+		}
+		computeScale();
+	}
+
+	void SoftCanvas::clipPath(const Path& path, ClipOp op, bool antiAlias) {
+		if (op > kReplace_ClipOp) {
+			Qk_DLog("Invalid ClipOp: %d, expected kIntersect_ClipOp, kDifference_ClipOp, or kReplace_ClipOp", op);
+			return;
+		}
+		Sp<SC_Clip> parent = _state->clip;
+		if (op == kReplace_ClipOp) {
+			op = kIntersect_ClipOp;
+			parent = nullptr; // ignore last clip state
+		}
+		auto cmd = new SC_ClipCmd;
+		auto clip = new SC_Clip;
+		auto target = targetBounds();
+		cmd->outline = new SC_Outline(path, deviceMatrix());
+		auto ob = sc_intersect(cmd->outline->bounds(), target);
+
+		// The mask only covers the pixels whose coverage can differ from `outside`
+		if (op == kIntersect_ClipOp) {
+			clip->bounds = parent && !parent->outside ? sc_intersect(ob, parent->bounds): ob;
+			clip->outside = 0;
+		} else if (!parent) {
+			clip->bounds = ob;
+			clip->outside = 255;
+		} else if (!parent->outside) {
+			clip->bounds = parent->bounds;
+			clip->outside = 0;
+		} else {
+			clip->bounds = sc_intersect(sc_union(ob, parent->bounds), target);
+			clip->outside = 255;
+		}
+		auto size = clip->bounds.end - clip->bounds.begin;
+		clip->mask = Array<uint8_t>(size[0] * size[1]);
+		cmd->clip = clip;
+		cmd->parent = parent;
+		cmd->op = op;
+		cmd->antiAlias = antiAlias;
+		_state->clip = clip;
+		pushCmd(cmd, clip->bounds);
+	}
+
+	void SoftCanvas::clipRect(const Rect& rect, ClipOp op, bool antiAlias) {
+		clipPath(_cache->getRectPath(rect), op, antiAlias);
+	}
+
+	void SoftCanvas::clearColor(const Color4f& color) {
+		auto cmd = new SC_ClearCmd;
+		SC_Shader shader;
+		shader.setColor(color);
+		cmd->color = shader.color32;
+		pushCmd(cmd, targetBounds());
+	}
+
+	void SoftCanvas::drawColor(const Color4f &color, BlendMode mode) {
+		auto cmd = new SC_FillCmd;
+		auto t = targetBounds();
+		Vec2 quad[4] = {
+			Vec2(t.begin[0], t.begin[1]), Vec2(t.end[0], t.begin[1]),
+			Vec2(t.end[0], t.end[1]), Vec2(t.begin[0], t.end[1]),
+		};
+		cmd->outlines.push(new SC_Outline(quad));
+		cmd->shader.setColor(color);
+		cmd->mode = mode;
+		cmd->clip = _state->clip;
+		pushCmd(cmd, t);
+	}
+
+	void SoftCanvas::drawPath(const Path &path, const Paint &paint) {
+		switch (paint.style) {
+			case Paint::kFill_Style:
+				fillPath(path, paint, paint.fill, false); break;
+			case Paint::kStrokeAndFill_Style:
+				fillPath(path, paint, paint.fill, false);
+			case Paint::kStroke_Style:
+				fillPath(path, paint, paint.stroke, true);
+				break;
+		}
+	}
+
+	void SoftCanvas::drawPathColor(const Path& path, const Color4f &color, BlendMode mode, bool antiAlias) {
+		fillPathColor(path, color, mode, antiAlias);
+	}
+
+	void SoftCanvas::drawPathColors(const Path* paths[], int count, const Color4f &color, BlendMode mode, bool antiAlias) {
+		for (int i = 0; i < count; i++) {
+			fillPathColor(*paths[i], color, mode, antiAlias);
+		}
+	}
+
+	void SoftCanvas::drawRect(const Rect& rect, const Paint& paint) {
+		drawPath(_cache->getRectPath(rect), paint);
+	}
+
+	void SoftCanvas::drawRRect(const Rect& rect, const Path::BorderRadius &radius, const Paint& paint) {
+		drawPath(_cache->getRRectPath(rect, radius), paint);
+	}
+
+	void SoftCanvas::drawRectOutlinePath(const RectOutlinePath& rect, const Color4f color[4], const Paint& paint) {
+		auto newPaint = paint;
+		auto baseColor = paint.fill.color;
+		newPaint.style = Paint::kFill_Style; // only fill for outline, no stroke
+		for (int i = 0; i < 4; i++) {
+			if (rect.flags & (1 << i)) { // if this edge is visible
+				newPaint.fill.color = baseColor.mul(color[i]);
+				drawPath((&rect.top)[i], newPaint);
+			}
+		}
+	}
+
+	void SoftCanvas::drawRRectBlurColor(const RRect& rrect, float blur, const Color4f &color,
+		const RRect* clip, BlendMode mode)
+	{
+		if (rrect.rect.size.is_zero_axis())
+			return;
+		auto mat = deviceMatrix();
+		auto cmd = new SC_RRectBlurCmd;
+		cmd->rrect = rrect;
+		cmd->inv = mat.inverse();
+		cmd->blur = blur;
+		cmd->color = color.premul_alpha();
+		cmd->mode = mode;
+		cmd->clip = _state->clip;
+		if (clip) {
+			cmd->clipRRect = *clip;
+			cmd->useClipRRect = true;
+		}
+		// the blur spreads to 2 * max(blur, 0.5) outside of the rect
+		float s1 = Qk_Max(blur, 0.5f) * 2.0f;
+		auto begin = rrect.rect.begin - s1, end = rrect.rect.begin + rrect.rect.size + s1;
+		Vec2 pts[4] = { begin, Vec2(end[0], begin[1]), end, Vec2(begin[0], end[1]) };
+		auto bounds = Path::getBoundsFromPoints(pts, 4, &mat);
+		pushCmd(cmd, {IVec2(floorf(bounds.begin[0]), floorf(bounds.begin[1])),
+			IVec2(ceilf(bounds.end[0]), ceilf(bounds.end[1]))});
+	}
+
+	float SoftCanvas::drawTextImage(Typeface::TextImage &img, float scale, Vec2 origin, const Paint &paint) {
+		auto pix = img.image->pixel(0);
+		scale *= img.scale;
+		auto scale_1 = 1.0f / scale;
+		// Default use baseline align
+		Vec2 dst_start(origin.x() - img.left * scale_1, origin.y() - img.top * scale_1);
+		if (_axisAlignedTransform) {
+			// Snap the pre-rasterized text image to device pixels to keep hinted lines sharp
+			Vec2 devicePos = (_state->matrix * dst_start) * _surfaceScale;
+			Vec2 deviceScale = _surfaceScale * _state->matrix.getScaling();
+			dst_start += (devicePos.round() - devicePos) / deviceScale;
+		}
+		Vec2 dst_size(pix->width() * scale_1, pix->height() * scale_1);
+		Rect rect{dst_start, dst_size};
+		PaintImage p;
+		p.setImage(*img.image, rect);
+		p.filterMode = PaintImage::kLinear_FilterMode;
+
+		auto mat = deviceMatrix();
+		auto cmd = new SC_FillCmd;
+		PaintStyle style;
+		bool isSDF = img.image->type() == kSDF_F32_ColorType || img.image->type() == kSDF_Unsigned_F32_ColorType;
+		if (isSDF) {
+			style.color = paint.style == Paint::kStroke_Style ? Color4f(0,0,0,0): paint.fill.color;
+			style.image = &p;
+		} else if (img.hasColors) {
+			// Color glyph atlases contain intrinsic premultiplied RGB, only apply the text opacity
+			style.color = Color4f(1, 1, 1, paint.fill.color.a());
+			style.image = &p;
+		} else {
+			style.color = paint.fill.color;
+		}
+		if (!cmd->shader.setPaint(style, isSDF || img.hasColors ? nullptr: &p, mat)) {
+			delete cmd;
+			return scale_1;
+		}
+		if (isSDF) {
+			float strokeWidth = paint.style == Paint::kFill_Style ? 0.0f: paint.strokeWidth;
+			cmd->shader.stroke = strokeWidth * scale;
+			cmd->shader.strokeColor = (strokeWidth <= 0 ? style.color: paint.stroke.color).premul_alpha();
+		}
+		Vec2 quad[4] = {
+			mat * dst_start, mat * Vec2(dst_start[0] + dst_size[0], dst_start[1]),
+			mat * (dst_start + dst_size), mat * Vec2(dst_start[0], dst_start[1] + dst_size[1]),
+		};
+		auto o = new SC_Outline(quad);
+		cmd->outlines.push(o);
+		cmd->mode = paint.blendMode;
+		cmd->clip = _state->clip;
+		pushCmd(cmd, o->bounds());
+		return scale_1;
+	}
+
+	float SoftCanvas::drawGlyphs(const FontGlyphs &glyphs, Vec2 origin, cArray<Vec2> *offsetIn, const Paint &paint) {
+		Array<Vec2> offset, *offsetP = nullptr;
+		if (offsetIn) {
+			offset = *offsetIn;
+			offsetP = &offset;
+			for (auto &o: offset) o *= _allScaleAverage;
+		}
+		auto isSDF = paint.style != Paint::kFill_Style;
+		auto tf = glyphs.typeface();
+		auto img = isSDF ?
+			tf->getSDFImage(glyphs.glyphs(), glyphs.fontSize() * _allScaleAverage, offsetP, false):
+			tf->getImage(glyphs.glyphs(), glyphs.fontSize() * _allScaleAverage, offsetP);
+		if (!img.image->width() || !img.image->height())
+			return 0;
+		img.image->markAsTexture(_render);
+		auto scale_1 = drawTextImage(img, _allScaleAverage, origin, paint);
+		return scale_1 * img.width;
+	}
+
+	void SoftCanvas::drawTextBlob(TextBlob *blob, Vec2 origin, float fontSize, const Paint &paint) {
+		auto fixedFSize = get_level_font_size(_scaleAverage * fontSize) * _surfaceScaleAverage;
+		if (fixedFSize == 0.0)
+			return;
+		auto scale = fixedFSize / fontSize; // scale from original font size to fixed font size
+		auto needSDF = paint.style != Paint::kFill_Style;
+		auto isSDF = [](ImageSource *img) {
+			return img->type() == kSDF_F32_ColorType || img->type() == kSDF_Unsigned_F32_ColorType;
+		};
+		if (blob->img.fontSize != fixedFSize || !blob->img.image ||
+			(needSDF ? !blob->img.hasColors && !isSDF(blob->img.image.get()): false)
+		) { // fill text bolb
+			Array<Vec2> offset;
+			if (blob->offset.length() >= blob->glyphs.length()) {
+				offset = blob->offset;
+				for (auto &o: offset) o *= scale;
+			}
+			blob->img = needSDF ?
+				blob->typeface->getSDFImage(blob->glyphs, fixedFSize, &offset, false):
+				blob->typeface->getImage(blob->glyphs, fixedFSize, &offset);
+		}
+		auto img = blob->img.image.get();
+		if (img->width() && img->height()) {
+			img->markAsTexture(_render);
+			drawTextImage(blob->img, scale, origin, paint);
+		}
+	}
+
+	void SoftCanvas::drawTriangles(const Triangles& triangles, const Paint &paint, bool copyData) {
+		auto image = paint.fill.image;
+		if (!triangles.verts || !triangles.indices || !triangles.vertCount || !triangles.indexCount)
+			return;
+		if (!image || image->_isCanvas || !image->image)
+			return;
+		auto mat = deviceMatrix();
+		auto cmd = new SC_TrianglesCmd;
+		auto color = paint.fill.color;
+		Vec2 min(1e9f), max(-1e9f);
+		// triangles are always copied, as they are transformed to device space here
+		cmd->verts.extend(triangles.vertCount);
+		for (uint32_t i = 0; i < triangles.vertCount; i++) {
+			auto &src = triangles.verts[i];
+			auto &dst = cmd->verts[i];
+			dst.pos = mat * Vec2(src.vertices[0], src.vertices[1]);
+			dst.uv = src.texCoords;
+			dst.light = src.lightColor.to_color4f().mul(color).premul_alpha();
+			dst.dark = src.darkColor.premul_alpha();
+			min = min.min(dst.pos); max = max.max(dst.pos);
+		}
+		cmd->indices = Array<uint16_t>(triangles.indexCount);
+		memcpy(cmd->indices.val(), triangles.indices, triangles.indexCount * sizeof(uint16_t));
+		cmd->image = image->image;
+		cmd->darkColor = triangles.isDarkColor;
+		cmd->mode = paint.blendMode;
+		cmd->clip = _state->clip;
+		image->image->markAsTexture(_render);
+		pushCmd(cmd, {IVec2(floorf(min[0]), floorf(min[1])), IVec2(ceilf(max[0]), ceilf(max[1]))});
+	}
+
+	Sp<ImageSource> SoftCanvas::readImage(const Rect &src, Vec2 dst, ColorType type, BlendMode mode, bool mipmap) {
+		auto o = src.begin;
+		auto s = Vec2{
+			F32::min(o.x()+src.size.x(), _size.x()) - o.x(),
+			F32::min(o.y()+src.size.y(), _size.y()) - o.y()
+		};
+		if (s[0] > 0 && s[1] > 0 && dst[0] > 0 && dst[1] > 0) {
+			// soft textures are always premultiplied kRGBA_8888, `type` is ignored
+			auto destImg = _render->createTexture(Vec2(
+				Qk_Min(dst.x(),_surfaceSize.x()), // limit max read image size to surface size
+				Qk_Min(dst.y(),_surfaceSize.y())
+			), kRGBA_8888_ColorType, mipmap ? kMipmap_TextureFlags: kNone_TextureFlags);
+			auto cmd = new SC_ReadImageCmd;
+			cmd->target = _state->target;
+			cmd->src = {o * _surfaceScale, (o + s) * _surfaceScale};
+			cmd->image = destImg;
+			cmd->mode = mode;
+			_cmds.push(cmd);
+			return destImg;
+		}
+		return nullptr;
+	}
+
+	Sp<ImageSource> SoftCanvas::outputImage(ImageSource* dst, bool mipmap) {
+		Sp<ImageSource> img(dst);
+		if (!dst) {
+			img = _render->createTexture(_surfaceSize, kRGBA_8888_ColorType, kNone_TextureFlags);
+		} else {
+			dst->markAsTexture(_render); // upload existing pixels as initial content
+			auto tex = sc_texture(dst);
+			if (!tex || tex->type() != kRGBA_8888_ColorType) {
+				auto stat = sc_new_texture_stat(dst->size(), kRGBA_8888_ColorType);
+				setTexUnsafe_SourceImage(dst, &stat);
+			}
+		}
+		if (img == _state->output)
+			return img; // same image, no need to switch
+		img->set_mipmap(mipmap);
+		auto barrier = new SC_BarrierCmd; // begin of output image
+		barrier->hold = img;
+		_cmds.push(barrier);
+		_state->output = img;
+		_state->target = sc_texture(*img);
+		_state->clip = nullptr; // clip masks are in the pixels of the last target
+		Qk_ReturnLocal(img);
+	}
+
+	bool SoftCanvas::swapBuffer() {
+		_frameAlloc.reset();
+		ScopeLock lock(_mutex);
+		// check if have cmds in front buffer, if have cmds, wait for next swap
+		bool canSwap = _cmdsFront.isEmpty();
+		if (canSwap) {
+			_cmdsFront.swap(_cmds);
+			clear_PathvCache(_cache, 0); // tag: clear mark
+		}
+		_cmds.clear(); // clear cmd buffer for next frame
+		return canSwap;
+	}
+
+	void SoftCanvas::flushBuffer(const std::function<void(const Pixel &colors)> &present) {
+		ScopeLock lock(_mutex);
+		_cmdsFront.playback();
+		sc_texture_collect();
+		if (present)
+			present(_colorBuffer);
+	}
+
+	void SoftCanvas::setSurface(const Mat4& root, Vec2 surfaceSize, Vec2 surfaceScale) {
+		Qk_ASSERT_GT(surfaceSize.x(), 0, "Invalid surface size width");
+		Qk_ASSERT_GT(surfaceSize.y(), 0, "Invalid surface size height");
+		ScopeLock lock(_mutex);
+		_cmds.clear();
+		_cmdsFront.clear();
+		if (surfaceSize != _surfaceSize) {
+			PixelInfo info(surfaceSize[0], surfaceSize[1], kRGBA_8888_ColorType, kPremul_AlphaType);
+			Buffer buf = Buffer::alloc(info.bytes());
+			memset(*buf, 0, buf.length());
+			_colorBuffer = Pixel(info, std::move(buf));
+		}
+		// clear all state
+		_stateStack.clear();
+		_stateStack.push({ .matrix=Mat(), .target=&_colorBuffer });
+		_state = &_stateStack.back();
+		_surfaceSize = surfaceSize;
+		_surfaceScale = surfaceScale;
+		_size = surfaceSize / surfaceScale;
+		_surfaceScaleAverage = sqrtf(surfaceScale.x() * surfaceScale.y());
+		computeScale();
+	}
+
+}
@@ -0,0 +1,124 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+// @private head
+
+#ifndef __quark_render_soft_canvas__
+#define __quark_render_soft_canvas__
+
+#include "../render.h"
+#include "../pathv_cache.h"
+#include "./soft_raster.h"
+
+namespace qk {
+	class SoftRender;
+
+	/**
+	 * @class SoftCanvas - A Canvas implementation that rasterizes on the CPU.
+	 *
+	 * Draw calls are recorded as device-space outlines into a command list,
+	 * `swapBuffer()` hands the list to the rendering thread and `flushBuffer()` plays it back
+	 * into premultiplied kRGBA_8888 pixels, splitting the target rows into bands
+	 * that are rasterized in parallel.
+	 */
+	class SoftCanvas: public Canvas {
+	public:
+		SoftCanvas(Render *render, Render::Options opts);
+		~SoftCanvas() override;
+		int  save() override;
+		void restore(uint32_t count) override;
+		int  getSaveCount() const override;
+		const Mat& getMatrix() const override;
+		void setMatrix(const Mat& mat) override;
+		void setTranslate(Vec2 val) override;
+		void translate(Vec2 val) override;
+		void scale(Vec2 val) override;
+		void rotate(float z) override;
+		void clipPath(const Path& path, ClipOp op, bool antiAlias) override;
+		void clipRect(const Rect& rect, ClipOp op, bool antiAlias) override;
+		void clearColor(const Color4f& color) override;
+		void drawColor(const Color4f& color, BlendMode mode) override;
+		void drawPath(const Path& path, const Paint& paint) override;
+		void drawPathColor(const Path &path, const Color4f &color, BlendMode mode, bool antiAlias) override;
+		void drawPathColors(const Path* path[], int count, const Color4f &color, BlendMode mode, bool antiAlias) override;
+		void drawRRectBlurColor(const RRect& rect, float blur, const Color4f &color,
+			const RRect* clip, BlendMode mode) override;
+		void drawRect(const Rect& rect, const Paint& paint) override;
+		void drawRRect(const Rect& rect, const Path::BorderRadius &radius, const Paint& paint) override;
+		void drawRectOutlinePath(const RectOutlinePath& path, const Color4f color[4], const Paint& paint) override;
+		float drawGlyphs(const FontGlyphs &glyphs, Vec2 origin, const Array<Vec2> *offset, const Paint &paint) override;
+		void drawTextBlob(TextBlob *blob, Vec2 origin, float fontSize, const Paint &paint) override;
+		void drawTriangles(const Triangles& triangles, const Paint &paint, bool copyData) override;
+		Sp<ImageSource> readImage(const Rect &src, Vec2 dst, ColorType type, BlendMode mode, bool mipmap) override;
+		Sp<ImageSource> outputImage(ImageSource* dst, bool mipmap) override;
+		bool swapBuffer() override;
+		PathvCache* getPathvCache() override;
+		Allocator* frameAllocator() override;
+		void setSurface(const Mat4& root, Vec2 surfaceSize, Vec2 surfaceScale) override;
+		Vec2 size() const override;
+		Vec2 surfaceSize() const override;
+		/**
+		 * Play back the swapped command list into the color buffer, only can rendering thread call.
+		 * If `present` is provided it is called with the finished color buffer before unlocking.
+		*/
+		void flushBuffer(const std::function<void(const Pixel &colors)> &present = nullptr);
+		const Render::Options& opts() const { return _opts; }
+	private:
+		struct State {
+			Mat             matrix;
+			Sp<SC_Clip>     clip; // current clip, null for no clip
+			Sp<ImageSource> output; // output dest texture, null for to main color buffer
+			SC_Texture      *target; // pixels of output or main color buffer
+		};
+		Mat  deviceMatrix() const;
+		IRange targetBounds() const;
+		void pushCmd(SC_Cmd *cmd, const IRange &bounds);
+		void fillPath(const Path &path, const Paint &paint, const PaintStyle &style, bool stroke);
+		void fillPathColor(const Path &path, const Color4f &color, BlendMode mode, bool antiAlias);
+		void addOutlines(SC_FillCmd *cmd, const Path &path, const Mat &mat, IRange &bounds);
+		float drawTextImage(Typeface::TextImage &img, float scale, Vec2 origin, const Paint &paint);
+		void computeScale();
+		// fields:
+		Render          *_render; // render backend
+		Render::Options _opts;
+		PathvCache      *_cache;
+		Array<State>    _stateStack;
+		State           *_state;
+		Vec2  _surfaceSize, _surfaceScale, _size;
+		float _surfaceScaleAverage, _scaleAverage, _allScaleAverage;
+		bool  _axisAlignedTransform;
+		Pixel _colorBuffer; // main color buffer, premultiplied kRGBA_8888
+		SC_CmdList _cmds, _cmdsFront; // recording and swapped command lists
+		Mutex _mutex; // submit swap mutex
+		LinearAllocator _frameAlloc; // frame-local temporary data of the callers, rewound by swapBuffer()
+	};
+
+}
+#endif
@@ -0,0 +1,740 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include <math.h>
+#include "./soft_raster.h"
+#include "../../util/thread.h"
+#include "../raster/ft_path.h"
+
+namespace qk {
+
+	struct SC_Scratch { // per thread scratch rows
+		uint32_t *colors = nullptr;
+		uint8_t  *cover = nullptr;
+		int      width = 0;
+		~SC_Scratch() {
+			::free(colors);
+			::free(cover);
+		}
+		void alloc(int w) {
+			if (w > width) {
+				colors = (uint32_t*)::realloc(colors, w * sizeof(uint32_t));
+				cover = (uint8_t*)::realloc(cover, w);
+				width = w;
+			}
+		}
+	};
+
+	static thread_local SC_Scratch tls_scratch;
+
+	inline uint32_t* sc_row(SC_Texture *tex, int y) {
+		return reinterpret_cast<uint32_t*>(tex->val() + y * tex->rowbytes());
+	}
+
+	inline uint32_t sc_color32(const Color4f &c) {
+		auto ch = [](float v) { return uint32_t(F32::clamp(v, 0, 1) * 255.0f + 0.5f); };
+		return ch(c[0]) | (ch(c[1]) << 8) | (ch(c[2]) << 16) | (ch(c[3]) << 24);
+	}
+
+	inline Color4f sc_color4f(uint32_t c) {
+		const float s = 1.0f / 255.0f;
+		return Color4f((c & 0xff) * s, ((c >> 8) & 0xff) * s, ((c >> 16) & 0xff) * s, (c >> 24) * s);
+	}
+
+	// multiply premultiplied texel by premultiplied color per channel
+	inline uint32_t sc_scale_color(uint32_t px, uint32_t c) {
+		if (c == 0xffffffff)
+			return px;
+		return sc_mul255(px & 0xff, c & 0xff) |
+			(sc_mul255((px >> 8) & 0xff, (c >> 8) & 0xff) << 8) |
+			(sc_mul255((px >> 16) & 0xff, (c >> 16) & 0xff) << 16) |
+			(sc_mul255(px >> 24, c >> 24) << 24);
+	}
+
+	// ----------------------------- O u t l i n e -----------------------------
+
+	inline Qk_FT_Pos sc_fixed26_6(float v) {
+		return Qk_FT_Pos(floorf(F32::clamp(v, -32000, 32000) * 64.0f + 0.5f));
+	}
+
+	SC_Outline::SC_Outline(const Path &path, const Mat &mat, bool evenOdd) {
+		auto &verbs = path.verbs();
+		auto pts = path.pts().val();
+		int contours = 0;
+		for (auto verb: verbs)
+			if (verb == Path::kMove_Verb) contours++;
+		// The gray rasterizer indexes points with short integers,
+		// the canvas splits larger paths by contours before getting here.
+		int ptsLen = Qk_Min(path.ptsLen(), 32767);
+		auto ft = qk_ft_outline_create(ptsLen, Qk_Max(contours, 1));
+		Vec2 min(1e9f), max(-1e9f);
+
+		auto add = [&](Vec2 p, char tag) {
+			if (ft->n_points == ptsLen) return;
+			p = mat * p;
+			min = min.min(p); max = max.max(p);
+			auto &pt = ft->points[ft->n_points];
+			pt.x = sc_fixed26_6(p.x());
+			pt.y = sc_fixed26_6(p.y());
+			ft->tags[ft->n_points++] = tag;
+		};
+		auto endContour = [&]() {
+			if (ft->n_points && (!ft->n_contours || ft->contours[ft->n_contours - 1] != ft->n_points - 1))
+				ft->contours[ft->n_contours++] = ft->n_points - 1;
+		};
+
+		for (auto verb: verbs) {
+			switch (verb) {
+				case Path::kMove_Verb:
+					endContour();
+					add(*pts++, Qk_FT_CURVE_TAG_ON);
+					break;
+				case Path::kLine_Verb:
+					add(*pts++, Qk_FT_CURVE_TAG_ON);
+					break;
+				case Path::kQuad_Verb:
+					add(pts[0], Qk_FT_CURVE_TAG_CONIC);
+					add(pts[1], Qk_FT_CURVE_TAG_ON);
+					pts += 2;
+					break;
+				case Path::kCubic_Verb:
+					add(pts[0], Qk_FT_CURVE_TAG_CUBIC);
+					add(pts[1], Qk_FT_CURVE_TAG_CUBIC);
+					add(pts[2], Qk_FT_CURVE_TAG_ON);
+					pts += 3;
+					break;
+				default: break; // close, the rasterizer always closes contours
+			}
+		}
+		endContour();
+		ft->flags = evenOdd ? Qk_FT_OUTLINE_EVEN_ODD_FILL: Qk_FT_OUTLINE_NONE;
+		_outline = ft;
+		_bounds = ft->n_points ?
+			IRange{IVec2(floorf(min[0]), floorf(min[1])), IVec2(ceilf(max[0]), ceilf(max[1]))}:
+			IRange{IVec2(0), IVec2(0)};
+	}
+
+	SC_Outline::SC_Outline(const Vec2 quad[4]) {
+		auto ft = qk_ft_outline_create(4, 1);
+		Vec2 min(1e9f), max(-1e9f);
+		for (int i = 0; i < 4; i++) {
+			min = min.min(quad[i]); max = max.max(quad[i]);
+			ft->points[i].x = sc_fixed26_6(quad[i].x());
+			ft->points[i].y = sc_fixed26_6(quad[i].y());
+			ft->tags[i] = Qk_FT_CURVE_TAG_ON;
+		}
+		ft->n_points = 4;
+		ft->contours[0] = 3;
+		ft->n_contours = 1;
+		_outline = ft;
+		_bounds = {IVec2(floorf(min[0]), floorf(min[1])), IVec2(ceilf(max[0]), ceilf(max[1]))};
+	}
+
+	SC_Outline::~SC_Outline() {
+		qk_ft_outline_destroy(_outline);
+	}
+
+	static void sc_bbox_noop(int x, int y, int w, int h, void *user) {}
+
+	static void sc_raster(const SC_Outline *o, int left, int top, int right, int bottom,
+		Qk_FT_SpanFunc spans, void *user)
+	{
+		if (left >= right || top >= bottom || !o->outline()->n_points)
+			return;
+		Qk_FT_Raster_Params params;
+		params.source = o->outline();
+		params.flags = Qk_FT_RASTER_FLAG_AA | Qk_FT_RASTER_FLAG_DIRECT | Qk_FT_RASTER_FLAG_CLIP;
+		params.gray_spans = spans;
+		params.bbox_cb = sc_bbox_noop;
+		params.user = user;
+		params.clip_box = { left, top, right, bottom };
+		sw_ft_grays_raster.raster_render(nullptr, &params);
+	}
+
+	// ----------------------------- T e x t u r e -----------------------------
+
+	static Mutex sc_retiredMutex;
+	static Array<SC_Texture*> sc_retired;
+
+	SC_Texture* sc_texture(const ImageSource *img) {
+		auto tex = img ? img->texture(0): nullptr;
+		return tex ? static_cast<SC_Texture*>(tex->ptr()): nullptr;
+	}
+
+	void sc_texture_retire(SC_Texture *tex) {
+		if (tex) {
+			ScopeLock lock(sc_retiredMutex);
+			sc_retired.push(tex);
+		}
+	}
+
+	void sc_texture_collect() {
+		Array<SC_Texture*> retired;
+		{
+			ScopeLock lock(sc_retiredMutex);
+			retired = std::move(sc_retired);
+		}
+		for (auto tex: retired)
+			delete tex;
+	}
+
+	// ----------------------------- C l i p -----------------------------
+
+	void SC_Clip::rowCoverage(int x, int y, int len, uint8_t *out) const {
+		int bx0 = bounds.begin.x(), bx1 = bounds.end.x();
+		if (y < bounds.begin.y() || y >= bounds.end.y() || x >= bx1 || x + len <= bx0) {
+			memset(out, outside, len);
+			return;
+		}
+		int x0 = Qk_Max(x, bx0), x1 = Qk_Min(x + len, bx1);
+		if (x0 > x)
+			memset(out, outside, x0 - x);
+		memcpy(out + (x0 - x), mask.val() + (y - bounds.begin.y()) * (bx1 - bx0) + (x0 - bx0), x1 - x0);
+		if (x + len > x1)
+			memset(out + (x1 - x), outside, x + len - x1);
+	}
+
+	// ----------------------------- S h a d e r -----------------------------
+
+	void SC_Shader::setColor(const Color4f &c) {
+		color = c.premul_alpha();
+		color32 = sc_color32(color);
+	}
+
+	bool SC_Shader::setPaint(const PaintStyle &style, const PaintImage *mask, const Mat &deviceMatrix) {
+		setColor(style.color);
+		auto setImage = [&](const PaintImage *paint) {
+			if (paint->_isCanvas || !paint->image)
+				return false; // sampling another canvas is not supported by the soft canvas
+			image = paint->image;
+			coord = paint->coord;
+			tileX = paint->tileModeX;
+			tileY = paint->tileModeY;
+			linear = paint->filterMode == PaintImage::kLinear_FilterMode;
+			inv = deviceMatrix.inverse();
+			return true;
+		};
+		if (style.image) {
+			kind = kImage_Kind;
+			if (!setImage(style.image))
+				return false;
+			if (image->type() == kSDF_F32_ColorType || image->type() == kSDF_Unsigned_F32_ColorType) {
+				kind = kSDFMask_Kind;
+				strokeColor = color;
+			}
+		} else if (style.gradient) {
+			auto g = style.gradient;
+			if (!g->count)
+				return false;
+			kind = kGradient_Kind;
+			gradientType = g->type;
+			origin = g->origin;
+			endOrRadius = g->endOrRadius;
+			for (uint32_t i = 0; i < g->count; i++) {
+				colors.push(g->colors[i].premul_alpha());
+				positions.push(g->positions ? g->positions[i]: g->count > 1 ? float(i) / (g->count - 1): 0);
+			}
+			inv = deviceMatrix.inverse();
+		} else if (mask) {
+			kind = kMask_Kind;
+			if (!setImage(mask))
+				return false;
+		} else {
+			kind = kColor_Kind;
+		}
+		return true;
+	}
+
+	bool SC_Shader::prepare() {
+		if (!image)
+			return true;
+		tex = sc_texture(*image);
+		return tex && tex->width() && tex->height();
+	}
+
+	inline int sc_tile(int i, int size, PaintImage::TileMode mode) {
+		switch (mode) {
+			case PaintImage::kRepeat_TileMode:
+				i %= size;
+				return i < 0 ? i + size: i;
+			case PaintImage::kMirror_TileMode: {
+				int period = size << 1;
+				i %= period;
+				if (i < 0) i += period;
+				return i < size ? i: period - i - 1;
+			}
+			case PaintImage::kDecal_TileMode:
+				return i < 0 || i >= size ? -1: i;
+			default:
+				return i < 0 ? 0: i >= size ? size - 1: i;
+		}
+	}
+
+	// fetch premultiplied texel, alpha textures are returned as (0,0,0,a)
+	inline uint32_t sc_fetch(const SC_Texture *tex, int x, int y) {
+		if (x < 0 || y < 0)
+			return 0;
+		auto row = tex->val() + y * tex->rowbytes();
+		switch (tex->type()) {
+			case kAlpha_8_ColorType: return uint32_t(row[x]) << 24;
+			case kRGBA_8888_ColorType: return reinterpret_cast<const uint32_t*>(row)[x];
+			default: return 0;
+		}
+	}
+
+	inline float sc_fetch_f32(const SC_Texture *tex, int x, int y) {
+		if (x < 0 || y < 0)
+			return 1e9f;
+		return reinterpret_cast<const float*>(tex->val() + y * tex->rowbytes())[x];
+	}
+
+	inline uint32_t sc_lerp(uint32_t a, uint32_t b, uint32_t t /*0-256*/) {
+		uint32_t rb = ((a & 0x00ff00ff) * (256 - t) + (b & 0x00ff00ff) * t) >> 8;
+		uint32_t ag = ((a >> 8) & 0x00ff00ff) * (256 - t) + ((b >> 8) & 0x00ff00ff) * t;
+		return (rb & 0x00ff00ff) | (ag & 0xff00ff00);
+	}
+
+	static uint32_t sc_sample(const SC_Shader *s, float u, float v) {
+		auto tex = s->tex;
+		int w = tex->width(), h = tex->height();
+		if (!s->linear) {
+			return sc_fetch(tex, sc_tile(int(floorf(u * w)), w, s->tileX), sc_tile(int(floorf(v * h)), h, s->tileY));
+		}
+		float fu = u * w - 0.5f, fv = v * h - 0.5f;
+		float x0f = floorf(fu), y0f = floorf(fv);
+		int x0 = int(x0f), y0 = int(y0f);
+		uint32_t tx = uint32_t((fu - x0f) * 256.0f), ty = uint32_t((fv - y0f) * 256.0f);
+		int xa = sc_tile(x0, w, s->tileX), xb = sc_tile(x0 + 1, w, s->tileX);
+		int ya = sc_tile(y0, h, s->tileY), yb = sc_tile(y0 + 1, h, s->tileY);
+		uint32_t top = sc_lerp(sc_fetch(tex, xa, ya), sc_fetch(tex, xb, ya), tx);
+		uint32_t bottom = sc_lerp(sc_fetch(tex, xa, yb), sc_fetch(tex, xb, yb), tx);
+		return sc_lerp(top, bottom, ty);
+	}
+
+	static float sc_sample_f32(const SC_Shader *s, float u, float v) {
+		auto tex = s->tex;
+		int w = tex->width(), h = tex->height();
+		float fu = u * w - 0.5f, fv = v * h - 0.5f;
+		float x0f = floorf(fu), y0f = floorf(fv);
+		int x0 = int(x0f), y0 = int(y0f);
+		float tx = fu - x0f, ty = fv - y0f;
+		int xa = sc_tile(x0, w, s->tileX), xb = sc_tile(x0 + 1, w, s->tileX);
+		int ya = sc_tile(y0, h, s->tileY), yb = sc_tile(y0 + 1, h, s->tileY);
+		float top = sc_fetch_f32(tex, xa, ya) * (1 - tx) + sc_fetch_f32(tex, xb, ya) * tx;
+		float bottom = sc_fetch_f32(tex, xa, yb) * (1 - tx) + sc_fetch_f32(tex, xb, yb) * tx;
+		return top * (1 - ty) + bottom * ty;
+	}
+
+	static Color4f sc_gradient(const SC_Shader *s, float t) {
+		auto &pos = s->positions;
+		int e = pos.length() - 1;
+		if (t <= pos[0] || e == 0) return s->colors[0];
+		if (t >= pos[e]) return s->colors[e];
+		int b = 0;
+		while (b + 1 < e) { // dichotomy search color stop
+			int idx = (e - b) / 2 + b;
+			if (t >= pos[idx]) b = idx; else e = idx;
+		}
+		float d = pos[e] - pos[b];
+		float w = d > 0 ? (t - pos[b]) / d: 0;
+		return Color4f(s->colors[b] + (s->colors[e] - s->colors[b]) * w);
+	}
+
+	void SC_Shader::shade(int x, int y, int len, uint32_t *out) const {
+		if (kind == kColor_Kind) {
+			for (int i = 0; i < len; i++) out[i] = color32;
+			return;
+		}
+		// map pixel centers to paint local space, stepping incrementally along the row
+		Vec2 p = inv * Vec2(x + 0.5f, y + 0.5f);
+		Vec2 dx(inv[0], inv[3]);
+
+		if (kind == kGradient_Kind) {
+			Vec2 axis = endOrRadius - origin;
+			float axisLenSq = axis.dot(axis);
+			for (int i = 0; i < len; i++, p += dx) {
+				float t = gradientType == PaintGradient::kRadial_Type ?
+					((p - origin) / endOrRadius).length():
+					axisLenSq > 0 ? axis.dot(p - origin) / axisLenSq: 0;
+				out[i] = sc_color32(sc_gradient(this, t).mul(color));
+			}
+			return;
+		}
+
+		Vec2 scale(1.0f / coord.end[0], 1.0f / coord.end[1]);
+		Vec2 uv = (coord.begin + p) * scale, duv = dx * scale;
+
+		if (kind == kSDFMask_Kind) {
+			Vec2 duvY = Vec2(inv[1], inv[4]) * scale;
+			for (int i = 0; i < len; i++, uv += duv) {
+				float dist = sc_sample_f32(this, uv[0], uv[1]);
+				float width = fabsf(sc_sample_f32(this, uv[0] + duv[0], uv[1] + duv[1]) - dist) +
+					fabsf(sc_sample_f32(this, uv[0] + duvY[0], uv[1] + duvY[1]) - dist);
+				width = Qk_Max(width, 1e-4f);
+				float t = F32::clamp((dist - stroke) / width, 0, 1);
+				float alpha = 1.0f - t * t * (3.0f - 2.0f * t); // 1 - smoothstep
+				float m = F32::clamp(dist, 0, 1);
+				out[i] = sc_color32(Color4f(color + (strokeColor - color) * m) * alpha);
+			}
+			return;
+		}
+
+		for (int i = 0; i < len; i++, uv += duv) {
+			uint32_t texel = sc_sample(this, uv[0], uv[1]);
+			out[i] = kind == kMask_Kind ?
+				sc_scale(color32, sc_alpha(texel)): sc_scale_color(texel, color32);
+		}
+	}
+
+	// ----------------------------- C o m m a n d s -----------------------------
+
+	void SC_Cmd::prepare() {}
+	void SC_Cmd::exec() {}
+
+	void SC_FillCmd::prepare() {
+		if (!shader.prepare())
+			bounds = {IVec2(0), IVec2(0)};
+	}
+
+	void SC_TrianglesCmd::prepare() {
+		tex = sc_texture(*image);
+		if (!tex || tex->type() != kRGBA_8888_ColorType)
+			bounds = {IVec2(0), IVec2(0)};
+	}
+
+	SC_FillCmd::~SC_FillCmd() {
+		for (auto o: outlines)
+			delete o;
+	}
+
+	SC_ClipCmd::~SC_ClipCmd() {
+		delete outline;
+	}
+
+	struct SC_FillCtx {
+		SC_FillCmd *cmd;
+		SC_Band    *band;
+	};
+
+	static void sc_fill_spans(int count, const Qk_FT_Span *spans, void *user) {
+		auto ctx = static_cast<SC_FillCtx*>(user);
+		auto cmd = ctx->cmd;
+		auto band = ctx->band;
+		auto &shader = cmd->shader;
+		for (int i = 0; i < count; i++) {
+			auto &span = spans[i];
+			uint8_t coverage = span.coverage;
+			if (!cmd->antiAlias) {
+				if (coverage < 128) continue;
+				coverage = 255;
+			}
+			int x = span.x, y = span.y, len = span.len;
+			uint32_t *dst = sc_row(cmd->target, y) + x;
+			const uint8_t *cover = nullptr;
+			if (cmd->clip) {
+				cmd->clip->rowCoverage(x, y, len, band->cover);
+				cover = band->cover;
+			}
+			if (shader.kind == SC_Shader::kColor_Kind && !cover) {
+				sc_blend_solid(cmd->mode, dst, shader.color32, coverage, len);
+			} else {
+				shader.shade(x, y, len, band->colors);
+				sc_blend_row(cmd->mode, dst, band->colors, cover, coverage, len);
+			}
+		}
+	}
+
+	void SC_FillCmd::draw(SC_Band &band) {
+		SC_FillCtx ctx{this, &band};
+		for (auto o: outlines) {
+			auto b = o->bounds();
+			sc_raster(o,
+				Qk_Max(b.begin.x(), bounds.begin.x()), Qk_Max(b.begin.y(), band.top),
+				Qk_Min(b.end.x(), bounds.end.x()), Qk_Min(b.end.y(), band.bottom), sc_fill_spans, &ctx
+			);
+		}
+	}
+
+	struct SC_ClipCtx {
+		SC_ClipCmd *cmd;
+	};
+
+	static void sc_clip_spans(int count, const Qk_FT_Span *spans, void *user) {
+		auto cmd = static_cast<SC_ClipCtx*>(user)->cmd;
+		auto clip = *cmd->clip;
+		int left = clip->bounds.begin.x();
+		for (int i = 0; i < count; i++) {
+			auto &span = spans[i];
+			uint8_t coverage = span.coverage;
+			if (!cmd->antiAlias)
+				coverage = coverage < 128 ? 0: 255;
+			memset(clip->row(span.y) + span.x - left, coverage, span.len);
+		}
+	}
+
+	void SC_ClipCmd::draw(SC_Band &band) {
+		auto c = *clip;
+		int top = Qk_Max(c->bounds.begin.y(), band.top);
+		int bottom = Qk_Min(c->bounds.end.y(), band.bottom);
+		int left = c->bounds.begin.x(), right = c->bounds.end.x();
+		int w = right - left;
+		if (top >= bottom || w <= 0)
+			return;
+		memset(c->row(top), 0, (bottom - top) * w);
+		SC_ClipCtx ctx{this};
+		sc_raster(outline, left, top, right, bottom, sc_clip_spans, &ctx);
+		// combine with the parent clip, a null parent covers everything
+		bool diff = op == Canvas::kDifference_ClipOp;
+		for (int y = top; y < bottom; y++) {
+			uint8_t *row = c->row(y);
+			if (parent) {
+				parent->rowCoverage(left, y, w, band.cover);
+				for (int x = 0; x < w; x++)
+					row[x] = sc_mul255(band.cover[x], diff ? 255 - row[x]: row[x]);
+			} else if (diff) {
+				for (int x = 0; x < w; x++)
+					row[x] = 255 - row[x];
+			}
+		}
+	}
+
+	void SC_ClearCmd::draw(SC_Band &band) {
+		int top = Qk_Max(bounds.begin.y(), band.top);
+		int bottom = Qk_Min(bounds.end.y(), band.bottom);
+		int left = bounds.begin.x(), len = bounds.end.x() - left;
+		for (int y = top; y < bottom; y++) {
+			uint32_t *dst = sc_row(target, y) + left;
+			for (int x = 0; x < len; x++)
+				dst[x] = color;
+		}
+	}
+
+	// erf approximation, same as in `color_rrect_blur.glsl`
+	inline float sc_erf(float x) {
+		float s = x < 0 ? -1: 1, a = fabsf(x);
+		x = 1.0f + (0.278393f + (0.230389f + 0.078108f * (a * a)) * a) * a;
+		x *= x;
+		return s - s / (x * x);
+	}
+
+	void SC_RRectBlurCmd::draw(SC_Band &band) {
+		int top = Qk_Max(bounds.begin.y(), band.top);
+		int bottom = Qk_Min(bounds.end.y(), band.bottom);
+		int left = bounds.begin.x(), len = bounds.end.x() - left;
+		if (top >= bottom || len <= 0)
+			return;
+		auto &rect = rrect.rect;
+		float s = Qk_Max(blur, 0.5f);
+		float s0 = s * 1.15f, s1 = s * 2.0f;
+		float min_edge = Qk_Min(rect.size[0], rect.size[1]);
+		float rmax = 0.5f * min_edge;
+		float s_inv = 1.0f / s;
+		Vec2 halfSize = rect.size * 0.5f;
+		Vec2 center = rect.begin + halfSize;
+		float r1[4], n[4], n_inv[4];
+		for (int i = 0; i < 4; i++) { // corners lt,rt,rb,lb
+			float r0 = F32::min(Vec2(rrect.radii[i], s0).length(), rmax);
+			r1[i] = F32::min(Vec2(rrect.radii[i], s1).length(), rmax);
+			n[i] = 2.0f * r1[i] / r0;
+			n_inv[i] = 1.0f / n[i];
+		}
+		// diff clip
+		Vec2 cHalf = clipRRect.rect.size * 0.5f;
+		Vec2 cCenter = clipRRect.rect.begin + cHalf;
+		float cMinHalf = Qk_Min(cHalf[0], cHalf[1]);
+		Vec2 dx(inv[0], inv[3]);
+		float aa = Qk_Max(dx.length(), 1e-4f);
+		uint32_t *colors = band.colors;
+
+		for (int y = top; y < bottom; y++) {
+			Vec2 p = inv * Vec2(left + 0.5f, y + 0.5f);
+			for (int x = 0; x < len; x++, p += dx) {
+				bool right = p[0] >= center[0], lower = p[1] >= center[1];
+				int i = lower ? (right ? 2: 3): (right ? 1: 0);
+				float r = r1[i];
+				float qx = Qk_Max(fabsf(p[0] - center[0]) - halfSize[0] + r, 0.0f);
+				float qy = Qk_Max(fabsf(p[1] - center[1]) - halfSize[1] + r, 0.0f);
+				float d = powf(powf(qx, n[i]) + powf(qy, n[i]), n_inv[i]) - r;
+				float z = (sc_erf(s_inv * (d + min_edge)) - sc_erf(s_inv * d)) * 0.5f;
+				if (useClipRRect) {
+					bool cr = p[0] >= cCenter[0], cl = p[1] >= cCenter[1];
+					float radius = clipRRect.radii[cl ? (cr ? 2: 3): (cr ? 1: 0)];
+					radius = Qk_Min(radius, cMinHalf);
+					float ux = fabsf(p[0] - cCenter[0]) - cHalf[0] + radius;
+					float uy = fabsf(p[1] - cCenter[1]) - cHalf[1] + radius;
+					float dist = Qk_Min(Qk_Max(ux, uy), 0.0f) +
+						Vec2(Qk_Max(ux, 0.0f), Qk_Max(uy, 0.0f)).length() - radius;
+					float t = F32::clamp((dist + aa * 1.5f) / (aa * 2.0f), 0, 1);
+					z *= t * t * (3.0f - 2.0f * t);
+				}
+				colors[x] = sc_color32(color * F32::clamp(z, 0, 1));
+			}
+			const uint8_t *cover = nullptr;
+			if (clip) {
+				clip->rowCoverage(left, y, len, band.cover);
+				cover = band.cover;
+			}
+			sc_blend_row(mode, sc_row(target, y) + left, colors, cover, 255, len);
+		}
+	}
+
+	void SC_TrianglesCmd::draw(SC_Band &band) {
+		int w = tex->width(), h = tex->height();
+		auto v = verts.val();
+		for (uint32_t k = 0; k + 2 < indices.length(); k += 3) {
+			auto &a = v[indices[k]], &b = v[indices[k+1]], &c = v[indices[k+2]];
+			float area = (b.pos - a.pos).det(c.pos - a.pos);
+			if (area == 0) continue;
+			float area_inv = 1.0f / area;
+			Vec2 min = a.pos.min(b.pos).min(c.pos), max = a.pos.max(b.pos).max(c.pos);
+			int x0 = Qk_Max(int(floorf(min[0])), bounds.begin.x());
+			int x1 = Qk_Min(int(ceilf(max[0])), bounds.end.x());
+			int y0 = Qk_Max(int(floorf(min[1])), band.top);
+			int y1 = Qk_Min(int(ceilf(max[1])), band.bottom);
+			for (int y = y0; y < y1; y++) {
+				uint32_t *dst = sc_row(target, y);
+				if (clip)
+					clip->rowCoverage(x0, y, x1 - x0, band.cover);
+				for (int x = x0; x < x1; x++) {
+					Vec2 p(x + 0.5f, y + 0.5f);
+					// barycentric weights, pixel centers on the edge belong to the triangle
+					float wa = (b.pos - p).det(c.pos - p) * area_inv;
+					float wb = (c.pos - p).det(a.pos - p) * area_inv;
+					float wc = 1.0f - wa - wb;
+					if (wa < 0 || wb < 0 || wc < 0) continue;
+					Vec2 uv = a.uv * wa + b.uv * wb + c.uv * wc;
+					int tx = F32::clamp(uv[0] * w, 0, w - 1), ty = F32::clamp(uv[1] * h, 0, h - 1);
+					Color4f t = sc_color4f(sc_fetch(tex, tx, ty));
+					Color4f light = Color4f(a.light * wa + b.light * wb + c.light * wc);
+					Color4f out = Color4f(light * t);
+					if (darkColor) {
+						Color4f dark = Color4f(a.dark * wa + b.dark * wb + c.dark * wc);
+						out = Color4f(out + dark * Color4f(t[3] - t[0], t[3] - t[1], t[3] - t[2], 0));
+					}
+					uint32_t s = sc_color32(out);
+					if (clip)
+						s = sc_scale(s, band.cover[x - x0]);
+					dst[x] = sc_blend(mode, s, dst[x]);
+				}
+			}
+		}
+	}
+
+	void SC_ReadImageCmd::exec() {
+		auto dst = sc_texture(*image);
+		if (!dst || dst->type() != kRGBA_8888_ColorType)
+			return;
+		SC_Shader shader;
+		shader.kind = SC_Shader::kImage_Kind;
+		shader.tex = target;
+		shader.linear = true;
+		// dst pixel => source target pixel
+		Vec2 scale = (src.end - src.begin) / dst->size();
+		shader.coord = {src.begin / scale, target->size() / scale};
+		shader.inv = Mat(1);
+		shader.color32 = 0xffffffff;
+		int w = dst->width();
+		Array<uint32_t> colors(w);
+		for (int y = 0; y < dst->height(); y++) {
+			shader.shade(0, y, w, colors.val());
+			sc_blend_row(mode, sc_row(dst, y), colors.val(), nullptr, 255, w);
+		}
+	}
+
+	// ----------------------------- C m d L i s t -----------------------------
+
+	void SC_CmdList::clear() {
+		for (auto cmd: _cmds)
+			delete cmd;
+		_cmds.clear();
+	}
+
+	void SC_CmdList::swap(SC_CmdList &list) {
+		auto tmp = std::move(_cmds);
+		_cmds = std::move(list._cmds);
+		list._cmds = std::move(tmp);
+	}
+
+	void SC_CmdList::playback() {
+		uint32_t begin = 0, len = _cmds.length();
+		for (uint32_t i = 0; i < len; i++) {
+			if (_cmds[i]->barrier) {
+				playSegment(begin, i);
+				_cmds[i]->exec();
+				begin = i + 1;
+			}
+		}
+		playSegment(begin, len);
+		clear();
+	}
+
+	void SC_CmdList::playSegment(uint32_t begin, uint32_t end) {
+		if (begin >= end)
+			return;
+		auto cmds = _cmds.val();
+		auto target = cmds[begin]->target;
+		int top = target->height(), bottom = 0;
+		for (uint32_t i = begin; i < end; i++) {
+			Qk_ASSERT(cmds[i]->target == target, "SC_CmdList::playSegment, mixed targets in segment");
+			cmds[i]->prepare();
+			top = Qk_Min(top, cmds[i]->bounds.begin.y());
+			bottom = Qk_Max(bottom, cmds[i]->bounds.end.y());
+		}
+		top = Qk_Max(top, 0);
+		bottom = Qk_Min(bottom, target->height());
+		if (top >= bottom)
+			return;
+		// Split the rows into horizontal bands, each band runs the whole command
+		// sequence in order, so the output doesn't depend on the thread count.
+		int rows = bottom - top;
+		int bands = Qk_Min(int(parallel_concurrency() * 4), Qk_Max(rows / 16, 1));
+		int bandRows = (rows + bands - 1) / bands;
+		int width = target->width();
+
+		parallel_for(bands, [&](uint32_t i) {
+			SC_Band band;
+			band.top = top + i * bandRows;
+			band.bottom = Qk_Min(band.top + bandRows, bottom);
+			if (band.top >= band.bottom)
+				return;
+			auto &scratch = tls_scratch;
+			scratch.alloc(width);
+			band.colors = scratch.colors;
+			band.cover = scratch.cover;
+			for (uint32_t j = begin; j < end; j++) {
+				auto cmd = cmds[j];
+				if (cmd->bounds.begin.y() < band.bottom && cmd->bounds.end.y() > band.top &&
+						cmd->bounds.begin.x() < cmd->bounds.end.x())
+					cmd->draw(band);
+			}
+		});
+	}
+
+}
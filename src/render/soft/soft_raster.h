@@ -0,0 +1,244 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+// @private head
+
+#ifndef __quark_render_soft_raster__
+#define __quark_render_soft_raster__
+
+#include "../canvas.h"
+#include "../source.h"
+#include "./soft_blend.h"
+
+struct Qk_FT_Outline_;
+
+namespace qk {
+
+	/**
+	 * Pixel storage of a soft texture, kept in `TexStat::ptr()` by SoftRender.
+	 * Color images are converted to premultiplied kRGBA_8888 on upload,
+	 * alpha, gray and luminance images are kept as kAlpha_8 and distance fields as kSDF_F32.
+	 */
+	typedef Pixel SC_Texture;
+
+	/**
+	 * Returns the soft texture of the image, or null if it was not uploaded by the soft render
+	*/
+	SC_Texture* sc_texture(const ImageSource *img);
+
+	/**
+	 * Defer deleting a replaced or unloaded soft texture until the current playback has finished,
+	 * `sc_texture_collect()` is called by the render thread after each playback
+	*/
+	void sc_texture_retire(SC_Texture *tex);
+	void sc_texture_collect();
+
+	/**
+	 * Device-space outline in 26.6 fixed point, the input format of the gray rasterizer
+	*/
+	class SC_Outline {
+		Qk_DISABLE_COPY(SC_Outline);
+	public:
+		SC_Outline(const Path &path, const Mat &mat, bool evenOdd = false);
+		SC_Outline(const Vec2 quad[4]); // device-space quadrilateral
+		~SC_Outline();
+		inline Qk_FT_Outline_* outline() const { return _outline; }
+		inline IRange bounds() const { return _bounds; } // integer pixel bounds
+	private:
+		Qk_FT_Outline_ *_outline;
+		IRange _bounds;
+	};
+
+	/**
+	 * A horizontal strip of the target rasterized by one thread, with its scratch rows
+	*/
+	struct SC_Band {
+		int top, bottom; // rows [top,bottom)
+		uint32_t *colors; // scratch row of shaded colors, target width
+		uint8_t  *cover; // scratch row of coverage values, target width
+	};
+
+	/**
+	 * Clip coverage mask in target pixels, coverage outside of `bounds` is `outside`
+	*/
+	struct SC_Clip: Reference {
+		IRange   bounds;
+		uint8_t  outside; // 0 or 255
+		Array<uint8_t> mask; // row-major coverage of bounds
+		inline uint8_t* row(int y) {
+			return mask.val() + (y - bounds.begin.y()) * (bounds.end.x() - bounds.begin.x());
+		}
+		// write coverage of [x,x+len) on row y to `out`
+		void rowCoverage(int x, int y, int len, uint8_t *out) const;
+	};
+
+	/**
+	 * Computes premultiplied source colors for device pixels
+	*/
+	struct SC_Shader {
+		enum Kind {
+			kColor_Kind,
+			kGradient_Kind,
+			kImage_Kind,
+			kMask_Kind, // color * texture alpha
+			kSDFMask_Kind, // color/strokeColor with distance field texture
+		};
+		Kind      kind = kColor_Kind;
+		Color4f   color; // premultiplied color
+		uint32_t  color32 = 0; // premultiplied rgba8 color
+		Mat       inv; // device pixel space => paint local space
+		// gradient
+		PaintGradient::Type gradientType = PaintGradient::kLinear_Type;
+		Vec2      origin, endOrRadius;
+		Array<Color4f> colors; // premultiplied stop colors
+		Array<float> positions;
+		// image
+		Sp<ImageSource> image; // keep texture alive until drawn
+		const SC_Texture *tex = nullptr; // resolved from image by prepare()
+		Range     coord; // uv = (coord.begin + local) / coord.end
+		PaintImage::TileMode tileX = PaintImage::kClamp_TileMode, tileY = PaintImage::kClamp_TileMode;
+		bool      linear = false;
+		Color4f   strokeColor; // premultiplied, sdf mask only
+		float     stroke = 0;
+
+		void setColor(const Color4f &color); // set unpremultiplied color
+		bool setPaint(const PaintStyle &style, const PaintImage *mask, const Mat &deviceMatrix);
+		bool prepare(); // resolve texture before playback, return false if it cannot be drawn
+		void shade(int x, int y, int len, uint32_t *out) const;
+	};
+
+	/**
+	 * Recorded soft canvas command, executed band by band on the render thread
+	*/
+	class SC_Cmd {
+	public:
+		virtual ~SC_Cmd() = default;
+		/** Called serially before the segment of the command is played back */
+		virtual void prepare();
+		/** Draw the part of the command that falls into the band rows */
+		virtual void draw(SC_Band &band) = 0;
+		/** Runs barrier commands once after all prior commands have completed */
+		virtual void exec();
+		SC_Texture *target = nullptr; // output pixel buffer
+		IRange bounds; // affected target pixels
+		bool barrier = false;
+	};
+
+	class SC_FillCmd: public SC_Cmd {
+	public:
+		void prepare() override;
+		void draw(SC_Band &band) override;
+		Array<SC_Outline*> outlines; // owned, drawn in sequence
+		SC_Shader   shader;
+		BlendMode   mode = kSrcOver_BlendMode;
+		Sp<SC_Clip> clip;
+		bool        antiAlias = true;
+		~SC_FillCmd() override;
+	};
+
+	class SC_ClipCmd: public SC_Cmd {
+	public:
+		void draw(SC_Band &band) override;
+		SC_Outline *outline = nullptr; // owned
+		Sp<SC_Clip> clip, parent; // build `clip` from `parent` and outline
+		Canvas::ClipOp op = Canvas::kIntersect_ClipOp;
+		bool        antiAlias = true;
+		~SC_ClipCmd() override;
+	};
+
+	class SC_ClearCmd: public SC_Cmd {
+	public:
+		void draw(SC_Band &band) override;
+		uint32_t color = 0;
+	};
+
+	class SC_RRectBlurCmd: public SC_Cmd {
+	public:
+		void draw(SC_Band &band) override;
+		RRect     rrect, clipRRect; // paint local space
+		Mat       inv; // device pixel space => paint local space
+		float     blur = 0;
+		Color4f   color; // premultiplied
+		BlendMode mode = kSrcOver_BlendMode;
+		Sp<SC_Clip> clip;
+		bool      useClipRRect = false;
+	};
+
+	class SC_TrianglesCmd: public SC_Cmd {
+	public:
+		void prepare() override;
+		void draw(SC_Band &band) override;
+		struct Vertex { Vec2 pos, uv; Color4f light, dark; };
+		Array<Vertex>   verts; // device space, premultiplied colors
+		Array<uint16_t> indices;
+		Sp<ImageSource> image;
+		const SC_Texture *tex = nullptr;
+		bool        darkColor = false;
+		BlendMode   mode = kSrcOver_BlendMode;
+		Sp<SC_Clip> clip;
+	};
+
+	class SC_ReadImageCmd: public SC_Cmd {
+	public:
+		SC_ReadImageCmd() { barrier = true; }
+		void draw(SC_Band &band) override {}
+		void exec() override;
+		Range      src; // source range in target pixels
+		Sp<ImageSource> image; // destination image
+		BlendMode  mode = kSrc_BlendMode;
+	};
+
+	class SC_BarrierCmd: public SC_Cmd {
+	public:
+		SC_BarrierCmd() { barrier = true; }
+		void draw(SC_Band &band) override {}
+		Sp<ImageSource> hold; // keep output image alive until played back
+	};
+
+	/**
+	 * Command list of one frame, played back in parallel horizontal bands
+	*/
+	class SC_CmdList {
+		Qk_DISABLE_COPY(SC_CmdList);
+	public:
+		SC_CmdList() = default;
+		~SC_CmdList() { clear(); }
+		inline void push(SC_Cmd *cmd) { _cmds.push(cmd); }
+		inline bool isEmpty() const { return _cmds.length() == 0; }
+		void clear();
+		void playback();
+		void swap(SC_CmdList &list);
+	private:
+		void playSegment(uint32_t begin, uint32_t end);
+		Array<SC_Cmd*> _cmds;
+	};
+
+}
+#endif
@@ -0,0 +1,436 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include "../../util/thread.h"
+#include "./soft_render.h"
+
+namespace qk {
+	void* acquireRenderBackendStorage(size_t typeHash, size_t size);
+
+	static inline uint32_t sc_pack(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+		return r | (g << 8) | (b << 16) | (a << 24);
+	}
+
+	static inline uint32_t sc_premul(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+		if (a == 255)
+			return sc_pack(r, g, b, a);
+		return sc_pack(sc_mul255(r, a), sc_mul255(g, a), sc_mul255(b, a), a);
+	}
+
+	TexStat sc_new_texture_stat(Vec2 size, ColorType type) {
+		switch (type) {
+			case kAlpha_8_ColorType:
+			case kSDF_F32_ColorType:
+			case kSDF_Unsigned_F32_ColorType: break;
+			default: type = kRGBA_8888_ColorType; break;
+		}
+		PixelInfo info(size[0], size[1], type, kPremul_AlphaType);
+		Buffer buf = Buffer::alloc(info.bytes());
+		memset(*buf, 0, buf.length());
+		return TexStat(new Pixel(info, std::move(buf)));
+	}
+
+	/**
+	 * Convert the source pixels to the storage format used by soft raster,
+	 * kRGBA_8888 premultiplied, kAlpha_8 or float distance field.
+	*/
+	static SC_Texture* sc_convert_pixel(const Pixel *pix) {
+		const int w = pix->width(), h = pix->height();
+		const uint32_t srcRow = pix->rowbytes();
+		const uint8_t *src = pix->val();
+		const bool unpremul = pix->alphaType() == kUnpremul_AlphaType;
+		auto type = pix->type();
+
+		if (!src || w <= 0 || h <= 0)
+			return nullptr;
+
+		if (type == kAlpha_8_ColorType ||
+				type == kSDF_F32_ColorType || type == kSDF_Unsigned_F32_ColorType) {
+			PixelInfo info(w, h, type, kPremul_AlphaType);
+			Buffer buf = Buffer::alloc(info.bytes());
+			auto dstRow = info.rowbytes();
+			auto len = U32::min(dstRow, srcRow);
+			for (int y = 0; y < h; y++)
+				memcpy(*buf + dstRow * y, src + srcRow * y, len);
+			return new Pixel(info, std::move(buf));
+		}
+
+		PixelInfo info(w, h, kRGBA_8888_ColorType, kPremul_AlphaType);
+		Buffer buf = Buffer::alloc(info.bytes());
+
+		for (int y = 0; y < h; y++) {
+			auto s = src + srcRow * y;
+			auto d = reinterpret_cast<uint32_t*>(*buf + info.rowbytes() * y);
+			auto s16 = reinterpret_cast<const uint16_t*>(s);
+			switch (type) {
+				case kRGBA_8888_ColorType:
+					if (unpremul) {
+						for (int x = 0; x < w; x++, s += 4)
+							d[x] = sc_premul(s[0], s[1], s[2], s[3]);
+					} else {
+						memcpy(d, s, w << 2);
+					}
+					break;
+				case kRGB_888X_ColorType:
+					for (int x = 0; x < w; x++, s += 4)
+						d[x] = sc_pack(s[0], s[1], s[2], 255);
+					break;
+				case kBGRA_8888_ColorType:
+					for (int x = 0; x < w; x++, s += 4)
+						d[x] = unpremul ? sc_premul(s[2], s[1], s[0], s[3]): sc_pack(s[2], s[1], s[0], s[3]);
+					break;
+				case kBGR_888X_ColorType:
+					for (int x = 0; x < w; x++, s += 4)
+						d[x] = sc_pack(s[2], s[1], s[0], 255);
+					break;
+				case kRGB_888_ColorType:
+					for (int x = 0; x < w; x++, s += 3)
+						d[x] = sc_pack(s[0], s[1], s[2], 255);
+					break;
+				case kRGB_565_ColorType:
+					for (int x = 0; x < w; x++) {
+						uint32_t c = s16[x], r = c >> 11, g = (c >> 5) & 63, b = c & 31;
+						d[x] = sc_pack((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255);
+					}
+					break;
+				case kRGBA_4444_ColorType:
+				case kRGB_444X_ColorType:
+					for (int x = 0; x < w; x++) {
+						uint32_t c = s16[x];
+						uint32_t a = type == kRGB_444X_ColorType ? 255: (c & 15) * 17;
+						uint32_t r = (c >> 12) * 17, g = ((c >> 8) & 15) * 17, b = ((c >> 4) & 15) * 17;
+						d[x] = unpremul ? sc_premul(r, g, b, a): sc_pack(r, g, b, a);
+					}
+					break;
+				case kRGBA_5551_ColorType:
+					for (int x = 0; x < w; x++) {
+						uint32_t c = s16[x], r = c >> 11, g = (c >> 6) & 31, b = (c >> 1) & 31;
+						uint32_t a = c & 1 ? 255: 0;
+						d[x] = sc_premul((r << 3) | (r >> 2), (g << 3) | (g >> 2), (b << 3) | (b >> 2), a);
+					}
+					break;
+				case kGray_8_ColorType:
+					for (int x = 0; x < w; x++)
+						d[x] = sc_pack(s[x], s[x], s[x], 255);
+					break;
+				case kLuminance_Alpha_88_ColorType:
+					for (int x = 0; x < w; x++, s += 2)
+						d[x] = sc_premul(s[0], s[0], s[0], s[1]);
+					break;
+				default:
+					Qk_DLog("SoftRender: unsupported texture color type %d", type);
+					return nullptr;
+			}
+		}
+		return new Pixel(info, std::move(buf));
+	}
+
+	static bool sc_upload_texture(Pixel *pix, TexStat *tex) {
+		auto newTex = sc_convert_pixel(pix); // only use level 0, the sampler filters itself
+		if (!newTex)
+			return false;
+		auto old = static_cast<SC_Texture*>(tex->ptr());
+		tex->set_ptr(newTex);
+		if (old)
+			sc_texture_retire(old); // maybe it is being read by the playback
+		return true;
+	}
+
+	static void sc_unload_texture(TexStat *tex) {
+		auto old = static_cast<SC_Texture*>(tex->ptr());
+		if (old) {
+			tex->set_ptr(nullptr);
+			sc_texture_retire(old);
+		}
+	}
+
+	void SoftRenderResource::post_message(Cb cb) {
+		_loop->post(cb);
+	}
+
+	bool SoftRenderResource::uploadTexture(Pixel *pix, int levels, TexStat *tex, bool mipmap) {
+		return sc_upload_texture(pix, tex);
+	}
+
+	void SoftRenderResource::unloadTexture(TexStat *tex) {
+		sc_unload_texture(tex);
+	}
+
+	TexStat SoftRenderResource::createTextureStat(Vec2 size, ColorType type, uint8_t flags) {
+		return sc_new_texture_stat(size, type);
+	}
+
+	// --------------------------------------------------
+
+	SoftRender::SoftRender(Options opts)
+		: RenderBackend(opts)
+		, _softcanvas(nullptr)
+		, _isRun(true)
+#if Qk_LINUX || Qk_ANDROID
+		, _window(0)
+#endif
+#if Qk_LINUX
+		, _gc(nullptr)
+#endif
+	{
+		_softcanvas = NewRetain<SoftCanvas>(this, _opts);
+		_canvas = _softcanvas; // set default canvas
+		_opts.colorType = kRGBA_8888_ColorType;
+	}
+
+	SoftRender::~SoftRender() {
+		Qk_CHECK(_softcanvas == nullptr);
+		Qk_CHECK(_msg.length() == 0);
+	}
+
+	void SoftRender::release() {
+		{
+			std::lock_guard<RecursiveMutex> lock(_mutex);
+			_isRun = false;
+		}
+		stopRenderLoop();
+		Qk_CHECK(_softcanvas->refCount() == 1,
+			"SoftCanvas still has reference, ref count: %d", _softcanvas->refCount());
+		Releasep(_softcanvas);
+		_canvas = nullptr;
+		resolvedMsg(true);
+#if Qk_LINUX || Qk_ANDROID
+		deleteSurface();
+#endif
+		Object::release(); // final destruction
+	}
+
+	void SoftRender::reload() {
+		auto size = getSurfaceSize();
+		if (size == _surfaceSize || size.is_zero_axis())
+			return;
+		std::lock_guard<RecursiveMutex> lock(_mutex);
+		_surfaceSize = size;
+		_delegate->onRenderBackendReload(_surfaceSize);
+	}
+
+	Canvas* SoftRender::createCanvas(Options opts) {
+		return new SoftCanvas(this, opts);
+	}
+
+	RenderSurface* SoftRender::surface() {
+#if Qk_LINUX || Qk_ANDROID
+		return this;
+#else
+		return nullptr;
+#endif
+	}
+
+	TexStat SoftRender::createTextureStat(Vec2 size, ColorType type, uint8_t flags) {
+		return sc_new_texture_stat(size, type);
+	}
+
+	bool SoftRender::uploadTexture(Pixel *pix, int levels, TexStat *tex, bool mipmap) {
+		return sc_upload_texture(pix, tex);
+	}
+
+	void SoftRender::unloadTexture(TexStat *tex) {
+		sc_unload_texture(tex);
+	}
+
+	bool SoftRender::uploadVertexData(VertexData::ID *id) {
+		return false; // soft canvas rasterizes the path directly, no vertex buffer
+	}
+
+	void SoftRender::unloadVertexData(VertexData::ID *id) {}
+
+	void SoftRender::post_message(Cb cb) {
+		if (_threadId == thread_self_id()) {
+			std::lock_guard<RecursiveMutex> lock(_mutex);
+			cb->resolve();
+		} else if (_threadId == ThreadID()) { // No run
+			if (_mutexMsg.try_lock()) {
+				_msg.push(cb);
+				_mutexMsg.unlock();
+			} else {
+				cb->resolve();
+			}
+		} else {
+			ScopeLock lock(_mutexMsg);
+			_msg.push(cb);
+		}
+	}
+
+	void SoftRender::resolvedMsg(bool destroy) {
+		if (destroy) {
+			ScopeLock lock(_mutexMsg);
+			if (_msg.length()) {
+				std::lock_guard<RecursiveMutex> lock(_mutex);
+				for (auto &i : _msg)
+					i->resolve();
+				_msg.clear();
+			}
+		} else if (_msg.length()) {
+			_mutexMsg.lock();
+			auto msg(std::move(_msg));
+			_mutexMsg.unlock();
+			for ( auto &i : msg )
+				i->resolve();
+		}
+	}
+
+	void SoftRender::setHeadlessSize(Vec2 size) {
+		_headlessSize = size;
+		reload();
+	}
+
+	Vec2 SoftRender::getSurfaceSize() {
+#if Qk_ANDROID
+		if (_window)
+			return Vec2(ANativeWindow_getWidth(_window), ANativeWindow_getHeight(_window));
+#elif Qk_LINUX
+		if (_window) {
+			XWindowAttributes attrs;
+			auto xwin = static_cast<XWindow>(_window);
+			Qk_ASSERT_EQ(1, XGetWindowAttributes(openXDisplay(), xwin, &attrs), "Failed to get X window attributes");
+			return Vec2(attrs.width, attrs.height);
+		}
+#endif
+		return _headlessSize;
+	}
+
+	void SoftRender::renderDisplay() {
+		std::lock_guard<RecursiveMutex> lock(_mutex);
+		if (!_isRun)
+			return;
+		resolvedMsg(false);
+		if (_delegate->onRenderBackendDisplay()) {
+			Canvas::SubmitScope submit(_softcanvas); // profile submit time, including present
+			_softcanvas->flushBuffer([this](const Pixel &colors) {
+				present(colors);
+			});
+		}
+	}
+
+	void SoftRender::present(const Pixel &colors) {
+		const int w = colors.width(), h = colors.height();
+		auto src = colors.val();
+#if Qk_ANDROID
+		if (!_window)
+			return;
+		ANativeWindow_Buffer buffer;
+		ANativeWindow_setBuffersGeometry(_window, w, h, WINDOW_FORMAT_RGBA_8888);
+		if (ANativeWindow_lock(_window, &buffer, nullptr) == 0) {
+			auto rows = I32::min(h, buffer.height);
+			auto len = I32::min(w, buffer.width) << 2;
+			for (int y = 0; y < rows; y++)
+				memcpy((uint8_t*)buffer.bits + (buffer.stride << 2) * y, src + colors.rowbytes() * y, len);
+			ANativeWindow_unlockAndPost(_window);
+		}
+#elif Qk_LINUX
+		if (!_window)
+			return;
+		auto dpy = openXDisplay();
+		auto xwin = static_cast<XWindow>(_window);
+		// X11 default visual is little endian BGRX
+		_presentBuffer.extend(w * h);
+		auto dst = _presentBuffer.val();
+		for (int y = 0; y < h; y++) {
+			auto s = reinterpret_cast<const uint32_t*>(src + colors.rowbytes() * y);
+			auto d = dst + w * y;
+			for (int x = 0; x < w; x++) {
+				uint32_t c = s[x];
+				d[x] = ((c & 0xff) << 16) | (c & 0xff00) | ((c >> 16) & 0xff);
+			}
+		}
+		if (!_gc)
+			_gc = XCreateGC(dpy, xwin, 0, nullptr);
+		XImage *img = XCreateImage(dpy, DefaultVisual(dpy, DefaultScreen(dpy)),
+			24, ZPixmap, 0, (char*)dst, w, h, 32, w << 2);
+		if (img) {
+			XPutImage(dpy, xwin, (GC)_gc, img, 0, 0, 0, 0, w, h);
+			img->data = nullptr; // the buffer is owned by _presentBuffer
+			img->f.destroy_image(img); // XDestroyImage()
+			XFlush(dpy);
+		}
+#endif
+	}
+
+	void SoftRender::runRenderLoop() {
+		if (_threadId != ThreadID())
+			return;
+
+		_threadId = thread_new([this](cThread* t) {
+			const int64_t intervalUs = 1e6 / 60; // 60 frames
+			while (!t->abort) {
+				auto sleepUs = time_monotonic();
+				renderDisplay();
+				sleepUs += intervalUs - time_monotonic();
+				if (sleepUs >= 0) {
+					thread_sleep(sleepUs);
+				}
+			}
+			_threadId = ThreadID();
+		}, "soft_render_Thread");
+	}
+
+	void SoftRender::stopRenderLoop() {
+		if (_threadId != ThreadID()) {
+			thread_try_abort(_threadId);
+			thread_join_for(_threadId);
+			_threadId = ThreadID();
+		}
+	}
+
+#if Qk_LINUX || Qk_ANDROID
+	void SoftRender::makeSurface(EGLNativeWindowType win) {
+		std::lock_guard<RecursiveMutex> lock(_mutex);
+		_window = win;
+	}
+
+	void SoftRender::deleteSurface() {
+		std::lock_guard<RecursiveMutex> lock(_mutex);
+#if Qk_LINUX
+		if (_gc) {
+			XFreeGC(openXDisplay(), (GC)_gc);
+			_gc = nullptr;
+		}
+		_presentBuffer.clear();
+#endif
+		_window = 0;
+		_surfaceSize = {}; // clear surface size
+	}
+#endif
+
+	Render* make_soft_render(Render::Options opts) {
+		auto mem = acquireRenderBackendStorage(typeid(SoftRender).hash_code(), sizeof(SoftRender));
+		return new (mem) SoftRender(opts);
+	}
+
+	RenderResource* get_shared_soft_render_resource() {
+		static SoftRenderResource* resource = new SoftRenderResource(current_loop());
+		return resource;
+	}
+}
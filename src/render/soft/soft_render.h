@@ -0,0 +1,124 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+// @private head
+
+#ifndef __quark_render_soft_render__
+#define __quark_render_soft_render__
+
+#include "../render.h"
+#include "../source.h"
+#include "./soft_canvas.h"
+#if Qk_LINUX || Qk_ANDROID
+# include "../plotforms.h"
+#endif
+
+namespace qk {
+
+	/**
+	 * Create a zero-filled soft texture, unsupported color types are stored as kRGBA_8888
+	*/
+	TexStat sc_new_texture_stat(Vec2 size, ColorType type);
+
+	/**
+	 * Global soft render resource, textures are converted on the calling thread
+	 */
+	class SoftRenderResource: public RenderResource, public PostMessage {
+	public:
+		explicit SoftRenderResource(RunLoop *loop): _loop(loop) {}
+		void post_message(Cb cb) override;
+		bool uploadTexture(Pixel *pix, int levels, TexStat *tex, bool mipmap) override;
+		void unloadTexture(TexStat *tex) override;
+		TexStat createTextureStat(Vec2 size, ColorType type, uint8_t flags) override;
+	private:
+		RunLoop *_loop;
+	};
+
+	/**
+	 * Render backend that draws with SoftCanvas and presents the color buffer
+	 * with XPutImage on Linux or ANativeWindow on Android.
+	 * Without a window it renders headless into a buffer of `setHeadlessSize()`.
+	 */
+	class SoftRender final: public RenderBackend, public PostMessage
+#if Qk_LINUX || Qk_ANDROID
+		, public RenderSurface
+#endif
+	{
+	public:
+		explicit SoftRender(Options opts);
+		~SoftRender() override;
+		void release() override;
+		void reload() override;
+		Canvas* createCanvas(Options opts) override;
+		RenderSurface* surface() override;
+		bool uploadTexture(Pixel *pix, int levels, TexStat *tex, bool mipmap) override;
+		void unloadTexture(TexStat *tex) override;
+		bool uploadVertexData(VertexData::ID *id) override;
+		void unloadVertexData(VertexData::ID *id) override;
+		void post_message(Cb cb) override;
+		void setHeadlessSize(Vec2 size); // surface size used when no window is attached
+#if Qk_LINUX || Qk_ANDROID
+		void makeSurface(EGLNativeWindowType win) override;
+		void deleteSurface() override;
+		void renderDisplay() override;
+		void runRenderLoop() override;
+		void stopRenderLoop() override;
+#else
+		void renderDisplay();
+		void runRenderLoop();
+		void stopRenderLoop();
+#endif
+		inline SoftCanvas* softCanvas() { return _softcanvas; }
+	protected:
+		TexStat createTextureStat(Vec2 size, ColorType type, uint8_t flags) override;
+		Vec2 getSurfaceSize() override;
+	private:
+		void present(const Pixel &colors);
+		void resolvedMsg(bool destroy);
+		SoftCanvas *_softcanvas;
+		Mutex     _mutexMsg;
+		Array<Cb> _msg;
+		ThreadID  _threadId;
+		RecursiveMutex _mutex;
+		Vec2      _headlessSize;
+		bool      _isRun;
+#if Qk_LINUX || Qk_ANDROID
+		EGLNativeWindowType _window;
+#endif
+#if Qk_LINUX
+		void      *_gc; // X11 graphics context
+		Array<uint32_t> _presentBuffer; // BGRX pixels for XPutImage
+#endif
+	};
+
+	Render* make_soft_render(Render::Options opts);
+	RenderResource* get_shared_soft_render_resource();
+}
+#endif
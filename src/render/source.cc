@@ -33,6 +33,9 @@
 #include "./codec/codec.h"
 #include "../util/codec.h"
 #include "./render.h"
+#include "../os/os.h"
+#include <algorithm>
+#include <math.h>
 #define Qk_ARM_NEON Qk_ARCH_ARM64
 #if Qk_ARM_NEON
 # include <arm_neon.h>
@@ -85,7 +88,7 @@ namespace qk {
 
 	ImageSource::ImageSource(RunLoop *loop): Qk_Init_Event(State)
 		, _state(kSTATE_NONE)
-		, _loadId(0), _res(nullptr), _loop(loop), _mipmap(true)
+		, _loadId(0), _res(nullptr), _loop(loop), _priority(RunLoop::kWorkLow), _mipmap(true)
 		, _premultipliedAlpha(false)
 		, _premulFlags(kConvert_PremulFlags)
 	{
@@ -149,6 +152,29 @@ namespace qk {
 		}
 	}
 
+	bool ImageSource::updateTexture(cPixel& src, IRect rect, RenderResource *first) {
+		AutoSharedMutexExclusive ame(_onState);
+		if (!_res || !_tex[0].ptr() || src.type() != _info.type() ||
+			src.width() != _info.width() || src.height() != _info.height() ||
+			rect.begin.x() < 0 || rect.begin.y() < 0 ||
+			rect.size.x() <= 0 || rect.size.y() <= 0 ||
+			rect.begin.x() + rect.size.x() > src.width() ||
+			rect.begin.y() + rect.size.y() > src.height()
+		) {
+			return false;
+		}
+		// copy the rect area as tightly packed rows
+		auto bpp = Pixel::bytes_per_pixel(src.type());
+		auto rowbytes = rect.size.x() * bpp;
+		PixelInfo info(rect.size.x(), rect.size.y(), src.type(), src.alphaType());
+		Buffer buf(rowbytes * rect.size.y());
+		auto s = src.val() + rect.begin.y() * src.rowbytes() + rect.begin.x() * bpp;
+		for (int y = 0; y < rect.size.y(); y++, s += src.rowbytes())
+			memcpy(*buf + y * rowbytes, s, rowbytes);
+		Pixel pix(info, std::move(buf));
+		return (first ? first: _res)->uploadTextureRect(&pix, rect, _tex, _mipmap);
+	}
+
 	void ImageSource::set_premulFlags(PremulFlags val) {
 		_premulFlags = val;
 	}
@@ -157,9 +183,17 @@ namespace qk {
 		_mipmap = val;
 	}
 
-	bool ImageSource::load() {
+	void ImageSource::set_decodeSize(Vec2 val) {
+		_decodeSize = val;
+	}
+
+	bool ImageSource::load(RunLoop::WorkPriority priority) {
 		if (_state & kSTATE_LOAD_COMPLETE)
 			return true;
+		if (priority < _priority.load(std::memory_order_relaxed))
+			_priority.store(priority, std::memory_order_relaxed); // raise the priority of the decoding not submitted yet
+		if (_state & kSTATE_LOAD_PARTIAL)
+			return true;
 		if (_state & (kSTATE_LOADING | kSTATE_LOAD_ERROR | kSTATE_DECODE_ERROR))
 			return false;
 
@@ -172,6 +206,11 @@ namespace qk {
 			_state = State(_state | kSTATE_LOADING);
 			Qk_Trigger(State, _state); // trigger
 
+			if (!fs_is_local_file(_uri) && !fs_is_local_zip(_uri)) {
+				loadStream(); // remote source, decode progressively
+				return;
+			}
+
 			_loadId = fs_reader()->read_file(_uri, Callback<Buffer>([this](auto e) { // read data
 				if (_state & kSTATE_LOADING) {
 					if (e.error || e.data->length() == 0) {
@@ -189,6 +228,76 @@ namespace qk {
 		return false;
 	}
 
+	void ImageSource::loadStream() {
+		struct Progressive: Callback<StreamResponse>::Core {
+			Progressive(ImageSource *source): source(source), decoder(source->_decodeSize) {}
+			void call(Data& e) override { // to call from mt
+				if (!(source->_state & kSTATE_LOADING))
+					return;
+				if (e.error) {
+					Qk_DLog("ImageSource::loadStream() kSTATE_LOAD_ERROR, %s", e.error->message().c_str());
+					fail();
+					return;
+				}
+				auto &res = e.data->value;
+				data.write(res.data.val(), res.data.length());
+
+				if (res.ended) {
+					source->_loadId = 0;
+					ended = true;
+					if (data.length()) {
+						source->decode(data); // final full decoding
+					} else {
+						fail();
+					}
+					return;
+				}
+
+				// Decode the received data again after it grows enough, at most 8 times for the known size
+				uint32_t len = data.length();
+				uint32_t step = Qk_Max(32 * 1024, (res.total > 0 ? uint32_t(res.total): len) >> 3);
+				if (!decoding && decoder.isSupported() && len - decodedLength >= step) {
+					decoding = true;
+					decodedLength = len;
+					New<Partial>()->run(this);
+				}
+			}
+			void fail() {
+				source->_loadId = 0;
+				source->_state = State((source->_state | kSTATE_LOAD_ERROR) & ~(kSTATE_LOADING | kSTATE_LOAD_PARTIAL));
+				source->Qk_Trigger(State, source->_state);
+			}
+			struct Partial: Cb::Core {
+				void call(Data& evt) override { // to call from mt
+					progressive->decoding = false;
+					auto source = progressive->source.get();
+					// discard it if the full data has been received or unloaded
+					if (completed && !progressive->ended && source->_state & kSTATE_LOADING) {
+						source->setPixels(pixels, State(source->_state | kSTATE_LOAD_PARTIAL));
+						source->Qk_Trigger(State, source->_state);
+					}
+				}
+				void run(Progressive *p) {
+					progressive = p;
+					data = p->data.copy(); // snapshot, the data continues to grow
+					p->source->_loop->work(Cb([this](auto e) {
+						completed = progressive->decoder.decode(data, &pixels);
+					}), Cb(this), p->source->_priority.load(std::memory_order_relaxed));
+				}
+				Sp<Progressive> progressive;
+				Buffer data;
+				Array<Pixel> pixels;
+				bool completed = false;
+			};
+			Sp<ImageSource> source; // hold source
+			Buffer data; // all of the data received so far
+			ImageProgressiveDecoder decoder; // only used by one work at a time
+			uint32_t decodedLength = 0; // data length of the last partial decoding
+			bool decoding = false, ended = false;
+		};
+		_loadId = fs_reader()->read_stream(_uri, New<Progressive>(this));
+	}
+
 	void ImageSource::decode(Buffer& data) {
 		struct Running: Cb::Core {
 			void call(Data& evt) override { // to call from mt
@@ -198,46 +307,52 @@ namespace qk {
 				}
 			}
 			void decode() {
-				completed = img_decode(data, &pixels);
+				completed = img_decode(data, &pixels, kUnknown_ImageFormat, size);
 			}
 			void run(ImageSource *source_, Buffer &data_) {
 				source = source_;
 				data = data_;
-				source->_loop->work(Cb([this](auto e) { decode(); }), Cb(this));
+				size = source_->_decodeSize;
+				source->_loop->work(Cb([this](auto e) { decode(); }), Cb(this), source_->_priority.load(std::memory_order_relaxed));
 			}
 			Buffer data;
 			Array<Pixel> pixels;
 			Sp<ImageSource> source; // hold source
+			Vec2 size; // decode size
 			bool completed = false;
 		};
 		New<Running>()->run(this, data);
 	}
 
 	void ImageSource::afterDecode(Array<Pixel>& pixels, bool success) {
-		auto self = this;
 		if (success) { // decode image complete
-			self->_onState.lock(); // lock, safe assign `_pixels`
-			for (auto &pix: pixels) {
-				if (pix.alphaType() == kUnpremul_AlphaType) {
-					if (self->_premulFlags == kConvert_PremulFlags)
-						premultipliedAlphaFromPixel(pix);
-					else if (self->_premulFlags == kAlready_PremulFlags)
-						pix._alphaType = kPremul_AlphaType; // mark as premultiplied
-				}
-			}
-			self->_info = pixels[0];
-			self->_premultipliedAlpha =
-				self->_info.alphaType() == kPremul_AlphaType ||
-				// kOpaque_AlphaType also as premultiplied, because alpha is 1.0
-				self->_info.alphaType() == kOpaque_AlphaType;
-			self->_pixels = std::move(pixels);
-			self->_state = State((self->_state | kSTATE_LOAD_COMPLETE) & ~kSTATE_LOADING);
-			self->_onState.unlock();
-			if (self->_res)
-				self->reloadTexture(self->_res);
+			setPixels(pixels, State((_state | kSTATE_LOAD_COMPLETE) & ~(kSTATE_LOADING | kSTATE_LOAD_PARTIAL)));
 		} else { // decode fail
-			self->_state = State((self->_state | kSTATE_DECODE_ERROR) & ~kSTATE_LOADING);
+			_state = State((_state | kSTATE_DECODE_ERROR) & ~(kSTATE_LOADING | kSTATE_LOAD_PARTIAL));
+		}
+	}
+
+	void ImageSource::setPixels(Array<Pixel>& pixels, State state) {
+		auto self = this;
+		self->_onState.lock(); // lock, safe assign `_pixels`
+		for (auto &pix: pixels) {
+			if (pix.alphaType() == kUnpremul_AlphaType) {
+				if (self->_premulFlags == kConvert_PremulFlags)
+					premultipliedAlphaFromPixel(pix);
+				else if (self->_premulFlags == kAlready_PremulFlags)
+					pix._alphaType = kPremul_AlphaType; // mark as premultiplied
+			}
 		}
+		self->_info = pixels[0];
+		self->_premultipliedAlpha =
+			self->_info.alphaType() == kPremul_AlphaType ||
+			// kOpaque_AlphaType also as premultiplied, because alpha is 1.0
+			self->_info.alphaType() == kOpaque_AlphaType;
+		self->_pixels = std::move(pixels);
+		self->_state = state;
+		self->_onState.unlock();
+		if (self->_res)
+			self->reloadTexture(self->_res);
 	}
 
 	void ImageSource::reloadTexture(RenderResource *res) {
@@ -285,8 +400,9 @@ namespace qk {
 		{
 			AutoSharedMutexExclusive ame(_onState); // lock, safe assign `_pixels`
 
-			_state = State( _state & ~(kSTATE_LOADING | kSTATE_LOAD_COMPLETE) );
+			_state = State( _state & ~(kSTATE_LOADING | kSTATE_LOAD_COMPLETE | kSTATE_LOAD_PARTIAL) );
 			_pixels.clear();
+			_priority.store(RunLoop::kWorkLow, std::memory_order_relaxed); // raised by the next loading
 			if (_loadId) {
 				fs_reader()->abort(_loadId); // to cancel load and ready status
 				_loadId = 0;
@@ -499,11 +615,13 @@ namespace qk {
 	// -------------------- I m a g e . S o u r c e . P o o l --------------------
 
 	void ImageSourcePool::handleSourceState(Event<ImageSource, ImageSource::State>& evt) {
+		Array<Sp<ImageSource>> evicted; // release after unlock
 		AutoMutexExclusive locl(_Mutex);
-		auto id = evt.sender()->uri().hashCode();
+		auto id = key(evt.sender()->uri(), evt.sender()->decodeSize());
 		auto it = _sources.find(id);
 		if (it != _sources.end()) {
-			if (evt.data() == ImageSource::kSTATE_LOAD_COMPLETE) {
+			// the preview pixels of the partial decoding also take up the memory
+			if (evt.data() & (ImageSource::kSTATE_LOAD_COMPLETE | ImageSource::kSTATE_LOAD_PARTIAL)) {
 				auto info = evt.sender()->info();
 				int ch = int(info.bytes()) - int(it->second.bytes);
 				if (ch != 0) {
@@ -511,11 +629,20 @@ namespace qk {
 					it->second.bytes = info.bytes();
 					it->second.time = time_millisecond();
 				}
+				if (_maxCapacity && _capacity > _maxCapacity) {
+					trim(_maxCapacity, evt.sender(), evicted);
+				}
 			}
 		}
 	}
 
-	ImageSourcePool::ImageSourcePool(RunLoop *loop): _loop(loop) {
+	ImageSourcePool::ImageSourcePool(RunLoop *loop)
+		: _loop(loop), _capacity(0)
+		, _maxCapacity(uint32_t(U64::clamp(
+			os_memory() >> 4, // 2GB:128MB, 4GB:256MB, 8GB:512MB
+			uint64_t(64 * 1024 * 1024), uint64_t(512 * 1024 * 1024))))
+		, _hits(0), _misses(0), _evictions(0)
+	{
 		Qk_CHECK(loop, "Create the ImageSourcePool fail, Haven't param RunLoop");
 	}
 
@@ -527,41 +654,113 @@ namespace qk {
 		_Mutex.unlock();
 	}
 
-	ImageSource* ImageSourcePool::get(cString& uri) {
+	void ImageSourcePool::set_maxCapacity(uint32_t val) {
+		Array<Sp<ImageSource>> evicted;
+		AutoMutexExclusive local(_Mutex);
+		_maxCapacity = val;
+		if (_maxCapacity && _capacity > _maxCapacity) {
+			trim(_maxCapacity, nullptr, evicted);
+		}
+	}
+
+	uint32_t ImageSourcePool::count() const {
+		return _sources.length();
+	}
+
+	uint64_t ImageSourcePool::key(cString& uri, Vec2 decodeSize) {
+		uint64_t id = uri.hashCode();
+		if (decodeSize[0] > 0 || decodeSize[1] > 0) {
+			uint64_t size = uint64_t(decodeSize[0]) << 32 | uint64_t(decodeSize[1]);
+			id ^= size * 0x9E3779B97F4A7C15ULL + (id << 6) + (id >> 2);
+		}
+		return id;
+	}
+
+	Sp<ImageSource> ImageSourcePool::get(cString& uri, Vec2 decodeSize) {
 		String _uri = fs_reader()->format(uri);
-		uint64_t id = _uri.hashCode();
+		// round up to reduce the members of different sizes with the same uri
+		decodeSize = Vec2(
+			decodeSize[0] > 0 ? ceilf(decodeSize[0] / 64) * 64: 0,
+			decodeSize[1] > 0 ? ceilf(decodeSize[1] / 64) * 64: 0
+		);
+		uint64_t id = key(_uri, decodeSize);
 
 		AutoMutexExclusive local(_Mutex);
 
 		// find image source by path
 		auto it = _sources.find(id);
 		if ( it != _sources.end() ) {
-			return it->second.source.get();
+			it->second.time = time_millisecond(); // touch
+			_hits++;
+			return it->second.source.get(); // the caller holds it, so it's not evicted
 		}
 		auto source = ImageSource::Make(_uri, _loop);
+		source->set_decodeSize(decodeSize);
 		source->Qk_On(State, &ImageSourcePool::handleSourceState, this);
 		auto info = source->info();
-		_sources.set(id, { source, info.bytes(), 0 });
+		_sources.set(id, { source, info.bytes(), time_millisecond() });
 		_capacity += info.bytes();
+		_misses++;
 
-		return *source;
+		return source.get();
 	}
 
-	ImageSource* ImageSourcePool::load(cString& uri) {
-		auto s = get(uri);
+	Sp<ImageSource> ImageSourcePool::load(cString& uri, Vec2 decodeSize, RunLoop::WorkPriority priority) {
+		auto s = get(uri, decodeSize);
 		if (s)
-			s->load();
+			s->load(priority);
 		return s;
 	}
 
 	void ImageSourcePool::remove(cString& uri) {
+		Array<Sp<ImageSource>> removed; // release after unlock
 		AutoMutexExclusive local(_Mutex);
 		String _uri = fs_reader()->format(uri);
-		auto it = _sources.find(_uri.hashCode());
-		if (it != _sources.end()) {
-			it->second.source->Qk_Off(State, &ImageSourcePool::handleSourceState, this);
+		for (auto it = _sources.begin(); it != _sources.end();) {
+			if (it->second.source->uri() == _uri) {
+				auto source = std::move(it->second.source);
+				source->Qk_Off(State, &ImageSourcePool::handleSourceState, this);
+				_capacity -= it->second.bytes;
+				removed.push(std::move(source));
+				it = _sources.erase(it);
+			} else {
+				it++;
+			}
+		}
+	}
+
+	void ImageSourcePool::trim(uint32_t capacity, ImageSource *exclude, Array<Sp<ImageSource>> &out) {
+		struct Victim {
+			int64_t  time;
+			uint32_t bytes;
+			uint64_t key;
+		};
+		Array<Victim> victims;
+
+		for (auto &i: _sources) {
+			auto source = i.second.source.get();
+			if (source == exclude || !i.second.bytes)
+				continue;
+			if (source->refCount() > 1) // held by the callers of `get()`, ImageSourceHold or others
+				continue;
+			victims.push({i.second.time, i.second.bytes, i.first});
+		}
+
+		// least recently used first, and the larger first at the same time
+		std::sort(victims.val(), victims.val() + victims.length(), [](const Victim &a, const Victim &b) {
+			return a.time < b.time || (a.time == b.time && a.bytes > b.bytes);
+		});
+
+		for (auto &v: victims) {
+			if (_capacity <= capacity)
+				break;
+			auto it = _sources.find(v.key);
+			auto source = std::move(it->second.source);
+			source->Qk_Off(State, &ImageSourcePool::handleSourceState, this);
+			_capacity -= Qk_Min(it->second.bytes, _capacity);
 			_sources.erase(it);
-			_capacity -= it->second.bytes;
+			_evictions++;
+			out.push(std::move(source)); // The next `get()` will create and reload it again
 		}
 	}
 
@@ -571,6 +770,7 @@ namespace qk {
 			// because render resource maybe already destroyed
 			return;
 		}
+		Array<Sp<ImageSource>> evicted; // release after unlock
 		AutoMutexExclusive local(_Mutex);
 		if (all) {
 			for (auto &i: _sources) {
@@ -585,7 +785,8 @@ namespace qk {
 				}
 			}
 		} else {
-			// sort by time asc and size desc
+			// memory warning, clean to half of the budget or half of the used
+			trim((_maxCapacity ? _maxCapacity: _capacity) >> 1, nullptr, evicted);
 		}
 	}
 
@@ -616,7 +817,7 @@ namespace qk {
 		return _imageSource.load(std::memory_order_acquire);
 	}
 
-	bool ImageSourceHold::set_src(String val) {
+	bool ImageSourceHold::set_src(String val, Vec2 decodeSize) {
 		if (val.startsWith("data:image")) {
 			// data:image/png;base64,
 			// data:image/svg+xml;base64,
@@ -645,9 +846,10 @@ namespace qk {
 		}
 		auto pool = imgPool();
 		if (pool) {
-			return set_source(pool->get(val));
+			return set_source(pool->get(val, decodeSize));
 		} else {
 			auto src = ImageSource::Make(val);
+			src->set_decodeSize(decodeSize);
 			return set_source(src);
 		}
 	}
@@ -120,6 +120,7 @@ namespace qk {
 			kSTATE_LOAD_COMPLETE = (1 << 1),
 			kSTATE_LOAD_ERROR = (1 << 2),
 			kSTATE_DECODE_ERROR = (1 << 3),
+			kSTATE_LOAD_PARTIAL = (1 << 4), // partial pixels are ready to draw as preview while loading
 		};
 
 		/**
@@ -146,6 +147,12 @@ namespace qk {
 		Qk_DEFINE_PROPERTY(PremulFlags, premulFlags, Const); // default as kConvert_PremulFlags
 		Qk_DEFINE_PROP_GET(bool, premultipliedAlpha, Const); // is premultiplied alpha
 		Qk_DEFINE_PROPERTY(bool, mipmap, Const); // is generate GPU mipmap texture default as true
+		/**
+		 * Target size hint in pixels for decoding, takes effect at the next load.
+		 * The image is decoded directly to the smallest size that still covers it
+		 * and keeps the aspect ratio, default as zero means decode the full size.
+		 */
+		Qk_DEFINE_PROPERTY(Vec2, decodeSize, Const);
 
 		/**
 		 * Create an ImageSource from URI.
@@ -181,9 +188,15 @@ namespace qk {
 		virtual ~ImageSource();
 
 		/**
-		 * @method load() async load source and decode
+		 * Async load source and decode, remote source is decoded progressively
+		 * while the data is arriving, and the partial pixels are published with `kSTATE_LOAD_PARTIAL`.
+		 *
+		 * @method load(priority?)
+		 * @param priority {WorkPriority} the work priority of decoding, the images to draw on
+		 *  screen are decoded with high priority, the prefetched images with low priority
+		 * @return {bool} Returns true if ready to draw, including the partial preview
 		 */
-		bool load();
+		bool load(RunLoop::WorkPriority priority = RunLoop::kWorkHigh);
 
 		/**
 		 * @method unload() delete load and decode ready
@@ -202,6 +215,16 @@ namespace qk {
 		 */
 		void markAsTexture(RenderResource *first = nullptr);
 
+		/**
+		 * Upload the `rect` area of `src` into the same area of the texture,
+		 * the texels outside rect are kept.
+		 *
+		 * @param src {cPixel&} the full size pixels of source, only the pixels in rect are read
+		 * @param first {RenderResource* = nullptr} the same as markAsTexture()
+		 * @return {bool} false if not texture yet or not supported by backend
+		 */
+		bool updateTexture(cPixel& src, IRect rect, RenderResource *first = nullptr);
+
 		/**
 		 * @method isLoaded() is ready draw image
 		 */
@@ -262,8 +285,10 @@ namespace qk {
 
 	private:
 		ImageSource(RunLoop *loop);
+		void loadStream();
 		void decode(Buffer& data);
 		void afterDecode(Array<Pixel>& pixels, bool success);
+		void setPixels(Array<Pixel>& pixels, State state);
 		void unload_(bool destroy);
 		void reloadTexture(RenderResource *res);
 		static bool premultipliedAlphaFromPixel(Pixel &pixel);
@@ -274,6 +299,7 @@ namespace qk {
 		RenderResource *_res; // weak ref, texture mark
 		RunLoop       *_loop;
 		uint32_t      _loadId;
+		std::atomic<RunLoop::WorkPriority> _priority; // decode work priority, the highest of the loadings
 	};
 
 	/**
@@ -284,6 +310,10 @@ namespace qk {
 	public:
 		Qk_DEFINE_PROP_GET(RunLoop*, loop);
 		Qk_DEFINE_PROP_GET(uint32_t, capacity, Const); // Used memory size total
+		Qk_DEFINE_PROPERTY(uint32_t, maxCapacity, Const); // Memory budget in bytes, 0 means unlimited
+		Qk_DEFINE_PROP_GET(uint32_t, hits, Const); // Count of `get()` found in the cache
+		Qk_DEFINE_PROP_GET(uint32_t, misses, Const); // Count of `get()` created a new source
+		Qk_DEFINE_PROP_GET(uint32_t, evictions, Const); // Count of sources evicted by budget
 
 		/**
 		 * @constructor
@@ -292,23 +322,41 @@ namespace qk {
 		~ImageSourcePool() override;
 
 		/**
-		 * @method get(uri) get image source by uri
+		 * @method get(uri,decodeSize?) get image source by uri
+		 *
+		 * If `decodeSize` is not zero, it's rounded up to the multiple of 64 pixels and
+		 * as a separate member from the full size source of the same uri.
+		 *
+		 * The pool never evicts the sources that are held by others,
+		 * so hold the returned source as long as it's used.
 		 */
-		ImageSource* get(cString& uri);
+		Sp<ImageSource> get(cString& uri, Vec2 decodeSize = Vec2());
 
 		/**
-		 * @method load(uri) load and return image source by uri 
+		 * @method load(uri,decodeSize?,priority?) load and return image source by uri
+		 *
+		 * It's used to prefetch the images ahead of drawing, so decoded with low priority by default.
 		 */
-		ImageSource* load(cString& uri);
+		Sp<ImageSource> load(cString& uri, Vec2 decodeSize = Vec2(),
+			RunLoop::WorkPriority priority = RunLoop::kWorkLow);
 
 		/**
-		 * @method remove(id) remove image source member
+		 * @method remove(id) remove image source members of all the decode sizes
 		 */
 		void remove(cString& uri);
 
 		/**
-			* @method clear(all?: bool) clean memory
-			*/
+		 * @method count() get the number of cached image sources
+		 */
+		uint32_t count() const;
+
+		/**
+		 * @method clear(all?: bool) clean memory
+		 *
+		 * If `all` is true, unload all the loaded image sources,
+		 * otherwise evict the least recently used sources that are not held by
+		 * anyone else until the used memory drops below half of the budget.
+		 */
 		void clear(bool all = false);
 
 		/**
@@ -318,11 +366,13 @@ namespace qk {
 
 	private:
 		void handleSourceState(Event<ImageSource, ImageSource::State>& evt);
+		static uint64_t key(cString& uri, Vec2 decodeSize);
+		void trim(uint32_t capacity, ImageSource *exclude, Array<Sp<ImageSource>> &out);
 
 		struct Member {
 			Sp<ImageSource> source;
 			uint32_t        bytes; // image size
-			int64_t         time; // load time
+			int64_t         time; // last access time
 		};
 		Dict<uint64_t, Member> _sources;
 		QkMutex _Mutex;
@@ -391,9 +441,10 @@ namespace qk {
 		 *  img.src = 'data:image/jpeg;base64,/9j/4AAQSkZJRgABAQAAAQ...';
 		 *
 		 * @param val Source URI string
+		 * @param decodeSize Target size hint in pixels for decoding, zero means full size
 		 * @return true if the source was successfully set, false on failure
 		 */
-		bool set_src(String val);
+		bool set_src(String val, Vec2 decodeSize = Vec2());
 
 		/**
 		 * Get the current image source.
@@ -584,6 +584,7 @@ namespace qk {
 	bool VulkanCanvas::swapBuffer() {
 		flushCAPABatch();
 		_alloc.reset();
+		_frameAlloc.reset();
 		endPass(); // end current pass
 
 		if (_cmdPack->recorded) {
@@ -609,6 +610,7 @@ namespace qk {
 			std::swap(_cmdPackFront, _cmdPack);
 
 			clear_PathvCache(_cache, 0);
+			_glyphAtlas->nextFrame();
 			_cmdPack->reset(this, &lock, true);
 		} else {
 			_cmdPack->reset(this, &lock, false);
@@ -203,6 +203,7 @@ namespace qk {
 				return;
 			if (!_delegate->onRenderBackendDisplay())
 				return;
+			Canvas::SubmitScope submit(_vkCanvas); // profile submit time, including present
 			auto commands = _vkCanvas->flushBuffer();
 			if (commands.isNull())
 				return;
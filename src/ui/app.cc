@@ -183,6 +183,8 @@ namespace qk {
 
 	void Application::set_maxResourceMemoryLimit(uint64_t limit) {
 		_maxResourceMemoryLimit = Qk_Max(limit, 64 * 1024 * 1024);
+		// the image cache is the most memory consuming, use the limit as its budget
+		_imgPool->set_maxCapacity(uint32_t(U64::min(_maxResourceMemoryLimit, U32::limit_max)));
 	}
 
 	uint32_t Application::usedResourceMemory() const {
@@ -462,8 +462,10 @@ namespace qk {
 		// Accessor for the set of views associated with a specific class hash
 		inline Set<View*>& viewsSet(uint64_t hash);
 
-		// Mark descendant views as needing style re-evaluation
-		void markViewsForClassChange_rt();
+		// Mark descendant views affected by the selectors that entered or left
+		// the propagation set, `last` is the set before the change
+		void markViewsForClassChange_rt(const Vector<CStyleSheets*> &last);
+		void markViewsForSubstyles_rt(CStyleSheets *propagating);
 
 		Set<String> _names; //!< class name set for work loop (main thread)
 
@@ -240,17 +240,47 @@ namespace qk {
 	}
 
 	/**
-	 * Mark views that may be affected by class / propagating style changes.
+	 * Mark views that may be affected by a change of the propagating styles.
 	 *
-	 * This method uses the Window-level reverse index (_viewsByClass)
-	 * to find candidate views that declare class names referenced by
-	 * the current propagating styles. Candidates that need an immediate
-	 * update are then verified against the host hierarchy.
+	 * Only the selectors that entered or left the propagation set can change the
+	 * match results of descendants; selectors kept across the change resolve to the
+	 * same substyles as before. So each added or removed selector is used as an
+	 * invalidation set: its `_sub` dict maps every class hash to the descendant
+	 * selectors it can affect, and the Window-level reverse index (_viewsByClass)
+	 * yields the candidate views declaring that class.
 	 *
 	 * Only a pre-filter is performed here:
 	 *  - No selector resolution
 	 *  - No style application
 	 *
+	 * The complete style set is always resolved later in normal cascade order.
+	 *
+	 * @param last {Vector} propagating styles before the change
+	 * @thread Rt
+	 */
+	void CStyleSheetsClass::markViewsForClassChange_rt(const Vector<CStyleSheets*> &last) {
+		auto host = _host.load();
+		if (host->_level == 0)
+			return; // detached host has no effective descendants in the UI tree
+
+		auto has = [](const Vector<CStyleSheets*> &styles, CStyleSheets *ss) {
+			for (auto i: styles)
+				if (i == ss) return true;
+			return false;
+		};
+		for (auto ss: last) {
+			if (!has(_propagatingStyles_rt, ss))
+				markViewsForSubstyles_rt(ss); // removed selector
+		}
+		for (auto ss: _propagatingStyles_rt) {
+			if (!has(last, ss))
+				markViewsForSubstyles_rt(ss); // added selector
+		}
+	}
+
+	/**
+	 * Mark the candidate views of the substyles of a propagating selector.
+	 *
 	 * Visible candidates enter the normal update queue. A hidden candidate is
 	 * queued only when the referenced substyle explicitly contains
 	 * `visible: true`, because that style may reactivate it. Other hidden
@@ -259,59 +289,49 @@ namespace qk {
 	 * avoids an O(depth) hierarchy query for every hidden candidate. Their mark
 	 * is restored when the corresponding branch becomes visible.
 	 *
-	 * The complete style set is always resolved later in normal cascade order.
-	 *
 	 * @thread Rt
 	 */
-	void CStyleSheetsClass::markViewsForClassChange_rt() {
+	void CStyleSheetsClass::markViewsForSubstyles_rt(CStyleSheets *propagating) {
 		auto host = _host.load();
 		auto &_viewsByClass = host->window()->_viewsByClass;
-
-		if (_propagatingStyles_rt.length() == 0)
-			return; // no propagating styles
-		if (host->_level == 0)
-			return; // detached host has no effective descendants in the UI tree
-
-		for (auto propagating: _propagatingStyles_rt) {
-			Set<View*> *views;
-			Qk_ASSERT(propagating->_sub.length(), "propagating style must have substyles");
-
-			for (auto it : propagating->_sub) {
-				// This flag describes only the current substyle node. Other matched
-				// selector nodes are tracked independently in _propagatingStyles_rt.
-				auto canWakeHidden = it.second->hasVisibleTrue();
-				if (_viewsByClass.get(it.second->_name.hashCode(), views)) {
-					for (auto &v: *views) {
-						auto child = v.first;
-
-						if (child->_level <= host->_level)
-							continue; // candidate is not a descendant of the host
-
-						// canLayout controls immediate queue admission only. A hidden view
-						// containing visible:true must be checked now because CSS may wake it.
-						auto canLayout = child->_cascade_visible || canWakeHidden;
-
-						if (it.second->_directChildOnly) {
-							if (host == child->_parent_rt) {
-								// Force only queue admission. Selector matching and property
-								// priority are resolved later by apply_class_rt().
-								child->mark_layout_rt_(View::kClass_Change, canLayout);
-							}
-						} else if (canLayout) {
-							if (host->is_child_rt(child)) {
-								// Same as the direct-child path, after confirming ancestry.
-								child->mark_layout_rt_(View::kClass_Change, true);
-							}
-						} else {
-							// Avoid the potentially expensive descendant walk for an ordinary
-							// hidden candidate. A false-positive dirty bit is inexpensive and
-							// will be resolved against the real parent chain only if it becomes visible.
-							child->_mark_value |= View::kClass_Change;
+		Set<View*> *views;
+		Qk_ASSERT(propagating->_sub.length(), "propagating style must have substyles");
+
+		for (auto it : propagating->_sub) {
+			// This flag describes only the current substyle node. Other matched
+			// selector nodes are tracked independently in _propagatingStyles_rt.
+			auto canWakeHidden = it.second->hasVisibleTrue();
+			if (_viewsByClass.get(it.second->_name.hashCode(), views)) {
+				for (auto &v: *views) {
+					auto child = v.first;
+
+					if (child->_level <= host->_level)
+						continue; // candidate is not a descendant of the host
+
+					// canLayout controls immediate queue admission only. A hidden view
+					// containing visible:true must be checked now because CSS may wake it.
+					auto canLayout = child->_cascade_visible || canWakeHidden;
+
+					if (it.second->_directChildOnly) {
+						if (host == child->_parent_rt) {
+							// Force only queue admission. Selector matching and property
+							// priority are resolved later by apply_class_rt().
+							child->mark_layout_rt_(View::kClass_Change, canLayout);
 						}
-					} // for views
-				}
-			} // for propagating->_sub
-		}
+					} else if (canLayout) {
+						if (host->is_child_rt(child)) {
+							// Same as the direct-child path, after confirming ancestry.
+							child->mark_layout_rt_(View::kClass_Change, true);
+						}
+					} else {
+						// Avoid the potentially expensive descendant walk for an ordinary
+						// hidden candidate. A false-positive dirty bit is inexpensive and
+						// will be resolved against the real parent chain only if it becomes visible.
+						child->_mark_value |= View::kClass_Change;
+					}
+				} // for views
+			}
+		} // for propagating->_sub
 	}
 
 	void CStyleSheetsClass::apply_rt(CStyleSheetsClass *parent, bool alwaysApply, bool propagate) {
@@ -319,6 +339,7 @@ namespace qk {
 		// Snapshot previous propagation state
 		auto lastHash = _propagatingStylesHash_rt.hashCode();
 		auto lastStylesHash = _stylesHash_rt.hashCode();
+		Vector<CStyleSheets*> lastPropagating;
 
 		// Reset runtime state for re-application
 		_stylesHash_rt = Hash();
@@ -326,17 +347,11 @@ namespace qk {
 		_parent = parent;
 		_state = _setState; // commit pseudo state
 
-		auto clearStatus = [this, host](bool propagate) {
+		auto clearStatus = [this, host, &lastPropagating]() {
 			// Clear all running CSS transitions for this view
 			host->window()->actionCenter()->removeCSSTransition_rt(host);
-
-			if (propagate) {
-				// Mark candidates affected by the outgoing propagation set before
-				// clearing it; removed selectors must also be re-evaluated.
-				markViewsForClassChange_rt();
-			}
-			// Reset propagation cache
-			_propagatingStyles_rt.clear();
+			// Reset propagation cache, keep the outgoing set to diff it against the new one
+			lastPropagating.swap(_propagatingStyles_rt);
 			_propagatingStylesHash_rt = Hash();
 		};
 
@@ -348,7 +363,7 @@ namespace qk {
 
 			// Apply styles only if the resolved set changed
 			if (lastStylesHash != _stylesHash_rt.hashCode() || alwaysApply) {
-				clearStatus(propagate);
+				clearStatus();
 
 				for (auto ss: styles) {
 					// Handle transition vs immediate apply
@@ -364,16 +379,17 @@ namespace qk {
 						_propagatingStyles_rt.push(ss);
 						_propagatingStylesHash_rt.updateu64(uintptr_t(ss));
 					}
-					// Mark candidates affected by the newly accumulated propagation
-					// set. This never applies an individual substyle directly.
-					if (propagate) {
-						markViewsForClassChange_rt();
-					}
 				}
 			}
 		} else {
 			// No class names → clear all styles and propagation
-			clearStatus(propagate);
+			clearStatus();
+		}
+
+		// Descendants are affected only when the propagation set itself changed,
+		// and then only through the selectors that entered or left it.
+		if (propagate && lastHash != _propagatingStylesHash_rt.hashCode()) {
+			markViewsForClassChange_rt(lastPropagating);
 		}
 		_firstApply = false; // mark first apply false
 	}
@@ -459,40 +459,23 @@ namespace qk {
 		}
 	}
 
-	void EventDispatch::touchstart(View *view, List<TouchPoint> &in) {
-		if ( view->_visible && in.length() ) {
-			if ( view->_visible_area ) {
-				if ( view->_last_rt && view->is_clip() ) {
-					List<TouchPoint> clipIn;
-
-					for ( auto i = in.begin(), e = in.end(); i != e; ) {
-						if ( view->overlap_test(i->position) ) {
-							clipIn.pushBack(*i);
-							in.erase(i++);
-						} else {
-							i++;
-						}
-					}
-					auto v = view->_last_rt;
-					while( v && clipIn.length() ) {
-						touchstart(v, clipIn);
-						v = v->_prev_rt;
-					}
-					touchstart_consume(view, clipIn);
-
-					if ( clipIn.length() ) {
-						in.splice(in.end(), clipIn);
-					}
-				} else {
-					auto v = view->_last_rt;
-					while( v && in.length() ) {
-						touchstart(v, in);
-						v = v->_prev_rt;
-					}
-					touchstart_consume(view, in);
+	void EventDispatch::touchstart(View *root, List<TouchPoint> &in) {
+		// group the touch points by the topmost view that receives them
+		Array<View*> views;
+		Dict<View*, List<TouchPoint>> touches;
+		for (auto &touch: in) {
+			auto view = find_receive_view(root, touch.position);
+			if (view) {
+				List<TouchPoint> *list;
+				if (!touches.get(view, list)) {
+					list = &touches.set(view, List<TouchPoint>());
+					views.push(view);
 				}
+				list->pushBack(touch);
 			}
 		}
+		for (auto view: views)
+			touchstart_consume(view, touches[view]);
 	}
 
 	void EventDispatch::touchmove(List<TouchPoint>& in) {
@@ -646,42 +629,158 @@ namespace qk {
 
 	// -------------------------- M o u s e --------------------------
 
-	View* EventDispatch::find_receive_view_exec(View* view, Vec2 pos) {
-		if ( view->visible() && view->visible_area() ) {
-			auto v = view->_last_rt;
-			if (v && view->is_clip() ) {
-				if (view->overlap_test(pos)) {
-					while (v) {
-						auto r = find_receive_view_exec(v, pos);
-						if (r) {
-							return r;
-						}
-						v = v->_prev_rt;
-					}
-					if (view->_receive) {
-						return view;
-					}
+	// ------------------------- H i t   G r i d -------------------------
+
+	// Views covering more cells than this are kept out of the grid and always tested
+	constexpr int32_t HIT_GRID_MAX_CELLS = 64;
+	// Hit grid cell size in window coords
+	constexpr float HIT_GRID_CELL_SIZE = 128.0f;
+
+	inline uint64_t hitGridKey(int32_t x, int32_t y) {
+		return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+	}
+
+	inline int32_t hitGridCell(float val) {
+		return int32_t(floorf(val * (1.0f / HIT_GRID_CELL_SIZE)));
+	}
+
+	void EventDispatch::removeFromHitGrid(View *view, HitState &state) {
+		if (state.isLarge) {
+			for (uint32_t i = 0; i < _hitLargeViews.length(); i++) {
+				if (_hitLargeViews[i] == view) {
+					_hitLargeViews[i] = _hitLargeViews.back();
+					_hitLargeViews.pop();
+					break;
 				}
-			} else {
-				while (v) {
-					auto r = find_receive_view_exec(v, pos);
-					if (r) {
-						return r;
+			}
+			state.isLarge = false;
+		}
+		auto &r = state.cells;
+		for (int32_t y = r.y0; y <= r.y1; y++) {
+			for (int32_t x = r.x0; x <= r.x1; x++) {
+				auto it = _hitGrid.find(hitGridKey(x, y));
+				if (it == _hitGrid.end())
+					continue;
+				auto &cell = it->second;
+				for (uint32_t i = 0; i < cell.length(); i++) {
+					if (cell[i] == view) {
+						cell[i] = cell.back(); // swap remove
+						cell.pop();
+						break;
 					}
-					v = v->_prev_rt;
-				}
-				if (view->_receive && view->overlap_test(pos)) {
-					return view;
 				}
+				if (cell.length() == 0)
+					_hitGrid.erase(it);
 			}
 		}
-		return nullptr;
+		r = GridRange();
+	}
+
+	void EventDispatch::updateHitGrid(View *view, const Range *bounds) {
+		Qk_ASSERT(_window->isUILocked());
+		if (!bounds) {
+			auto it = _hitViews.find(view);
+			if (it != _hitViews.end()) {
+				removeFromHitGrid(view, it->second);
+				_hitViews.erase(it);
+			}
+			return;
+		}
+		HitState *s;
+		if (!_hitViews.get(view, s))
+			s = &_hitViews.set(view, {false, GridRange()});
+		auto &state = *s;
+		GridRange r{
+			hitGridCell(bounds->begin.x()), hitGridCell(bounds->begin.y()),
+			hitGridCell(bounds->end.x()), hitGridCell(bounds->end.y()),
+		};
+		bool isLarge = int64_t(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1) > HIT_GRID_MAX_CELLS;
+		if (isLarge) {
+			if (!state.isLarge) {
+				removeFromHitGrid(view, state);
+				_hitLargeViews.push(view);
+				state.isLarge = true;
+			}
+			return;
+		}
+		if (!state.isLarge && r == state.cells)
+			return; // still in the same cells
+		removeFromHitGrid(view, state);
+		for (int32_t y = r.y0; y <= r.y1; y++) {
+			for (int32_t x = r.x0; x <= r.x1; x++) {
+				_hitGrid[hitGridKey(x, y)].push(view);
+			}
+		}
+		state.cells = r;
+	}
+
+	bool EventDispatch::hit_test(View *view, View *root, Vec2 pos) {
+		if (!view->_receive || !view->overlap_test(pos))
+			return false;
+		// the same conditions as visiting the view recursively from the root
+		do {
+			if (!view->visible() || !view->visible_area())
+				return false;
+			if (view == root)
+				return true;
+			view = view->_parent_rt;
+			if (!view)
+				return false; // not in the attached tree
+			if (view->is_clip() && !view->overlap_test(pos))
+				return false; // clipped by ancestor
+		} while (true);
+	}
+
+	// Returns true if the view `a` is drawn above `b`, false if they are not in the same tree.
+	static bool is_drawn_above(View *a, View *b) {
+		auto la = a->level(), lb = b->level();
+		for (; la > lb; la--) {
+			a = a->parent_rt();
+			if (a == b)
+				return true; // descendant of b
+			if (!a)
+				return false;
+		}
+		for (; lb > la; lb--) {
+			b = b->parent_rt();
+			if (b == a)
+				return false; // ancestor of b
+			if (!b)
+				return false;
+		}
+		while (a->parent_rt() != b->parent_rt()) {
+			a = a->parent_rt();
+			b = b->parent_rt();
+			if (!a || !b)
+				return false; // past the root
+		}
+		for (auto v = b->next_rt(); v; v = v->next_rt()) {
+			if (v == a)
+				return true; // later sibling
+		}
+		return false;
+	}
+
+	View* EventDispatch::find_receive_view(View *root, Vec2 pos) {
+		View *r = nullptr;
+		auto test = [&](View *v) {
+			// hit_test() first, it rejects the views out of the tree of root
+			if (hit_test(v, root, pos) && (!r || is_drawn_above(v, r)))
+				r = v;
+		};
+		auto it = _hitGrid.find(hitGridKey(hitGridCell(pos.x()), hitGridCell(pos.y())));
+		if (it != _hitGrid.end())
+			for (auto v: it->second)
+				test(v);
+		for (auto v: _hitLargeViews)
+			test(v);
+		return r;
 	}
 
 	View* EventDispatch::find_receive_view_and_retain(Vec2 pos) {
 		auto root = _window->root();
 		if (root) {
-			auto r = find_receive_view_exec(root, pos);
+			auto r = find_receive_view(root, pos);
 			r = r ? r : root;
 			return r->try_retain_rt();
 		} else {
@@ -277,14 +277,48 @@ namespace qk {
 		void setImeKeyboardSpotRect(Rect rect);
 		bool setActiveView(View *view); // set focus from main thread
 		void cancelImeMarked(); // clear marked text
+
+		/**
+		 * Update the hit test grid for a view after its visible area has been solved,
+		 * must be called from the render thread with the UILock held.
+		 * @param bounds axis-aligned bounds of the view in window coords, null to remove the view.
+		 */
+		void updateHitGrid(View *view, const Range *bounds);
+
+		/**
+		 * Returns the topmost view in draw order under the point that receives events or null,
+		 * it is answered from the hit test grid and must be called with the UILock held.
+		 * @param root the root view of the attached tree
+		 * @param pos the point in window coords
+		 */
+		View* find_receive_view(View *root, Vec2 pos);
+
 	private:
+		/**
+		 * Grid cell range covered by the bounds of a view, empty when x1 < x0.
+		 */
+		struct GridRange {
+			int32_t x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+			inline bool isEmpty() const { return x1 < x0; }
+			inline bool operator==(const GridRange& r) const {
+				return x0 == r.x0 && y0 == r.y0 && x1 == r.x1 && y1 == r.y1;
+			}
+		};
+
+		/** Hit test state of a view in the grid. */
+		struct HitState {
+			bool isLarge; ///< true if too large for the grid and always tested
+			GridRange cells; ///< cells currently occupied in the grid
+		};
+
+		void removeFromHitGrid(View *view, HitState &state);
+		bool hit_test(View *view, View *root, Vec2 pos);
 		void touchstart_consume(View *view, List<TouchPoint>& in);
-		void touchstart(View* view, List<TouchPoint>& in);
+		void touchstart(View* root, List<TouchPoint>& in);
 		void touchmove(List<TouchPoint>& in);
 		void touchend(List<TouchPoint>& in, bool isCancel);
 		void mousemove(View* view, Vec2 pos);
 		void mousepress(View* view, Vec2 pos, KeyboardCode code, bool down);
-		View* find_receive_view_exec(View *view, Vec2 pos);
 		View* find_receive_view_and_retain(Vec2 pos);
 		Sp<View> safe_active_view();
 
@@ -294,6 +328,9 @@ namespace qk {
 		MouseHandler *_mouse;
 		std::atomic<TextInput*> _text_input;
 		Mutex _activeViewMutex; // get set focus view mutex for main and render thread
+		Dict<View*, HitState> _hitViews; ///< Views in the hit test grid
+		Dict<uint64_t, Array<View*>> _hitGrid; ///< Uniform grid in window coords, cell key => views
+		Array<View*> _hitLargeViews; ///< Views covering too many cells, always tested
 		friend class View;
 		friend class View;
 	};
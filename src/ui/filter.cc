@@ -32,6 +32,7 @@
 #include "./view/box.h"
 #include "./app.h"
 #include "./window.h"
+#include "./view/image.h"
 #include "../render/source.h"
 #include "./ui.h"
 
@@ -275,11 +276,30 @@ namespace qk {
 	}
 
 	void FillImage::set_src(String val) {
-		if (ImageSourceHold::set_src(val)) {
+		if (ImageSourceHold::set_src(val, decode_size())) {
 			mark(this);
 		}
 	}
 
+	Vec2 FillImage::decode_size() {
+		// decode directly to the fixed size of fill image
+		if (_width.kind == FillSizeKind::Value && _height.kind == FillSizeKind::Value) {
+			return Image::decode_size(view(), Vec2(_width.value, _height.value));
+		}
+		return Vec2();
+	}
+
+	void FillImage::reload_src() {
+		auto src = source();
+		if (src && src->decodeSize() != Vec2()) { // decoded to the size hint
+			auto size = decode_size();
+			if (size == Vec2() || size[0] > src->decodeSize()[0] || size[1] > src->decodeSize()[1]) {
+				// the size is no longer fixed or grows past the decoded size, request again
+				ImageSourceHold::set_src(src->uri(), size);
+			}
+		}
+	}
+
 	BoxFilter* FillImage::copy(BoxFilter* dest) {
 		auto dest1 = (dest && dest->type() == kImage) ?
 				static_cast<FillImage*>(dest) : new FillImage(String(), {/*.repeat=Repeat::Repeat*/});
@@ -338,6 +358,7 @@ namespace qk {
 	void FillImage::set_width(FillSize value) {
 		if (value != _width) {
 			_width = value;
+			reload_src();
 			mark(this);
 		}
 	}
@@ -345,6 +366,7 @@ namespace qk {
 	void FillImage::set_height(FillSize value) {
 		if (value != _height) {
 			_height = value;
+			reload_src();
 			mark(this);
 		}
 	}
@@ -372,7 +394,7 @@ namespace qk {
 	}
 
 	void FillImage::onSourceState(ImageSource::State state) {
-		if (state & ImageSource::kSTATE_LOAD_COMPLETE) {
+		if (state & (ImageSource::kSTATE_LOAD_COMPLETE | ImageSource::kSTATE_LOAD_PARTIAL)) {
 			if (view()) {
 				mark(this);
 			} else if (shared_app()) {
@@ -96,6 +96,8 @@ namespace qk {
 		static bool compute_size(FillSize size, float host, float& out);
 		static float compute_position(FillPosition pos, float host, float size);
 	private:
+		Vec2 decode_size();
+		void reload_src(); // request the source again if the fixed size grows past the decoded size
 		void onSourceState(ImageSource::State state) override;
 	};
 
@@ -29,8 +29,22 @@
  * ***** END LICENSE BLOCK ***** */
 
 #include "./layer.h"
+#include "./window.h"
+#include "./painter.h"
 
 namespace qk
 {
-	
+	Layer::Layer(View *host, bool isAuto)
+		: _host(host), _isAuto(isAuto)
+		, _static_frames(0), _scale(1)
+		, _epoch(0), _dirty(false), _ready(false), _queued(false), _warned(false)
+	{}
+
+	Layer::~Layer() {
+		// The painter is released before the views that are still held when closing window
+		auto painter = _host->window()->painter();
+		if (painter)
+			painter->removeLayer(this);
+	}
+
 } // namespace qk
@@ -32,12 +32,60 @@
 #define __quark__layer__
 
 #include "../util/util.h"
+#include "../render/source.h"
 
 namespace qk
 {
+	class View;
+	class Painter;
+
+	/**
+	 * @class Layer
+	 *
+	 * The offscreen raster cache of a view subtree, see Morph::layer.
+	 *
+	 * The subtree is rendered once into an offscreen image via Canvas::outputImage()
+	 * in the local space of the host view, and then composited as a single textured
+	 * rect with the matrix and opacity of the host, until a view inside it is marked.
+	 *
+	 * @thread Rt
+	 */
 	class Qk_EXPORT Layer: public Object {
+		Qk_DISABLE_COPY(Layer);
 	public:
+		Qk_DEFINE_PROP_GET(View*, host); //!< the view that owns the layer
+		Qk_DEFINE_PROP_GET(bool, isAuto, Const); //!< promoted automatically, see Window::autoLayerFrames
+		Qk_DEFINE_PROP_GET(uint32_t, static_frames, Const); //!< frames drawn without any change inside
+		Qk_DEFINE_PROP_GET(float, scale, Const); //!< the raster scale of the image
+
+		/**
+		 * @constructor
+		 */
+		Layer(View *host, bool isAuto);
+
+		/**
+		 * @destructor
+		 */
+		~Layer() override;
+
+		/**
+		 * Returns whether the image holds the up to date content of the host view
+		 */
+		inline bool is_ready() const { return _ready && !_dirty; }
+
+		/**
+		 * Mark the content of the host view as changed
+		 */
+		inline void mark_dirty() { _dirty = true; }
+
 	private:
+		Sp<ImageSource> _image; // full surface size output image
+		Color4f _color; // the opaque color of the host when rastered
+		Vec2 _size, _surface; // the host client size and surface size when rastered
+		uint32_t _epoch; // the layer epoch of pre render when rastered
+		bool _dirty, _ready, _queued, _warned;
+
+		friend class Painter;
 	};
 
 } // namespace qk
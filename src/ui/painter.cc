@@ -59,14 +59,14 @@ namespace qk {
 		: _render(window->render()), _canvas(nullptr)
 		, _cache(nullptr)
 		, _window(window)
-		, _color(1,1,1,1), _mark_recursive(0), _matrix(nullptr)
-		, _delayCmdsAllocator()
+		, _color(1,1,1,1), _mark_recursive(0), _damage(nullptr)
+		, _raster(nullptr), _layers(0), _autoLayers(0), _matrix(nullptr)
 		, _delayCmds(nullptr)
 	{
 		_canvas = _render->getCanvas();
 		_cache = _canvas->getPathvCache();
 		_delayCmdsStack.push_back(DelayCmdMap(
-			std::less<uint32_t>(), STLAllocator<DelayCmdKV>(&_delayCmdsAllocator)
+			std::less<uint32_t>(), STLAllocator<DelayCmdKV>(_canvas->frameAllocator())
 		));
 	}
 
@@ -414,6 +414,8 @@ namespace qk {
 		auto shadow = v->box_shadow();
 		if (!shadow)
 			return;
+		if (_raster && _raster->_host == v)
+			return; // the shadow is outside of the layer, it's drawn when compositing
 		getOutsideRectPath(v);
 		do {
 			if (shadow->type() != BoxFilter::kShadow)
@@ -551,6 +553,27 @@ namespace qk {
 
 	//////////////////////////////////////////////////////////
 
+	// Leaf boxes that never draw outside of their bounds can skip drawing out of the damage region
+	bool Painter::isOutOfDamage(View *v) {
+		auto &damage = *_damage;
+		if (v->_first_rt)
+			return false;
+		switch (v->view_type()) {
+			case kBox_ViewType:
+			case kFlex_ViewType:
+			case kFlow_ViewType:
+			case kImage_ViewType: break;
+			default: return false;
+		}
+		auto box = static_cast<Box*>(v);
+		if (box->box_shadow())
+			return false;
+		auto re = region_aabb_from_convex_quadrilateral(box->_boxBounds);
+		// one pixel more for anti-aliasing edges
+		return re.end.x() + 1 <= damage.begin.x() || re.begin.x() - 1 >= damage.end.x() ||
+			re.end.y() + 1 <= damage.begin.y() || re.begin.y() - 1 >= damage.end.y();
+	}
+
 	void Painter::visitView(View *view) {
 		auto v = view->_first_rt;
 		if (!v) return;
@@ -563,7 +586,8 @@ namespace qk {
 					v->solve_marks(*_matrix, view, mark);
 					_mark_recursive = mark & View::kRecursive_Solve_Mark;
 				}
-				if (v->_visible_area) {
+				if (v->_visible_area && !(_damage && isOutOfDamage(v))) {
+					_window->profiler().count(FrameProfiler::kPaintViews_Counter);
 					switch (v->_cascade_color) {
 						case CascadeColor::None:
 							_color = v->_color.to_color4f(); break;
@@ -609,7 +633,7 @@ namespace qk {
 		_canvas->clipPath(*_boxData.inside, Canvas::kIntersect_ClipOp, v->_aa); // clip
 		_window->clipRange(region_aabb_from_convex_quadrilateral(v->_boxBounds));
 		_delayCmdsStack.push_back(DelayCmdMap(
-			std::less<uint32_t>(), STLAllocator<DelayCmdKV>(&_delayCmdsAllocator)
+			std::less<uint32_t>(), STLAllocator<DelayCmdKV>(_canvas->frameAllocator())
 		));
 		_delayCmds = &_delayCmdsStack.back(); // set current cmds
 		if (cb)
@@ -654,6 +678,229 @@ namespace qk {
 		_matrix = lastMatrix; // restore last matrix
 	}
 
+	constexpr uint32_t kMaxLayers = 16; // full surface images held by all layers
+	constexpr uint32_t kMaxAutoLayers = 8; // full surface images held by the automatic layers
+	constexpr float kLayerScaleTolerance = 1.25f; // raster again when the layer is scaled up more
+
+	static float layer_scale(const Mat &mat) {
+		return sqrtf(fabsf(mat[0] * mat[4] - mat[1] * mat[3]));
+	}
+
+	bool Painter::drawLayer(Morph *v) {
+		if (_raster && _raster->_host == v)
+			return false; // rastering the layer of self
+		auto layer = v->_raster_layer;
+		auto autoFrames = _window->autoLayerFrames();
+		if (!v->layer() && !(autoFrames && v->_clip && v->_first_rt)) {
+			if (layer)
+				Releasep(v->_raster_layer); // no longer a layer
+			return false;
+		}
+		auto &pre = _window->pre_render();
+		if (!layer) {
+			layer = v->_raster_layer = new Layer(v, !v->layer());
+			pre.set_has_layer(); // views start to mark layers
+		} else if (layer->_isAuto == v->layer()) {
+			clearLayer(layer); // switch between explicit and automatic
+			layer->_isAuto = !v->layer();
+		}
+		if (layer->_dirty || layer->_epoch != pre.layer_epoch()) { // the content changed
+			layer->_dirty = false;
+			layer->_epoch = pre.layer_epoch();
+			layer->_static_frames = 0;
+			layer->_ready = false;
+			if (layer->_isAuto)
+				clearLayer(layer); // demote the automatic layer and free its image
+		}
+		Color4f color(_color[0], _color[1], _color[2], 1); // the opacity is applied when compositing
+		auto scale = layer_scale(v->_matrix);
+		if (layer->_ready) {
+			if (scale > layer->_scale * kLayerScaleTolerance ||
+				layer->_size != v->_client_size ||
+				layer->_surface != _canvas->surfaceSize() || layer->_color != color
+			) {
+				layer->_ready = false; // raster again with the new scale or color
+			} else {
+				compositeLayer(v, layer);
+				return true;
+			}
+		}
+		layer->_color = color;
+		layer->_static_frames++;
+
+		if (!layer->_queued) {
+			bool budget = layer->_image || (_layers < kMaxLayers &&
+				(!layer->_isAuto || _autoLayers < kMaxAutoLayers));
+			bool promote = layer->_isAuto ? layer->_static_frames >= autoFrames && budget: true;
+			if (promote) {
+				const char *reason = !budget ? "the layer images are out of budget":
+					!v->_clip ? "the view does not clip its content": nullptr;
+				if (reason) {
+					if (!layer->_isAuto && !layer->_warned) {
+						layer->_warned = true; // log once, the view is drawn directly
+						Qk_DLog("Painter::drawLayer, cannot raster the layer of view %p, %s", v, reason);
+					}
+				} else if (isLayerRasterable(v, scale)) {
+					layer->_queued = true; // raster before drawing the next frame, when no clip is applied
+					_layerQueue.push(layer);
+				}
+			}
+		}
+		return false;
+	}
+
+	bool Painter::isLayerRasterable(Morph *v, float scale) {
+		if (!v->_clip || !v->_visible_area)
+			return false;
+		auto size = v->_client_size * scale;
+		auto canvasSize = _canvas->size();
+		if (size.x() <= 0 || size.y() <= 0 || size.x() > canvasSize.x() || size.y() > canvasSize.y())
+			return false;
+		// The views outside of the clip region are not drawn,
+		// so the view must be entirely inside to raster the complete subtree.
+		auto &clip = _window->getClipRange();
+		auto re = region_aabb_from_convex_quadrilateral(v->_boxBounds);
+		return re.begin.x() >= clip.begin.x() && re.begin.y() >= clip.begin.y() &&
+			re.end.x() <= clip.end.x() && re.end.y() <= clip.end.y();
+	}
+
+	void Painter::rasterLayers() {
+		if (_layerQueue.length() == 0)
+			return;
+		auto epoch = _window->pre_render().layer_epoch();
+		for (auto layer: _layerQueue) {
+			layer->_queued = false;
+			if (layer->_isAuto && (layer->_dirty || layer->_epoch != epoch))
+				continue; // changed again, the view is not static
+			if (!layer->_image && (_layers >= kMaxLayers ||
+				(layer->_isAuto && _autoLayers >= kMaxAutoLayers)))
+				continue; // out of budget
+			auto v = layer->_host;
+			if (v->_level && v->_cascade_visible) // still on the window
+				rasterLayer(layer);
+		}
+		_layerQueue.clear();
+	}
+
+	void Painter::rasterLayer(Layer *layer) {
+		auto v = static_cast<Morph*>(layer->_host);
+		auto size = v->_client_size;
+		auto canvasSize = _canvas->size();
+		// Raster with the scale of the view, which must fit in the image
+		auto scale = F32::min(layer_scale(v->_matrix),
+			F32::min(canvasSize.x() / size.x(), canvasSize.y() / size.y()));
+		if (!(scale > 0))
+			return;
+		auto origin = v->_origin_value;
+		auto lastMatrix = _matrix; // save state
+		auto lastColor = _color;
+		auto lastMarkRecursive = _mark_recursive;
+		auto lastOrigin = _origin;
+		auto lastDamage = _damage;
+
+		// The host is drawn at the rect {-origin,size} of its local space,
+		// the layer image maps the rect to {0,size*scale}.
+		_rasterMatrix = Mat(scale, 0, scale * origin.x(), 0, scale, scale * origin.y()) * v->_matrix.inverse();
+		_raster = layer;
+		_damage = nullptr; // the whole subtree is drawn into the image
+		_color = layer->_color;
+		_mark_recursive = 0;
+		_matrix = &v->_matrix;
+		if (!layer->_image) {
+			_layers++;
+			if (layer->_isAuto)
+				_autoLayers++;
+		}
+		_canvas->save();
+		layer->_image = _canvas->outputImage(layer->_image.get());
+		_canvas->clearColor(Color4f(0, 0, 0, 0));
+		v->draw(this);
+		_canvas->restore(); // restore the output target
+		_raster = nullptr;
+
+		_damage = lastDamage; // restore state
+		_origin = lastOrigin;
+		_mark_recursive = lastMarkRecursive;
+		_color = lastColor;
+		_matrix = lastMatrix;
+
+		layer->_scale = scale;
+		layer->_size = size;
+		layer->_surface = _canvas->surfaceSize();
+		layer->_epoch = _window->pre_render().layer_epoch();
+		layer->_dirty = false;
+		layer->_ready = true;
+	}
+
+	void Painter::compositeLayer(Morph *v, Layer *layer) {
+		if (_mark_recursive) {
+			// The views inside are not drawn, but their matrices are still used for hit testing
+			_window->clipRange(region_aabb_from_convex_quadrilateral(v->_boxBounds));
+			solveLayerMarks(v, &v->_matrix, _mark_recursive);
+			_window->clipRestore();
+		}
+		auto lastMatrix = _matrix;
+		auto lastOrigin = _origin;
+		resetBoxData();
+		set_matrix(&v->_matrix);
+		set_origin(-v->_origin_value);
+		if (v->_color.a())
+			drawBoxShadow(v);
+		Paint paint;
+		PaintImage img;
+		paint.antiAlias = v->_aa;
+		paint.fill.image = &img;
+		paint.fill.color = Color4f(1, 1, 1, _color.a());
+		img.filterMode = default_FilterMode;
+		img.mipmapMode = PaintImage::kNone_MipmapMode;
+		img.setImage(layer->_image.get(), {_origin, _canvas->size() / layer->_scale});
+		_canvas->drawRect({_origin, v->_client_size}, paint);
+		set_origin(lastOrigin);
+		set_matrix(lastMatrix);
+	}
+
+	void Painter::solveLayerMarks(View *view, cMat *mat, uint32_t mark) {
+		auto v = view->_first_rt;
+		while (v) {
+			if (v->_visible) {
+				uint32_t m = mark | v->mark_value();
+				if (m) {
+					v->solve_marks(*mat, view, m);
+					auto morph = v->asMorphView();
+					solveLayerMarks(v, morph ? &morph->matrix(): mat, m & View::kRecursive_Solve_Mark);
+				}
+			}
+			v = v->_next_rt;
+		}
+	}
+
+	void Painter::clearLayer(Layer *layer) {
+		if (layer->_image) {
+			_layers--;
+			if (layer->_isAuto)
+				_autoLayers--;
+			layer->_image = nullptr;
+		}
+		layer->_ready = false;
+	}
+
+	void Painter::removeLayer(Layer *layer) {
+		if (layer->_queued) {
+			for (uint32_t i = 0; i < _layerQueue.length(); i++) {
+				if (_layerQueue[i] == layer) {
+					_layerQueue[i] = _layerQueue.back();
+					_layerQueue.pop();
+					break;
+				}
+			}
+		}
+		if (layer->_image) {
+			_layers--;
+			if (layer->_isAuto)
+				_autoLayers--;
+		}
+	}
+
 	//////////////////////////////////////////////////////////
 
 	void View::draw(Painter *draw) {
@@ -838,6 +1085,8 @@ namespace qk {
 	}
 
 	void Morph::draw(Painter *painter) {
+		if (painter->drawLayer(this))
+			return; // composited from the layer
 		painter->resetBoxData();
 		auto lastMatrix = painter->matrix();
 		auto lastOrigin = painter->origin();
@@ -863,18 +1112,30 @@ namespace qk {
 				painter->_delayCmds = &painter->_delayCmdsStack.back();
 				painter->_tempAllocator[0].reset(); // reset temp allocator
 				painter->_tempAllocator[1].reset(); // reset temp allocator
-				painter->_delayCmdsAllocator.reset(); // reset delay cmds allocator
 				painter->resetBoxData();
+				painter->rasterLayers(); // before the clip of damage region
 				painter->_color = color().to_color4f();
+				auto damage = painter->_damage;
+				if (damage) { // redraw only the damage region, the rest keeps the last frame
+					canvas->save();
+					canvas->setMatrix(Mat());
+					canvas->clipRect({damage->begin, damage->size()}, Canvas::kIntersect_ClipOp, false);
+				}
 				painter->set_origin(-origin_value());
 				painter->set_matrix(&matrix());
-				// The root background is not pre-multiplied, the color is drawn directly.
-				canvas->clearColor(background_color().mul_color4f(painter->_color));
+				if (damage) {
+					canvas->drawColor(background_color().mul_color4f(painter->_color), kSrc_BlendMode);
+				} else {
+					// The root background is not pre-multiplied, the color is drawn directly.
+					canvas->clearColor(background_color().mul_color4f(painter->_color));
+				}
 				painter->drawBoxFill(this);
 				painter->drawBoxBorder(this);
 				painter->set_origin({}); // reset origin
 				painter->visitView(this);
 				painter->flushDelayDrawCommands(); // flush delay draw commands
+				if (damage)
+					canvas->restore(); // cancel damage clip
 			} else {
 				canvas->clearColor(Color4f(0,0,0,0));
 			}
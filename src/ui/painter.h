@@ -39,6 +39,7 @@
 #include "./filter.h"
 #include "./text/text_blob.h"
 #include "./view/box.h"
+#include "./layer.h"
 #include <map>
 #include <deque>
 
@@ -85,9 +86,26 @@ namespace qk {
 		void visitBox(Box *v, cMat *mat = nullptr);
 		void visitAndClipBox(Box *v, void (*cb)(Painter *drawer, Box *v), cMat *mat = nullptr);
 		void flushDelayDrawCommands();
+		/**
+		 * Composite the view from its layer if the layer is ready,
+		 * otherwise returns false to draw the view tree, see Morph::layer
+		 */
+		bool drawLayer(Morph *v);
+		/**
+		 * Raster the layers queued in the last frame, before drawing the root
+		 */
+		void rasterLayers();
+		/**
+		 * Forget the layer when it is deleted
+		 */
+		void removeLayer(Layer *layer);
 		inline void set_matrix(const Mat* mat) {
 			_matrix = mat;
-			_canvas->setMatrix(*mat);
+			if (_raster) { // map the window coordinates into the layer image
+				_canvas->setMatrix(_rasterMatrix * *mat);
+			} else {
+				_canvas->setMatrix(*mat);
+			}
 		}
 		inline void set_origin(Vec2 origin) {
 			_origin = origin;
@@ -105,16 +123,34 @@ namespace qk {
 			return _reuseContainer;
 		}
 		inline void setPosition(Vec2 pos) {
-			_canvas->setTranslate(pos);
+			if (_raster) {
+				_canvas->setMatrix(_rasterMatrix * Mat(*_matrix).set_translate(pos));
+			} else {
+				_canvas->setTranslate(pos);
+			}
+		}
+		// set the region of window to be redrawn, null for full frame
+		inline void set_damage(const Range *damage) {
+			_damage = damage;
 		}
 	private:
+		bool isOutOfDamage(View *v);
+		bool isLayerRasterable(Morph *v, float scale);
+		void rasterLayer(Layer *layer);
+		void compositeLayer(Morph *v, Layer *layer);
+		void solveLayerMarks(View *view, cMat *mat, uint32_t mark);
+		void clearLayer(Layer *layer);
 		Render     *_render;
 		uint32_t   _mark_recursive;
+		const Range *_damage; // damage region of partial redraw
+		Layer      *_raster; // the layer being rastered
+		Mat        _rasterMatrix; // maps the window coordinates into the raster layer image
+		Array<Layer*> _layerQueue; // layers to raster at the beginning of next frame
+		uint32_t   _layers; // images held by all layers
+		uint32_t   _autoLayers; // images held by the automatic layers
 		Buffer     _tempBuff; // reuse buffer for draw text
 		// Reuse allocator, reset when starting every frame
 		LinearAllocator _tempAllocator[2];
-		// allocator for delay draw commands
-		LinearAllocator _delayCmdsAllocator;
 		BoxData _boxData; // reuse box data
 		// reuse container as layout calculation
 		View::Container _reuseContainer;
@@ -128,7 +164,7 @@ namespace qk {
 			} indexed[5];
 			int total = 0;
 		} _pathvs;
-		// Delay draw command for order drawing
+		// Delay draw command for order drawing, allocated from the frame arena of canvas
 		struct DelayCmd {
 			View *view;
 			cMat *matrix;
@@ -36,6 +36,13 @@
 #include "./action/action.h"
 
 namespace qk {
+	// Views marked from a parallel layout worker get this index until they are queued
+	// after the join, so that marking them again does not queue them twice.
+	static constexpr uint32_t kDeferred_MarkIndex = 0xffffffffu;
+	// Smaller levels are not worth the fork-join and run on the render thread
+	static constexpr uint32_t kParallelLayout_MinViews = 64;
+
+	thread_local PreRender::LayoutGroup* PreRender::_layoutGroup = nullptr;
 
 	PreRender::LevelMarks::LevelMarks(): Array<View*>(1) {
 		// Ensure the _mark_index is not zero, so push an empty view as a placeholder
@@ -62,11 +69,31 @@ namespace qk {
 		: _mark_total(0)
 		, _window(win)
 		, _rerender(false)
-	{}
+		, _damage_all(false)
+		, _damage{}
+		, _has_layer(false)
+		, _layer_epoch(0)
+	{
+		_parallel_layout = false;
+	}
+
+	void PreRender::set_parallel_layout(bool val) {
+		_parallel_layout.store(val, std::memory_order_release);
+	}
+
+	bool PreRender::isLayoutWorker() const {
+		return _layoutGroup && _layoutGroup->host == this; // only set while running layout_reverse
+	}
 
 	void PreRender::mark_layout(View *view, uint32_t level) {
 		Qk_ASSERT_EQ(view->_mark_index, 0);
 		Qk_ASSERT_NE(level, 0);
+		if (_layoutGroup) { // parallel layout, queue it after the join
+			Qk_ASSERT_EQ(_layoutGroup->host, this);
+			view->_mark_index = kDeferred_MarkIndex;
+			_layoutGroup->marks.push(view);
+			return;
+		}
 		_marks.extend(level + 1);
 		auto& arr = _marks[level];
 		view->_mark_index = arr.length();
@@ -171,10 +198,23 @@ namespace qk {
 		solveAsyncCall();
 	}
 
-	bool PreRender::solve(int64_t time, int64_t deltaTime) {
-		bool rerender = _rerender;
-		_rerender = false;  // Reset render flag
+	void PreRender::mark_damage(const Range &region) {
+		if (_layoutGroup)
+			return; // the layout redraws the whole window, see solve()
+		_rerender = true;
+		if (!_damage_all)
+			_damage = _damage.isEmpty() ? region: _damage.join(region);
+	}
+
+	bool PreRender::take_damage(Range &region) {
+		bool partial = !_damage_all;
+		region = _damage;
+		_damage = {};
+		_damage_all = false;
+		return partial;
+	}
 
+	bool PreRender::solve(int64_t time, int64_t deltaTime) {
 		// Flush async calls
 		solveAsyncCall();
 
@@ -186,7 +226,14 @@ namespace qk {
 				if ( task ) {
 					if ( time > task->task_timeout() ) {
 						if ( task->run_task(time, deltaTime) ) {
-							rerender = true;
+							mark_rerender(); // the task changes are not tracked by region
+							if (_has_layer) {
+								auto view = task->task_view();
+								if (view)
+									view->mark_layer_rt(true);
+								else
+									mark_layers_dirty();
+							}
 						}
 					}
 					i++;
@@ -196,7 +243,14 @@ namespace qk {
 			}
 		}
 
+		// Render the marks of async calls and tasks in this frame
+		bool rerender = _rerender;
+		_rerender = false;  // Reset render flag
+
+		auto &profiler = _window->profiler();
+
 		if (_mark_total) {
+			FrameProfiler::Scope scope(profiler, FrameProfiler::kClass_Phase);
 			// Resolve CSS before layout, including explicitly queued hidden views.
 			// A hidden view may become visible under a new selector context, so class
 			// processing must not be gated by _cascade_visible.
@@ -209,7 +263,9 @@ namespace qk {
 		}
 
 		// Advance actions
+		profiler.begin(FrameProfiler::kAction_Phase);
 		_window->actionCenter()->advance_rt(deltaTime);
+		profiler.end(FrameProfiler::kAction_Phase);
 
 		// Solve layout marks
 		while (_mark_total) {
@@ -218,37 +274,105 @@ namespace qk {
 			// in this pass for CSS processing, while their layout bits remain in
 			// _mark_value and are restored to the queue when the branch becomes visible.
 			// First forward iteration
-			for (auto &levelMarks: _marks) {
-				for (auto view: levelMarks) {
-					if (view->_cascade_visible)
-						view->layout_forward(view->_mark_value);
-				}
+			profiler.begin(FrameProfiler::kLayoutForward_Phase);
+			for (uint32_t i = 0, len = _marks.length(); i < len; i++) {
+				layout_level(i, false);
 			}
+			profiler.end(FrameProfiler::kLayoutForward_Phase);
 			// Then reverse iteration until no marks. Keep the same visibility guard as
 			// the forward pass so a hidden view cannot consume only half of its layout.
+			profiler.begin(FrameProfiler::kLayoutReverse_Phase);
 			for (int i = _marks.length() - 1; i >= 0; i--) {
-				auto &levelMarks = _marks[i];
-				for (auto view: levelMarks) {
-					if (view->_cascade_visible)
-						view->layout_reverse(view->_mark_value);
-					// simple delete mark recursive
-					view->_mark_index = 0;
-					_mark_total--;
-				}
-				levelMarks.clear();
+				layout_level(i, true);
 			}
+			profiler.end(FrameProfiler::kLayoutReverse_Phase);
 			rerender = true; // Mark as needing render
+			_damage_all = true; // the layout may move any view
 		}
 
 		return rerender;
 	}
 
+	void PreRender::layout_level(uint32_t level, bool reverse) {
+		// Index the queues on every step, as marking a view of a new level extends _marks
+		uint32_t len = _marks[level].length();
+
+		if (reverse && len > kParallelLayout_MinViews && parallel_layout()) {
+			layout_level_parallel(level);
+		} else if (reverse) {
+			for (uint32_t i = 1; i < len; i++) {
+				auto view = _marks[level][i];
+				if (view->_cascade_visible) {
+					view->layout_reverse(view->_mark_value);
+					_window->profiler().count(FrameProfiler::kLayoutViews_Counter);
+				}
+				// simple delete mark recursive
+				view->_mark_index = 0;
+				_mark_total--;
+			}
+		} else {
+			for (uint32_t i = 1; i < len; i++) {
+				auto view = _marks[level][i];
+				if (view->_cascade_visible)
+					view->layout_forward(view->_mark_value);
+			}
+		}
+		if (reverse)
+			_marks[level].clear();
+	}
+
+	void PreRender::layout_level_parallel(uint32_t level) {
+		Array<LayoutGroup> groups;
+		Dict<View*, uint32_t> groupIndexs; // parent => index of group
+		uint32_t len = _marks[level].length();
+
+		// Siblings update the same parent and must run on the same worker
+		for (uint32_t i = 1; i < len; i++) {
+			auto view = _marks[level][i];
+			if (!view->_cascade_visible)
+				continue;
+			uint32_t *index;
+			if (!groupIndexs.get(view->_parent_rt, index)) {
+				index = &groupIndexs.set(view->_parent_rt, groups.length());
+				groups.push({this});
+			}
+			groups[*index].views.push(view);
+		}
+
+		parallel_for(groups.length(), [&](uint32_t i) {
+			auto &group = groups[i];
+			_layoutGroup = &group; // the worker acts for the render thread only in this scope
+			for (auto view: group.views)
+				view->layout_reverse(view->_mark_value);
+			_layoutGroup = nullptr;
+		});
+
+		for (auto &group: groups)
+			_window->profiler().count(FrameProfiler::kLayoutViews_Counter, group.views.length());
+		for (uint32_t i = 1; i < len; i++) {
+			_marks[level][i]->_mark_index = 0; // simple delete mark recursive
+			_mark_total--;
+		}
+		// Queue the deferred marks in group order, as the serial layout would have done
+		for (auto &group: groups) {
+			for (auto view: group.marks) {
+				Qk_ASSERT_EQ(view->_mark_index, kDeferred_MarkIndex);
+				view->_mark_index = 0;
+				mark_layout(view, view->_level);
+			}
+		}
+	}
+
 	RenderTask::~RenderTask() {
 		if (_pre) {
 			_pre->untask(this);
 		}
 	}
 
+	View* RenderTask::task_view() {
+		return nullptr;
+	}
+
 	void RenderTask::set_task_timeout(int64_t timeout_us) {
 		_task_timeout = timeout_us;
 	}
@@ -34,6 +34,7 @@
 #include "../util/list.h"
 #include "../util/array.h"
 #include "../util/thread.h"
+#include "../render/math.h"
 
 namespace qk {
 	class Window;
@@ -54,6 +55,11 @@ namespace qk {
 		inline RenderTask(): _task_timeout(0) {}
 		virtual ~RenderTask();
 		virtual bool run_task(int64_t time, int64_t deltaTime) = 0;
+		/**
+		 * Returns the view changed by the task when run_task() returns true,
+		 * the layers that cache the view are redrawn. Default returns nullptr for all layers
+		 */
+		virtual View* task_view();
 		inline bool is_register_task() const { return _task_id != ID(); }
 		friend class PreRender;
 	};
@@ -64,6 +70,20 @@ namespace qk {
 	class PreRender {
 	public:
 		typedef RenderTask Task;
+
+		/**
+		 * Run the reverse layout (typesetting) of large levels on the parallel_for() workers,
+		 * the forward layout stays serial on the render thread.
+		 *
+		 * The views of a level are grouped by parent, as a view only changes itself, its
+		 * subtree and its parent while laying out, and the groups run in parallel with a
+		 * join before the next level. Layout marks raised by the workers are deferred and
+		 * queued serially in group order after the join, so the queue order stays stable.
+		 * Default: false
+		 * @thread Rt/Ft
+		 */
+		Qk_DEFINE_PROPERTY_Atomic(bool, parallel_layout, Const);
+
 		/*
 		 * @constructor
 		 */
@@ -71,10 +91,46 @@ namespace qk {
 
 		void mark_layout(View *view, uint32_t depth); //!< @thread Rt only render thread call
 		void unmark_layout(View *view, uint32_t depth); //!< @thread Rt only render thread call
+
+		/**
+		 * Returns whether the calling thread is a worker running layout_reverse for a view group
+		 * of this pre render, the only scope where a worker acts for the render thread
+		 */
+		bool isLayoutWorker() const;
+		/**
+		 * mark rerender state, the whole window will be redrawn in the next frame
+		 */
+		inline void mark_rerender() { _rerender = true; _damage_all = true; }
+
+		/**
+		 * Mark a region of the window to be redrawn in the next frame, in window coordinates.
+		 * The regions are joined until the next drawing, see Window::partialRedraw
+		 * @thread Rt
+		 */
+		void mark_damage(const Range &region);
+
+		/**
+		 * Returns whether any view has an offscreen layer, the views inside of
+		 * a layer mark it only if true, see Morph::layer
+		 */
+		inline bool has_layer() const { return _has_layer; }
+
 		/**
-		 * mark rerender state, the view will be rendered in the next frame
+		 * Set has layer flag when the first layer is created
+		 * @thread Rt
 		 */
-		inline void mark_rerender() { _rerender = true; }
+		inline void set_has_layer() { _has_layer = true; }
+
+		/**
+		 * Returns the epoch of layers, the layers rastered in an old epoch are dirty
+		 */
+		inline uint32_t layer_epoch() const { return _layer_epoch.load(std::memory_order_acquire); }
+
+		/**
+		 * Mark all of the layers as dirty, used when the changed view is unknown
+		 * @thread Any
+		 */
+		inline void mark_layers_dirty() { _layer_epoch.fetch_add(1, std::memory_order_acq_rel); }
 
 		/** 
 		 * add pre render task, if task already in pre render then ignore add
@@ -158,6 +214,13 @@ namespace qk {
 		void asyncCommit(); // commit async cmd to ready, only main thread call
 		void solveAsyncCall();
 		void flushAsyncCall();
+		void layout_level(uint32_t level, bool reverse);
+		void layout_level_parallel(uint32_t level); // reverse layout only
+		/**
+		 * Take the joined damage region and reset it,
+		 * return false if the whole window is damaged
+		 */
+		bool take_damage(Range &region);
 
 		struct LevelMarks: Array<View*> {
 			LevelMarks();
@@ -168,14 +231,24 @@ namespace qk {
 		struct AsyncCmds: Array<AsyncCall<>> {
 			void clear();
 		};
+		struct LayoutGroup {
+			PreRender   *host;
+			Array<View*> views; // views of the level that share one parent
+			Array<View*> marks; // views marked by the group, queued after the join
+		};
 
 		Window *_window;
 		int32_t _mark_total;
 		List<Task*> _tasks;
 		Array<LevelMarks> _marks; // marked view layout
 		AsyncCmds _asyncWrite, _asyncReady, _asyncExec;
+		static thread_local LayoutGroup *_layoutGroup; // group laid out in reverse by the current thread
 		Mutex _asyncCommitMutex;
 		bool _rerender; // next frame render
+		bool _damage_all; // the whole window needs to be redrawn
+		Range _damage; // joined damage region, empty if none
+		bool _has_layer; // any view has an offscreen layer
+		std::atomic<uint32_t> _layer_epoch; // layers epoch, marked from any thread
 		friend class Application;
 		friend class Window;
 		friend class View;
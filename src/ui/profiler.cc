@@ -0,0 +1,177 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include <inttypes.h>
+#include "./profiler.h"
+#include "../render/canvas.h"
+#include "../render/pathv_cache.h"
+
+namespace qk {
+
+	FrameProfiler::FrameProfiler(uint32_t capacity)
+		: _ring(Qk_Max(capacity, 1))
+		, _ringNext(0), _ringLength(0), _frame(), _submitTime(0)
+		, _recording(false), _submitSampled(false)
+	{
+		_enabled = false;
+	}
+
+	void FrameProfiler::set_enabled(bool val) {
+		_enabled.store(val, std::memory_order_release);
+	}
+
+	void FrameProfiler::sampleCanvas(Canvas *canvas, uint32_t out[4]) {
+		auto cache = canvas->getPathvCache();
+		out[0] = canvas->drawCalls();
+		out[1] = cache ? cache->hits(): 0;
+		out[2] = cache ? cache->misses(): 0;
+		out[3] = cache ? cache->evictions(): 0;
+	}
+
+	void FrameProfiler::sampleSubmit(Canvas *canvas) {
+		auto total = canvas->submitTime();
+		auto duration = total - _submitTime; // unsigned difference, wrap around safe
+		// the rendering thread submitted the commands of the last committed frame since then
+		if (_submitSampled && duration) {
+			ScopeLock lock(_mutex);
+			if (_ringLength) {
+				auto &last = _ring[(_ringNext + _ring.length() - 1) % _ring.length()];
+				last.phases[kSubmit_Phase].begin = canvas->submitBegin();
+				last.phases[kSubmit_Phase].duration += duration;
+			}
+		}
+		_submitTime = total;
+		_submitSampled = true;
+	}
+
+	void FrameProfiler::beginFrame(Canvas *canvas) {
+		_recording = _enabled.load(std::memory_order_acquire);
+		if (!_recording)
+			_submitSampled = false; // don't count the submits while disabled
+		if (_recording) {
+			_frame = Frame();
+			_frame.frame.begin = time_monotonic();
+			sampleCanvas(canvas, _canvasBegin);
+		}
+	}
+
+	void FrameProfiler::endFrame(Canvas *canvas, bool commit) {
+		if (!_recording)
+			return;
+		_recording = false;
+		sampleSubmit(canvas);
+		if (!commit)
+			return;
+		uint32_t canvasEnd[4];
+		sampleCanvas(canvas, canvasEnd);
+		// unsigned differences stay correct when the canvas counters wrap around
+		_frame.counters[kDrawCalls_Counter] = canvasEnd[0] - _canvasBegin[0];
+		_frame.counters[kPathCacheHits_Counter] = canvasEnd[1] - _canvasBegin[1];
+		_frame.counters[kPathCacheMisses_Counter] = canvasEnd[2] - _canvasBegin[2];
+		_frame.counters[kPathCacheEvictions_Counter] = canvasEnd[3] - _canvasBegin[3];
+		_frame.frame.duration = uint32_t(time_monotonic() - _frame.frame.begin);
+
+		ScopeLock lock(_mutex);
+		_ring[_ringNext] = _frame;
+		_ringNext = (_ringNext + 1) % _ring.length();
+		_ringLength = Qk_Min(_ringLength + 1, _ring.length());
+	}
+
+	void FrameProfiler::beginPhase(Phase phase) {
+		auto now = time_monotonic();
+		_phaseBegin[phase] = now;
+		if (!_frame.phases[phase].begin)
+			_frame.phases[phase].begin = now;
+	}
+
+	void FrameProfiler::endPhase(Phase phase) {
+		_frame.phases[phase].duration += uint32_t(time_monotonic() - _phaseBegin[phase]);
+	}
+
+	Array<FrameProfiler::Frame> FrameProfiler::frames() const {
+		ScopeLock lock(_mutex);
+		Array<Frame> frames(_ringLength);
+		uint32_t first = (_ringNext + _ring.length() - _ringLength) % _ring.length();
+		for (uint32_t i = 0; i < _ringLength; i++) {
+			frames[i] = _ring[(first + i) % _ring.length()];
+		}
+		return frames;
+	}
+
+	String FrameProfiler::chromeTrace() const {
+		Array<String> events;
+		for (auto &frame: frames()) {
+			events.push(String::format(
+				"{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%" PRId64 ",\"dur\":%u}",
+				frame.frame.begin, frame.frame.duration
+			));
+			for (int i = 0; i < kPhase_Count; i++) {
+				auto &span = frame.phases[i];
+				if (span.begin) {
+					events.push(String::format( // the submit phase runs on the rendering thread
+						"{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%" PRId64 ",\"dur\":%u}",
+						phaseName(Phase(i)), i == kSubmit_Phase ? 2: 1, span.begin, span.duration
+					));
+				}
+			}
+			Array<String> args;
+			for (int i = 0; i < kCounter_Count; i++) {
+				args.push(String::format("\"%s\":%u", counterName(Counter(i)), frame.counters[i]));
+			}
+			events.push(String::format(
+				"{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":%" PRId64 ",\"args\":{%s}}",
+				frame.frame.begin, args.join(",").c_str()
+			));
+		}
+		return String("{\"traceEvents\":[") + events.join(",") + "],\"displayTimeUnit\":\"ms\"}";
+	}
+
+	void FrameProfiler::clear() {
+		ScopeLock lock(_mutex);
+		_ringNext = 0;
+		_ringLength = 0;
+	}
+
+	cChar* FrameProfiler::phaseName(Phase phase) {
+		static cChar* names[kPhase_Count] = {
+			"class", "action", "layoutForward", "layoutReverse", "paint", "swap", "submit",
+		};
+		return names[phase];
+	}
+
+	cChar* FrameProfiler::counterName(Counter counter) {
+		static cChar* names[kCounter_Count] = {
+			"layoutViews", "paintViews", "drawCalls", "pathCacheHits", "pathCacheMisses",
+			"pathCacheEvictions",
+		};
+		return names[counter];
+	}
+
+}
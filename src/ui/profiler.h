@@ -0,0 +1,174 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __quark__ui__profiler__
+#define __quark__ui__profiler__
+
+#include "../util/array.h"
+#include "../util/thread.h"
+#include "../render/math.h"
+
+namespace qk {
+	class Canvas;
+
+	/**
+	 * @class FrameProfiler
+	 *
+	 * Low-overhead per-frame tracer for the render thread. Every rendered frame records
+	 * the duration of its phases and a few counters into a fixed-size ring buffer, which
+	 * can be read from any thread or dumped as Chrome trace JSON (chrome://tracing, Perfetto).
+	 *
+	 * When disabled, every probe is a single branch on a render thread local flag.
+	 * All times are in microseconds from time_monotonic().
+	 *
+	 * The commands of a frame are submitted to the GPU by the rendering thread after
+	 * the frame ends, so the submit phase of a frame is filled in when the next frame ends.
+	 */
+	class Qk_EXPORT FrameProfiler {
+		Qk_DISABLE_COPY(FrameProfiler);
+	public:
+		enum Phase {
+			kClass_Phase,         //!< CSS class apply
+			kAction_Phase,        //!< actions advance
+			kLayoutForward_Phase, //!< forward layout pass
+			kLayoutReverse_Phase, //!< reverse layout pass
+			kPaint_Phase,         //!< painter visitation
+			kSwap_Phase,          //!< hand the recorded commands to the rendering thread, swapBuffer()
+			kSubmit_Phase,        //!< submit the commands to the GPU on the rendering thread, filled in by the next frame
+			kPhase_Count,
+		};
+
+		enum Counter {
+			kLayoutViews_Counter,        //!< views laid out by the reverse pass
+			kPaintViews_Counter,         //!< views visited by the painter
+			kDrawCalls_Counter,          //!< draw commands recorded by the canvas
+			kPathCacheHits_Counter,      //!< path cache lookups served from the cache
+			kPathCacheMisses_Counter,    //!< path cache lookups that built new data
+			kPathCacheEvictions_Counter, //!< path cache entries evicted by the capacity limit
+			kCounter_Count,
+		};
+
+		struct Span {
+			int64_t  begin;    //!< begin time of the first run in the frame, zero if it did not run
+			uint32_t duration; //!< total duration of all runs in the frame
+		};
+
+		struct Frame {
+			Span     frame; //!< whole frame
+			Span     phases[kPhase_Count];
+			uint32_t counters[kCounter_Count];
+			Range    damage; //!< region redrawn by the partial redraw, empty for a full frame
+		};
+
+		/**
+		 * @struct Scope records a phase for the lifetime of the object
+		 */
+		struct Scope {
+			inline Scope(FrameProfiler &host, Phase phase): _host(host), _phase(phase) {
+				host.begin(phase);
+			}
+			inline ~Scope() { _host.end(_phase); }
+		private:
+			FrameProfiler &_host;
+			Phase _phase;
+		};
+
+		/**
+		 * Whether to record frames, it takes effect at the next frame
+		 * @thread Rt/Ft
+		 */
+		Qk_DEFINE_PROPERTY_Atomic(bool, enabled, Const);
+
+		/**
+		 * @param capacity {uint32_t} max number of frames kept by the ring buffer
+		 */
+		FrameProfiler(uint32_t capacity = 300);
+
+		void beginFrame(Canvas *canvas); //!< @thread Rt
+		/**
+		 * Finish the current frame and keep it if `commit` is true,
+		 * frames that were not rendered should not be committed.
+		 * @thread Rt
+		 */
+		void endFrame(Canvas *canvas, bool commit);
+
+		inline void begin(Phase phase) {
+			if (_recording) beginPhase(phase);
+		}
+		inline void end(Phase phase) {
+			if (_recording) endPhase(phase);
+		}
+		inline void count(Counter counter, uint32_t n = 1) {
+			if (_recording) _frame.counters[counter] += n;
+		}
+		inline void damage(const Range &region) {
+			if (_recording) _frame.damage = region;
+		}
+
+		/**
+		 * Returns the recorded frames, oldest first
+		 * @thread Rt/Ft
+		 */
+		Array<Frame> frames() const;
+
+		/**
+		 * Returns the recorded frames as Chrome trace event JSON
+		 * @thread Rt/Ft
+		 */
+		String chromeTrace() const;
+
+		/**
+		 * Clear the recorded frames
+		 * @thread Rt/Ft
+		 */
+		void clear();
+
+		static cChar* phaseName(Phase phase);
+		static cChar* counterName(Counter counter);
+
+	private:
+		void beginPhase(Phase phase);
+		void endPhase(Phase phase);
+		void sampleCanvas(Canvas *canvas, uint32_t out[4]);
+		void sampleSubmit(Canvas *canvas);
+
+		Array<Frame> _ring;
+		uint32_t     _ringNext, _ringLength;
+		mutable Mutex _mutex; // guards the ring buffer
+		// current frame, render thread only
+		Frame    _frame;
+		int64_t  _phaseBegin[kPhase_Count];
+		uint32_t _canvasBegin[4]; // draw calls, path cache hits, misses and evictions at frame begin
+		uint32_t _submitTime; // submit time of the canvas at the last frame end
+		bool     _recording, _submitSampled;
+	};
+
+}
+#endif
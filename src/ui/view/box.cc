@@ -822,7 +822,7 @@ namespace qk {
 		_BorderAlloc();
 		if (_border->color[0] != val) {
 			_border->color[0] = val;
-			mark_rerender();
+			mark_repaint();
 		}
 	}
 
@@ -830,7 +830,7 @@ namespace qk {
 		_BorderAlloc();
 		if (_border->color[1] != val) {
 			_border->color[1] = val;
-			mark_rerender();
+			mark_repaint();
 		}
 	}
 
@@ -838,7 +838,7 @@ namespace qk {
 		_BorderAlloc();
 		if (_border->color[2] != val) {
 			_border->color[2] = val;
-			mark_rerender();
+			mark_repaint();
 		}
 	}
 
@@ -846,7 +846,7 @@ namespace qk {
 		_BorderAlloc();
 		if (_border->color[3] != val) {
 			_border->color[3] = val;
-			mark_rerender();
+			mark_repaint();
 		}
 	}
 
@@ -889,7 +889,7 @@ namespace qk {
 	void Box::set_background_color_direct(Color color, bool isRT) {
 		if (_background_color != color) {
 			_background_color = color;
-			mark_rerender();
+			mark_repaint();
 		}
 	}
 
@@ -980,6 +980,18 @@ namespace qk {
 		_visible_area = compute_visible_area(mat, _boxBounds);
 	}
 
+	void Box::mark_repaint() {
+		if (window()->isUILocked()) {
+			if (_visible_area && _cascade_visible) // nothing to redraw if not on the screen
+				pre_render().mark_damage(region_aabb_from_convex_quadrilateral(_boxBounds));
+			mark_layer_rt(true);
+		} else if (RunLoop::is_first()) {
+			_async_call({ self->mark_repaint(); }, 0); // join the region on the render thread
+		} else {
+			mark_rerender();
+		}
+	}
+
 	Vec2 Box::layout_offset_inside() {
 		Vec2 offset(
 			_padding_left, _padding_top
@@ -121,6 +121,14 @@ namespace qk {
 		virtual void draw(Painter *render) override;
 		virtual void destroy() override;
 
+		/**
+		 * Mark only the box region of the view as needing to be redrawn,
+		 * for the appearance changes that do not draw outside the box bounds.
+		 * @method mark_repaint()
+		 * @thread Any
+		 */
+		void mark_repaint();
+
 	protected:
 		/**
 			* @method set_content_size(content_size)
@@ -117,6 +117,14 @@ namespace qk {
 	void Entity::solve_visible_area(const Mat &mat) {
 		solve_bounds(); // compute bounds pts and circle
 		_visible_area = true; // Always visible
+		if (_bounds.type == kDefault || _bounds.type == kCircle || _bounds.type == kPolygon) {
+			Vec2 boxBounds[4];
+			solve_box_Bounds(mat, boxBounds); // the same bounds as the overlap test
+			auto re = region_aabb_from_convex_quadrilateral(boxBounds);
+			update_hit_grid_rt(&re);
+		} else {
+			update_hit_grid_rt(nullptr);
+		}
 	}
 
 	void Entity::solve_bounds() {
@@ -297,10 +305,14 @@ namespace qk {
 	}
 
 	bool Entity::test_entity_vs_entity(Entity *o, MTV *outMTV, Vec2 *outMtvVec, bool computeMTV) {
+		return test_entity_vs_entity(_circleBounds, ptsOfBounds(), o, outMTV, outMtvVec, computeMTV);
+	}
+
+	bool Entity::test_entity_vs_entity(const Circle &circ, Array<Vec2> &pts,
+		Entity *o, MTV *outMTV, Vec2 *outMtvVec, bool computeMTV)
+	{
 		Qk_ASSERT(_bounds.type != Entity::kLineSegment); // line segment agent does not move
 		bool isPoly = _bounds.type == Entity::kPolygon;
-		auto &pts = ptsOfBounds();
-		auto &circ = _circleBounds;
 		bool collided = false;
 		if (o->_bounds.type == Entity::kDefault || o->_bounds.type == Entity::kCircle) {
 			// circle vs circle
@@ -202,6 +202,13 @@ namespace qk {
 	private:
 		bool test_entity_vs_entity(Entity *other, MTV *outMTV, Vec2 *outMtvVec, bool computeMTV);
 
+		/**
+		 * Same as above but tests with the given bounds of this entity instead of the cached bounds,
+		 * used when the entity is simulated on a private copy of its bounds.
+		 */
+		bool test_entity_vs_entity(const Circle &circ, Array<Vec2> &pts,
+			Entity *other, MTV *outMTV, Vec2 *outMtvVec, bool computeMTV);
+
 		/** Draw debug outlines for development visualization. */
 		void debugDraw(Painter *painter);
 
@@ -32,6 +32,7 @@
 #include "../../render/render.h"
 #include "../window.h"
 #include "../app.h"
+#include "../screen.h"
 #include "../../errno.h"
 
 namespace qk {
@@ -54,16 +55,37 @@ namespace qk {
 	}
 
 	void Image::set_src_direct(String val, bool isRT) {
-		if (ImageSourceHold::set_src(val)) {
+		if (ImageSourceHold::set_src(val, decode_size())) {
 			mark_layout(kLayout_Inner_Width | kLayout_Inner_Height, isRT);
 		}
 	}
 
+	Vec2 Image::decode_size(View *view, Vec2 size) {
+		return size * (view ? view->window()->scale(): Screen::main_screen_scale());
+	}
+
+	Vec2 Image::decode_size() {
+		// decode directly to the fixed size of view, save memory for thumbnails
+		auto w = width(), h = height();
+		if (w.kind == BoxSizeKind::Value && h.kind == BoxSizeKind::Value) {
+			return decode_size(this, Vec2(w.value, h.value));
+		}
+		return Vec2(); // the natural size of image affects the layout
+	}
+
 	uint32_t Image::solve_layout_content_size_pre(uint32_t &mark, const Container &pContainer) {
 		uint32_t change_mark = kLayout_None;
 		
 		if (mark & (kLayout_Inner_Width | kLayout_Inner_Height)) {
 			auto src = source(); // Rt
+			if (src && src->decodeSize() != Vec2()) { // decoded to the size hint
+				auto size = decode_size();
+				if (size == Vec2() || size[0] > src->decodeSize()[0] || size[1] > src->decodeSize()[1]) {
+					// the size is no longer fixed or grows past the decoded size, request again
+					ImageSourceHold::set_src(src->uri(), size);
+					src = source();
+				}
+			}
 			int w,h;
 			if (src) {
 				w = Qk_Max(1,src->width());
@@ -115,6 +137,9 @@ namespace qk {
 			Sp<UIEvent> evt = new UIEvent(this);
 			trigger(UIEvent_Load, **evt);
 		}
+		else if (state & ImageSource::kSTATE_LOAD_PARTIAL) { // progressive preview
+			mark_layout(kLayout_Inner_Width | kLayout_Inner_Height);
+		}
 		else if (state & (ImageSource::kSTATE_LOAD_ERROR | ImageSource::kSTATE_DECODE_ERROR)) {
 			Sp<UIEvent> evt = new UIEvent(this, new Error(ERR_IMAGE_LOAD_ERROR, "ERR_IMAGE_LOAD_ERROR"));
 			trigger(UIEvent_Error, **evt);
@@ -44,10 +44,18 @@ namespace qk {
 		Qk_DEFINE_VIEW_ACCESSOR(String, src, Const);
 		virtual ViewType view_type() const override;
 		virtual void draw(Painter *render) override;
+
+		/**
+		 * Returns the size hint in pixels to decode the image for the fixed size of view,
+		 * the image filling of a box without view uses the main screen scale
+		 */
+		static Vec2 decode_size(View *view, Vec2 size);
 	protected:
 		virtual uint32_t solve_layout_content_size_pre(uint32_t &mark, const Container &pContainer) override;
 		virtual void onSourceState(ImageSource::State state) override;
 		virtual ImagePool* imgPool() override;
+	private:
+		Vec2 decode_size();
 	};
 }
 #endif
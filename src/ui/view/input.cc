@@ -1258,6 +1258,10 @@ namespace qk {
 		_input_text_offset_y = val.y();
 	}
 
+	View* Input::task_view() {
+		return this;
+	}
+
 	bool Input::run_task(int64_t time, int64_t deltaTime) {
 		if ( _flag > kFlag_Find_Cursor_Disable ) {
 			if ( _flag == kFlag_Auto_Find_Cursor || _flag == kFlag_Auto_Range_Select ) {
@@ -1268,6 +1272,10 @@ namespace qk {
 		} else {
 			_cursor_twinkle_status = !_cursor_twinkle_status;
 			set_task_timeout(time + 700000); /* 700ms */
+			if (clip()) { // the cursor can only be drawn inside the box
+				mark_repaint();
+				return false;
+			}
 			return true;
 		}
 		return false;
@@ -117,6 +117,7 @@ namespace qk {
 		virtual TextInput* asTextInput() override;
 		virtual TextOptions* asTextOptions() override;
 		virtual bool run_task(int64_t time, int64_t deltaTime) override;
+		virtual View* task_view() override;
 		// impl text input
 		virtual void input_delete(int count) override;
 		virtual void input_insert(cString& text) override;
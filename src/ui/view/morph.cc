@@ -322,10 +322,21 @@ namespace qk {
 	/////////////////////////////////////////////////////////////
 
 	Morph::Morph()
-		: Box(), MorphView(this)
+		: Box(), MorphView(this), _layer(false)
 	{
 	}
 
+	void Morph::set_layer(bool val) {
+		_async_call({ self->set_layer_direct(arg, true); }, val);
+	}
+
+	void Morph::set_layer_direct(bool val, bool isRT) {
+		if (_layer != val) {
+			_layer = val;
+			mark_rerender();
+		}
+	}
+
 	MorphView* Morph::asMorphView() {
 		return this;
 	}
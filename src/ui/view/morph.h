@@ -89,6 +89,19 @@ namespace qk {
 		*/
 	class Morph: public Box, public MorphView {
 	public:
+		/**
+		 * Cache the subtree in an offscreen layer, it is rendered once into an image and then
+		 * composited as a single textured rect until a view inside it is changed,
+		 * so the transform and opacity animations of the view only cost one rect.
+		 *
+		 * The view must clip its content, and the layer is rastered only when the view is
+		 * entirely inside the visible region. The layer holds a full surface size image,
+		 * at most 16 layer images are held by a window, 8 of them for the automatic layers.
+		 * Otherwise the subtree is drawn directly as without layer, and a debug log is printed.
+		 * Default: false
+		*/
+		Qk_DEFINE_VIEW_PROPERTY(bool, layer, Const);
+
 		Morph();
 		ViewType view_type() const override;
 		MorphView* asMorphView() override;
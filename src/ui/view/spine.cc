@@ -273,6 +273,10 @@ namespace qk {
 		}
 	}
 
+	View* Spine::task_view() {
+		return this;
+	}
+
 	bool Spine::run_task(int64_t time, int64_t delta) {
 		_IfAutoMutex(false);
 		auto deltaTime = _speed * 0.000001f * delta; /* delta in seconds */
@@ -332,6 +332,7 @@ namespace qk {
 		 * @return true if task continues, false to stop.
 		 */
 		bool run_task(int64_t time, int64_t delta) override;
+		View* task_view() override;
 
 		/**
 		 * @brief Resets skeleton to its full setup pose (bones + slots).
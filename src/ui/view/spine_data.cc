@@ -45,8 +45,7 @@ namespace qk {
 		Qk_ASSERT(source, "Invalid image");
 		Qk_ASSERT_NE(page.width, 0, "Invalid image width");
 		Qk_ASSERT_NE(page.height, 0, "Invalid image height");
-		source->retain();
-		page.texture = source;
+		page.texture = source.collapse(); // held by the page until unload
 	}
 
 	void QkTextureLoader::unload(void *texture) {
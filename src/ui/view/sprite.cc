@@ -226,6 +226,9 @@ namespace qk {
 			Sp<UIEvent> evt = new UIEvent(this);
 			trigger(UIEvent_Load, **evt);
 		}
+		else if (state & ImageSource::kSTATE_LOAD_PARTIAL) { // progressive preview
+			mark(kLayout_None);
+		}
 		else if (state & (ImageSource::kSTATE_LOAD_ERROR | ImageSource::kSTATE_DECODE_ERROR)) {
 			Sp<UIEvent> evt = new UIEvent(this, new Error(ERR_IMAGE_LOAD_ERROR, "ERR_IMAGE_LOAD_ERROR"));
 			trigger(UIEvent_Error, **evt);
@@ -97,6 +97,10 @@ namespace qk {
 		}
 	}
 
+	View* Video::task_view() {
+		return this;
+	}
+
 	bool Video::run_task(int64_t now, int64_t deltaTime) {
 		ScopeLock lock(_mutex);
 		if (!_video) {
@@ -51,6 +51,7 @@ namespace qk {
 		void unlock() override;
 		void onEvent(const UIEventName& name, Object* data) override;
 		bool run_task(int64_t now, int64_t deltaTime) override;
+		View* task_view() override;
 		void onSourceState(ImageSource::State state) override;
 	};
 }
@@ -38,6 +38,8 @@
 #include "../css/css_props.h"
 #include "../geometry.h"
 #include "../painter.h"
+#include "../event.h"
+#include "../layer.h"
 
 #if DEBUG
 # define _Assert_IsRt(isRt, ...) \
@@ -118,6 +120,7 @@ namespace qk {
 		, _parent_rt(nullptr), _prev_rt(nullptr)
 		, _next_rt(nullptr), _first_rt(nullptr), _last_rt(nullptr)
 		, _cssclass(nullptr)
+		, _raster_layer(nullptr)
 		, _window(nullptr)
 		, _action(nullptr)
 		, _accessor(nullptr)
@@ -160,6 +163,8 @@ namespace qk {
 			if (center) {
 				center->removeCSSTransition_rt(self);
 			}
+			Releasep(self->_raster_layer); // the layer needs the window
+			self->update_hit_grid_rt(nullptr);
 			self->_window = nullptr;
 			self->Object::destroy();
 		}, this, 0);
@@ -256,7 +261,8 @@ namespace qk {
 		uint8_t alpha8 = val * 255;
 		if (_color.a() != alpha8) {
 			_color.set_a(alpha8);
-			mark_rerender();
+			pre_render().mark_rerender();
+			mark_layer_(false); // the opacity is applied when compositing the layer of self
 		}
 	}
 
@@ -345,6 +351,12 @@ namespace qk {
 		_visible_area = true; // Always visible
 	}
 
+	void View::update_hit_grid_rt(const Range *bounds) {
+		auto dispatch = _window->dispatch();
+		if (dispatch) // null if the window has been closed
+			dispatch->updateHitGrid(this, bounds);
+	}
+
 	bool View::compute_visible_area(const Mat &mat, Vec2 bounds[4]) {
 		/*
 		* 这里考虑到性能不做精确的多边形重叠测试，只测试图形在横纵轴是否与当前绘图区域是否为重叠。
@@ -359,6 +371,7 @@ namespace qk {
 					<= re.end.x() - re.begin.x() + clip.size.x()
 				) {
 			//_visible_area = !_client_size.is_zero_axis();
+			update_hit_grid_rt(&re);
 			return true;
 		} else {
 
@@ -368,6 +381,7 @@ namespace qk {
 			Qk_DLog("visible_area-y: %f<=%f", Qk_Max( clip.x2, re.end.x() ) - Qk_Min( clip.x, re.origin.x() ),
 																				re.end.x() - re.origin.x() + clip.width);
 #endif
+			update_hit_grid_rt(nullptr);
 			return false;
 		}
 	}
@@ -487,11 +501,16 @@ namespace qk {
 	void View::onActivate() {
 	}
 
+	void View::mark_rerender() {
+		pre_render().mark_rerender();
+		mark_layer_(true);
+	}
+
 	void View::mark_(uint32_t mark) {
 		if (mark) {
 			_async_call({ self->mark_rt_(arg); }, mark);
 		} else {
-			pre_render()._rerender = true;
+			mark_rerender();
 		}
 	}
 
@@ -501,7 +520,9 @@ namespace qk {
 
 	void View::mark_rt_(uint32_t mark) {
 		_mark_value |= mark;
-		pre_render()._rerender = true;
+		pre_render().mark_rerender();
+		// moving the view only changes the layers of parents
+		mark_layer_rt(mark & ~(kTransform | kVisible_Region));
 	}
 
 	void View::mark_layout_rt_(uint32_t mark, bool canLayout) {
@@ -515,6 +536,30 @@ namespace qk {
 				pre_render().mark_layout(this, _level); // push to pre render
 			}
 		}
+		mark_layer_rt(true);
+	}
+
+	void View::mark_layer_(bool inner) {
+		if (!pre_render().has_layer())
+			return;
+		if (_window->isUILocked()) {
+			mark_layer_rt(inner);
+		} else if (RunLoop::is_first()) {
+			_async_call({ self->mark_layer_rt(arg); }, inner);
+		} else {
+			pre_render().mark_layers_dirty(); // the view tree cannot be accessed on this thread
+		}
+	}
+
+	void View::mark_layer_rt(bool inner) {
+		if (!pre_render().has_layer())
+			return;
+		auto v = inner ? this: _parent_rt;
+		while (v) {
+			if (v->_raster_layer)
+				v->_raster_layer->mark_dirty(); // nested layers contain the inner layers
+			v = v->_parent_rt;
+		}
 	}
 
 	bool View::is_clip() {
@@ -949,6 +994,7 @@ namespace qk {
 			pre_render().unmark_layout(this, _level);
 		_level = 0;
 		_cascade_visible = false;
+		update_hit_grid_rt(nullptr); // not hit until it is attached and drawn again
 		onActivate();
 		auto v = _first_rt;
 		while ( v ) {
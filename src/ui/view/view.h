@@ -226,6 +226,10 @@ namespace qk {
 		// @thread Mt/w,Any/r
 		private: std::atomic<CStyleSheetsClass*> _cssclass;
 
+		// The offscreen raster cache of this view subtree, see Morph::layer
+		// @thread Rt
+		private: Layer *_raster_layer;
+
 		/**
 		 * @prop style sheets class object
 		 * @thread Mt
@@ -834,14 +838,15 @@ namespace qk {
 		 * Mark the view as needing to be rendered only.
 		 *
 		 * It indicates that the view's visual appearance has changed and requires
-		 * a redraw in the next rendering pass.
+		 * a redraw of the whole window in the next rendering pass.
+		 * The layers that cache the view are marked as dirty too.
 		 *
 		 * Thread safety:
 		 *   - This method can be called from any thread.
 		 * 
 		 * @thread Any
 		 */
-		inline void mark_rerender() { _window->pre_render()._rerender = true; }
+		void mark_rerender();
 
 		/**
 		 * Mark the view as needing a render/update pass.
@@ -918,11 +923,27 @@ namespace qk {
 
 	protected:
 		/**
-		 * Compute the view is visible in the screen or the clipped region
+		 * Compute the view is visible in the screen or the clipped region,
+		 * and update the hit test grid of the window from the bounds
 		 * @thread Rt
 		*/
 		bool compute_visible_area(const Mat &mat, Vec2 bounds[4]);
 
+		/**
+		 * Update the bounds of this view in the hit test grid, see EventDispatch::updateHitGrid
+		 * @param bounds {const Range*} bounds in window coords, null to remove the view
+		 * @thread Rt
+		*/
+		void update_hit_grid_rt(const Range *bounds);
+
+		/**
+		 * Mark the layers that cache this view as dirty, see Morph::layer
+		 * @param inner {bool} the content of this view changed, otherwise only its compositing,
+		 *   as the opacity or the matrix, and the layer of this view itself keeps valid
+		 * @thread Rt
+		*/
+		void mark_layer_rt(bool inner);
+
 		View(); // @constructor
 		virtual
 		View* init(Window* win);
@@ -953,6 +974,7 @@ namespace qk {
 		// canLayout may be forced by CSS only to admit a hidden candidate into the
 		// normal class-resolution queue; it does not force any style to be applied.
 		void mark_layout_rt_(uint32_t mark, bool canLayout);
+		void mark_layer_(bool inner); // mark layers from any thread
 
 		friend class Painter;
 		friend class PreRender;
@@ -28,12 +28,50 @@
  *
  * ***** END LICENSE BLOCK ***** */
 
+#include <algorithm>
 #include "./world.h"
 #include "./entity.h"
 
 namespace qk {
 	// Geometric epsilon for float comparisons
 	constexpr float GEOM_EPS = 1e-6f;
+	// Entities covering more cells than this are kept out of the grid and always queried
+	constexpr int32_t GRID_MAX_CELLS = 64;
+	// Minimum grid cell size in world units
+	constexpr float GRID_MIN_CELL_SIZE = 8.0f;
+
+	inline uint64_t gridKey(int32_t x, int32_t y) {
+		return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+	}
+
+	/**
+	 * Private state of an agent stepped by World::stepAgents().
+	 * Other agents keep reading the cached bounds, which stay unchanged as the snapshot.
+	 */
+	struct AgentSim {
+		Agent       *agent;
+		Circle      circle; // private circle bounds
+		Array<Vec2> pts; // private bounds points
+		bool        moved; // translate changed, mark transform at commit
+		Array<Cb>   posts; // deferred event callbacks, posted in order at commit
+	};
+
+	// agent currently stepped on this thread
+	static thread_local AgentSim *tls_agentSim = nullptr;
+
+	inline AgentSim* agentSimOf(Agent* agent) {
+		auto sim = tls_agentSim;
+		return sim && sim->agent == agent ? sim: nullptr;
+	}
+
+	static void postAgentEvent(Agent* agent, Cb cb) {
+		auto sim = agentSimOf(agent);
+		if (sim) {
+			sim->posts.push(cb); // keep the event order independent of thread scheduling
+		} else {
+			agent->pre_render().post(cb, agent);
+		}
+	}
 
 	static float frandf(float min, float max) {
 		constexpr float randMaxInv = 1.0f / float(RAND_MAX);
@@ -50,7 +88,7 @@ namespace qk {
 			cUIEventName& name;
 		};
 		auto core = new CbCore(name, evt);
-		agent->pre_render().post(Cb(core), agent);
+		postAgentEvent(agent, Cb(core));
 	}
 
 	template<class T, typename... Args>
@@ -73,7 +111,7 @@ namespace qk {
 		};
 		auto core = new CbCore;
 		core->w = { Sp<Agent>::lazy(otherPtr), mtv, level, entering };
-		agent->pre_render().post(Cb(core), agent); // post to main thread
+		postAgentEvent(agent, Cb(core)); // post to main thread
 	}
 
 	World::World()
@@ -81,7 +119,7 @@ namespace qk {
 		, _subSteps(1), _timeScale(1.0f)
 		, _predictionTime(0.5f)
 		, _discoveryThresholdBuffer(5.0f)
-		, _waypointRadius(0.0f) {
+		, _waypointRadius(0.0f), _parallel(false), _cellSize(0.0f) {
 		_layout = LayoutType::Free;
 	}
 
@@ -122,6 +160,10 @@ namespace qk {
 		_waypointRadius = F32::max(value, 0.0f);
 	}
 
+	void World::set_parallel(bool value) {
+		_parallel = value;
+	}
+
 	ViewType World::view_type() const {
 		return kWorld_ViewType;
 	}
@@ -159,11 +201,17 @@ namespace qk {
 				}
 			}
 			if (child->parent_rt()) { // add to world
-				_entities.set(entity, other != nullptr);
-				entity->retain(); // retain for world
+				if (!_entities.has(entity)) {
+					_entities.set(entity, {other != nullptr, false});
+					entity->retain(); // retain for world
+				}
 			} else { // remove from world
-				_entities.erase(entity);
-				entity->release(); // release for world
+				EntityState *state;
+				if (_entities.get(entity, state)) {
+					removeFromGrid(entity, *state);
+					_entities.erase(entity);
+					entity->release(); // release for world
+				}
 			}
 		}
 		View::onChildLayoutChange(child, mark);
@@ -210,17 +258,232 @@ namespace qk {
 		}
 	}
 
+	World::GridRange World::gridRangeOf(const Circle &circ) const {
+		float inv = 1.0f / _cellSize;
+		auto &c = circ.center;
+		return {
+			int32_t(floorf((c.x() - circ.radius) * inv)), int32_t(floorf((c.y() - circ.radius) * inv)),
+			int32_t(floorf((c.x() + circ.radius) * inv)), int32_t(floorf((c.y() + circ.radius) * inv)),
+		};
+	}
+
+	void World::removeFromGrid(Entity* entity, EntityState &state) {
+		if (state.isLarge) {
+			for (uint32_t i = 0; i < _largeEntities.length(); i++) {
+				if (_largeEntities[i] == entity) {
+					_largeEntities[i] = _largeEntities.back();
+					_largeEntities.pop();
+					break;
+				}
+			}
+			state.isLarge = false;
+		}
+		auto &r = state.cells;
+		for (int32_t y = r.y0; y <= r.y1; y++) {
+			for (int32_t x = r.x0; x <= r.x1; x++) {
+				auto it = _grid.find(gridKey(x, y));
+				if (it == _grid.end())
+					continue;
+				auto &cell = it->second;
+				for (uint32_t i = 0; i < cell.length(); i++) {
+					if (cell[i] == entity) {
+						cell[i] = cell.back(); // swap remove
+						cell.pop();
+						break;
+					}
+				}
+				if (cell.length() == 0)
+					_grid.erase(it);
+			}
+		}
+		r = GridRange();
+	}
+
+	void World::updateGrid(Entity* entity, EntityState &state, bool inGrid) {
+		if (!inGrid) {
+			if (state.isLarge || !state.cells.isEmpty())
+				removeFromGrid(entity, state);
+			return;
+		}
+		auto r = gridRangeOf(entity->_circleBounds);
+		bool isLarge = int64_t(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1) > GRID_MAX_CELLS;
+		if (isLarge) {
+			if (!state.isLarge) {
+				removeFromGrid(entity, state);
+				_largeEntities.push(entity);
+				state.isLarge = true;
+			}
+			return;
+		}
+		if (!state.isLarge && r == state.cells)
+			return; // still in the same cells
+		removeFromGrid(entity, state);
+		for (int32_t y = r.y0; y <= r.y1; y++) {
+			for (int32_t x = r.x0; x <= r.x1; x++) {
+				_grid[gridKey(x, y)].push(entity);
+			}
+		}
+		state.cells = r;
+	}
+
+	void World::queryGrid(const Circle &circ, float reach, Array<Entity*> &out) {
+		out.reset(0);
+		if (_cellSize == 0)
+			return; // grid not built, no participating entities
+		float radius = circ.radius + reach;
+		auto r = gridRangeOf({circ.center, radius});
+		auto test = [&](Entity *o) {
+			auto &c = o->_circleBounds;
+			float d = radius + c.radius;
+			if ((c.center - circ.center).lengthSq() <= d * d)
+				out.push(o);
+		};
+		if (int64_t(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1) > int64_t(_grid.length())) {
+			for (auto &it: _grid) // visiting all occupied cells is cheaper
+				for (auto o: it.second)
+					test(o);
+		} else {
+			for (int32_t y = r.y0; y <= r.y1; y++) {
+				for (int32_t x = r.x0; x <= r.x1; x++) {
+					auto it = _grid.find(gridKey(x, y));
+					if (it != _grid.end())
+						for (auto o: it->second)
+							test(o);
+				}
+			}
+		}
+		for (auto o: _largeEntities)
+			test(o);
+		// entities overlapping several cells are found more than once
+		std::sort(out.val(), out.val() + out.length());
+		out.reset(std::unique(out.val(), out.val() + out.length()) - out.val());
+	}
+
+	float World::interactionReachOf(Agent* agent, float deltaTime) {
+		// predictive avoidance horizon plus the safety buffer
+		float reach = agent->_velocityMax * _predictionTime + agent->_safetyBuffer;
+		// farthest discovery level, beyond it discovered agents are dropped without buffering
+		auto dds = agent->_discoveryDistances.load();
+		if (dds && dds->length())
+			reach = F32::max(reach, dds->back() + _discoveryThresholdBuffer);
+		// the agent keeps moving during sub-steps, and may be pushed out of collisions
+		return reach + agent->_velocityMax * deltaTime * 2.0f + agent->_circleBounds.radius;
+	}
+
+	void World::stepAgent(Agent* agent, bool follow, float deltaTime, Array<Entity*> &nearby) {
+		auto sim = agentSimOf(agent);
+		queryGrid(sim ? sim->circle: agent->_circleBounds, interactionReachOf(agent, deltaTime), nearby);
+		if (follow) {
+			updateAgentWithFollow(agent, nearby, deltaTime);
+		} else {
+			updateAgentWithMovement(agent, nearby, deltaTime);
+		}
+		// Discovered agents out of reach are no longer returned by the grid, drop them here
+		if (agent->_discoverys_rt.length() && agent->_discoveryDistances.load()) {
+			Array<Agent*> lost;
+			for (auto &it: agent->_discoverys_rt) {
+				auto other = it.first;
+				if (other->_participate && other->visible() &&
+					!std::binary_search(nearby.val(), nearby.val() + nearby.length(), (Entity*)other))
+					lost.push(other);
+			}
+			for (auto other: lost) {
+				MTV mtv;
+				Vec2 mtvVec;
+				if (sim) {
+					agent->test_entity_vs_entity(sim->circle, sim->pts, other, &mtv, &mtvVec, true);
+				} else {
+					agent->test_entity_vs_entity(other, &mtv, &mtvVec, true);
+				}
+				handleDiscoveryEvents(agent, other, mtv);
+			}
+		}
+	}
+
+	void World::stepAgents(cArray<Agent*> &agents, uint32_t followBegin, float deltaTime) {
+		Array<AgentSim> sims(agents.length());
+		for (uint32_t i = 0; i < agents.length(); i++) {
+			auto agent = agents[i];
+			auto &sim = sims[i];
+			sim.agent = agent;
+			sim.circle = agent->_circleBounds;
+			sim.pts = agent->ptsOfBounds(); // copy
+			sim.moved = false;
+		}
+
+		// Agents only write their private state and read the others from the snapshot,
+		// so the serial mode and any split over the workers give the same result
+		uint32_t chunks = _parallel ? U32::min(agents.length(), parallel_concurrency() * 4): 1;
+		uint32_t perChunk = (agents.length() + chunks - 1) / chunks;
+		auto stepChunk = [&](uint32_t chunk) {
+			Array<Entity*> nearby;
+			uint32_t end = U32::min(agents.length(), (chunk + 1) * perChunk);
+			for (uint32_t i = chunk * perChunk; i < end; i++) {
+				tls_agentSim = &sims[i];
+				stepAgent(agents[i], i >= followBegin, deltaTime, nearby);
+			}
+			tls_agentSim = nullptr;
+		};
+		if (_parallel) {
+			parallel_for(chunks, stepChunk);
+		} else {
+			stepChunk(0);
+		}
+
+		// Commit in agent order
+		for (auto &sim: sims) {
+			auto agent = sim.agent;
+			agent->_circleBounds = sim.circle;
+			if (agent->_bounds.type == Entity::kPolygon)
+				agent->ptsOfBounds() = std::move(sim.pts);
+			if (sim.moved)
+				agent->mark(View::kTransform, true);
+			for (auto &cb: sim.posts)
+				agent->pre_render().post(cb, agent);
+			EntityState *state;
+			if (_entities.get(agent, state))
+				updateGrid(agent, *state, agent->_participate);
+		}
+	}
+
+	View* World::task_view() {
+		return this;
+	}
+
 	bool World::run_task(int64_t time, int64_t delta) {
 		// World per-frame update logic can be added here
 		Array<Agent*> agents, follows;
-		Array<Entity*> entities;
 
-		for (auto it : _entities) {
+		// Choose the grid cell size from the average entity size, rebuild when it drifts too far
+		float diameterSum = 0;
+		uint32_t participants = 0;
+		for (auto &it : _entities) {
+			auto entity = it.first;
+			if (entity->_circleBounds.radius && entity->visible() && entity->_participate) {
+				diameterSum += entity->_circleBounds.radius * 2.0f;
+				participants++;
+			}
+		}
+		if (participants) {
+			float cellSize = F32::max(diameterSum / participants * 2.0f, GRID_MIN_CELL_SIZE);
+			if (_cellSize == 0 || cellSize > _cellSize * 2.0f || cellSize < _cellSize * 0.5f) {
+				for (auto &it : _entities) {
+					it.second.cells = GridRange();
+					it.second.isLarge = false;
+				}
+				_grid.clear();
+				_largeEntities.clear();
+				_cellSize = cellSize;
+			}
+		}
+
+		for (auto &it : _entities) {
 			auto entity = it.first;
 			// only process visible entities
-			if (entity->_circleBounds.radius && entity->visible()) {
+			bool visible = entity->_circleBounds.radius && entity->visible();
+			if (visible) {
 				auto agent = static_cast<Agent*>(entity);
-				if (it.second && agent->_active) { // is active agent
+				if (it.second.isAgent && agent->_active) { // is active agent
 					// Skip line segment agents for movement
 					if (agent->_bounds.type != Entity::kLineSegment) {
 						if (agent->_followTarget) {
@@ -231,8 +494,10 @@ namespace qk {
 					}
 				}
 				if (entity->_participate)
-					entities.push(entity);
+					entity->ptsOfBounds(); // build the lazy points of the snapshot before stepping
 			}
+			if (_cellSize != 0) // only moved entities change their cells
+				updateGrid(entity, it.second, visible && entity->_participate);
 		}
 
 		if (agents.isNull() && follows.isNull()) {
@@ -242,14 +507,10 @@ namespace qk {
 		float nsTime = 1.0f / 1e6f; // convert ns to seconds
 		auto deltaTime = delta * nsTime * _timeScale; // convert to seconds
 
-		// Update normal agents
-		for (auto agent : agents) {
-			updateAgentWithMovement(agent, entities, deltaTime);
-		}
-		// Update follow agents
-		for (auto agent : follows) {
-			updateAgentWithFollow(agent, entities, deltaTime);
-		}
+		// Update normal agents and then follow agents
+		uint32_t followBegin = agents.length();
+		agents.concat(std::move(follows));
+		stepAgents(agents, followBegin, deltaTime);
 
 		return false;
 	}
@@ -332,7 +593,11 @@ namespace qk {
 			}
 		};
 
-		if (agent->test_entity_vs_entity(other, &mtv, &mtvVec, true)) {
+		auto sim = agentSimOf(agent);
+		bool overlap = sim ?
+			agent->test_entity_vs_entity(sim->circle, sim->pts, other, &mtv, &mtvVec, true):
+			agent->test_entity_vs_entity(other, &mtv, &mtvVec, true);
+		if (overlap) {
 			// add min distance vector to separate
 			agent->_target = pos + mtvVec + mtv.axis * agent->_followMinDistance;
 			mtv.axis *= -1.0f; // reverse axis for report direction
@@ -373,8 +638,9 @@ namespace qk {
 	// ------------------------ 局部避让合成：结合 SAT MTV（即时）与 预测 (T) ------------------------
 	Vec2 World::computeAvoidanceForAgent(Agent *agent, cArray<Entity*>& obs, Vec2 dirToTarget) {
 		bool isPoly = agent->_bounds.type == Entity::kPolygon;
-		auto &pts = agent->ptsOfBounds();
-		Circle &circ = agent->_circleBounds;
+		auto sim = agentSimOf(agent);
+		auto &pts = sim ? sim->pts: agent->ptsOfBounds();
+		Circle &circ = sim ? sim->circle: agent->_circleBounds;
 		Vec2 pos = circ.center;
 		float vSq = agent->_velocitySteer.lengthSq();
 		// normalized movement direction
@@ -507,12 +773,23 @@ namespace qk {
 		bool isVelocityZero = agent->_velocityMax == 0.0f; // zero max velocity
 		bool isPoly = agent->_bounds.type == Entity::kPolygon;
 		bool isFollow = agent->_followTarget.load();
-		Circle &circ = agent->_circleBounds;
+		auto sim = agentSimOf(agent);
+		Circle &circ = sim ? sim->circle: agent->_circleBounds;
 		Vec2 pos = agent->_translate; // current position
 		Vec2 toTarget = agent->_target - pos;
 
 		// precompute polygon points at current position
-		auto* pts = isPoly ? &agent->ptsOfBounds() : nullptr;
+		auto* pts = isPoly ? sim ? &sim->pts: &agent->ptsOfBounds() : nullptr;
+
+		// Set position, in parallel mode the transform is marked at commit
+		auto setTranslate = [agent, sim](Vec2 pos) {
+			if (!sim) {
+				agent->set_translate_direct(pos, true);
+			} else if (agent->_translate != pos) {
+				agent->_translate = pos;
+				sim->moved = true;
+			}
+		};
 		// load discovery distances
 		auto dds = agent->_discoveryDistances.load();
 
@@ -555,7 +832,10 @@ namespace qk {
 				MTV mtv;
 				auto other = o->asAgent();
 				bool isEvent = dds && other; // only agents have discovery events
-				if (agent->test_entity_vs_entity(o, &mtv, &totalMTV, isEvent)) {
+				bool overlap = sim ?
+					agent->test_entity_vs_entity(circ, sim->pts, o, &mtv, &totalMTV, isEvent):
+					agent->test_entity_vs_entity(o, &mtv, &totalMTV, isEvent);
+				if (overlap) {
 					collided = true;
 				}
 				if (isEvent) { // handle discovery events
@@ -609,14 +889,14 @@ namespace qk {
 					return deltaTime - stepDt * step;
 				} else if (d < moveLen) {
 					float scalar = d / moveLen;
-					agent->set_translate_direct(pos + move * scalar, true); // update entity position
+					setTranslate(pos + move * scalar); // update entity position
 					return deltaTime - (step + scalar) * stepDt; // return remaining time
 				}
 			}
 
 			// apply move
 			pos += move;
-			agent->set_translate_direct(pos, true); // update entity position
+			setTranslate(pos); // update entity position
 
 			// update toTarget for next substep
 			toTarget = agent->_target - pos;
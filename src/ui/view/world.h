@@ -93,6 +93,16 @@ namespace qk {
 		*/
 		Qk_DEFINE_PROPERTY(float, waypointRadius, Const);
 
+		/**
+		 * Simulate agents in parallel on the compute workers.
+		 *
+		 * In both modes every agent steps from a read-only snapshot of the world at the start of the frame,
+		 * and the new positions and the events are applied serially in agent order afterwards.
+		 * So the results are bit-identical to the serial mode and independent of the number of workers.
+		 * Default: false
+		 */
+		Qk_DEFINE_PROPERTY(bool, parallel, Const);
+
 		/** Constructor — initializes default parameters and world state. */
 		World();
 
@@ -135,6 +145,7 @@ namespace qk {
 		 * @return true if the world requires continued updates; false to pause.
 		 */
 		bool run_task(int64_t time, int64_t delta) override;
+		View* task_view() override;
 
 		/**
 		 * @method destroy() heap memory destructor
@@ -195,8 +206,66 @@ namespace qk {
 		 */
 		void updateAgentWithFollow(Agent* agent, cArray<Entity*>& obs, float deltaTime);
 
+		/**
+		 * Grid cell range covered by the circle bounds of an entity, empty when x1 < x0.
+		 */
+		struct GridRange {
+			int32_t x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+			inline bool isEmpty() const { return x1 < x0; }
+			inline bool operator==(const GridRange& r) const {
+				return x0 == r.x0 && y0 == r.y0 && x1 == r.x1 && y1 == r.y1;
+			}
+		};
+
+		/** Runtime state of an entity in the world. */
+		struct EntityState {
+			bool isAgent; ///< true if Agent
+			bool isLarge; ///< true if too large for the grid and always queried
+			GridRange cells; ///< cells currently occupied in the broadphase grid
+		};
+
+		/** Compute the grid cells covered by a circle. */
+		GridRange gridRangeOf(const Circle &circ) const;
+
+		/**
+		 * Update the broadphase grid for an entity whose circle bounds may have moved.
+		 * Only touches the grid when the covered cell range changes.
+		 * @param inGrid false to remove the entity from the grid.
+		 */
+		void updateGrid(Entity* entity, EntityState &state, bool inGrid);
+
+		/** Remove an entity from the cells it occupies. */
+		void removeFromGrid(Entity* entity, EntityState &state);
+
+		/**
+		 * Query entities whose circle bounds may be within `reach` of the circle.
+		 * Results are unique and written to `out`.
+		 */
+		void queryGrid(const Circle &circ, float reach, Array<Entity*> &out);
+
+		/**
+		 * Compute the maximum distance an agent interacts with other entities this frame,
+		 * covering prediction, safety buffer, discovery levels and movement.
+		 */
+		float interactionReachOf(Agent* agent, float deltaTime);
+
+		/**
+		 * Step an agent for this frame: query nearby entities, update movement or follow,
+		 * and drop discovered agents that are out of reach.
+		 */
+		void stepAgent(Agent* agent, bool follow, float deltaTime, Array<Entity*> &nearby);
+
+		/**
+		 * Step all agents from a snapshot of the world, on the compute workers if `parallel` is true,
+		 * then commit bounds, transforms and events serially in agent order.
+		 */
+		void stepAgents(cArray<Agent*> &agents, uint32_t followBegin, float deltaTime);
+
 	private:
-		Dict<Entity*, bool> _entities; ///< All entities in the world, true if Agent
+		Dict<Entity*, EntityState> _entities; ///< All entities in the world
+		Dict<uint64_t, Array<Entity*>> _grid; ///< Uniform grid broadphase, cell key => entities
+		Array<Entity*> _largeEntities; ///< Participating entities covering too many cells
+		float _cellSize; ///< Grid cell size in world units, 0 if the grid is not built
 	};
 
 } // namespace qk
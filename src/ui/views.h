@@ -67,6 +67,7 @@ namespace qk {
 	class Entity;
 	class Agent;
 	class Spine;
+	class Layer;
 	typedef BoxFilter* BoxFilterPtr;
 	typedef BoxShadow* BoxShadowPtr;
 	typedef Array<float> ArrayFloat;
@@ -102,6 +102,8 @@ namespace qk {
 		, _impl(nullptr)
 		, _opts(opts)
 		, _debugMode(false)
+		, _partialRedraw(false)
+		, _autoLayerFrames(0)
 		, _fspBlob(nullptr)
 	{
 		Qk_ASSERT(_host, "Cannot create a window without an application object");
@@ -283,6 +285,24 @@ namespace qk {
 		_debugMode = v;
 	}
 
+	void Window::set_partialRedraw(bool v) {
+		_partialRedraw = v;
+		_preRender.mark_rerender(); // start from a full frame
+	}
+
+	void Window::set_autoLayerFrames(uint32_t v) {
+		_autoLayerFrames = v;
+		_preRender.mark_rerender();
+	}
+
+	bool Window::parallelLayout() const {
+		return _preRender.parallel_layout();
+	}
+
+	void Window::set_parallelLayout(bool v) {
+		_preRender.set_parallel_layout(v);
+	}
+
 	void Window::reload() { // Lock before calling this method
 		Qk_ASSERT(isUILocked(), "Window::reload must be called with UILock");
 
@@ -374,7 +394,11 @@ namespace qk {
 		int64_t st = time_microsecond();
 #endif
 
+		auto canvas = _render->getCanvas();
+		_profiler.beginFrame(canvas);
+
 		if (!_preRender.solve(time, deltaTime)) {
+			_profiler.endFrame(canvas, false); // nothing rendered
 			solveNextFrame();
 			delayTaskMark();
 			return false;
@@ -395,7 +419,26 @@ namespace qk {
 			_fspTime = _time;
 		}
 
+		Range damage;
+		// the fps text is drawn outside of the damage region, so debug mode draws full frames
+		bool partial = _preRender.take_damage(damage) && _partialRedraw && !_debugMode;
+		if (partial) {
+			damage = damage.clip({Vec2(), _size});
+			if (damage.isEmpty()) { // nothing changed on the screen
+				_profiler.endFrame(canvas, false);
+				solveNextFrame();
+				delayTaskMark();
+				return false;
+			}
+			// cover the anti-aliasing edges of the damaged boxes
+			damage = Range{damage.begin - 2, damage.end + 2}.expandToInteger();
+		}
+
+		_profiler.damage(partial ? damage: Range());
+		_profiler.begin(FrameProfiler::kPaint_Phase);
+		_painter->set_damage(partial ? &damage: nullptr);
 		_root->draw(_painter); // start drawing
+		_painter->set_damage(nullptr);
 
 		if (_debugMode) {
 			// draw fps
@@ -407,14 +450,22 @@ namespace qk {
 			_painter->canvas()->setMatrix(Mat());
 			_painter->canvas()->drawTextBlob(&_fspBlob->blob, {70}, 32.0f, paint);
 		}
+		_profiler.end(FrameProfiler::kPaint_Phase);
 
 		afterDisplay(); // draw something for platform
 
 		solveNextFrame(); // solve frame
 
-		if (_render->getCanvas()->swapBuffer()) {
+		_profiler.begin(FrameProfiler::kSwap_Phase);
+		bool swapped = canvas->swapBuffer();
+		_profiler.end(FrameProfiler::kSwap_Phase);
+		_profiler.endFrame(canvas, true);
+
+		if (swapped) {
 			_fspTick++;
 			delayTaskMark();
+		} else {
+			dropFrame();
 		}
 
 #if PRINT_RENDER_FRAME_TIME
@@ -470,7 +521,14 @@ namespace qk {
 		_clipRange.pop();
 	}
 
+	void Window::dropFrame() {
+		if (_partialRedraw)
+			_preRender.mark_rerender(); // redraw the whole window
+	}
+
 	bool Window::isUILocked() const {
-		return thread_self_id() == _lockThreadId;
+		// A worker acts for the render thread that holds the lock only while it runs
+		// layout_reverse of a parallel level, see PreRender::isLayoutWorker()
+		return thread_self_id() == _lockThreadId || _preRender.isLayoutWorker();
 	}
 }
@@ -33,6 +33,7 @@
 
 #include "../render/render.h"
 #include "./pre_render.h"
+#include "./profiler.h"
 #include "./types.h"
 
 namespace qk {
@@ -137,6 +138,17 @@ namespace qk {
 		// debug mode, if true, will show some debug info such as fps
 		Qk_DEFINE_PROPERTY(bool, debugMode, Const);
 
+		// draw only the damaged region of the window if only box appearances changed,
+		// the render backend must preserve the surface between frames, default false
+		Qk_DEFINE_PROPERTY(bool, partialRedraw, Const);
+
+		// typeset large view levels in parallel on the compute workers, default false
+		Qk_DEFINE_ACCESSOR(bool, parallelLayout, Const);
+
+		// cache the clipped morph views that keep unchanged for the number of frames
+		// in offscreen layers automatically, see Morph::layer, default 0 is disabled
+		Qk_DEFINE_PROPERTY(uint32_t, autoLayerFrames, Const);
+
 		/**
 		 * @static
 		 * @method Make(opts) create new window object
@@ -175,6 +187,13 @@ namespace qk {
 			return _preRender;
 		}
 
+		/**
+		 * @func profiler() frame phase timings and counters, disabled by default
+		*/
+		inline FrameProfiler& profiler() {
+			return _profiler;
+		}
+
 		/**
 		 * @method requestFullscreen(fullscreen)
 		*/
@@ -214,6 +233,13 @@ namespace qk {
 		*/
 		bool isUILocked() const;
 
+		/**
+		 * Called when the drawn frame is dropped by swapBuffer(), the surface may not hold the
+		 * last frame, so the next frame redraws the whole window if partialRedraw is enabled
+		 * @thread Rt
+		 */
+		void dropFrame();
+
 	private:
 		void reload();
 		void solveNextFrame();
@@ -251,6 +277,7 @@ namespace qk {
 		RecursiveMutex _renderMutex;
 		ThreadID _lockThreadId; // thread id of current UILock
 		PreRender _preRender;
+		FrameProfiler _profiler;
 		Options _opts;
 		// Reverse index: class hash -> views declaring the class.
 		// Used only as a pre-filter to eliminate unrelated views
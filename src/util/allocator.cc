@@ -342,6 +342,8 @@ namespace qk {
 				return;
 			}
 			auto next = block->next;
+			_blocks--;
+			_capacity -= block->capacity;
 			::free(block);
 			block = next;
 		}
@@ -343,6 +343,19 @@ namespace qk {
 		 */
 		void clear();
 
+		/**
+		 * @brief Returns the number of memory blocks held by the allocator.
+		 *
+		 * It stays the same from frame to frame when the usage does not grow,
+		 * as `reset()` reuses the existing blocks.
+		 */
+		inline uint32_t blocks() const { return _blocks; }
+
+		/**
+		 * @brief Returns the total capacity in bytes across all blocks.
+		 */
+		inline uint32_t capacity() const { return _capacity; }
+
 	private:
 		/**
 		 * @brief Allocates a block of memory from the allocator.
@@ -0,0 +1,678 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __quark__util__flat_dict__
+#define __quark__util__flat_dict__
+
+#include "./dict.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define Qk_FLAT_DICT_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define Qk_FLAT_DICT_NEON 1
+#endif
+
+namespace qk {
+
+	/**
+	 * @class FlatDict open addressing hash table
+	 *
+	 * A SwissTable style table for the hot caches, the entries are stored inline in one block
+	 * with a control byte per slot, that holds 7 bits of the hash code or the empty/deleted state,
+	 * and a group of 16 control bytes is probed at once with SIMD where available.
+	 *
+	 * It keeps the api of Dict for the unordered use cases, and as Dict the keys are identified
+	 * by the hash code of Compare. Unlike Dict the iteration is not in insertion order,
+	 * and inserting a new key may move the entries, so that invalidates the pointers,
+	 * references and iterators to the entries.
+	 */
+	template<
+		typename Key,
+		typename Value,
+		typename Compare = Compare<Key>,
+		typename B = NonObject
+	>
+	class FlatDict: public B {
+	public:
+		typedef qk::Pair<Key, Value> Pair;
+		struct Slot {
+			uint64_t hashCode;
+			Pair pair;
+		};
+		template<bool IsConst> class Iter;
+		typedef Iter<true>  IteratorConst;
+		typedef Iter<false> Iterator;
+
+		template<bool IsConst>
+		class Iter {
+		public:
+			typedef typename IteratorType<Pair, IsConst>::Type* Pointer;
+			typedef typename IteratorType<Pair, IsConst>::Type& Reference;
+
+			Iter(): _ctrl(nullptr), _slot(nullptr) {}
+			Iter(const Iterator& it): _ctrl(it._ctrl), _slot(it._slot) {}
+
+			Iter& operator++() { // ++i
+				++_ctrl, ++_slot;
+				skip_();
+				return *this;
+			}
+			Iter operator++(int) { // i++
+				Iter old(*this);
+				operator++();
+				return old;
+			}
+			bool operator==(const IteratorConst& that) const {
+				return _slot == that._slot;
+			}
+			bool operator!=(const IteratorConst& that) const {
+				return _slot != that._slot;
+			}
+			Reference operator*() const { return _slot->pair; }
+			Pointer operator->() const { return &_slot->pair; }
+
+		private:
+			Iter(const int8_t* ctrl, Slot* slot): _ctrl(ctrl), _slot(slot) {}
+			inline void skip_() { // skip the empty and deleted slots until a full one or the sentinel
+				while (*_ctrl < kSentinel)
+					++_ctrl, ++_slot;
+			}
+			const int8_t *_ctrl;
+			Slot         *_slot;
+			friend class FlatDict;
+			template<bool> friend class Iter;
+		};
+
+		FlatDict();
+		FlatDict(FlatDict&& dict);
+		FlatDict(const FlatDict& dict);
+		FlatDict(std::initializer_list<Pair>&& list);
+		FlatDict(Allocator* allocator);
+
+		~FlatDict();
+
+		FlatDict&     operator=(const FlatDict& value);
+		FlatDict&     operator=(FlatDict&& value);
+
+		Value&        operator[](const Key& key);
+		Value&        operator[](Key&& key);
+
+		Iterator      find(const Key& key);
+		IteratorConst find(const Key& key) const;
+		Iterator      findFor(uint64_t hashCode);
+		IteratorConst findFor(uint64_t hashCode) const;
+
+		bool          hasFor(uint64_t hashCode) const;
+		bool          has(const Key& key) const;
+		uint32_t      count(const Key& key) const;
+
+		Array<Key>    keys() const;
+		Array<Value>  values() const;
+
+		bool          get(const Key& key, const Value* &out) const;
+		bool          get(const Key& key, Value &out) const;
+		bool          get(const Key& key, Value* &out);
+		Value&        get(const Key& key);
+		Value&        get(Key&& key);
+		Value&        set(const Key& key, const Value& value);
+		Value&        set(const Key& key, Value&& value);
+		Value&        set(Key&& key, const Value& value);
+		Value&        set(Key&& key, Value&& value);
+		bool          add(const Key& key);
+		bool          add(Key&& key);
+
+		Iterator      erase(IteratorConst it);
+		bool          erase(const Key& key);
+		void          clear();
+
+		/**
+		 * Reserve space for at least `length` entries without rehashing
+		 */
+		void          reserve(uint32_t length);
+
+		uint32_t      length() const;
+		uint32_t      capacity() const;
+
+		IteratorConst begin() const;
+		IteratorConst end() const;
+		Iterator      begin();
+		Iterator      end();
+
+	private:
+		enum: int8_t {
+			kEmpty = -128, kDeleted = -2, kSentinel = -1, // full slots are 0..127
+		};
+		static constexpr uint32_t kGroupWidth = 16;
+
+		/** Bits of the matched slots in a group, the slot i at the bit `i << kShift`. */
+		struct BitMask {
+#if Qk_FLAT_DICT_NEON
+			enum { kShift = 2 };
+#else
+			enum { kShift = 0 };
+#endif
+			uint64_t bits;
+			inline explicit operator bool() const { return bits; }
+			inline uint32_t lowest() const { return __builtin_ctzll(bits) >> kShift; }
+			inline void next() { bits &= bits - 1; }
+		};
+
+		/** A group of control bytes probed at once. */
+		struct Group {
+#if Qk_FLAT_DICT_SSE2
+			explicit Group(const int8_t* p): ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+			inline BitMask match(int8_t h2) const {
+				return {uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)))};
+			}
+			inline BitMask matchEmptyOrDeleted() const {
+				return {uint64_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(kSentinel), ctrl)))};
+			}
+			__m128i ctrl;
+#elif Qk_FLAT_DICT_NEON
+			explicit Group(const int8_t* p): ctrl(vld1q_s8(p)) {}
+			inline static BitMask mask(uint8x16_t eq) { // narrow each lane to 4 bits
+				auto nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+				return {vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ull};
+			}
+			inline BitMask match(int8_t h2) const {
+				return mask(vceqq_s8(ctrl, vdupq_n_s8(h2)));
+			}
+			inline BitMask matchEmptyOrDeleted() const {
+				return mask(vcltq_s8(ctrl, vdupq_n_s8(kSentinel)));
+			}
+			int8x16_t ctrl;
+#else
+			explicit Group(const int8_t* p): ctrl(p) {}
+			inline BitMask match(int8_t h2) const {
+				uint64_t bits = 0;
+				for (uint32_t i = 0; i < kGroupWidth; i++)
+					bits |= uint64_t(ctrl[i] == h2) << i;
+				return {bits};
+			}
+			inline BitMask matchEmptyOrDeleted() const {
+				uint64_t bits = 0;
+				for (uint32_t i = 0; i < kGroupWidth; i++)
+					bits |= uint64_t(ctrl[i] < kSentinel) << i;
+				return {bits};
+			}
+			const int8_t *ctrl;
+#endif
+			inline BitMask matchEmpty() const { return match(kEmpty); }
+		};
+
+		// The same as mix64_fast(), spreads the identity hash codes of the integer keys
+		inline static uint64_t mix_(uint64_t x) {
+			x ^= x >> 33;
+			x *= 0xd6e8feb86659fd93ULL;
+			x ^= x >> 28;
+			return x;
+		}
+		inline static uint32_t maxLoad_(uint32_t capacity) {
+			return capacity - capacity / 8; // 7/8
+		}
+		inline void setCtrl_(uint32_t i, int8_t h) {
+			_ctrl[i] = h;
+			// mirror the first group to the end, so a group can be loaded from any slot
+			_ctrl[((i - (kGroupWidth - 1)) & _capacity) + (kGroupWidth - 1)] = h;
+		}
+		void reset_();
+		void resize_(uint32_t capacity);
+		uint32_t findNonFull_(uint64_t hash) const;
+		const Slot* find_(uint64_t hashCode) const;
+		bool make_(uint64_t hashCode, Pair** data);
+		void erase_(Slot* slot);
+
+		Allocator *_allocator;
+		Slot      *_slots;
+		int8_t    *_ctrl; // control bytes: capacity + sentinel + mirrored first group - 1
+		uint32_t  _length, _capacity, _growthLeft; // capacity is 0 or 2^n-1
+	};
+
+	// -----------------------------------------------------------------
+
+	template<typename K, typename V, typename C, typename B>
+	FlatDict<K, V, C, B>::FlatDict() {
+		reset_();
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	FlatDict<K, V, C, B>::FlatDict(FlatDict&& dict) {
+		reset_();
+		operator=(std::move(dict));
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	FlatDict<K, V, C, B>::FlatDict(const FlatDict& dict) {
+		reset_();
+		operator=(dict);
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	FlatDict<K, V, C, B>::FlatDict(std::initializer_list<Pair>&& list) {
+		reset_();
+		reserve(uint32_t(list.size()));
+		for (auto& i: list)
+			set(std::move(i.first), std::move(i.second));
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	FlatDict<K, V, C, B>::FlatDict(Allocator* allocator) {
+		reset_();
+		_allocator = allocator;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	FlatDict<K, V, C, B>::~FlatDict() {
+		clear();
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	FlatDict<K, V, C, B>& FlatDict<K, V, C, B>::operator=(const FlatDict& dict) {
+		if (this != &dict) {
+			clear();
+			reserve(dict._length);
+			for (auto& i: dict)
+				set(i.first, i.second);
+		}
+		return *this;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	FlatDict<K, V, C, B>& FlatDict<K, V, C, B>::operator=(FlatDict&& dict) {
+		if (this != &dict) {
+			clear();
+			_allocator = dict._allocator; // take ownership of allocator
+			_slots = dict._slots;
+			_ctrl = dict._ctrl;
+			_length = dict._length;
+			_capacity = dict._capacity;
+			_growthLeft = dict._growthLeft;
+			dict.reset_();
+			dict._allocator = _allocator;
+		}
+		return *this;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	V& FlatDict<K, V, C, B>::operator[](const K& key) {
+		return get(key);
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	V& FlatDict<K, V, C, B>::operator[](K&& key) {
+		return get(std::move(key));
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	const typename FlatDict<K, V, C, B>::Slot* FlatDict<K, V, C, B>::find_(uint64_t hashCode) const {
+		if (!_length)
+			return nullptr;
+		auto hash = mix_(hashCode);
+		auto h2 = int8_t(hash & 0x7f);
+		uint32_t offset = uint32_t(hash >> 7) & _capacity;
+		for (uint32_t step = kGroupWidth;; step += kGroupWidth) {
+			Group group(_ctrl + offset);
+			for (auto m = group.match(h2); m; m.next()) {
+				auto slot = _slots + ((offset + m.lowest()) & _capacity);
+				if (slot->hashCode == hashCode)
+					return slot;
+			}
+			if (group.matchEmpty())
+				return nullptr; // an empty slot ends the probe sequence
+			offset = (offset + step) & _capacity; // triangular probing visits every group
+		}
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	uint32_t FlatDict<K, V, C, B>::findNonFull_(uint64_t hash) const {
+		uint32_t offset = uint32_t(hash >> 7) & _capacity;
+		for (uint32_t step = kGroupWidth;; step += kGroupWidth) {
+			auto m = Group(_ctrl + offset).matchEmptyOrDeleted();
+			if (m)
+				return (offset + m.lowest()) & _capacity;
+			offset = (offset + step) & _capacity;
+		}
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::make_(uint64_t hashCode, Pair** data) {
+		auto slot = const_cast<Slot*>(find_(hashCode));
+		if (slot) {
+			*data = &slot->pair;
+			return false;
+		}
+		if (!_capacity)
+			resize_(kGroupWidth - 1);
+		auto hash = mix_(hashCode);
+		auto i = findNonFull_(hash);
+		if (_growthLeft == 0 && _ctrl[i] != kDeleted) {
+			// grow if it is really full, otherwise rehash in place to drop the deleted slots
+			resize_(_length + 1 > maxLoad_(_capacity) / 2 ? _capacity * 2 + 1: _capacity);
+			i = findNonFull_(hash);
+		}
+		_growthLeft -= _ctrl[i] == kEmpty;
+		setCtrl_(i, int8_t(hash & 0x7f));
+		_length++;
+		slot = _slots + i;
+		slot->hashCode = hashCode;
+		*data = &slot->pair;
+		return true;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	void FlatDict<K, V, C, B>::erase_(Slot* slot) {
+		slot->pair.~Pair(); // destructor
+		setCtrl_(uint32_t(slot - _slots), kDeleted); // keep the probe sequences through the slot
+		_length--;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	void FlatDict<K, V, C, B>::resize_(uint32_t capacity) {
+		auto oldSlots = _slots;
+		auto oldCtrl = _ctrl;
+		auto oldCapacity = _capacity;
+		auto ctrlSize = capacity + kGroupWidth; // + sentinel and mirrored bytes
+		_slots = reinterpret_cast<Slot*>(_allocator->malloc(sizeof(Slot) * capacity + ctrlSize));
+		_ctrl = reinterpret_cast<int8_t*>(_slots + capacity);
+		_capacity = capacity;
+		::memset(_ctrl, kEmpty, ctrlSize);
+		_ctrl[capacity] = kSentinel;
+		_growthLeft = maxLoad_(capacity) - _length;
+
+		for (uint32_t i = 0; i < oldCapacity; i++) {
+			if (oldCtrl[i] >= 0) {
+				auto src = oldSlots + i;
+				auto hash = mix_(src->hashCode);
+				auto j = findNonFull_(hash);
+				setCtrl_(j, int8_t(hash & 0x7f));
+				_slots[j].hashCode = src->hashCode;
+				new(&_slots[j].pair) Pair(std::move(src->pair));
+				src->pair.~Pair();
+			}
+		}
+		if (oldSlots)
+			_allocator->free(oldSlots);
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	void FlatDict<K, V, C, B>::reserve(uint32_t length) {
+		if (length > maxLoad_(_capacity)) {
+			uint32_t capacity = kGroupWidth - 1;
+			while (maxLoad_(capacity) < length)
+				capacity = capacity * 2 + 1;
+			if (capacity > _capacity)
+				resize_(capacity);
+		}
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::hasFor(uint64_t hashCode) const {
+		return find_(hashCode);
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::has(const K& key) const {
+		return find_(C::hashCode(key));
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	uint32_t FlatDict<K, V, C, B>::count(const K& key) const {
+		return has(key) ? 1: 0;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::Iterator FlatDict<K, V, C, B>::find(const K& key) {
+		return findFor(C::hashCode(key));
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::IteratorConst FlatDict<K, V, C, B>::find(const K& key) const {
+		return findFor(C::hashCode(key));
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::Iterator FlatDict<K, V, C, B>::findFor(uint64_t hashCode) {
+		auto slot = const_cast<Slot*>(find_(hashCode));
+		return slot ? Iterator(_ctrl + (slot - _slots), slot): end();
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::IteratorConst FlatDict<K, V, C, B>::findFor(uint64_t hashCode) const {
+		return const_cast<FlatDict*>(this)->findFor(hashCode);
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	Array<K> FlatDict<K, V, C, B>::keys() const {
+		Array<K> ls;
+		for (auto& i: *this)
+			ls.push(i.first);
+		Qk_ReturnLocal(ls);
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	Array<V> FlatDict<K, V, C, B>::values() const {
+		Array<V> ls;
+		for (auto& i: *this)
+			ls.push(i.second);
+		Qk_ReturnLocal(ls);
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::get(const K& k, const V* &out) const {
+		auto slot = find_(C::hashCode(k));
+		return slot ? (out = &slot->pair.second, true): false;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::get(const K& k, V &out) const {
+		auto slot = find_(C::hashCode(k));
+		return slot ? (out = slot->pair.second, true): false;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::get(const K& k, V* &out) {
+		auto slot = const_cast<Slot*>(find_(C::hashCode(k)));
+		return slot ? (out = &slot->pair.second, true): false;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	V& FlatDict<K, V, C, B>::get(const K& key) {
+		Pair* pair;
+		if (make_(C::hashCode(key), &pair)) {
+			new(&pair->first) K(key);
+			new(&pair->second) V();
+		}
+		return pair->second;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	V& FlatDict<K, V, C, B>::get(K&& key) {
+		Pair* pair;
+		if (make_(C::hashCode(key), &pair)) {
+			new(&pair->first) K(std::move(key));
+			new(&pair->second) V();
+		}
+		return pair->second;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::add(const K& key) {
+		Pair* pair;
+		auto isMake = make_(C::hashCode(key), &pair);
+		if (isMake) {
+			new(&pair->first) K(key);
+			new(&pair->second) V();
+		}
+		return isMake;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::add(K&& key) {
+		Pair* pair;
+		auto isMake = make_(C::hashCode(key), &pair);
+		if (isMake) {
+			new(&pair->first) K(std::move(key));
+			new(&pair->second) V();
+		}
+		return isMake;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	V& FlatDict<K, V, C, B>::set(const K& key, const V& value) {
+		Pair* pair;
+		if (make_(C::hashCode(key), &pair)) {
+			new(&pair->first) K(key);
+			new(&pair->second) V(value);
+		} else {
+			pair->second = value;
+		}
+		return pair->second;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	V& FlatDict<K, V, C, B>::set(const K& key, V&& value) {
+		Pair* pair;
+		if (make_(C::hashCode(key), &pair)) {
+			new(&pair->first) K(key);
+			new(&pair->second) V(std::move(value));
+		} else {
+			pair->second = std::move(value);
+		}
+		return pair->second;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	V& FlatDict<K, V, C, B>::set(K&& key, const V& value) {
+		Pair* pair;
+		if (make_(C::hashCode(key), &pair)) {
+			new(&pair->first) K(std::move(key));
+			new(&pair->second) V(value);
+		} else {
+			pair->second = value;
+		}
+		return pair->second;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	V& FlatDict<K, V, C, B>::set(K&& key, V&& value) {
+		Pair* pair;
+		if (make_(C::hashCode(key), &pair)) {
+			new(&pair->first) K(std::move(key));
+			new(&pair->second) V(std::move(value));
+		} else {
+			pair->second = std::move(value);
+		}
+		return pair->second;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	bool FlatDict<K, V, C, B>::erase(const K& key) {
+		auto slot = const_cast<Slot*>(find_(C::hashCode(key)));
+		return slot ? (erase_(slot), true): false;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::Iterator FlatDict<K, V, C, B>::erase(IteratorConst it) {
+		if (it == end())
+			return end();
+		erase_(it._slot);
+		Iterator next(it._ctrl, it._slot);
+		return ++next;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	void FlatDict<K, V, C, B>::clear() {
+		if (_length) {
+			for (uint32_t i = 0; i < _capacity; i++) {
+				if (_ctrl[i] >= 0)
+					_slots[i].pair.~Pair(); // destructor
+			}
+		}
+		if (_slots)
+			_allocator->free(_slots);
+		_slots = nullptr;
+		_ctrl = nullptr;
+		_length = 0;
+		_capacity = 0;
+		_growthLeft = 0;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	uint32_t FlatDict<K, V, C, B>::length() const {
+		return _length;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	uint32_t FlatDict<K, V, C, B>::capacity() const {
+		return _capacity;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::IteratorConst FlatDict<K, V, C, B>::begin() const {
+		return const_cast<FlatDict*>(this)->begin();
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::IteratorConst FlatDict<K, V, C, B>::end() const {
+		return const_cast<FlatDict*>(this)->end();
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::Iterator FlatDict<K, V, C, B>::begin() {
+		Iterator it(_ctrl, _slots);
+		if (_length)
+			it.skip_();
+		else
+			it = end();
+		return it;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	typename FlatDict<K, V, C, B>::Iterator FlatDict<K, V, C, B>::end() {
+		return Iterator(_ctrl + _capacity, _slots + _capacity);
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	void FlatDict<K, V, C, B>::reset_() {
+		_allocator = Allocator::current();
+		_slots = nullptr;
+		_ctrl = nullptr;
+		_length = 0;
+		_capacity = 0;
+		_growthLeft = 0;
+	}
+
+	template<typename K, typename V, typename C, typename B>
+	using cFlatDict = const FlatDict<K, V, C, B>;
+}
+
+#endif
@@ -94,11 +94,15 @@ namespace qk {
 
 	class FileReader::Core {
 	public:
+		// Opened zip package, retained by every read in progress so that `clear()`
+		// cannot close it under a reader
+		struct Zip: Reference {
+			Zip(cString& path): reader(path) {}
+			ZipReader reader;
+		};
+
 		~Core() {
-			ScopeLock lock(zip_mutex_);
-			for (auto i: zips_ ) {
-				Release(i.second);
-			}
+			clear();
 		}
 
 		String zip_path(cString& path) {
@@ -112,30 +116,30 @@ namespace qk {
 			return String();
 		}
 
-		ZipReader* get_zip_reader(cString& path) throw(Error) {
-			ZipReader* reader = zips_[path];
-			if (reader) {
-				return reader;
+		// The lock only guards the package table, the directory index of a package is
+		// immutable after opening and file reads use their own zip cursors
+		Sp<Zip> get_zip(cString& path) throw(Error) {
+			ScopeLock lock(zip_mutex_);
+			Zip* zip;
+			if (zips_.get(path, zip)) {
+				return zip;
 			}
-			reader = new ZipReader(path);
-			if ( !reader->open() ) {
-				Release(reader);
+			Sp<Zip> hold(new Zip(path));
+			if ( !hold->reader.open() ) {
 				Qk_Throw(ERR_FILE_NOT_EXISTS, "Cannot open zip file, `%s`", *path);
 			}
-			zips_[path] = reader;
-			return reader;
+			hold->retain(); // retain for zips_
+			zips_[path] = hold.get();
+			return hold;
 		}
 
 		void read_from_zip(RunLoop* loop, cString& zip, cString& path, bool stream, Cb cb) {
-			ScopeLock lock(zip_mutex_);
 			Buffer buffer;
 			try {
-				ZipReader* read = get_zip_reader(zip);
+				auto read = get_zip(zip);
 				String inl_path = fs_format_part_path(path.substr(zip.length() + fs_SEPARATOR.length()));
-				if ( read->jump(inl_path) ) {
-					buffer = read->read();
-				} else {
-					Error err(ERR_FILE_NO_EXIST_IN_ZIP_PKG, "Zip package internal file does not exist, %s", *path);
+				if ( !read->reader.read_file(inl_path, &buffer) ) {
+					Error err(ERR_FILE_NO_EXIST_IN_ZIP_PKG, "Zip package internal file does not exist or cannot be read, %s", *path);
 					async_reject(cb, std::move(err), loop); return;
 				}
 			} catch (cError& err) {
@@ -216,17 +220,13 @@ namespace qk {
 				case ZIP: {
 					String zip = zip_path(path);
 					Qk_IfThrow(zip.isEmpty(), ERR_FILE_NOT_EXISTS, "Invalid file path, \"%s\"", *path);
-					
-					ScopeLock lock(zip_mutex_);
-					
-					ZipReader* read = get_zip_reader(zip);
+
+					auto read = get_zip(zip);
 					String inl_path = fs_format_part_path( path.substr(zip.length() + fs_SEPARATOR.length()) );
-					
-					if ( read->jump(inl_path) ) {
-						rv = read->read();
-					} else {
+
+					if ( !read->reader.read_file(inl_path, &rv) ) {
 						Qk_Throw(ERR_ZIP_IN_FILE_NOT_EXISTS,
-							"Zip package internal file does not exist, %s", *path);
+							"Zip package internal file does not exist or cannot be read, %s", *path);
 					}
 					break;
 				}
@@ -257,12 +257,11 @@ namespace qk {
 					String zip = zip_path(path);
 					if ( !zip.isEmpty() ) {
 						try {
-							ScopeLock lock(zip_mutex_);
-							ZipReader* read = get_zip_reader(zip);
+							auto read = get_zip(zip);
 							String inl_path = fs_format_part_path( path.substr(zip.length() + fs_SEPARATOR.length()) );
-							if ( file && read->is_file( inl_path ) )
+							if ( file && read->reader.is_file( inl_path ) )
 								return true;
-							if ( dir && read->is_directory( inl_path ) )
+							if ( dir && read->reader.is_directory( inl_path ) )
 								return true;
 						} catch(cError &e) {
 							Qk_Warn("Warn, %s", e.message().c_str());
@@ -288,10 +287,9 @@ namespace qk {
 					String zip = zip_path(path);
 					if ( !zip.isEmpty() ) {
 						try {
-							ScopeLock lock(zip_mutex_);
-							ZipReader* read = get_zip_reader(zip);
+							auto read = get_zip(zip);
 							String inl_path = fs_format_part_path( path.substr(zip.length() + fs_SEPARATOR.length()) );
-							rv = read->readdir(inl_path);
+							rv = read->reader.readdir(inl_path);
 						} catch(cError &e) {
 							Qk_Warn("Sync readdir zip, %s", e.message().c_str());
 						}
@@ -356,7 +354,7 @@ namespace qk {
 		
 	private:
 		Mutex zip_mutex_;
-		Dict<String, ZipReader*> zips_;
+		Dict<String, Zip*> zips_;
 	};
 
 	FileReader::FileReader(): _core(new Core()) { }
@@ -38,6 +38,7 @@ namespace qk {
 	#define Open(...) if (opendbi(dbi)) return __VA_ARGS__
 	#define CHECK_RC(code, ...) do { rc = (code); if (rc != MDB_SUCCESS) return __VA_ARGS__; } while(0)
 	#define CHECK_BEGIN(flags, ...) \
+		if (!((flags) & MDB_RDONLY) && writing()) return __VA_ARGS__; \
 		Open(__VA_ARGS__); \
 		MDB_txn* txn; \
 		int rc; \
@@ -95,7 +96,7 @@ namespace qk {
 	}
 
 	LMDB::LMDB(cString& path, uint32_t max_dbis, uint32_t map_size)
-			: _path(path), _env(nullptr), _max_dbis(max_dbis), _map_size(map_size) {
+			: _path(path), _env(nullptr), _max_dbis(max_dbis), _map_size(map_size), _writer(ThreadID()) {
 	}
 
 	LMDB::~LMDB() {
@@ -201,6 +202,9 @@ namespace qk {
 		if (dbi->lmdb != this) {
 			return MDB_BAD_DBI; // invalid dbi handle
 		}
+		if (writing()) {
+			return MDB_BAD_TXN; // would wait for the write Txn of this thread
+		}
 		int rc;
 		CHECK_RC(open(), rc); // open env
 		MDB_dbi mdb_dbi;
@@ -395,4 +399,187 @@ namespace qk {
 		return MDB_SUCCESS;
 	}
 
+	// ----------------------- Transaction API -------------------------
+
+	int LMDB::begin(Sp<Txn>* out, bool readonly) {
+		if (!readonly && writing())
+			return MDB_BAD_TXN; // nested write Txn on this thread, would wait forever
+		int rc;
+		CHECK_RC(open(), rc);
+		MDB_txn* txn;
+		CHECK_RC( mdb_txn_begin((MDB_env*)_env, nullptr, readonly ? MDB_RDONLY: 0, &txn), rc);
+		if (!readonly)
+			_writer = thread_self_id();
+		*out = new Txn(this, txn, readonly);
+		return MDB_SUCCESS;
+	}
+
+	#define TXN_HANDLE(dbi) \
+		if (!_txn) return MDB_BAD_TXN; \
+		MDB_dbi h; \
+		int rc; \
+		CHECK_RC( handle(dbi, &h), rc)
+
+	LMDB::Txn::Txn(LMDB* lmdb, void* txn, bool readonly)
+		: _lmdb(lmdb), _txn(txn), _readonly(readonly) {}
+
+	LMDB::Txn::~Txn() {
+		abort();
+	}
+
+	int LMDB::Txn::handle(DBI* dbi, uint32_t* out) {
+		Qk_ASSERT(dbi, "LMDB DBI is null");
+		if (dbi->lmdb != _lmdb.get())
+			return MDB_BAD_DBI; // invalid dbi handle
+		if (dbi->dbi) {
+			*out = dbi->dbi;
+			return MDB_SUCCESS;
+		}
+		for (auto &i: _opened) {
+			if (i.first == dbi) {
+				*out = i.second;
+				return MDB_SUCCESS;
+			}
+		}
+		// LMDB::opendbi() would begin a second transaction on this thread,
+		// open it here, the handle becomes shared only after commit
+		MDB_dbi h;
+		int rc;
+		CHECK_RC( mdb_dbi_open((MDB_txn*)_txn, dbi->name.c_str(), _readonly ? 0: MDB_CREATE, &h), rc);
+		_opened.push({dbi, h});
+		*out = h;
+		return MDB_SUCCESS;
+	}
+
+	int LMDB::Txn::get_buf(DBI* dbi, cString& key, Buffer* out) {
+		WeakBuffer view;
+		int rc;
+		CHECK_RC( get_view(dbi, key, &view), rc);
+		*out = view.copy(); // make a copy
+		return MDB_SUCCESS;
+	}
+
+	int LMDB::Txn::set_buf(DBI* dbi, cString& key, cArray<char>& val) {
+		TXN_HANDLE(dbi);
+		MDB_val k{ key.length(), (void*)key.c_str() };
+		MDB_val v{ val.length(), (void*)*val };
+		return mdb_put((MDB_txn*)_txn, h, &k, &v, 0);
+	}
+
+	int LMDB::Txn::get(DBI* dbi, cString& key, String* out) {
+		WeakBuffer view;
+		int rc;
+		CHECK_RC( get_view(dbi, key, &view), rc);
+		*out = String(*view, view.length());
+		return MDB_SUCCESS;
+	}
+
+	int LMDB::Txn::set(DBI* dbi, cString& key, cString& val) {
+		TXN_HANDLE(dbi);
+		MDB_val k{ key.length(), (void*)key.c_str() };
+		MDB_val v{ val.length(), (void*)val.c_str() };
+		return mdb_put((MDB_txn*)_txn, h, &k, &v, 0);
+	}
+
+	int LMDB::Txn::remove(DBI* dbi, cString& key) {
+		TXN_HANDLE(dbi);
+		MDB_val k{ key.length(), (void*)key.c_str() };
+		return mdb_del((MDB_txn*)_txn, h, &k, nullptr);
+	}
+
+	bool LMDB::Txn::has(DBI* dbi, cString& key) {
+		WeakBuffer view;
+		return get_view(dbi, key, &view) == MDB_SUCCESS;
+	}
+
+	int LMDB::Txn::get_view(DBI* dbi, cString& key, WeakBuffer* out) {
+		TXN_HANDLE(dbi);
+		MDB_val k{ key.length(), (void*)key.c_str() };
+		MDB_val v;
+		CHECK_RC( mdb_get((MDB_txn*)_txn, h, &k, &v), rc);
+		*out = WeakBuffer((char*)v.mv_data, (uint32_t)v.mv_size);
+		return MDB_SUCCESS;
+	}
+
+	int LMDB::Txn::cursor(DBI* dbi, Sp<Cursor>* out) {
+		TXN_HANDLE(dbi);
+		MDB_cursor* cur;
+		CHECK_RC( mdb_cursor_open((MDB_txn*)_txn, h, &cur), rc);
+		*out = new Cursor(this, cur);
+		return MDB_SUCCESS;
+	}
+
+	int LMDB::Txn::commit() {
+		if (!_txn)
+			return MDB_BAD_TXN;
+		int rc = mdb_txn_commit((MDB_txn*)_txn);
+		_txn = nullptr;
+		if (!_readonly)
+			_lmdb->_writer = ThreadID();
+		if (rc == MDB_SUCCESS) {
+			for (auto &i: _opened)
+				i.first->dbi = i.second; // now shared in the environment
+		}
+		_opened.clear();
+		return rc;
+	}
+
+	void LMDB::Txn::abort() {
+		if (_txn) {
+			mdb_txn_abort((MDB_txn*)_txn);
+			_txn = nullptr;
+			_opened.clear();
+			if (!_readonly)
+				_lmdb->_writer = ThreadID();
+		}
+	}
+
+	#undef TXN_HANDLE
+
+	LMDB::Cursor::Cursor(Txn* txn, void* cur)
+		: _txn(txn), _cur(cur), _key(nullptr), _val(nullptr)
+		, _keySize(0), _valSize(0), _valid(false) {}
+
+	LMDB::Cursor::~Cursor() {
+		// cursors of a write transaction are freed when the transaction ends,
+		// read-only cursors must always be closed explicitly
+		if (_txn->active() || _txn->readonly())
+			mdb_cursor_close((MDB_cursor*)_cur);
+	}
+
+	bool LMDB::Cursor::move(int op, cString* key) {
+		MDB_val k, v;
+		if (key)
+			k = { key->length(), (void*)key->c_str() };
+		_valid = _txn->active() &&
+			mdb_cursor_get((MDB_cursor*)_cur, &k, &v, (MDB_cursor_op)op) == MDB_SUCCESS;
+		if (_valid) {
+			_key = (const char*)k.mv_data; _keySize = (uint32_t)k.mv_size;
+			_val = (const char*)v.mv_data; _valSize = (uint32_t)v.mv_size;
+		}
+		return _valid;
+	}
+
+	bool LMDB::Cursor::first() {
+		return move(MDB_FIRST);
+	}
+
+	bool LMDB::Cursor::seek(cString& key) {
+		return move(MDB_SET_RANGE, &key);
+	}
+
+	bool LMDB::Cursor::next() {
+		return _valid && move(MDB_NEXT);
+	}
+
+	int LMDB::Cursor::remove() {
+		if (!_valid || !_txn->active())
+			return MDB_BAD_TXN;
+		int rc;
+		CHECK_RC( mdb_cursor_del((MDB_cursor*)_cur, 0), rc);
+		// the deleted item is skipped, MDB_NEXT lands on the following key
+		move(MDB_NEXT);
+		return MDB_SUCCESS;
+	}
+
 } // namespace qk
@@ -59,7 +59,9 @@ namespace qk {
 	 * 3. Acquire DBI using dbi("tablename").  
 	 * 4. Read/write using get/set or get_buf/set_buf.  
 	 * 5. Optionally use scan_prefix / scan_range for grouped keys.  
-	 * 6. close() if needed (or allow destructor to auto-close).
+	 * 6. Use begin() to batch many operations into one transaction, and
+	 *    Txn::cursor() to iterate without copying keys or values.
+	 * 7. close() if needed (or allow destructor to auto-close).
 	 *
 	 * Threading Notes:
 	 * ---------------
@@ -81,6 +83,8 @@ namespace qk {
 	class Qk_EXPORT LMDB: public Reference {
 	public:
 		struct DBI;                     // LMDB database handle (per logical table)
+		class Txn;                      // Explicit transaction
+		class Cursor;                   // Zero-copy cursor inside a transaction
 		typedef qk::Pair<String, String> Pair;
 
 		// Statistics for a database in the environment
@@ -278,6 +282,29 @@ namespace qk {
 		 */
 		int clear(DBI* dbi);
 
+		/**
+		 * Begin an explicit transaction.
+		 *
+		 * Each get/set/remove above opens and commits its own transaction, a Txn
+		 * holds one transaction across many operations and commits them together,
+		 * which is much cheaper for frequent small writes.
+		 *
+		 * A write transaction holds the environment write lock until it is
+		 * committed or aborted, other writers block meanwhile. Like all LMDB
+		 * transactions it must only be used by the thread that began it.
+		 *
+		 * While the thread holds a write transaction, the writes outside of it
+		 * on the same thread, including begin() of another write transaction, would
+		 * wait for the lock forever, they fail with MDB_BAD_TXN instead.
+		 * The reads outside of it still see the last committed data.
+		 *
+		 * @param out       Output transaction.
+		 * @param readonly  Begin a read-only transaction.
+		 * @return MDB_SUCCESS on success, MDB_BAD_TXN if this thread already
+		 *         holds a write transaction.
+		 */
+		int begin(Sp<Txn>* out, bool readonly = false);
+
 		/**
 		 * Global shared LMDB instance.
 		 * Typically used for system-level storage (cookies, caches, etc.)
@@ -304,6 +331,11 @@ namespace qk {
 		 */
 		int opendbi(DBI *dbi);
 
+		/**
+		 * @return true if the current thread holds the write transaction.
+		 */
+		inline bool writing() const { return _writer.load() == thread_self_id(); }
+
 	private:
 		void* _env;                     // LMDB environment handle
 		DBI* _next_id_dbi;              // Internal DBI for next_id counter
@@ -312,6 +344,129 @@ namespace qk {
 		Mutex _mutex;                   // Guards DBI map & env open sequence
 		uint32_t _max_dbis;             // Maximum allowed DBI count
 		uint32_t _map_size;             // Initial mmap size
+		std::atomic<ThreadID> _writer;  // Thread holding the write Txn, see begin()
+	};
+
+	/**
+	 * @class LMDB::Txn
+	 *
+	 * One LMDB transaction across many operations, see LMDB::begin().
+	 * Destroying an unfinished transaction aborts it.
+	 */
+	class Qk_EXPORT LMDB::Txn: public Reference {
+		Qk_DISABLE_COPY(Txn);
+	public:
+		~Txn();
+
+		/**
+		 * @return true if the transaction is read-only.
+		 */
+		inline bool readonly() const { return _readonly; }
+
+		/**
+		 * @return true until commit() or abort() is called.
+		 */
+		inline bool active() const { return _txn; }
+
+		int get_buf(DBI* dbi, cString& key, Buffer* out);
+		int set_buf(DBI* dbi, cString& key, cArray<char>& val);
+		int get(DBI* dbi, cString& key, String* out);
+		int set(DBI* dbi, cString& key, cString& val);
+		int remove(DBI* dbi, cString& key);
+		bool has(DBI* dbi, cString& key);
+
+		/**
+		 * Read a value without copying it.
+		 *
+		 * @param out   View of the value in the memory map, valid until the
+		 *              transaction ends or the next write in it.
+		 * @return MDB_SUCCESS if found, otherwise error code.
+		 */
+		int get_view(DBI* dbi, cString& key, WeakBuffer* out);
+
+		/**
+		 * Open a cursor on dbi.
+		 *
+		 * @param out   Output cursor, unpositioned until first() or seek().
+		 * @return MDB_SUCCESS on success.
+		 */
+		int cursor(DBI* dbi, Sp<Cursor>* out);
+
+		/**
+		 * Commit all operations of the transaction.
+		 * @return MDB_SUCCESS on success.
+		 */
+		int commit();
+
+		/**
+		 * Discard all operations of the transaction.
+		 */
+		void abort();
+
+	private:
+		Txn(LMDB* lmdb, void* txn, bool readonly);
+		int handle(DBI* dbi, uint32_t* out); // get the dbi handle, open it inside this txn if needed
+		Sp<LMDB> _lmdb;
+		void* _txn;                     // MDB_txn, null after commit or abort
+		Array<qk::Pair<DBI*, uint32_t>> _opened; // dbi handles opened by this txn
+		bool _readonly;
+		friend class LMDB;
+	};
+
+	/**
+	 * @class LMDB::Cursor
+	 *
+	 * Ordered iteration over a DBI inside a transaction.
+	 *
+	 * key() and val() are views into the memory map and are not copied, they
+	 * stay valid until the cursor moves, the transaction writes or ends.
+	 */
+	class Qk_EXPORT LMDB::Cursor: public Reference {
+		Qk_DISABLE_COPY(Cursor);
+	public:
+		~Cursor();
+
+		/**
+		 * Position at the first key, returns false if the table is empty.
+		 */
+		bool first();
+
+		/**
+		 * Position at the first key >= key, returns false if there is none.
+		 */
+		bool seek(cString& key);
+
+		/**
+		 * Move to the next key, returns false at the end.
+		 */
+		bool next();
+
+		/**
+		 * @return true if the cursor is positioned at a key.
+		 */
+		inline bool valid() const { return _valid; }
+
+		inline WeakBuffer key() const { return _valid ? WeakBuffer(_key, _keySize): WeakBuffer(); }
+		inline WeakBuffer val() const { return _valid ? WeakBuffer(_val, _valSize): WeakBuffer(); }
+
+		/**
+		 * Delete the current key, the cursor moves to the next key.
+		 * Only for write transactions.
+		 *
+		 * @return MDB_SUCCESS on success.
+		 */
+		int remove();
+
+	private:
+		Cursor(Txn* txn, void* cur);
+		bool move(int op, cString* key = nullptr);
+		Sp<Txn> _txn;
+		void* _cur;                     // MDB_cursor
+		const char* _key;
+		const char* _val;
+		uint32_t _keySize, _valSize;
+		bool _valid;
+		friend class Txn;
 	};
 
 	typedef LMDB::DBI* LMDB_DBIPtr;
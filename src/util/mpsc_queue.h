@@ -0,0 +1,180 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __quark__util__mpsc_queue__
+#define __quark__util__mpsc_queue__
+
+#include <atomic>
+#include "./util.h"
+
+namespace qk {
+
+	/**
+	 * @class MPSCQueue
+	 * @brief An unbounded multi-producer, single-consumer lock-free queue.
+	 *
+	 * Intrusive Vyukov queue, `push()` is wait-free and can be called from any thread,
+	 * `pop()` and `empty()` must be called only from the consumer thread.
+	 *
+	 * The node storage is recycled through a lock-free free list shared by all queues of `T`,
+	 * the consumer returns nodes to it with `recycle()`, and a producer takes the whole
+	 * list at once into its thread local cache, so no ABA problem arises.
+	 */
+	template<typename T>
+	class MPSCQueue {
+		Qk_DISABLE_COPY(MPSCQueue);
+		struct NodeBase {
+			std::atomic<NodeBase*> next;
+		};
+	public:
+		struct Node: NodeBase {
+			T value;
+		};
+
+		MPSCQueue(): _head(&_stub), _tail(&_stub) {
+			_stub.next.store(nullptr, std::memory_order_relaxed);
+		}
+
+		~MPSCQueue() {
+			while (auto node = pop())
+				recycle(node);
+		}
+
+		/**
+		 * Push one item from any thread
+		 */
+		template<typename... Args>
+		void push(Args&&... args) {
+			auto node = alloc_node();
+			new(&node->value) T{std::forward<Args>(args)...};
+			push_node(node);
+		}
+
+		/**
+		 * Pop one node or return nullptr if the queue is empty or a push is still in progress,
+		 * only called from the consumer thread.
+		 *
+		 * The node must be returned to storage with `recycle()` after using its value
+		 */
+		Node* pop() {
+			auto tail = _tail;
+			auto next = tail->next.load(std::memory_order_acquire);
+			if (tail == &_stub) {
+				if (!next)
+					return nullptr;
+				_tail = tail = next;
+				next = next->next.load(std::memory_order_acquire);
+			}
+			if (next) {
+				_tail = next;
+				return static_cast<Node*>(tail);
+			}
+			if (tail != _head.load(std::memory_order_acquire))
+				return nullptr; // a producer has not linked its node yet
+			push_node(&_stub);
+			next = tail->next.load(std::memory_order_acquire);
+			if (next) {
+				_tail = next;
+				return static_cast<Node*>(tail);
+			}
+			return nullptr;
+		}
+
+		/**
+		 * Returns whether the queue is empty, only called from the consumer thread
+		 */
+		bool empty() const {
+			return _tail == &_stub && !_stub.next.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * Destroy the node value and return the node storage to the free list
+		 */
+		static void recycle(Node* node) {
+			node->value.~T();
+			if (_freeCount.load(std::memory_order_relaxed) >= kMaxFree) {
+				::free(node); return;
+			}
+			_freeCount.fetch_add(1, std::memory_order_relaxed);
+			auto head = _free.load(std::memory_order_relaxed);
+			do {
+				node->next.store(head, std::memory_order_relaxed);
+			} while (!_free.compare_exchange_weak(head, node,
+				std::memory_order_release, std::memory_order_relaxed));
+		}
+
+	private:
+		enum { kMaxFree = 1024 };
+
+		struct Cache {
+			NodeBase *list = nullptr;
+			~Cache() {
+				while (list) {
+					auto next = list->next.load(std::memory_order_relaxed);
+					::free(list);
+					list = next;
+				}
+			}
+		};
+
+		void push_node(NodeBase* node) {
+			node->next.store(nullptr, std::memory_order_relaxed);
+			auto prev = _head.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release); // link, visible to consumer
+		}
+
+		static Node* alloc_node() {
+			static thread_local Cache cache;
+			if (!cache.list) { // take the whole free list
+				cache.list = _free.exchange(nullptr, std::memory_order_acquire);
+				if (!cache.list)
+					return static_cast<Node*>(::malloc(sizeof(Node)));
+				_freeCount.store(0, std::memory_order_relaxed);
+			}
+			auto node = cache.list;
+			cache.list = node->next.load(std::memory_order_relaxed);
+			return static_cast<Node*>(node);
+		}
+
+		alignas(64) std::atomic<NodeBase*> _head; // producers
+		alignas(64) NodeBase *_tail; // consumer
+		NodeBase _stub;
+		static std::atomic<NodeBase*> _free;
+		static std::atomic<uint32_t>  _freeCount;
+	};
+
+	template<typename T>
+	std::atomic<typename MPSCQueue<T>::NodeBase*> MPSCQueue<T>::_free(nullptr);
+
+	template<typename T>
+	std::atomic<uint32_t> MPSCQueue<T>::_freeCount(0);
+}
+
+#endif
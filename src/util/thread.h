@@ -40,6 +40,7 @@
 #include "./util.h"
 #include "./cb.h"
 #include "./list.h"
+#include "./mpsc_queue.h"
 #include "./string.h"
 #include "./event.h"
 
@@ -88,6 +89,13 @@ namespace qk {
 	//!< wait for the target 'id' thread to end, param `timeoutUs` less than 1 permanent wait
 	Qk_EXPORT void     thread_join_for(ThreadID id, uint64_t timeoutUs = 0);
 	Qk_EXPORT cThread* thread_self(); // return the self thread object created by `thread_new`
+	/**
+	 * Call `fn(index)` for every index in [0, count) on the shared compute workers and
+	 * return after all calls have finished. The calling thread takes part in the work.
+	 * Nested or concurrent calls run inline on the calling thread.
+	 */
+	Qk_EXPORT void     parallel_for(uint32_t count, const std::function<void(uint32_t index)> &fn);
+	Qk_EXPORT uint32_t parallel_concurrency(); //!< threads used by parallel_for(), including the caller
 	/**
 	 * Abort all Qk-managed threads with status -2, wait up to one second for
 	 * each thread to finish, and then exit the process with `exit_rc`.
@@ -119,6 +127,50 @@ namespace qk {
 #endif
 	}
 
+	/**
+	 * @class WorkGroup
+	 *
+	 * A set of works of `RunLoop::work()` that can be awaited or cancelled together
+	*/
+	class Qk_EXPORT WorkGroup: public Reference {
+		Qk_DISABLE_COPY(WorkGroup);
+	public:
+		WorkGroup();
+
+		/**
+		 * Cancel the works of the group that have not started yet,
+		 * their `done` callbacks are not called
+		*/
+		void cancel();
+
+		/**
+		 * Returns whether `cancel()` has been called
+		*/
+		bool is_cancel() const;
+
+		/**
+		 * Returns the works count of the group that have not finished the work callback
+		*/
+		uint32_t pending() const;
+
+		/**
+		 * Wait for all the works of the group to finish the work callback,
+		 * the `done` callbacks are still called later on their run loop.
+		 *
+		 * @note Do not call it from a work callback, it can wait for itself
+		 * @return false when timeout
+		*/
+		bool wait(uint64_t timeoutUs = 0 /*Less than 1 permanent wait*/);
+
+	private:
+		void enter();
+		void leave();
+		std::atomic_uint _pending;
+		std::atomic_bool _cancel;
+		CondMutex        _cond;
+		friend class RunLoop;
+	};
+
 	/**
 	* @class PostMessage
 	*/
@@ -163,6 +215,17 @@ namespace qk {
 			kCheck,
 		};
 
+		/**
+		 * Priority classes of the work pool behind `work()`.
+		 *
+		 * The higher queued works are always taken first by the pool workers.
+		*/
+		enum WorkPriority {
+			kWorkHigh,   //!< user-visible work, such as decoding the images on screen
+			kWorkNormal, //!< default, file io and the common background jobs
+			kWorkLow,    //!< prefetch and the other speculative jobs
+		};
+
 		/**
 		 * @class PostSyncData
 		*/
@@ -211,9 +274,11 @@ namespace qk {
 		void timer_stop(uint32_t id);
 
 		/**
-		 * @method work(cb[,done])
+		 * @method work(cb[,done[,priority[,group]]])
+		 *
+		 * Run `cb` on the shared work-stealing pool and then `done` on this run loop
 		*/
-		uint32_t work(Cb cb, Cb done = 0);
+		uint32_t work(Cb cb, Cb done = 0, WorkPriority priority = kWorkNormal, WorkGroup *group = nullptr);
 
 		/**
 		* @method work_cancel(id)
@@ -306,6 +371,7 @@ namespace qk {
 
 		/**
 		* @method clear(), immediately stop all timer and msg,
+		* cancel all works and discard their done callbacks,
 		* only allowed to be called on the self thread
 		*/
 		void clear();
@@ -322,7 +388,8 @@ namespace qk {
 		struct Msg { uv_timer_t *timer; Cb cb; };
 		struct work_t;
 		struct check_t;
-		List<Msg>       _msg;
+		MPSCQueue<Msg>  _msg; // lock-free, posted from any thread
+		std::atomic_bool _msgWakeup; // an async wakeup is pending for _msg
 		Dict<uint32_t, uv_timer_t*> _timer;
 		Dict<uint32_t, check_t*> _check;
 		Dict<uint32_t, work_t*> _work;
@@ -69,12 +69,26 @@ namespace qk {
 		void stop_check();
 	};
 
-	struct RunLoop::work_t: CallbackCore<Object> {
+	/**
+	 * A job of the work pool, it is retained by the pool until `complete()`
+	*/
+	struct WorkTask: Reference {
+		enum State { kPending, kRunning, kCancel };
+		RunLoop::WorkPriority priority;
+		Sp<WorkGroup> group;
+		std::atomic_int state;
+		virtual void exec() = 0; // call on a pool worker when it is not cancelled
+		virtual void complete() = 0; // call on the pool worker at the end, either or not cancelled
+		bool cancel(); // cancel the task if it has not started yet
+	};
+
+	struct RunLoop::work_t: WorkTask {
 		RunLoop* host;
 		uint32_t id;
 		Cb work, done;
-		uv_work_t uv_req;
-		void call(Data &e) override; // call start uv work
+		void submit(); // submit to the work pool
+		void exec() override;
+		void complete() override;
 	};
 
 	//////
@@ -91,6 +105,7 @@ namespace qk {
 		Set<ThreadID> _childs;
 	};
 
+	void        work_pool_submit(WorkTask *task);
 	Thread_INL* thread_self_inl();
 	void        runloop_death(RunLoop *loop);
 	RunLoop*    current_from(RunLoop **inOut);
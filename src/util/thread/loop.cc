@@ -86,23 +86,43 @@ namespace qk {
 				Qk_ASSERT_EQ(0, uv_async_send(_uv_async));
 		}
 
+		void async_wakeup() {
+			// Coalesce the wakeups, only the first post after the messages are drained sends
+			if (!_msgWakeup.exchange(true)) {
+				ScopeLock lock(_mutex); // protect _uv_async
+				async_send();
+			}
+		}
+
 		void msgs_call() {
-			Lock lock(_mutex);
-			if (_msg.length()) {
-				auto msg = std::move(_msg);
-				lock.unlock();
-				autoreleasepool([](auto msgs, auto self) {
-					for (auto &m: *msgs) {
+			// Clear it before draining, so a post that is not seen by this drain wakes up again
+			_msgWakeup.store(false);
+
+			MPSCQueue<Msg>::Node *first = nullptr, *last = nullptr;
+			while (auto node = _msg.pop()) { // take out the current messages
+				node->next.store(nullptr, std::memory_order_relaxed);
+				if (last)
+					last->next.store(node, std::memory_order_relaxed);
+				else
+					first = node;
+				last = node;
+			}
+			if (first) {
+				autoreleasepool([](auto node, auto self) {
+					while (node) {
+						auto next = static_cast<MPSCQueue<Msg>::Node*>(node->next.load(std::memory_order_relaxed));
+						auto &m = node->value;
 						if (m.timer) {
 							self->timer_start((timer_t*)m.timer);
 						} else {
 							m.cb->resolve(self);
 						}
+						MPSCQueue<Msg>::recycle(node);
+						node = next;
 					}
-				}, &msg, this);
-				lock.lock();
+				}, first, this);
 			}
-			if (_msg.length()) {
+			if (!_msg.empty()) {
 				Qk_ASSERT_EQ(0, uv_async_send(_uv_async));
 			}
 			else if (is_alive()) {
@@ -115,10 +135,8 @@ namespace qk {
 		}
 
 		void post(cCb &cb) {
-			_mutex.lock();
-			_msg.pushBack({ 0, cb });
-			_this->async_send();
-			_mutex.unlock();
+			_msg.push(nullptr, cb);
+			async_wakeup();
 		}
 
 		void death() {
@@ -279,24 +297,39 @@ namespace qk {
 		host->_check.erase(id); // release hold for _check.set
 	}
 
-	void RunLoop::work_t::call(Data &e) {
+	void RunLoop::work_t::submit() {
 		host->_work.set(id, this);
 		retain(); // retain for _work.set
-		Qk_ASSERT_EQ(0, uv_queue_work(host->_uv_loop, &uv_req, [](uv_work_t* req) {
-			autoreleasepool([](auto self, auto _) {
-				self->work->resolve(self->host);
-			}, static_cast<work_t*>(req->data));
-		}, [](uv_work_t* req, int status) {
-			autoreleasepool([](auto self, auto status) {
-				auto host = _inl(self->host);
+		if (group)
+			group->enter();
+		work_pool_submit(this);
+	}
+
+	void RunLoop::work_t::exec() {
+		autoreleasepool([](auto self, auto _) {
+			self->work->resolve(self->host);
+		}, this);
+	}
+
+	void RunLoop::work_t::complete() {
+		if (group)
+			group->leave();
+		// The post holds the work by itself, as RunLoop::clear() may release the hold
+		// for _work.set before it runs, and the post is freed with the message if it never runs
+		struct Core: CallbackCore<Object> {
+			Sp<work_t> work;
+			Core(work_t *w): work(w) {}
+			void call(Data& e) {
+				auto host = work->host;
 				Qk_ASSERT_EQ(thread_self_id(), host->_tid);
-				host->_work.erase(self->id);
-				if (UV_ECANCELED != *status) // no cancel
-					self->done->resolve(host);
-				host->async_send();
-				self->release(); // release hold for _work.set
-			}, static_cast<work_t*>(req->data), &status);
-		}));
+				if (!host->_work.erase(work->id))
+					return; // discarded by RunLoop::clear()
+				if (work->state.load() != kCancel)
+					work->done->resolve(host);
+				work->release(); // release hold for _work.set
+			}
+		};
+		host->post(Cb(new Core(this)), true);
 	}
 
 	// ----------------------------- R u n . L o o p -----------------------------
@@ -305,6 +338,7 @@ namespace qk {
 		: _thread(nullptr)
 		, _uv_loop(uv)
 		, _uv_async(nullptr)
+		, _msgWakeup(false)
 	{}
 
 	RunLoop::~RunLoop() {
@@ -316,20 +350,20 @@ namespace qk {
 			return;
 
 		_mutex.lock();
-		List<Msg>             msgs(std::move(_msg));
 		Dict<uint32_t, uv_timer_t*> timers(std::move(_timer));
 		Dict<uint32_t, check_t*> checks(std::move(_check));
 		Dict<uint32_t, work_t*> works(std::move(_work));
 		_mutex.unlock();
 
-		for (auto &i: msgs) {
-			if (i.timer) {
-				auto timer = (timer_t*)(i.timer);
+		while (auto node = _msg.pop()) {
+			if (node->value.timer) {
+				auto timer = (timer_t*)(node->value.timer);
 				Qk_DLog("RunLoop::clear(), discard timer %p", timer);
 				delete timer;
 			} else {
 				Qk_DLog("RunLoop::clear(), discard msg cb");
 			}
+			MPSCQueue<Msg>::recycle(node);
 		}
 
 		for (auto &i: timers) {
@@ -346,7 +380,8 @@ namespace qk {
 
 		for (auto& i: works) {
 			Qk_DLog("RunLoop::clear(), discard work %p", i.second);
-			Qk_ASSERT_EQ(0, uv_cancel((uv_req_t*)&i.second->uv_req));
+			i.second->cancel(); // a running work still completes, but its done is not called
+			i.second->release(); // release hold for _work.set
 		}
 	}
 
@@ -379,7 +414,7 @@ namespace qk {
 	bool RunLoop::is_alive() const {
 		return _uv_loop->active_reqs.count != 0 ||
 					_uv_loop->active_handles > 1 ||
-					_uv_loop->closing_handles != NULL || _msg.length() != 0;
+					_uv_loop->closing_handles != NULL || !_msg.empty() || _work.length() != 0;
 	}
 
 	void RunLoop::post_message(Cb cb) {
@@ -398,9 +433,8 @@ namespace qk {
 		if (thread_self_id() == _tid) { // is self thread
 			_this->timer_start(timer);
 		} else {
-			ScopeLock lock(_mutex);
-			_msg.pushBack({ timer });
-			_this->async_send();
+			_msg.push(timer);
+			_this->async_wakeup();
 		}
 		return timer->id;
 	}
@@ -449,19 +483,21 @@ namespace qk {
 		}
 	}
 
-	uint32_t RunLoop::work(Cb cb, Cb done) {
+	uint32_t RunLoop::work(Cb cb, Cb done, WorkPriority priority, WorkGroup *group) {
 		auto work = new work_t();
+		work->priority = priority;
+		work->group = group;
+		work->state = WorkTask::kPending;
 		work->host = this;
 		work->id = getId32();
 		work->work = cb;
 		work->done = done;
-		work->uv_req.data = work;
 
 		if (thread_self_id() == _tid) {
-			work->resolve();
+			work->submit();
 		} else {
 			ScopeLock lock(_mutex);
-			work->resolve();
+			work->submit();
 		}
 		return work->id;
 	}
@@ -472,7 +508,7 @@ namespace qk {
 			if (isNoSelfThread) _mutex.lock();
 			work_t *out;
 			if (_work.get(id, out)) {
-				Qk_ASSERT_EQ(0, uv_cancel((uv_req_t*)&out->uv_req));
+				out->cancel();
 			}
 			if (isNoSelfThread) _mutex.unlock();
 		}
@@ -0,0 +1,145 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include "../thread.h"
+
+namespace qk {
+
+	/**
+	 * Fork-join workers shared by all parallel_for() callers.
+	 *
+	 * A job lives on the caller's stack, items are claimed through an atomic cursor,
+	 * and the caller itself consumes items until none are left, so a job always
+	 * completes even if no worker wakes up in time.
+	 */
+	class ParallelWorkers {
+	public:
+		struct Job {
+			const std::function<void(uint32_t index)> *fn;
+			uint32_t count;
+			std::atomic<uint32_t> next;
+			std::atomic<uint32_t> workers; // workers that are still touching this job
+		};
+
+		ParallelWorkers(): _job(nullptr), _gen(0), _busy(false) {
+			uint32_t n = std::thread::hardware_concurrency();
+			n = Qk_Min(Qk_Max(n, 1), 16) - 1; // the calling thread also takes part
+			for (uint32_t i = 0; i < n; i++) {
+				thread_new([this](cThread *t) { run(t); }, "parallel_worker");
+			}
+			_concurrency = n + 1;
+		}
+
+		uint32_t concurrency() const {
+			return _concurrency;
+		}
+
+		void exec(uint32_t count, const std::function<void(uint32_t index)> &fn) {
+			bool busy = false;
+			if (count < 2 || _concurrency < 2 || tls_inWorker ||
+					!_busy.compare_exchange_strong(busy, true)) {
+				for (uint32_t i = 0; i < count; i++)
+					fn(i); // nested or concurrent call, run inline on the calling thread
+				return;
+			}
+			Job job{&fn, count};
+			job.next = 0;
+			job.workers = 0;
+			{
+				ScopeLock lock(_cond.mutex);
+				_job = &job;
+				_gen++;
+				_cond.cond.notify_all();
+			}
+			tls_inWorker = true;
+			consume(&job);
+			tls_inWorker = false;
+			{
+				ScopeLock lock(_cond.mutex);
+				_job = nullptr; // no more workers can join this job
+			}
+			while (job.workers.load(std::memory_order_acquire))
+				std::this_thread::yield(); // wait for the claimed items to finish
+			_busy.store(false, std::memory_order_release);
+		}
+
+	private:
+		static void consume(Job *job) {
+			uint32_t i;
+			while ((i = job->next.fetch_add(1, std::memory_order_relaxed)) < job->count) {
+				(*job->fn)(i);
+			}
+		}
+
+		void run(cThread *t) {
+			uint64_t gen = 0;
+			tls_inWorker = true;
+			while (!t->abort) {
+				Job *job = nullptr;
+				{
+					Lock lock(_cond.mutex);
+					if (gen == _gen) // wake up periodically to observe thread abort
+						_cond.cond.wait_for(lock, std::chrono::milliseconds(100));
+					if (gen != _gen) {
+						gen = _gen;
+						if ((job = _job))
+							job->workers.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+				if (job) {
+					consume(job);
+					job->workers.fetch_sub(1, std::memory_order_release);
+				}
+			}
+		}
+
+		CondMutex _cond;
+		Job      *_job;
+		uint64_t  _gen;
+		uint32_t  _concurrency;
+		std::atomic_bool _busy;
+		static thread_local bool tls_inWorker;
+	};
+
+	thread_local bool ParallelWorkers::tls_inWorker = false;
+
+	static ParallelWorkers* parallel_workers() {
+		static ParallelWorkers *workers = new ParallelWorkers();
+		return workers;
+	}
+
+	void parallel_for(uint32_t count, const std::function<void(uint32_t index)> &fn) {
+		parallel_workers()->exec(count, fn);
+	}
+
+	uint32_t parallel_concurrency() {
+		return parallel_workers()->concurrency();
+	}
+}
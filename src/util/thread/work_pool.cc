@@ -0,0 +1,180 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include "./inl.h"
+
+namespace qk {
+
+	/**
+	 * Work-stealing pool behind RunLoop::work().
+	 *
+	 * Every worker owns one deque per priority class. The works submitted from a worker
+	 * go to its own deques, the others are spread over the workers round robin.
+	 * A worker takes the front of its own deque first and otherwise steals the back
+	 * of the others, the higher priority class is always searched first in all deques.
+	 */
+	class WorkPool {
+	public:
+		enum { kPriorityCount = RunLoop::kWorkLow + 1 };
+
+		struct Deque {
+			Mutex           mutex;
+			List<WorkTask*> tasks[kPriorityCount];
+		};
+
+		WorkPool(): _pending(0), _sleeping(0), _next(0) {
+			uint32_t n = std::thread::hardware_concurrency();
+			_count = Qk_Min(Qk_Max(n, 4), 16); // works can block on io, so at least 4 workers
+			_deques = new Deque[_count];
+			for (uint32_t i = 0; i < _count; i++) {
+				thread_new([this, i](cThread *t) { run(t, i); }, "work_pool");
+			}
+		}
+
+		void submit(WorkTask *task) {
+			task->retain(); // retain for the pool
+			auto i = tls_index >= 0 ? uint32_t(tls_index): _next.fetch_add(1, std::memory_order_relaxed) % _count;
+			auto &deque = _deques[i];
+			deque.mutex.lock();
+			deque.tasks[task->priority].pushBack(task);
+			deque.mutex.unlock();
+			_pending.fetch_add(1, std::memory_order_seq_cst);
+			if (_sleeping.load(std::memory_order_seq_cst)) {
+				ScopeLock lock(_mutex);
+				_cond.notify_one();
+			}
+		}
+
+	private:
+		WorkTask* take(uint32_t self) {
+			if (!_pending.load(std::memory_order_acquire))
+				return nullptr;
+			for (int p = 0; p < kPriorityCount; p++) {
+				for (uint32_t j = 0; j < _count; j++) {
+					auto &deque = _deques[(self + j) % _count];
+					ScopeLock lock(deque.mutex);
+					auto &tasks = deque.tasks[p];
+					if (tasks.length()) {
+						WorkTask *task;
+						if (j == 0) {
+							task = tasks.front(); tasks.popFront(); // own deque
+						} else {
+							task = tasks.back(); tasks.popBack(); // steal
+						}
+						_pending.fetch_sub(1, std::memory_order_relaxed);
+						return task;
+					}
+				}
+			}
+			return nullptr;
+		}
+
+		void run(cThread *t, uint32_t self) {
+			tls_index = self;
+			while (!t->abort) {
+				auto task = take(self);
+				if (task) {
+					int state = WorkTask::kPending;
+					if (!(task->group && task->group->is_cancel()) &&
+							task->state.compare_exchange_strong(state, WorkTask::kRunning)) {
+						task->exec();
+					} else {
+						task->state.store(WorkTask::kCancel);
+					}
+					task->complete();
+					task->release(); // release for the pool
+				} else {
+					Lock lock(_mutex);
+					_sleeping.fetch_add(1, std::memory_order_seq_cst);
+					if (!_pending.load(std::memory_order_seq_cst)) // wake up periodically to observe thread abort
+						_cond.wait_for(lock, std::chrono::milliseconds(100));
+					_sleeping.fetch_sub(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		Deque    *_deques;
+		uint32_t  _count;
+		std::atomic_uint _pending, _sleeping, _next;
+		Mutex     _mutex;
+		Condition _cond;
+		static thread_local int tls_index;
+	};
+
+	thread_local int WorkPool::tls_index = -1;
+
+	void work_pool_submit(WorkTask *task) {
+		static WorkPool *pool = new WorkPool();
+		pool->submit(task);
+	}
+
+	bool WorkTask::cancel() {
+		int state = kPending;
+		return this->state.compare_exchange_strong(state, kCancel);
+	}
+
+	// ----------------------------- W o r k . G r o u p -----------------------------
+
+	WorkGroup::WorkGroup(): _pending(0), _cancel(false) {
+	}
+
+	void WorkGroup::cancel() {
+		_cancel.store(true);
+	}
+
+	bool WorkGroup::is_cancel() const {
+		return _cancel.load();
+	}
+
+	uint32_t WorkGroup::pending() const {
+		return _pending.load();
+	}
+
+	bool WorkGroup::wait(uint64_t timeoutUs) {
+		Lock lock(_cond.mutex);
+		if (timeoutUs) {
+			return _cond.cond.wait_for(lock, std::chrono::microseconds(timeoutUs), [this]() {
+				return _pending.load() == 0;
+			});
+		}
+		_cond.cond.wait(lock, [this]() { return _pending.load() == 0; });
+		return true;
+	}
+
+	void WorkGroup::enter() {
+		_pending.fetch_add(1);
+	}
+
+	void WorkGroup::leave() {
+		if (_pending.fetch_sub(1) == 1) {
+			_cond.lock_notify_all();
+		}
+	}
+}
@@ -322,6 +322,11 @@ namespace qk {
 			_file_info.clear();
 			_dir_info.clear();
 		}
+		ScopeLock lock(_cursors_mutex);
+		for (auto unzp: _cursors) {
+			unzClose((unzFile)unzp);
+		}
+		_cursors.clear();
 		return !_unzp;
 	}
 
@@ -409,6 +414,57 @@ namespace qk {
 		return buffer;
 	}
 
+	bool ZipReader::read_file(cString& path, Buffer *out) {
+		auto it = _file_info.find(path);
+		if ( it == _file_info.end() ) {
+			return false;
+		}
+		auto &info = it->second;
+		unzFile unzp = nullptr;
+		{
+			ScopeLock lock(_cursors_mutex);
+			if (_cursors.length()) {
+				unzp = (unzFile)_cursors.back();
+				_cursors.pop();
+			}
+		}
+		if ( !unzp ) {
+			// Opening only reads the end of central directory, the entry index is shared
+			unzp = unzOpen(fs_fallback_c(_path));
+			if ( !unzp ) {
+				Qk_ELog("Cannot open file ZipReader, %s", _path.c_str());
+				*out = Buffer();
+				return false;
+			}
+		}
+		unz_file_pos pos = { info.pos.pos_in_zip_directory, info.pos.num_of_file };
+		int code = unzGoToFilePos(unzp, &pos);
+		if ( code == UNZ_OK ) {
+			code = _passwd.isEmpty() ?
+				unzOpenCurrentFile(unzp): unzOpenCurrentFilePassword(unzp, _passwd.c_str());
+		}
+		bool ok = false;
+		if ( code == UNZ_OK ) {
+			uint32_t size = info.uncompressed_size;
+			Buffer buffer = Buffer::alloc(size, size + 1);
+			int length = unzReadCurrentFile(unzp, *buffer, size);
+			if ( unzCloseCurrentFile(unzp) != UNZ_OK || length < 0 ) {
+				*out = Buffer(); // err
+			} else {
+				*(*buffer + length) = '\0';
+				*out = std::move(buffer);
+				ok = true;
+			}
+		} else {
+			*out = Buffer();
+		}
+		if (!ok)
+			Qk_ELog("Cannot read file ZipReader, %s, %s", _path.c_str(), path.c_str());
+		ScopeLock lock(_cursors_mutex);
+		_cursors.push(unzp);
+		return ok;
+	}
+
 	// ZipWriter
 
 	ZipWriter::ZipWriter(cString& path, cString& passwd)
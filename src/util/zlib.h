@@ -34,6 +34,7 @@
 #include "./fs.h"
 #include "./error.h"
 #include "./dict.h"
+#include "./thread.h"
 
 namespace qk {
 
@@ -149,6 +150,14 @@ namespace qk {
 		*/
 		Buffer read(uint32_t size);
 
+		/**
+		* @method read_file(path, out) Reads the whole package internal file of path,
+		* unlike jump/read it uses a zip cursor of its own and can be called from
+		* multiple threads at the same time
+		* @return {bool} false if the file does not exist or cannot be read
+		*/
+		bool read_file(cString& path, Buffer *out);
+
 		/**
 		* @method current 当前文件名称
 		*/
@@ -211,6 +220,8 @@ namespace qk {
 		iterator  _cur_it;
 		Info      _file_info;
 		DirInfo   _dir_info;
+		Mutex     _cursors_mutex;
+		Array<void*> _cursors; // idle zip cursors for read_file
 
 		Qk_DEFINE_INLINE_CLASS(Inl);
 	};
@@ -30,6 +30,29 @@
 
 import { Mv, LOG } from './tool'
 import * as v from 'quark/types';
+import { Path } from 'quark/path';
+
+// The native parser of Path.getBounds(matrix) must accept the same values as parseMat
+function MatParity(val: any) {
+	let path = new Path(v.newVec2(0, 0));
+	path.lineTo(v.newVec2(10, 20));
+	let str = (r: v.Range)=>`${r.begin.x},${r.begin.y},${r.end.x},${r.end.y}`;
+	let js: string, native: string;
+	try {
+		js = str(path.getBounds(v.parseMat(val)));
+	} catch(e) {
+		js = 'error';
+	}
+	try {
+		native = str(path.getBounds(val));
+	} catch(e) {
+		native = 'error';
+	}
+	let ok = js === native;
+	console.log('MatParity', typeof val == 'string' ? val: JSON.stringify(val), ':', ok ? 'ok': 'no', js);
+	if (!ok)
+		throw new Error('test fail');
+}
 
 export default async function(_: any) {
 	LOG('\nTEST Types:\n')
@@ -79,6 +102,13 @@ export default async function(_: any) {
 	Mv(v, 'parseRect', [`rect(0,0,1,1)`], e=>e.x==0&&e.y==0&&e.width==1&&e.height==1)
 	Mv(v, 'parseMat', ['mat(1,0,0,0,1,0)'],e=>e.toString()=='mat(1,0,0,0,1,0)')
 	Mv(v, 'parseMat4', ['mat4(1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1)'],e=>e.toString()=='mat4(1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1)')
+	MatParity('mat(2,0,1,0,2,1)')
+	MatParity(' mat( 2 , 0,1, 0,2,-1.5 ) ')
+	MatParity(2)
+	MatParity(new Float32Array([2,0,1,0,2,1]))
+	MatParity([2,0,1,0,2,1]) // plain arrays are rejected by both
+	MatParity('mat(2,0,1)')
+	MatParity('2 0 1 0 2 1')
 	Mv(v, 'parseColor', ['rgba(0,0,100,1)'],e=>e.toString()=='#000064');
 	Mv(v, 'parseShadow', ['10 10 5 #f00'],e=>e.toString()=='10 10 5 #ff0000')
 	Mv(v, 'parseBorder', [`1 #f00`], e=>e.toString()=='1 #ff0000')
@@ -140,7 +140,7 @@ class TestCanvas0: public Box {
 			PaintImage image;
 			image.filterMode = PaintImage::kLinear_FilterMode;
 			image.mipmapMode = PaintImage::kLinear_MipmapMode;
-			image.setImage(shared_imgPool()->load(fs_resources("jsapi/res/0.jpg")), {{180,150}, 200});
+			image.setImage(shared_imgPool()->load(fs_resources("jsapi/res/0.jpg")).get(), {{180,150}, 200});
 			paint.fill.image = &image;
 			canvas->drawPath(Path::MakeRRect({ {180,150}, 200 }, {50, 80, 50, 80}), paint);
 			paint.fill.image = nullptr;
@@ -0,0 +1,104 @@
+#include <inttypes.h>
+#include <src/ui/app.h>
+#include <src/ui/window.h>
+#include <src/ui/view/root.h>
+#include <src/ui/view/morph.h>
+#include <src/ui/view/text.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Test that drawing a steady frame allocates nothing after warming up.
+ *
+ * Only the allocations made through the qk Allocator are counted, that is the containers
+ * (Array, Path, VertexData ...) allocated while the counter is the current Allocator,
+ * the objects created with operator new and the direct calls to malloc are not counted.
+ */
+
+struct AllocCounter: Allocator {
+	AllocCounter()
+		: Allocator((void*(Allocator::*)(uint32_t))&AllocCounter::_malloc,
+				(void* (Allocator::*)(void*, uint32_t))&AllocCounter::_mrealloc,
+				(void (Allocator::*)(void*))&AllocCounter::_free)
+		, allocs(0) {}
+	void* _malloc(uint32_t size) {
+		allocs++;
+		return ::malloc(size);
+	}
+	void* _mrealloc(void* ptr, uint32_t size) {
+		allocs++;
+		return ::realloc(ptr, size);
+	}
+	void _free(void* ptr) {
+		::free(ptr);
+	}
+	uint64_t allocs;
+};
+
+// Draw the subtree through Painter and the canvas of the window under the counting allocator,
+// and draw again in every frame, the frames after warming up must not allocate through it.
+class FrameAllocsBox: public Box {
+public:
+	static constexpr uint32_t kWarmupFrames = 30;
+
+	void draw(Painter *painter) override {
+		{
+			AllocatorScope scope(&counter);
+			auto allocs = counter.allocs;
+			Box::draw(painter);
+			if (frames >= kWarmupFrames)
+				steadyAllocs += counter.allocs - allocs;
+		}
+		frames++;
+		mark_rerender(); // draw the same content again in the next frame
+	}
+	AllocCounter counter;
+	std::atomic<uint32_t> frames{0};
+	std::atomic<uint64_t> steadyAllocs{0};
+};
+
+static void build_frame_views(FrameAllocsBox *box) {
+	box->set_width({ 0, BoxSizeKind::Match });
+	box->set_height({ 0, BoxSizeKind::Match });
+	box->set_clip(true); // the z_index views below are drawn with the delay commands
+
+	for (int i = 0; i < 6; i++) {
+		auto v = box->append_new<Box>();
+		v->set_width({ 80 });
+		v->set_height({ 60 });
+		v->set_margin({ 10 });
+		v->set_background_color(Color(40 * i, 128, 255 - 40 * i));
+		v->set_border_radius({ float(i * 4) });
+		v->set_border({ {float(i % 3), Color(0,0,0)} });
+		v->set_z_index(i % 2 ? i: 0);
+	}
+	auto m = box->append_new<Morph>();
+	m->set_width({ 120 });
+	m->set_height({ 120 });
+	m->set_rotate_z(30);
+	m->set_clip(true);
+	m->set_background_color(Color(255,0,0));
+	auto t = m->append_new<Text>();
+	t->set_value("Quark frame allocs 0123456789");
+	t->set_text_color({ Color(255,255,255) });
+}
+
+Qk_TEST_Func(render_frame_allocs) {
+	App app;
+	auto win = Window::Make({.frame={{0,0}, {500,500}}, .title="Test Frame Allocs"});
+	win->activate();
+	auto box = win->root()->append_new<FrameAllocsBox>();
+	build_frame_views(box);
+
+	app.loop()->timer(Cb([win, box](auto e) {
+		uint32_t frames = box->frames;
+		uint64_t allocs = box->steadyAllocs;
+		Qk_Log("render_frame_allocs, frames: %u, allocs after warming up: %" PRIu64, frames, allocs);
+		Qk_TEST_EXPECT(frames > FrameAllocsBox::kWarmupFrames);
+		Qk_TEST_EQ(allocs, 0);
+		win->close();
+	}), 3000);
+
+	app.run();
+}
@@ -0,0 +1,151 @@
+#include <src/ui/app.h>
+#include <src/ui/window.h>
+#include <src/ui/event.h>
+#include <src/ui/view/root.h>
+#include <src/ui/view/morph.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Compare the pointer hit tests answered from the grid of EventDispatch with
+ * the recursive walk over the whole view tree that it replaced.
+ */
+
+// The reference, the topmost view in draw order that receives the point
+static View* find_receive_view_linear(View* view, Vec2 pos) {
+	if (!view->visible() || !view->visible_area())
+		return nullptr;
+	bool clip = view->is_clip();
+	if (clip && !view->overlap_test(pos))
+		return nullptr;
+	for (auto v = view->last_rt(); v; v = v->prev_rt()) {
+		auto r = find_receive_view_linear(v, pos);
+		if (r)
+			return r;
+	}
+	if (view->receive() && (clip || view->overlap_test(pos)))
+		return view;
+	return nullptr;
+}
+
+static Box* new_box(View* parent, float w, float h, Color color) {
+	auto box = parent->append_new<Box>();
+	box->set_width({w});
+	box->set_height({h});
+	box->set_background_color(color);
+	box->set_receive(true);
+	return box;
+}
+
+static Morph* new_morph(View* parent, float w, float h, Color color) {
+	auto morph = parent->append_new<Morph>();
+	morph->set_width({w});
+	morph->set_height({h});
+	morph->set_background_color(color);
+	morph->set_receive(true);
+	return morph;
+}
+
+static Morph* build_hit_grid_views(Root* r) {
+	r->set_receive(true);
+
+	// covers far more than 64 cells, kept out of the grid and always tested
+	auto large = new_morph(r, 300, 300, Color(200,200,200));
+	large->set_scale({6});
+
+	// overlapping siblings, the later one is drawn above
+	auto a = new_box(r, 300, 200, Color(255,0,0));
+	a->set_margin_left(40);
+	a->set_margin_top(40);
+	auto a1 = new_box(a, 120, 120, Color(255,128,0));
+	a1->set_margin_left(100);
+	auto b = new_morph(r, 200, 200, Color(0,255,0));
+	b->set_translate({150, -120});
+	b->set_rotate_z(30);
+
+	// the children outside of the clipping box are not hit
+	auto c = new_box(r, 200, 160, Color(0,0,255));
+	c->set_clip(true);
+	c->set_margin_left(420);
+	auto c1 = new_morph(c, 400, 60, Color(0,255,255));
+	c1->set_translate({-100, 50});
+	c1->set_rotate_z(-15);
+
+	// nested transforms spanning several cells
+	auto d = new_morph(r, 260, 140, Color(255,0,255));
+	d->set_translate({100, 20});
+	d->set_rotate_z(45);
+	d->set_skew({0.2, 0});
+	auto d1 = new_morph(d, 100, 100, Color(128,0,255));
+	d1->set_scale({1.5, 0.5});
+	d1->set_rotate_z(-60);
+	auto d2 = new_box(d, 80, 80, Color(0,128,255));
+	d2->set_receive(false); // does not receive, the views below are hit
+
+	return b;
+}
+
+// Returns true if the view is in the branch of `branch`
+static bool is_in_branch(View* view, View* branch) {
+	for (; view; view = view->parent_rt())
+		if (view == branch)
+			return true;
+	return false;
+}
+
+// `removed` is a branch detached from the tree, it is never hit
+static void test_hit_grid_views(Window* win, View* removed = nullptr) {
+	UILock lock(win);
+	auto root = win->root();
+	auto dispatch = win->dispatch();
+	auto size = win->size();
+	uint32_t count = 0, miss = 0, hits = 0;
+
+	for (float y = -20; y < size.y() + 20; y += 7) {
+		for (float x = -20; x < size.x() + 20; x += 7) {
+			Vec2 pos(x, y);
+			auto r0 = find_receive_view_linear(root, pos);
+			auto r1 = dispatch->find_receive_view(root, pos);
+			if (r0 != r1 || (removed && is_in_branch(r1, removed))) {
+				if (miss++ < 10)
+					Qk_Log("hit grid mismatch at %f, %f, linear: %p, grid: %p", x, y, r0, r1);
+			}
+			if (r0 && r0 != root)
+				hits++;
+			count++;
+		}
+	}
+	Qk_Log("hit grid, points: %d, hits: %d, mismatches: %d", count, hits, miss);
+	Qk_TEST_EXPECT(hits > 0);
+	Qk_TEST_EQ(miss, 0);
+}
+
+Qk_TEST_Func(hit_grid) {
+	App app;
+	auto win = Window::Make({.frame={{0,0}, {700,700}}, .title="Test Hit Grid"});
+	win->activate();
+	auto b = build_hit_grid_views(win->root());
+
+	// test after the views are laid out and drawn
+	app.loop()->timer(Cb([win,b](auto e) {
+		test_hit_grid_views(win);
+		// move the view and test again, the grid is updated incrementally
+		b->set_translate({-100, 300});
+		b->set_rotate_z(75);
+		shared_app()->loop()->timer(Cb([win](auto e) {
+			test_hit_grid_views(win);
+			// remove the nested transforms, the detached branch leaves the grid
+			auto d = win->root()->last();
+			d->retain(); // keep it alive to compare the results
+			d->remove();
+			shared_app()->loop()->timer(Cb([win,d](auto e) {
+				test_hit_grid_views(win, d);
+				d->release();
+				win->close();
+			}), 500);
+		}), 500);
+	}), 1000);
+
+	app.run();
+}
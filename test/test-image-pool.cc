@@ -0,0 +1,87 @@
+#include <src/util/fs.h>
+#include <src/render/source.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Test the memory budget of ImageSourcePool, the eviction of the sources
+ * that are not held by anyone, `clear(false)` and reloading after evicted.
+ */
+
+static const char* pool_uris[] = {
+	"jsapi/res/0.jpg", "jsapi/res/1.jpg", "jsapi/res/cc.jpg", "jsapi/res/aa.jpg", "jsapi/res/0.png",
+};
+static constexpr int pool_uris_len = sizeof(pool_uris) / sizeof(pool_uris[0]);
+
+// run the loop until all the sources are loaded or fail, at most 10 seconds
+static void wait_loaded(RunLoop *loop, Array<Sp<ImageSource>> &sources) {
+	int64_t timeout = time_millisecond() + 10000;
+	uint32_t id = loop->timer(Cb([&](auto e) {
+		for (auto &s: sources) {
+			auto done = s->state() & (ImageSource::kSTATE_LOAD_COMPLETE |
+				ImageSource::kSTATE_LOAD_ERROR | ImageSource::kSTATE_DECODE_ERROR);
+			if (!done && time_millisecond() < timeout)
+				return;
+		}
+		loop->stop();
+	}), 20, -1);
+	loop->run();
+	loop->timer_stop(id);
+}
+
+Qk_TEST_Func(image_pool) {
+	auto loop = RunLoop::current();
+	auto pool = new ImageSourcePool(loop);
+	pool->set_maxCapacity(0); // unlimited while loading
+
+	Array<Sp<ImageSource>> sources;
+	for (auto uri: pool_uris) {
+		sources.push(pool->load(fs_resources(uri)));
+	}
+	wait_loaded(loop, sources);
+
+	uint32_t total = 0;
+	for (auto &s: sources) {
+		Qk_TEST_EXPECT(s->isLoaded());
+		total += s->info().bytes();
+	}
+	Qk_TEST_EQ(pool->count(), pool_uris_len);
+	Qk_TEST_EQ(pool->capacity(), total);
+	Qk_TEST_EQ(pool->misses(), pool_uris_len);
+
+	// only hold the first one, the others can be evicted
+	Sp<ImageSource> held = sources[0];
+	uint32_t heldBytes = held->info().bytes();
+	sources.clear();
+
+	// clear(false) without a budget trims to half of the used memory
+	pool->clear(false);
+	Qk_TEST_EXPECT(pool->evictions() > 0);
+	Qk_TEST_EXPECT(pool->capacity() <= Qk_Max(total >> 1, heldBytes));
+	Qk_TEST_EXPECT(pool->get(fs_resources(pool_uris[0])).get() == held.get()); // the held source is never evicted
+
+	// the budget evicts all the sources that are not held
+	pool->set_maxCapacity(heldBytes);
+	Qk_TEST_EQ(pool->count(), 1);
+	Qk_TEST_EQ(pool->capacity(), heldBytes);
+	Qk_TEST_EQ(pool->evictions(), pool_uris_len - 1);
+	Qk_TEST_EXPECT(held->isLoaded());
+
+	// the evicted source is created and loaded again
+	pool->set_maxCapacity(0);
+	auto misses = pool->misses();
+	sources.push(pool->load(fs_resources(pool_uris[1])));
+	Qk_TEST_EQ(pool->misses(), misses + 1);
+	Qk_TEST_EQ(pool->count(), 2);
+	wait_loaded(loop, sources);
+	Qk_TEST_EXPECT(sources[0]->isLoaded());
+	Qk_TEST_EQ(pool->capacity(), heldBytes + sources[0]->info().bytes());
+
+	Qk_Log("image pool, hits: %d, misses: %d, evictions: %d",
+		pool->hits(), pool->misses(), pool->evictions());
+
+	held = nullptr;
+	sources.clear();
+	Release(pool);
+}
@@ -0,0 +1,55 @@
+#include <src/util/fs.h>
+#include <src/render/codec/codec.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Test ImageProgressiveDecoder with the truncated data, like the prefixes of
+ * the image data received over a slow network.
+ */
+
+static void test_progressive(cString& name, Vec2 size) {
+	Buffer data = fs_read_file_sync(fs_resources(name));
+	Array<Pixel> full;
+	Qk_TEST_EXPECT(img_decode(data, &full, kUnknown_ImageFormat, size));
+
+	ImageProgressiveDecoder decoder(size);
+	Array<Pixel> out;
+	// too short to detect the format
+	Qk_TEST_EXPECT(!decoder.decode(data.copy(0, 10), &out));
+	Qk_TEST_EXPECT(decoder.isSupported());
+
+	// the prefixes that grow as the data arrives
+	uint32_t outputs = 0;
+	for (uint32_t len: {data.length() >> 3, data.length() >> 2, data.length() >> 1, data.length() - 1}) {
+		Array<Pixel> pixels;
+		if (decoder.decode(data.copy(0, len), &pixels)) {
+			Qk_TEST_EQ(pixels[0].width(), full[0].width());
+			Qk_TEST_EQ(pixels[0].height(), full[0].height());
+			Qk_TEST_EXPECT(pixels[0].length() >= pixels[0].rowbytes() * pixels[0].height());
+			outputs++;
+		}
+	}
+	Qk_Log("progressive %s, size: %f, %f, outputs: %d", name.c_str(), size[0], size[1], outputs);
+	Qk_TEST_EXPECT(outputs > 0);
+
+	// the whole data
+	Qk_TEST_EXPECT(decoder.decode(data, &out));
+	Qk_TEST_EQ(out[0].width(), full[0].width());
+	Qk_TEST_EQ(out[0].height(), full[0].height());
+}
+
+Qk_TEST_Func(img_progressive) {
+	for (auto name: {"jsapi/res/0.jpg", "jsapi/res/0.png", "jsapi/res/0.webp"}) {
+		test_progressive(name, Vec2());
+		test_progressive(name, Vec2(64, 0)); // decode to the size hint
+	}
+
+	// not supported format waits for the full data
+	ImageProgressiveDecoder decoder;
+	Array<Pixel> out;
+	Buffer data = fs_read_file_sync(fs_resources("jsapi/res/0.gif"));
+	Qk_TEST_EXPECT(!decoder.decode(data.copy(0, data.length() >> 1), &out));
+	Qk_TEST_EXPECT(!decoder.isSupported());
+}
@@ -0,0 +1,132 @@
+#include <src/render/codec/codec.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Test the downscaling for decoding to the size hint, the levels to halve,
+ * the output dimensions of odd sizes and the values of the 2x2 box filter.
+ */
+
+static Pixel new_pixel(int w, int h, ColorType type, uint32_t channels, uint32_t seed) {
+	auto buff = Buffer::alloc(w * h * channels);
+	auto val = (uint8_t*)buff.val();
+	for (uint32_t i = 0; i < buff.length(); i++)
+		val[i] = uint8_t((i * 37 + seed * 101 + (i >> 3) * 13) & 0xff);
+	return Pixel(PixelInfo(w, h, type, kUnpremul_AlphaType), buff);
+}
+
+// The reference, halve one time with the last column and row repeated for odd sizes
+static Array<uint8_t> halve_reference(const uint8_t *in, uint32_t w, uint32_t h, uint32_t channels) {
+	uint32_t ow = (w + 1) >> 1, oh = (h + 1) >> 1;
+	Array<uint8_t> out(ow * oh * channels);
+	for (uint32_t y = 0; y < oh; y++) {
+		uint32_t y0 = y * 2, y1 = Qk_Min(y0 + 1, h - 1);
+		for (uint32_t x = 0; x < ow; x++) {
+			uint32_t x0 = x * 2, x1 = Qk_Min(x0 + 1, w - 1);
+			for (uint32_t k = 0; k < channels; k++) {
+				uint32_t sum = in[(y0 * w + x0) * channels + k] + in[(y0 * w + x1) * channels + k] +
+					in[(y1 * w + x0) * channels + k] + in[(y1 * w + x1) * channels + k];
+				out[(y * ow + x) * channels + k] = uint8_t((sum + 2) >> 2);
+			}
+		}
+	}
+	return out;
+}
+
+static void test_row_scaler(uint32_t w, uint32_t h, uint32_t channels, uint32_t levels) {
+	auto pix = new_pixel(w, h, kRGBA_8888_ColorType, channels, w + h + levels);
+	uint32_t ow = ImageRowScaler::size(w, levels);
+	uint32_t oh = ImageRowScaler::size(h, levels);
+	Array<uint8_t> out(ow * oh * channels);
+
+	ImageRowScaler scaler(w, channels, levels, out.val());
+	for (uint32_t y = 0; y < h; y++)
+		scaler.push(pix.val() + y * w * channels);
+	scaler.flush();
+
+	Array<uint8_t> ref(w * h * channels);
+	memcpy(ref.val(), pix.val(), ref.length());
+	uint32_t rw = w, rh = h;
+	for (uint32_t i = 0; i < levels; i++) {
+		ref = halve_reference(ref.val(), rw, rh, channels);
+		rw = (rw + 1) >> 1;
+		rh = (rh + 1) >> 1;
+	}
+	Qk_TEST_EQ(rw, ow);
+	Qk_TEST_EQ(rh, oh);
+	uint32_t diff = 0;
+	for (uint32_t i = 0; i < out.length(); i++) {
+		if (out[i] != ref[i])
+			diff++;
+	}
+	Qk_TEST_EQ(diff, 0);
+}
+
+Qk_TEST_Func(img_scale) {
+	// levels, as many times as the halved size still covers the size hint
+	Qk_TEST_EQ(img_scale_levels(1024, 768, Vec2(256, 0)), 2);
+	Qk_TEST_EQ(img_scale_levels(1024, 768, Vec2(0, 100)), 2);
+	Qk_TEST_EQ(img_scale_levels(1000, 1000, Vec2(300, 300)), 1);
+	Qk_TEST_EQ(img_scale_levels(1000, 1000, Vec2(250, 250)), 2);
+	Qk_TEST_EQ(img_scale_levels(1000, 1000, Vec2(250.5, 250)), 1);
+	Qk_TEST_EQ(img_scale_levels(100, 100, Vec2(200, 200)), 0);
+	Qk_TEST_EQ(img_scale_levels(1024, 768, Vec2()), 0);
+	Qk_TEST_EQ(img_scale_levels(4096, 4096, Vec2(1, 1)), 12);
+
+	// output size of odd input
+	Qk_TEST_EQ(ImageRowScaler::size(5, 1), 3);
+	Qk_TEST_EQ(ImageRowScaler::size(5, 2), 2);
+	Qk_TEST_EQ(ImageRowScaler::size(1, 3), 1);
+	Qk_TEST_EQ(ImageRowScaler::size(1000, 3), 125);
+	Qk_TEST_EQ(ImageRowScaler::size(1001, 3), 126);
+
+	// box filter values, rounded to nearest, the last column and row repeated
+	{
+		uint8_t data[] = {
+			0,   4,   8,
+			100, 200, 9,
+			255, 1,   20,
+		};
+		Array<uint8_t> out(4);
+		ImageRowScaler scaler(3, 1, 1, out.val());
+		scaler.push(data);
+		scaler.push(data + 3);
+		scaler.push(data + 6);
+		scaler.flush();
+		Qk_TEST_EQ(out[0], 76);  // (0 + 4 + 100 + 200 + 2) >> 2
+		Qk_TEST_EQ(out[1], 9);   // (8 + 8 + 9 + 9 + 2) >> 2
+		Qk_TEST_EQ(out[2], 128); // (255 + 1 + 255 + 1 + 2) >> 2
+		Qk_TEST_EQ(out[3], 20);  // (20 + 20 + 20 + 20 + 2) >> 2
+	}
+
+	// compare with the reference, the widths of 16 pixels and more use the SIMD path
+	test_row_scaler(2, 2, 4, 1);
+	test_row_scaler(37, 23, 4, 3);
+	test_row_scaler(64, 64, 4, 2);
+	test_row_scaler(67, 9, 1, 2);
+	test_row_scaler(33, 17, 3, 1);
+	test_row_scaler(21, 40, 2, 4);
+	test_row_scaler(1, 5, 4, 3);
+
+	// scale down pixel
+	{
+		auto pix = new_pixel(101, 53, kRGBA_8888_ColorType, 4, 1);
+		Pixel out;
+		Qk_TEST_EXPECT(img_scale_down(pix, &out, Vec2(25, 0)));
+		Qk_TEST_EQ(out.width(), 26);
+		Qk_TEST_EQ(out.height(), 14);
+		Qk_TEST_EQ(out.type(), kRGBA_8888_ColorType);
+		Qk_TEST_EQ(out.alphaType(), kUnpremul_AlphaType);
+		Qk_TEST_EXPECT(out.width() >= 25);
+
+		auto ref = halve_reference(pix.val(), 101, 53, 4);
+		ref = halve_reference(ref.val(), 51, 27, 4);
+		Qk_TEST_EQ(memcmp(out.val(), ref.val(), ref.length()), 0);
+
+		// not smaller than the size hint, or not supported type
+		Qk_TEST_EXPECT(!img_scale_down(pix, &out, Vec2(60, 30)));
+		auto pix565 = new_pixel(64, 64, kRGB_565_ColorType, 2, 2);
+		Qk_TEST_EXPECT(!img_scale_down(pix565, &out, Vec2(16, 16)));
+	}
+}
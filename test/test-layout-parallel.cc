@@ -0,0 +1,85 @@
+#include <src/ui/app.h>
+#include <src/ui/window.h>
+#include <src/ui/view/root.h>
+#include <src/ui/view/box.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Lay out the same wide view tree in a window with parallel layout and in a window
+ * with serial layout, the offsets and sizes of all the views are the same.
+ */
+
+// Every row has many children that wrap their own children, so the levels below the
+// rows have far more than 64 marked views in many groups that typeset in parallel
+static void build_layout_views(Window *win, bool parallel) {
+	win->set_parallelLayout(parallel);
+	auto root = win->root();
+	for (int i = 0; i < 16; i++) {
+		auto row = root->append_new<Box>();
+		row->set_width({780});
+		row->set_padding_left(i % 3);
+		for (int j = 0; j < 12; j++) {
+			auto cell = row->append_new<Box>(); // wraps the children
+			cell->set_margin_left(j % 4);
+			cell->set_padding_top(1 + j % 2);
+			for (int k = 0; k < 3; k++) {
+				auto item = cell->append_new<Box>();
+				item->set_width({float(4 + (i * 7 + j * 3 + k) % 11)});
+				item->set_height({float(2 + (i + j * 5 + k * 3) % 7)});
+				item->set_margin_top(k);
+			}
+		}
+	}
+}
+
+// Compare the views of the two trees in the same order
+static void compare_layout_views(View *a, View *b, uint32_t &count, uint32_t &diff) {
+	auto oa = a->layout_offset(), ob = b->layout_offset();
+	auto sa = a->layout_size(), sb = b->layout_size();
+	if (oa != ob || sa != sb) {
+		if (diff++ < 10)
+			Qk_Log("view %d, serial: %f, %f, %f, %f, parallel: %f, %f, %f, %f", count,
+				oa.x(), oa.y(), sa.x(), sa.y(), ob.x(), ob.y(), sb.x(), sb.y());
+	}
+	count++;
+	auto va = a->first_rt(), vb = b->first_rt();
+	while (va && vb) {
+		compare_layout_views(va, vb, count, diff);
+		va = va->next_rt();
+		vb = vb->next_rt();
+	}
+	if (va || vb)
+		diff++; // not the same tree
+}
+
+Qk_TEST_Func(layout_parallel) {
+	App app;
+	auto serial = Window::Make({.frame={{0,0}, {800,600}}, .title="Test Layout Serial"});
+	auto parallel = Window::Make({.frame={{0,0}, {800,600}}, .title="Test Layout Parallel"});
+	serial->activate();
+	parallel->activate();
+	build_layout_views(serial, false);
+	build_layout_views(parallel, true);
+
+	// compare after both windows are laid out
+	app.loop()->timer(Cb([serial,parallel](auto e) {
+		uint32_t count = 0, diff = 0;
+		float height;
+		{
+			UILock lock0(serial);
+			UILock lock1(parallel);
+			compare_layout_views(serial->root(), parallel->root(), count, diff);
+			height = parallel->root()->first_rt()->layout_size().y();
+		}
+		Qk_Log("layout parallel, views: %d, mismatches: %d", count, diff);
+		Qk_TEST_EXPECT(count > 16 * 12 * 4);
+		Qk_TEST_EXPECT(height > 0);
+		Qk_TEST_EQ(diff, 0);
+		serial->close();
+		parallel->close();
+	}), 1000);
+
+	app.run();
+}
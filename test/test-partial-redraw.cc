@@ -0,0 +1,94 @@
+#include <src/ui/app.h>
+#include <src/ui/window.h>
+#include <src/ui/view/root.h>
+#include <src/ui/view/box.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Test the damage region that the partial redraw of Window hands to the painter,
+ * read back from the frames of the profiler, and the cases that redraw the whole window.
+ */
+
+// the damage region of the last drawn frame
+static Range last_damage(Window *win) {
+	auto frames = win->profiler().frames();
+	Qk_TEST_EXPECT(frames.length() > 0);
+	return frames.length() ? frames.back().damage: Range();
+}
+
+static void set_color(Window *win, Box *box, Color color) {
+	UILock lock(win);
+	box->set_background_color(color);
+}
+
+// run `cb` after the frames of the last change are drawn
+static void next_step(Cb cb) {
+	shared_app()->loop()->timer(cb, 300);
+}
+
+Qk_TEST_Func(partial_redraw) {
+	App app;
+	auto win = Window::Make({.frame={{0,0}, {400,300}}, .title="Test Partial Redraw"});
+	win->profiler().set_enabled(true); // record the first frame
+	win->set_partialRedraw(true);
+	auto box = win->root()->append_new<Box>();
+	box->set_margin_left(100);
+	box->set_margin_top(50);
+	box->set_width({60});
+	box->set_height({40});
+	box->set_background_color(Color(255,0,0));
+	win->activate();
+
+	app.loop()->timer(Cb([win,box](auto e) {
+		// the first frame lays out the views, it redraws the whole window
+		auto frames = win->profiler().frames();
+		Qk_TEST_EXPECT(frames.length() > 0);
+		Qk_TEST_EXPECT(frames.length() && frames[0].damage.isEmpty());
+
+		// only the region of the box is redrawn, expanded by 2 for the anti-aliasing edges
+		set_color(win, box, Color(0,255,0));
+
+		next_step(Cb([win,box](auto e) {
+			auto damage = last_damage(win);
+			Qk_Log("partial redraw, damage: %f, %f, %f, %f",
+				damage.begin.x(), damage.begin.y(), damage.end.x(), damage.end.y());
+			Qk_TEST_EQ(damage.begin, Vec2(98, 48));
+			Qk_TEST_EQ(damage.end, Vec2(162, 92));
+
+			// the fps text of debug mode is out of the damage region, it redraws the whole window
+			{
+				UILock lock(win);
+				win->set_debugMode(true);
+				box->set_background_color(Color(0,0,255));
+			}
+			next_step(Cb([win,box](auto e) {
+				Qk_TEST_EXPECT(last_damage(win).isEmpty());
+
+				// a dropped frame redraws the whole window in the next frame
+				{
+					UILock lock(win);
+					win->set_debugMode(false);
+					win->dropFrame();
+					box->set_background_color(Color(255,0,255));
+				}
+				next_step(Cb([win,box](auto e) {
+					Qk_TEST_EXPECT(last_damage(win).isEmpty());
+
+					// back to the partial redraw
+					set_color(win, box, Color(255,255,0));
+
+					next_step(Cb([win](auto e) {
+						auto damage = last_damage(win);
+						Qk_TEST_EQ(damage.begin, Vec2(98, 48));
+						Qk_TEST_EQ(damage.end, Vec2(162, 92));
+						win->close();
+					}));
+				}));
+			}));
+		}));
+	}), 1000);
+
+	app.run();
+}
@@ -0,0 +1,308 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include <inttypes.h>
+#include <src/render/path.h>
+#include <src/render/pathv_cache.h>
+#include <src/render/sdf.h>
+#include <src/util/fs.h>
+#include "./test.h"
+
+using namespace qk;
+
+namespace qk {
+	void clear_PathvCache(PathvCache *cache, int flags);
+}
+
+/**
+ * Headless benchmarks for the CPU half of the render pipeline.
+ *
+ * Every case runs over a fixed corpus of UI shapes and SVG icon paths and prints one
+ * JSON object per line. With `test1 render_bench <file>` the results are also written
+ * to <file> as a JSON array, so CI machines without a GPU can track regressions.
+ *
+ * allocsPerOp/bytesPerOp count the container allocations (Array, Path, VertexData)
+ * made through the current Allocator while an op runs.
+ */
+
+struct CountingAllocator: Allocator {
+	CountingAllocator()
+		: Allocator((void*(Allocator::*)(uint32_t))&CountingAllocator::_malloc,
+				(void* (Allocator::*)(void*, uint32_t))&CountingAllocator::_mrealloc,
+				(void (Allocator::*)(void*))&CountingAllocator::_free)
+		, allocs(0), bytes(0) {}
+	void* _malloc(uint32_t size) {
+		allocs++, bytes += size;
+		return ::malloc(size);
+	}
+	void* _mrealloc(void* ptr, uint32_t size) {
+		allocs++, bytes += size;
+		return ::realloc(ptr, size);
+	}
+	void _free(void* ptr) {
+		::free(ptr);
+	}
+	uint64_t allocs, bytes;
+};
+
+// Material Design icons, 24x24 viewBox
+static cChar* kSvgIcons[] = {
+	// favorite
+	"M12 21.35l-1.45-1.32C5.4 15.36 2 12.28 2 8.5 2 5.42 4.42 3 7.5 3c1.74 0 3.41.81 4.5 2.09"
+	"C13.09 3.81 14.76 3 16.5 3 19.58 3 22 5.42 22 8.5c0 3.78-3.4 6.86-8.55 11.54L12 21.35z",
+	// search
+	"M15.5 14h-.79l-.28-.27C15.41 12.59 16 11.11 16 9.5 16 5.91 13.09 3 9.5 3S3 5.91 3 9.5 5.91 16 9.5 16"
+	"c1.61 0 3.09-.59 4.23-1.57l.27.28v.79l5 4.99L20.49 19l-4.99-5zm-6 0C7.01 14 5 11.99 5 9.5S7.01 5 9.5 5 "
+	"14 7.01 14 9.5 11.99 14 9.5 14z",
+	// star
+	"M12 17.27L18.18 21l-1.64-7.03L22 9.24l-7.19-.61L12 2 9.19 8.63 2 9.24l5.46 4.73L5.82 21z",
+	// home
+	"M10 20v-6h4v6h5v-8h3L12 3 2 12h3v8z",
+	// check
+	"M9 16.17L4.83 12l-1.42 1.41L9 19 21 7l-1.41-1.41z",
+	// settings
+	"M19.14 12.94c.04-.3.06-.61.06-.94 0-.32-.02-.64-.07-.94l2.03-1.58c.18-.14.23-.41.12-.61l-1.92-3.32"
+	"c-.12-.22-.37-.29-.59-.22l-2.39.96c-.5-.38-1.03-.7-1.62-.94l-.36-2.54c-.04-.24-.24-.41-.48-.41h-3.84"
+	"c-.24 0-.43.17-.47.41l-.36 2.54c-.59.24-1.13.57-1.62.94l-2.39-.96c-.22-.08-.47 0-.59.22L2.74 8.87"
+	"c-.12.21-.08.47.12.61l2.03 1.58c-.05.3-.09.63-.09.94s.02.64.07.94l-2.03 1.58c-.18.14-.23.41-.12.61"
+	"l1.92 3.32c.12.22.37.29.59.22l2.39-.96c.5.38 1.03.7 1.62.94l.36 2.54c.05.24.24.41.48.41h3.84"
+	"c.24 0 .44-.17.47-.41l.36-2.54c.59-.24 1.13-.56 1.62-.94l2.39.96c.22.08.47 0 .59-.22l1.92-3.32"
+	"c.12-.22.07-.47-.12-.61l-2.01-1.58zM12 15.6c-1.98 0-3.6-1.62-3.6-3.6s1.62-3.6 3.6-3.6 3.6 1.62 3.6 3.6"
+	"-1.62 3.6-3.6 3.6z",
+};
+
+// Parse SVG path data, supports the M/L/H/V/C/S/Q/Z commands
+static Path parseSvgPath(cChar* d, float scale) {
+	Path path;
+	Vec2 cur, start, lastCtrl;
+	char cmd = 0, lastCmd = 0;
+	auto skip = [&]() {
+		while (*d == ' ' || *d == ',' || *d == '\n') d++;
+	};
+	auto num = [&]() {
+		skip();
+		char *end;
+		float v = strtof(d, &end);
+		d = end;
+		return v;
+	};
+	auto pt = [&](bool rel) {
+		float x = num(), y = num();
+		return rel ? cur + Vec2(x, y): Vec2(x, y);
+	};
+	for (skip(); *d; skip()) {
+		if (isalpha(*d))
+			cmd = *d++;
+		else if (cmd == 'M')
+			cmd = 'L'; // implicit lineto after moveto
+		else if (cmd == 'm')
+			cmd = 'l';
+		bool rel = islower(cmd);
+		switch (toupper(cmd)) {
+			case 'M': cur = start = pt(rel); path.moveTo(cur * scale); break;
+			case 'L': cur = pt(rel); path.lineTo(cur * scale); break;
+			case 'H': cur = Vec2(num() + (rel ? cur.x(): 0), cur.y()); path.lineTo(cur * scale); break;
+			case 'V': cur = Vec2(cur.x(), num() + (rel ? cur.y(): 0)); path.lineTo(cur * scale); break;
+			case 'C': {
+				auto c1 = pt(rel), c2 = pt(rel), to = pt(rel);
+				path.cubicTo(c1 * scale, c2 * scale, to * scale);
+				lastCtrl = c2, cur = to;
+				break;
+			}
+			case 'S': {
+				auto c1 = (toupper(lastCmd) == 'C' || toupper(lastCmd) == 'S') ? cur * 2 - lastCtrl: cur;
+				auto c2 = pt(rel), to = pt(rel);
+				path.cubicTo(c1 * scale, c2 * scale, to * scale);
+				lastCtrl = c2, cur = to;
+				break;
+			}
+			case 'Q': {
+				auto c = pt(rel), to = pt(rel);
+				path.quadTo(c * scale, to * scale);
+				lastCtrl = c, cur = to;
+				break;
+			}
+			case 'Z': path.close(); cur = start; break;
+			default: return path; // unsupported command
+		}
+		lastCmd = cmd;
+	}
+	return path;
+}
+
+static Array<Path> makeCorpus() {
+	Array<Path> corpus;
+	// UI shapes
+	corpus.push(Path::MakeRect({{0,0},{320,48}}));
+	corpus.push(Path::MakeRRect({{0,0},{120,40}}, {8,8,8,8})); // button
+	corpus.push(Path::MakeRRect({{0,0},{200,40}}, {20,20,20,20})); // pill
+	corpus.push(Path::MakeRRect({{0,0},{360,240}}, {{16},{16},{0},{0}})); // card
+	corpus.push(Path::MakeCircle({24,24}, 24)); // avatar
+	corpus.push(Path::MakeOval({{0,0},{300,120}}));
+	corpus.push(Path::MakeArc({{0,0},{64,64}}, 0, Qk_PI * 1.5f, false, false)); // spinner
+	corpus.push(Path::MakeRRectOutline({{0,0},{200,60}}, {{2,2},{196,56}}, {10,10,10,10}));
+	// SVG icons at 8x (192px)
+	for (auto d: kSvgIcons)
+		corpus.push(parseSvgPath(d, 8));
+	return corpus;
+}
+
+struct BenchResult {
+	String name;
+	uint64_t ops, allocs, bytes;
+	int64_t timeUs;
+	String toJSON() const {
+		double ns = timeUs * 1e3 / ops;
+		return String::format(
+			"{\"bench\":\"%s\",\"ops\":%" PRIu64 ",\"nsPerOp\":%.1f,\"opsPerSec\":%.1f,"
+			"\"allocsPerOp\":%.2f,\"bytesPerOp\":%.1f}",
+			name.c_str(), ops, ns, 1e9 / ns, double(allocs) / ops, double(bytes) / ops
+		);
+	}
+};
+
+static uint64_t bench_sink = 0; // keep results alive
+
+// Run `op(i)` in batches for at least `minUs` microseconds
+template<class Op>
+static BenchResult runBench(cChar* name, uint32_t batch, Op op, int64_t minUs = 200000) {
+	CountingAllocator counter;
+	BenchResult r{name, 0, 0, 0, 0};
+	auto st = time_monotonic();
+	do {
+		AllocatorScope scope(&counter);
+		for (uint32_t i = 0; i < batch; i++)
+			op(i);
+		r.ops += batch;
+		r.timeUs = time_monotonic() - st;
+	} while (r.timeUs < minUs);
+	r.allocs = counter.allocs;
+	r.bytes = counter.bytes;
+	return r;
+}
+
+static Array<uint8_t> makeMask(int size) {
+	// anti-aliased ring, like a rasterized glyph or icon mask
+	Array<uint8_t> mask(size * size);
+	float c = size * 0.5f, r0 = size * 0.25f, r1 = size * 0.4f;
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			float d = Vec2(x + 0.5f - c, y + 0.5f - c).length();
+			float a = Qk_Min(Qk_Min(d - r0, r1 - d) + 0.5f, 1.0f);
+			mask[y * size + x] = a > 0 ? uint8_t(a * 255): 0;
+		}
+	}
+	return mask;
+}
+
+Qk_TEST_Func(render_bench) {
+	auto corpus = makeCorpus();
+	uint32_t n = corpus.length();
+	Array<Path> normalized;
+	for (auto &p: corpus)
+		normalized.push(Path(p).normalizedPath(1));
+
+	Array<BenchResult> results;
+
+	results.push(runBench("normalizedPath", n, [&](uint32_t i) {
+		bench_sink += Path(corpus[i]).normalizedPath(1).ptsLen();
+	}));
+
+	results.push(runBench("strokePath_miter", n, [&](uint32_t i) {
+		bench_sink += corpus[i].strokePath(2, Paint::kButt_Cap, Paint::kMiter_Join, 4).ptsLen();
+	}));
+
+	results.push(runBench("strokePath_round", n, [&](uint32_t i) {
+		bench_sink += corpus[i].strokePath(6, Paint::kRound_Cap, Paint::kRound_Join).ptsLen();
+	}));
+
+	results.push(runBench("getTriangles", n, [&](uint32_t i) {
+		bench_sink += normalized[i].getTriangles(1).vCount;
+	}));
+
+	results.push(runBench("getAASideTriangles", n, [&](uint32_t i) {
+		bench_sink += normalized[i].getAASideTriangles(0.5f).vCount;
+	}));
+
+	{ // cached lookups, as drawn by the canvas from the second frame on
+		auto cache = new PathvCache(0, nullptr);
+		for (auto &p: normalized)
+			cache->getPathTriangles(p);
+		results.push(runBench("PathvCache_getPathTriangles_hit", n, [&](uint32_t i) {
+			bench_sink += cache->getPathTriangles(normalized[i]).vCount;
+		}));
+		Qk_TEST_EXPECT(cache->hits() >= results.back().ops);
+		Release(cache);
+	}
+
+	for (int size: {64, 256}) {
+		auto mask = makeMask(size);
+		results.push(runBench(size == 64 ? "sdf_64": "sdf_256", 1, [&](uint32_t i) {
+			bench_sink += compute_distance_f32(mask.val(), size, size, 1, true).width();
+		}));
+	}
+
+	Array<String> json;
+	for (auto &r: results) {
+		Qk_TEST_EXPECT(r.ops > 0);
+		json.push(r.toJSON());
+		Qk_Log(json.back());
+	}
+	Qk_TEST_EXPECT(bench_sink > 0);
+
+	if (argc > 2) {
+		fs_write_file_sync(argv[2], String("[\n") + json.join(",\n") + "\n]\n");
+	}
+}
+
+// LRU eviction of memory warning, the entries of the current frame are kept
+Qk_TEST_Func(pathv_cache_lru) {
+	Array<Path> normalized;
+	for (auto &p: makeCorpus())
+		normalized.push(Path(p).normalizedPath(1));
+	auto cache = new PathvCache(0, nullptr);
+	for (auto &p: normalized)
+		cache->getPathTriangles(p);
+	Qk_TEST_EQ(cache->evictions(), 0);
+	clear_PathvCache(cache, 0); // next frame
+	cache->getPathTriangles(normalized[0]);
+	auto capacity = cache->capacity();
+	clear_PathvCache(cache, 1);
+	Qk_TEST_EXPECT(cache->evictions() > 0);
+	Qk_TEST_EXPECT(cache->capacity() < capacity);
+	auto hits = cache->hits();
+	cache->getPathTriangles(normalized[0]); // used in the current frame, still cached
+	Qk_TEST_EQ(cache->hits(), hits + 1);
+	auto misses = cache->misses();
+	for (uint32_t i = 1; i < normalized.length(); i++)
+		cache->getPathTriangles(normalized[i]); // the evicted entries are built again
+	Qk_TEST_EXPECT(cache->misses() > misses);
+	Release(cache);
+}
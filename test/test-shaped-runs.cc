@@ -0,0 +1,76 @@
+#include <src/util/fs.h>
+#include <src/util/codec.h>
+#include <src/render/font/pool.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Test the shaped runs cache of FontPool, the hits with the same families, style,
+ * font size and text, the eviction by the budget and the capacity accounting.
+ */
+
+static Array<FontGlyphs> shape(FontFamilies *ffs, cString& text, FontStyle style, float fontSize) {
+	return ffs->makeFontGlyphs(codec_decode_to_unicode(kUTF8_Encoding, text), style, fontSize);
+}
+
+static bool equals(cArray<FontGlyphs>& a, cArray<FontGlyphs>& b) {
+	if (a.length() != b.length())
+		return false;
+	for (uint32_t i = 0; i < a.length(); i++) {
+		if (a[i].typeface() != b[i].typeface() || a[i].length() != b[i].length())
+			return false;
+		if (memcmp(*a[i].glyphs(), *b[i].glyphs(), a[i].length() * sizeof(GlyphID)))
+			return false;
+	}
+	return true;
+}
+
+Qk_TEST_Func(shaped_runs) {
+	auto pool = shared_fontPool();
+	auto ffs = pool->defaultFontFamilies();
+	auto maxCapacity = pool->shapedRunsMaxCapacity();
+	FontStyle style, bold(FontWeight::Bold, FontWidth::Normal, FontSlant::Normal);
+
+	pool->set_shapedRunsMaxCapacity(0); // clear all
+	Qk_TEST_EQ(pool->shapedRunsCapacity(), 0);
+	pool->set_shapedRunsMaxCapacity(16 * 1024);
+
+	// hit, the capacity is unchanged and the same glyphs are returned
+	auto fg0 = shape(ffs, "Hello World! 你好，世界！", style, 16);
+	auto capacity = pool->shapedRunsCapacity();
+	Qk_TEST_EXPECT(capacity > 0);
+	auto fg1 = shape(ffs, "Hello World! 你好，世界！", style, 16);
+	Qk_TEST_EQ(pool->shapedRunsCapacity(), capacity);
+	Qk_TEST_EXPECT(equals(fg0, fg1));
+	Qk_TEST_EXPECT(fg1[0].advances().length() == fg1[0].length());
+
+	// the other font size or style is a separate run
+	shape(ffs, "Hello World! 你好，世界！", style, 17);
+	Qk_TEST_EXPECT(pool->shapedRunsCapacity() > capacity);
+	capacity = pool->shapedRunsCapacity();
+	shape(ffs, "Hello World! 你好，世界！", bold, 16);
+	Qk_TEST_EXPECT(pool->shapedRunsCapacity() > capacity);
+
+	// eviction, the capacity never exceeds the budget and the least recently used are evicted
+	for (int i = 0; i < 500; i++) {
+		shape(ffs, String::format("shaped run %d", i), style, 16);
+		Qk_TEST_EXPECT(pool->shapedRunsCapacity() <= pool->shapedRunsMaxCapacity());
+	}
+	capacity = pool->shapedRunsCapacity();
+	shape(ffs, "shaped run 499", style, 16); // the most recently used, hit
+	Qk_TEST_EQ(pool->shapedRunsCapacity(), capacity);
+	shape(ffs, "shaped run 0", style, 16); // evicted, shaped and cached again
+	Qk_TEST_EXPECT(pool->shapedRunsCapacity() != capacity);
+
+	// a new font family clears all the runs, it may change the fallback typefaces
+	pool->addFontFamily(fs_read_file_sync(fs_resources("jsapi/res/lateef.ttf")));
+	Qk_TEST_EQ(pool->shapedRunsCapacity(), 0);
+
+	// the too large run is not cached
+	pool->set_shapedRunsMaxCapacity(1024);
+	shape(ffs, String::format("%0256d", 0), style, 16);
+	Qk_TEST_EQ(pool->shapedRunsCapacity(), 0);
+
+	pool->set_shapedRunsMaxCapacity(maxCapacity);
+}
@@ -0,0 +1,71 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include <src/ui/app.h>
+#include <src/render/soft/soft_render.h>
+#include "./test.h"
+
+using namespace qk;
+
+static uint32_t pixelAt(const Pixel &pix, int x, int y) {
+	return reinterpret_cast<const uint32_t*>(pix.val() + pix.rowbytes() * y)[x];
+}
+
+Qk_TEST_Func(soft_canvas) {
+	App app;
+	auto render = static_cast<SoftRender*>(make_soft_render({}));
+	auto canvas = render->softCanvas();
+	canvas->setSurface(Mat4(), {64,64}, {1,1});
+
+	Paint paint;
+	canvas->clearColor(Color4f(0, 0, 0, 1));
+	paint.fill.color = Color4f(1, 0, 0, 1);
+	canvas->drawRect({{8,8},{16,16}}, paint);
+	paint.fill.color = Color4f(0, 0, 1, 0.5);
+	canvas->drawCircle({40,40}, 10, paint);
+	canvas->save();
+	canvas->clipRect({{0,48},{64,16}}, Canvas::kIntersect_ClipOp, false);
+	canvas->drawColor(Color4f(0, 1, 0, 1), kSrcOver_BlendMode);
+	canvas->restore(1);
+
+	Qk_TEST_EXPECT(canvas->swapBuffer());
+
+	canvas->flushBuffer([](const Pixel &pix) {
+		Qk_TEST_EQ(pix.width(), 64);
+		Qk_TEST_EQ(pixelAt(pix, 0, 0), 0xff000000u); // clear color
+		Qk_TEST_EQ(pixelAt(pix, 12, 12), 0xff0000ffu); // red rect
+		Qk_TEST_EQ(pixelAt(pix, 40, 20), 0xff000000u); // out of circle
+		auto c = pixelAt(pix, 40, 40); // half blue over black
+		Qk_TEST_EXPECT(((c >> 16) & 0xff) >= 126 && ((c >> 16) & 0xff) <= 129);
+		Qk_TEST_EQ(pixelAt(pix, 2, 50), 0xff00ff00u); // clipped green
+		Qk_TEST_EQ(pixelAt(pix, 2, 46), 0xff000000u); // out of clip
+	});
+	render->release();
+}
@@ -0,0 +1,84 @@
+#include <src/ui/app.h>
+#include <src/ui/window.h>
+#include <src/ui/view/root.h>
+#include <src/ui/view/world.h>
+#include <src/ui/view/sprite.h>
+#include "./test.h"
+
+using namespace qk;
+
+/**
+ * Step the same agents in the serial mode and in the parallel mode of World,
+ * the results are bit-identical as both step from the snapshot of the frame.
+ */
+
+static constexpr int kPairs = 24;
+
+// The pairs of agents move head-on to each other, so they avoid and collide each other.
+// The pairs are far apart, the sum of avoidance only has one term and doesn't depend on
+// the order of the entities, so the two worlds are comparable.
+static Array<Agent*> build_world_agents(World *world, bool parallel) {
+	Array<Agent*> agents;
+	world->set_parallel(parallel);
+	world->set_subSteps(2);
+	for (int i = 0; i < kPairs * 2; i++) {
+		Agent* agent = world->append_new<Sprite>(); // a sprite without image as agent
+		Entity::Bounds bounds;
+		bounds.type = Entity::kCircle;
+		bounds.radius = 8 + i % 3;
+		bounds.pts = nullptr;
+		agent->set_bounds(bounds);
+		agent->set_active(true);
+		agent->set_velocityMax(60 + i % 5 * 10);
+		float y = (i >> 1) * 400;
+		if (i & 1) {
+			agent->set_translate({200, y + 3});
+			agent->moveTo({0, y});
+		} else {
+			agent->set_translate({0, y});
+			agent->moveTo({200, y + 3});
+		}
+		agents.push(agent);
+	}
+	return agents;
+}
+
+Qk_TEST_Func(world_parallel) {
+	App app;
+	auto win = Window::Make({.frame={{0,0}, {400,400}}, .title="Test World Parallel"});
+	win->activate();
+	auto serial = win->root()->append_new<World>(); // not playing, stepped by the test
+	auto parallel = win->root()->append_new<World>();
+	auto a = build_world_agents(serial, false);
+	auto b = build_world_agents(parallel, true);
+
+	// step after the agents are added to the worlds and their bounds are solved
+	app.loop()->timer(Cb([win,serial,parallel,a,b](auto e) {
+		{
+			UILock lock(win);
+			int64_t time = 0, delta = 16000; // fixed time step
+			for (int frame = 0; frame < 120; frame++) {
+				time += delta;
+				serial->run_task(time, delta);
+				parallel->run_task(time, delta);
+			}
+		}
+		uint32_t moved = 0, diff = 0;
+		for (uint32_t i = 0; i < a.length(); i++) {
+			auto pa = a[i]->translate(), pb = b[i]->translate();
+			auto va = a[i]->velocity(), vb = b[i]->velocity();
+			if (memcmp(&pa, &pb, sizeof(Vec2)) || memcmp(&va, &vb, sizeof(Vec2))) {
+				if (diff++ < 10)
+					Qk_Log("agent %d, serial: %f, %f, parallel: %f, %f", i, pa.x(), pa.y(), pb.x(), pb.y());
+			}
+			if (pa.x() != 0 && pa.x() != 200)
+				moved++;
+		}
+		Qk_Log("world parallel, agents: %d, moved: %d, mismatches: %d", a.length(), moved, diff);
+		Qk_TEST_EXPECT(moved > 0);
+		Qk_TEST_EQ(diff, 0);
+		win->close();
+	}), 500);
+
+	app.run();
+}
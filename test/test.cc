@@ -109,6 +109,7 @@ void call_test(int argc, char** argv, const char* funcName, TestFunc func) {
 //-----------------------------------------------------------------------------
 
 #define TEST_UTILS(F) \
+	F(allocator) \
 	F(atomic) \
 	F(buffer) \
 	F(event) \
@@ -123,6 +124,7 @@ void call_test(int argc, char** argv, const char* funcName, TestFunc func) {
 	F(json) \
 	F(list) \
 	F(localstorage) \
+	F(lmdb) \
 	F(loop) \
 	F(map) \
 	F(mutex) \
@@ -159,6 +161,14 @@ void call_test(int argc, char** argv, const char* funcName, TestFunc func) {
 	F(media) \
 	F(freetype) \
 	F(gui) \
+	F(hit_grid) \
+	F(image_pool) \
+	F(img_scale) \
+	F(img_progressive) \
+	F(shaped_runs) \
+	F(world_parallel) \
+	F(layout_parallel) \
+	F(partial_redraw) \
 	F(input) \
 	F(jsc) \
 	F(jsx) \
@@ -168,6 +178,10 @@ void call_test(int argc, char** argv, const char* funcName, TestFunc func) {
 	F(openurl) \
 	F(outimg) \
 	F(rrect) \
+	F(soft_canvas) \
+	F(render_bench) \
+	F(pathv_cache_lru) \
+	F(render_frame_allocs) \
 	F(subcanvas) \
 	F(jsapi) \
 	F(v8) \
@@ -0,0 +1,76 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Distributed under the BSD license:
+ *
+ * Copyright (c) 2015, Louis.chu
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Louis.chu nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Louis.chu BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include <src/util/array.h>
+#include <src/util/allocator.h>
+#include "../test.h"
+
+using namespace qk;
+
+static void draw_frame(LinearAllocator *frame, uint32_t count) {
+	// the frame-local containers of a frame, as GPUCanvas::drawTextBlobAtlas
+	Array<uint64_t> offset(frame);
+	Array<uint16_t> indices(frame);
+	for (uint32_t i = 0; i < count; i++) {
+		offset.push(i);
+		indices.push(uint16_t(i));
+	}
+	indices.reset(0);
+	void *tmp = frame->malloc(count * 3);
+	Qk_TEST_EXPECT(tmp);
+	offset.push(0);
+}
+
+Qk_TEST_Func(allocator) {
+	LinearAllocator frame(1024);
+
+	for (int i = 0; i < 3; i++) { // warm up, the blocks grow to the usage of a frame
+		draw_frame(&frame, 5000);
+		frame.reset();
+	}
+	auto blocks = frame.blocks();
+	auto capacity = frame.capacity();
+	Qk_TEST_EXPECT(blocks > 1);
+
+	for (int i = 0; i < 100; i++) { // steady state, no heap allocations
+		draw_frame(&frame, 5000);
+		frame.reset();
+		Qk_TEST_EQ(frame.blocks(), blocks);
+		Qk_TEST_EQ(frame.capacity(), capacity);
+	}
+
+	draw_frame(&frame, 20000); // a larger frame grows the blocks
+	frame.reset();
+	Qk_TEST_EXPECT(frame.capacity() > capacity);
+
+	frame.clear(); // keep only the first block
+	Qk_TEST_EQ(frame.blocks(), 1);
+	Qk_TEST_EQ(frame.capacity(), 1024);
+}
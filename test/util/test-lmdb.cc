@@ -0,0 +1,130 @@
+#include "src/util/lmdb.h"
+#include "src/util/fs.h"
+#include "../test.h"
+
+using namespace qk;
+
+// the keys from the cursor position to the end key, compared as unsigned bytes like LMDB
+static String cursor_keys(LMDB::Cursor *cur, cString& end) {
+	String keys;
+	while (cur->valid()) {
+		String key(*cur->key(), cur->key().length());
+		int cmp = memcmp(key.c_str(), end.c_str(), Qk_Min(key.length(), end.length()));
+		if (cmp > 0 || (cmp == 0 && key.length() > end.length()))
+			break;
+		keys += key + ",";
+		cur->next();
+	}
+	return keys;
+}
+
+Qk_TEST_Func(lmdb) {
+	auto db = LMDB::Make(fs_temp("test_lmdb"));
+	auto dbi = db->dbi("test");
+	String val;
+
+	db->clear(dbi);
+	db->set(dbi, "a", "1");
+	db->set(dbi, "b/1", "2");
+	db->set(dbi, "b/2", "3");
+	db->set(dbi, "b/3", "4");
+	db->set(dbi, "c", "5");
+
+	// commit, the writes are visible together after commit
+	{
+		Sp<LMDB::Txn> txn;
+		Qk_TEST_EQ(db->begin(&txn), 0);
+		Qk_TEST_EQ(txn->set(dbi, "d", "6"), 0);
+		Qk_TEST_EQ(txn->remove(dbi, "a"), 0);
+		Qk_TEST_EXPECT(txn->has(dbi, "d"));
+		Qk_TEST_EXPECT(!txn->has(dbi, "a"));
+		Qk_TEST_EQ(db->get(dbi, "a", &val), 0); // not yet committed
+		Qk_TEST_EQ(val, "1");
+		Qk_TEST_EQ(txn->commit(), 0);
+		Qk_TEST_EXPECT(!txn->active());
+		Qk_TEST_EXPECT(txn->set(dbi, "e", "7") != 0); // finished
+	}
+	Qk_TEST_EQ(db->get(dbi, "d", &val), 0);
+	Qk_TEST_EQ(val, "6");
+	Qk_TEST_EXPECT(!db->has(dbi, "a"));
+
+	// abort, the writes are discarded
+	{
+		Sp<LMDB::Txn> txn;
+		Qk_TEST_EQ(db->begin(&txn), 0);
+		txn->set(dbi, "a", "8");
+		txn->remove(dbi, "c");
+		txn->abort();
+		Qk_TEST_EXPECT(!txn->active());
+	}
+	Qk_TEST_EXPECT(!db->has(dbi, "a"));
+	Qk_TEST_EXPECT(db->has(dbi, "c"));
+
+	// destroying an unfinished transaction aborts it and releases the write lock
+	{
+		Sp<LMDB::Txn> txn;
+		Qk_TEST_EQ(db->begin(&txn), 0);
+		txn->set(dbi, "a", "9");
+	}
+	Qk_TEST_EXPECT(!db->has(dbi, "a"));
+
+	// the nested writes on the thread holding the write transaction fail instead of waiting forever
+	{
+		Sp<LMDB::Txn> txn, nested;
+		Qk_TEST_EQ(db->begin(&txn), 0);
+		Qk_TEST_EXPECT(db->set(dbi, "a", "10") != 0);
+		Qk_TEST_EXPECT(db->remove(dbi, "c") != 0);
+		Qk_TEST_EXPECT(db->begin(&nested) != 0);
+		Qk_TEST_EQ(db->get(dbi, "c", &val), 0); // reads are still allowed
+		Qk_TEST_EQ(db->begin(&nested, true), 0);
+		nested->abort();
+		txn->commit();
+		Qk_TEST_EQ(db->set(dbi, "a", "11"), 0); // finished, writes again
+		db->remove(dbi, "a");
+	}
+
+	// cursor, prefix and range iteration in key order
+	{
+		Sp<LMDB::Txn> txn;
+		Sp<LMDB::Cursor> cur;
+		Qk_TEST_EQ(db->begin(&txn, true), 0);
+		Qk_TEST_EQ(txn->cursor(dbi, &cur), 0);
+		Qk_TEST_EXPECT(!cur->valid());
+
+		Qk_TEST_EXPECT(cur->first());
+		Qk_TEST_EQ(cursor_keys(*cur, "\xFF"), "b/1,b/2,b/3,c,d,");
+
+		Qk_TEST_EXPECT(cur->seek("b/"));
+		Qk_TEST_EQ(cursor_keys(*cur, "b/\xFF"), "b/1,b/2,b/3,");
+
+		Qk_TEST_EXPECT(cur->seek("b/2"));
+		Qk_TEST_EQ(String(*cur->val(), cur->val().length()), "3");
+		Qk_TEST_EQ(cursor_keys(*cur, "c"), "b/2,b/3,c,");
+
+		Qk_TEST_EXPECT(!cur->seek("e")); // past the last key
+		Qk_TEST_EXPECT(!cur->next());
+		txn->commit();
+	}
+
+	// cursor removes the prefix inside a write transaction
+	{
+		Sp<LMDB::Txn> txn;
+		Sp<LMDB::Cursor> cur;
+		Qk_TEST_EQ(db->begin(&txn), 0);
+		Qk_TEST_EQ(txn->cursor(dbi, &cur), 0);
+		cur->seek("b/");
+		while (cur->valid() && cur->key().length() > 2 && memcmp(*cur->key(), "b/", 2) == 0) {
+			Qk_TEST_EQ(cur->remove(), 0);
+		}
+		Qk_TEST_EQ(txn->commit(), 0);
+	}
+	Array<LMDB::Pair> pairs;
+	Qk_TEST_EQ(db->scan_prefix(dbi, "b/", &pairs), 0);
+	Qk_TEST_EQ(pairs.length(), 0);
+	Qk_TEST_EQ(db->scan_range(dbi, "", "\xFF", &pairs), 0);
+	Qk_TEST_EQ(pairs.length(), 2);
+	Qk_TEST_EQ(pairs[0].first, "c");
+	Qk_TEST_EQ(pairs[1].first, "d");
+
+	db->clear(dbi);
+}
@@ -80,5 +80,107 @@ Qk_TEST_Func(loop) {
 
 	loop->run();
 
+	// post from several threads at once
+	std::atomic_int count(0);
+	auto keep = loop->timer(Cb([](auto &e){}), 10e3); // keep loop
+	for (int j = 0; j < 4; j++) {
+		thread_new([&](auto t) {
+			for (int i = 0; i < 10000; i++) {
+				loop->post(Cb([&](auto &e) {
+					if (++count == 40000) {
+						loop->timer_stop(keep);
+						loop->stop();
+					}
+				}));
+			}
+			return 0;
+		}, "test_post");
+	}
+
+	loop->run();
+
+	Qk_TEST_EQ(count.load(), 40000);
+
+	// work groups and priorities
+	Sp<WorkGroup> group = new WorkGroup();
+	std::atomic_int works(0), dones(0);
+	for (int i = 0; i < 100; i++) {
+		loop->work(Cb([&](auto &e) {
+			thread_sleep(1e3);
+			works++;
+		}), Cb([&](auto &e) {
+			dones++;
+		}), i % 2 ? RunLoop::kWorkHigh: RunLoop::kWorkLow, group.get());
+	}
+	Qk_TEST_EXPECT(group->wait());
+	Qk_TEST_EQ(works.load(), 100);
+	Qk_TEST_EQ(group->pending(), 0);
+
+	loop->run(); // run the done callbacks
+	Qk_TEST_EQ(dones.load(), 100);
+
+	Sp<WorkGroup> group2 = new WorkGroup();
+	group2->cancel();
+	loop->work(Cb([&](auto &e) { works++; }), Cb([&](auto &e) { dones++; }), RunLoop::kWorkNormal, group2.get());
+	Qk_TEST_EXPECT(group2->wait());
+	loop->run();
+	Qk_TEST_EQ(works.load(), 100); // cancelled, neither work nor done is called
+	Qk_TEST_EQ(dones.load(), 100);
+
+	// a saturated pool starts the queued high priority works before the low ones
+	{
+		Sp<WorkGroup> group = new WorkGroup();
+		std::atomic_int running(0), seq(0);
+		std::atomic_bool gate(false);
+		int highs[20], lows[20];
+		for (int i = 0; i < 32; i++) { // more than the workers of the pool, at most 16
+			loop->work(Cb([&](auto &e) {
+				running++;
+				while (!gate.load())
+					thread_sleep(1e3);
+			}), 0, RunLoop::kWorkHigh, group.get());
+		}
+		thread_sleep(2e5); // all the workers are blocked
+		int workers = running.load();
+		for (int i = 0; i < 20; i++) // the low ones are queued first
+			loop->work(Cb([&,i](auto &e) { lows[i] = seq++; }), 0, RunLoop::kWorkLow, group.get());
+		for (int i = 0; i < 20; i++)
+			loop->work(Cb([&,i](auto &e) { highs[i] = seq++; }), 0, RunLoop::kWorkHigh, group.get());
+		gate = true;
+		Qk_TEST_EXPECT(group->wait());
+		loop->run();
+
+		int lastHigh = 0, lowsBefore = 0;
+		for (int i = 0; i < 20; i++)
+			lastHigh = Qk_Max(lastHigh, highs[i]);
+		for (int i = 0; i < 20; i++) {
+			if (lows[i] < lastHigh)
+				lowsBefore++;
+		}
+		Qk_Log("saturated pool, workers: %d, low works started before the last high one: %d", workers, lowsBefore);
+		Qk_TEST_EXPECT(workers > 0);
+		// only the workers that take the last high works at the same time may start a low one earlier
+		Qk_TEST_EXPECT(lowsBefore < workers);
+	}
+
+	// clear() discards the works, a running work completes without calling done
+	{
+		Sp<WorkGroup> group = new WorkGroup();
+		std::atomic_bool gate(false), started(false);
+		int done = 0;
+		loop->work(Cb([&](auto &e) {
+			started = true;
+			while (!gate.load())
+				thread_sleep(1e3);
+		}), Cb([&](auto &e) { done++; }), RunLoop::kWorkNormal, group.get());
+		while (!started.load())
+			thread_sleep(1e3);
+		loop->clear();
+		gate = true;
+		Qk_TEST_EXPECT(group->wait());
+		loop->run(); // run the completion posted by the work
+		Qk_TEST_EQ(done, 0);
+	}
+
 	Qk_Log("Loop ok");
 }
@@ -32,13 +32,108 @@
 #include <src/util/list.h>
 #include <src/util/string.h>
 #include <src/util/dict.h>
+#include <src/util/flat_dict.h>
+#include <src/util/util.h>
 #include <map>
+#include <inttypes.h>
 #include "../test.h"
 
 using namespace qk;
 
+static void test_flat_dict() {
+	FlatDict<String, String> map;
+
+	Qk_TEST_EXPECT(map.find("AA") == map.end());
+	Qk_TEST_EQ(map.length(), 0);
+
+	map.set("AA1", "BB");
+	map.set("AA2", "BB1");
+	map["AA3"] = "BB2";
+	Qk_TEST_EQ(map.length(), 3);
+	Qk_TEST_EXPECT(map.has("AA2"));
+	Qk_TEST_EXPECT(map["AA3"] == "BB2");
+	Qk_TEST_EXPECT(!map.add("AA1"));
+
+	map.set("AA1", "CC");
+	Qk_TEST_EQ(map.length(), 3);
+	Qk_TEST_EXPECT(map.get("AA1") == "CC");
+
+	Qk_TEST_EXPECT(map.erase("AA2"));
+	Qk_TEST_EXPECT(!map.erase("AA2"));
+	Qk_TEST_EXPECT(!map.has("AA2"));
+	Qk_TEST_EQ(map.length(), 2);
+
+	FlatDict<uint64_t, uint64_t> ints;
+	Dict<uint64_t, uint64_t> dict;
+
+	for (uint64_t i = 0; i < 10000; i++) { // rehash many times
+		ints.set(i * 7, i);
+		dict.set(i * 7, i);
+	}
+	for (uint64_t i = 0; i < 10000; i += 2) { // erase leaves the deleted slots
+		ints.erase(i * 7);
+		dict.erase(i * 7);
+	}
+	for (uint64_t i = 10000; i < 15000; i++) { // reuse or drop the deleted slots
+		ints.set(i * 7, i);
+		dict.set(i * 7, i);
+	}
+	Qk_TEST_EQ(ints.length(), dict.length());
+
+	uint32_t count = 0;
+	for (auto &i: ints) {
+		uint64_t value;
+		Qk_TEST_EXPECT(dict.get(i.first, value) && value == i.second);
+		count++;
+	}
+	Qk_TEST_EQ(count, dict.length());
+
+	for (auto it = ints.begin(); it != ints.end(); ) { // erase while iterating
+		it = it->second % 3 ? ints.erase(it): ++it;
+	}
+	for (auto &i: dict) {
+		Qk_TEST_EXPECT(ints.has(i.first) == !(i.second % 3));
+	}
+
+	FlatDict<uint64_t, uint64_t> ints2(std::move(ints));
+	Qk_TEST_EQ(ints.length(), 0);
+	Qk_TEST_EXPECT(ints.begin() == ints.end());
+	ints = ints2;
+	Qk_TEST_EQ(ints.length(), ints2.length());
+	ints.clear();
+	Qk_TEST_EQ(ints.length(), 0);
+}
+
+template<class Map>
+static void bench_map(cChar* name, uint32_t len) {
+	Map map;
+	uint64_t sum = 0;
+	auto t0 = time_monotonic();
+	for (uint64_t i = 0; i < len; i++)
+		map.set(i * 2654435761u, i);
+	auto t1 = time_monotonic();
+	for (uint32_t j = 0; j < 4; j++) {
+		for (uint64_t i = 0; i < len * 2; i++) { // half of the lookups miss
+			const uint64_t *out;
+			if (map.get(i * 2654435761u, out))
+				sum += *out;
+		}
+	}
+	auto t2 = time_monotonic();
+	for (uint64_t i = 0; i < len; i++)
+		map.erase(i * 2654435761u);
+	auto t3 = time_monotonic();
+	Qk_Log("%s insert: %dus, lookup: %dus, erase: %dus, sum: %" PRIu64,
+		name, int(t1 - t0), int(t2 - t1), int(t3 - t2), sum);
+}
+
 Qk_TEST_Func(map) {
 
+	test_flat_dict();
+
+	bench_map<Dict<uint64_t, uint64_t>>("Dict", 500000);
+	bench_map<FlatDict<uint64_t, uint64_t>>("FlatDict", 500000);
+
 	std::map<int, String> m;
 
 	m[0] = "-100900978";
@@ -148,4 +148,20 @@ Qk_TEST_Func(zlib) {
 		Qk_Log(str2);
 		Qk_Log(reader.current());
 	}
+
+	{
+		ZipReader reader(fs_documents("test.zip"));
+		reader.open();
+		String names[] = { "aa.txt", "bb.txt", "cc.txt", "dd.txt" };
+		std::atomic_int ok(0);
+		parallel_for(64, [&](uint32_t i) { // concurrent reads use their own zip cursors
+			Buffer buf;
+			auto &name = names[i % 4];
+			if (reader.read_file(name, &buf) && String(*buf) == String("------------- ") + name)
+				ok++;
+		});
+		Qk_TEST_EQ(ok.load(), 64);
+		Buffer buf;
+		Qk_TEST_EXPECT(!reader.read_file("kk.txt", &buf));
+	}
 }